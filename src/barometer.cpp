@@ -1,16 +1,30 @@
 /**
  * @file barometer.cpp
- * @brief BME280/BMP280 barometer module with I2C scanning and EMA smoothing
+ * @brief BME280/BMP280 barometer module with I2C scanning, EMA smoothing
+ *        and barometric altitude
  * @author slopez.tech
  * @date 2025-11-30
+ *
+ * The ESP32-C3 has no FPU, so the sample path stays in the sensor's own
+ * fixed-point units (Pa in Q24.8, 0.01 °C) from compensation through
+ * smoothing to the FDR records; floats are only produced by the getters
+ * for the API.
+ *
+ * Every reading is also turned into altitude above a reference (ground)
+ * pressure, a vertical speed over a short window and a flight phase, so
+ * launch, apogee and landing are flagged as they happen.
  */
 
 #include "barometer.h"
+#include "perf.h"
+#include "logger.h"
 #include <Wire.h>
 #include <Adafruit_Sensor.h>
 #include <Adafruit_BME280.h>
 #include <Adafruit_BMP280.h>
 #include <math.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
 
 // ============================================================================
 // Configuration Constants
@@ -19,20 +33,85 @@
 // I2C Addresses
 static const uint8_t BME280_ADDRESS_PRIMARY = 0x76;
 static const uint8_t BME280_ADDRESS_SECONDARY = 0x77;
-static const uint8_t BME280_CHIP_ID = 0x58;
+static const uint8_t BME280_CHIP_ID = 0x60;
+static const uint8_t BMP280_CHIP_ID = 0x58;
+static const uint8_t REG_CHIP_ID = 0xD0;
+
+// Register map shared by BME280 and BMP280
+static const uint8_t REG_CALIB_START = 0x88; // dig_T1 .. dig_P9, 24 bytes
+static const uint8_t CALIB_LENGTH = 24;
+static const uint8_t REG_DATA_START = 0xF7;  // press_msb .. temp_xlsb, 6 bytes
+static const uint8_t DATA_LENGTH = 6;
+static const int32_t ADC_SKIPPED = 0x80000;  // value reported for a disabled channel
+static const uint8_t REG_CTRL_HUM = 0xF2;    // BME280 only
+static const uint8_t REG_STATUS = 0xF3;
+static const uint8_t REG_CTRL_MEAS = 0xF4;   // osrs_t[7:5] osrs_p[4:2] mode[1:0]
+static const uint8_t STATUS_MEASURING = 0x08;
+static const uint8_t CTRL_MODE_FORCED = 0x01;
+
+// Forced mode: ctrl_meas oversampling fields of each sampling mode (the same
+// settings as the configure*() functions below) and the datasheet maximum
+// measurement time, 1.25 ms + 2.3 ms per temperature and pressure
+// oversample + 0.575 ms. Humidity is skipped, it is never read.
+static const uint8_t OSRS_FAST = (1 << 5) | (1 << 2);          // x1, x1
+static const uint8_t OSRS_BME_PRECISION = (5 << 5) | (5 << 2); // x16, x16
+static const uint8_t OSRS_BMP_PRECISION = (4 << 5) | (4 << 2); // x8, x8
+static const uint32_t CONVERSION_BASE_US = 1250 + 575;
+static const uint32_t CONVERSION_PER_OVERSAMPLE_US = 2300;
 
 // Sensor Configuration
 static const int BAD_READS_MAX = 3;
-static const uint8_t I2C_SCAN_TIMEOUT = 5;
 
-// Pressure Smoothing (EMA)
-static const float PRESSURE_EMA_ALPHA = 0.25f; // 0.0–1.0 (higher = less smoothing)
+// Incremental rescan: addresses probed per barometer_process() call, the
+// probe range, and the backoff between unsuccessful full scans.
+static const uint8_t RESCAN_PROBES_PER_CALL = 4;
+static const uint8_t I2C_FIRST_ADDRESS = 1;
+static const uint8_t I2C_LAST_ADDRESS = 119;
+static const uint32_t RESCAN_BACKOFF_MIN_MS = 250;
+static const uint32_t RESCAN_BACKOFF_MAX_MS = 8000;
+
+// I2C bus speeds, fastest first. The bus starts at the configured clock and
+// steps down one entry whenever I2C_FALLBACK_ERRORS transactions fail in a row.
+static const uint32_t I2C_CLOCK_STEPS[] = {1000000, 400000, 100000};
+static const uint8_t I2C_CLOCK_STEP_COUNT = sizeof(I2C_CLOCK_STEPS) / sizeof(I2C_CLOCK_STEPS[0]);
+static const uint8_t I2C_FALLBACK_ERRORS = 2;
+static const uint32_t I2C_DEFAULT_CLOCK = 100000;
+
+// Wire.endTransmission() result codes
+static const uint8_t I2C_ERR_NACK_ADDR = 2;
+static const uint8_t I2C_ERR_NACK_DATA = 3;
+static const uint8_t I2C_ERR_TIMEOUT = 5;
+
+// Pressure Smoothing (EMA): alpha = 1 / 2^PRESSURE_EMA_SHIFT (higher shift = more smoothing)
+static const uint8_t PRESSURE_EMA_SHIFT = 2; // alpha = 0.25
+
+// Sensor Validation Ranges (0.01 °C; Pa in Q24.8)
+static const int32_t TEMPERATURE_MIN_CDEG = -4000;
+static const int32_t TEMPERATURE_MAX_CDEG = 8500;
+static const uint32_t PRESSURE_MIN_Q8 = 30000UL << 8;  // 300 hPa
+static const uint32_t PRESSURE_MAX_Q8 = 110000UL << 8; // 1100 hPa
+
+// Altitude: standard atmosphere, h = 44330.77 m * (1 - (p / p0)^0.190263),
+// tabulated at init over pressure ratios 0.25-1.25 (Q24) and interpolated
+// linearly (under 10 cm of error near the ground, under 1 m at 9 km)
+static const float ALTITUDE_SCALE_CM = 4433077.0f;
+static const float ALTITUDE_EXPONENT = 0.190263f;
+static const uint32_t ALTITUDE_RATIO_MIN_Q24 = 1UL << 22; // 0.25
+static const uint8_t ALTITUDE_STEP_SHIFT = 17;            // 1/128 per table step
+static const size_t ALTITUDE_TABLE_STEPS = 128;
+
+// Vertical speed: least-squares slope over the readings of the last
+// VSPEED_WINDOW_MS, kept VSPEED_WINDOW_MS / VSPEED_SLOTS apart whatever the
+// sample rate so the cost per reading is bounded
+static const uint32_t VSPEED_WINDOW_MS = 500;
+static const uint8_t VSPEED_SLOTS = 16;
 
-// Sensor Validation Ranges
-static const float TEMPERATURE_MIN = -40.0F;
-static const float TEMPERATURE_MAX = 85.0F;
-static const float PRESSURE_MIN = 300.0F;
-static const float PRESSURE_MAX = 1100.0F;
+// Flight detection thresholds
+static const int32_t LAUNCH_ALTITUDE_CM = 1000;  // 10 m above the reference...
+static const int32_t LAUNCH_SPEED_CMS = 500;     // ...and climbing at 5 m/s
+static const int32_t APOGEE_DROP_CM = 300;       // 3 m below the highest reading, descending
+static const int32_t LANDING_SPEED_CMS = 200;    // |vertical speed| below 2 m/s...
+static const uint32_t LANDING_HOLD_MS = 5000;    // ...for 5 s
 
 // ============================================================================
 // Static Runtime Variables
@@ -43,11 +122,95 @@ static Adafruit_BMP280 bmp;
 static bool bme_ok = false;
 static bool bmp_used = false;
 static int bad_read_count = 0;
-static float lastTemp = NAN;
-static float lastPressure = NAN;
-static float pressure_ema = NAN;
+// Latest readings (temperature, smoothed pressure); written under
+// `reading_mux` so that other tasks get both values from the same sample
+// through barometer_getReading()
+static bool lastValid = false;
+static int32_t lastTemp_cdeg = 0;    // 0.01 °C
+static uint32_t lastPressure_q8 = 0; // Pa, Q24.8, EMA-smoothed
+static uint32_t lastRawPressure_q8 = 0; // Pa, Q24.8, as compensated
+static uint32_t reading_seq = 0;     // readings stored since boot
+static int64_t reading_t_us = 0;     // esp_timer time of the latest one
+static portMUX_TYPE reading_mux = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t pressure_ema_q8 = 0; // 0 until the first reading
+
+// Altitude conversion table (cm by pressure ratio), filled by barometer_init()
+static int32_t altitude_table_cm[ALTITUDE_TABLE_STEPS + 1];
+
+// Reference pressure and its reciprocal (2^48 / p0_q8), set on the first
+// reading or on request; the request is taken under `reading_mux` and
+// applied by barometer_process() (0 = capture the current pressure)
+static uint32_t reference_q8 = 0;
+static uint32_t reference_inverse = 0;
+static bool reference_requested = false;
+static uint32_t reference_request_q8 = 0;
+
+// Vertical speed window, oldest first from `vspeed_first` (sampler task only)
+struct AltitudeSample {
+  uint32_t t_ms;
+  int32_t altitude_cm;
+};
+static AltitudeSample vspeed_window[VSPEED_SLOTS];
+static uint8_t vspeed_first = 0;
+static uint8_t vspeed_count = 0;
+
+// Flight detection state (sampler task only) and the published snapshot,
+// written under `reading_mux`
+static uint32_t landing_still_since_ms = 0;
+static int64_t apogee_t_us = 0;
+static BarometerFlight flight = {};
 static int deviceCount = 0;
 
+// Rescan state machine. The probe order is the two known sensor addresses
+// first, then the rest of the bus; `rescan_index` walks that order.
+enum class RescanState : uint8_t { Probing, Backoff };
+static RescanState rescan_state = RescanState::Probing;
+static uint8_t rescan_index = 0;
+static uint8_t rescan_found = 0;
+static uint32_t rescan_resume_ms = 0;
+static uint32_t rescan_backoff_ms = RESCAN_BACKOFF_MIN_MS;
+static const uint8_t RESCAN_KNOWN_COUNT = 2;
+static const uint8_t RESCAN_ORDER_LENGTH =
+  RESCAN_KNOWN_COUNT + (I2C_LAST_ADDRESS - I2C_FIRST_ADDRESS + 1);
+static uint8_t sensor_address = 0;
+
+/**
+ * @brief Bosch trimming coefficients, read once per sensor initialization.
+ */
+struct BoschCalibration {
+  uint16_t T1;
+  int16_t T2, T3;
+  uint16_t P1;
+  int16_t P2, P3, P4, P5, P6, P7, P8, P9;
+};
+static BoschCalibration calib = {};
+static bool calib_ok = false;
+
+// Sampling mode requested by barometer_setFastMode() and the mode the sensor
+// is actually configured for. The switch is applied from barometer_process()
+// so that only the task running it ever touches the I2C bus.
+static volatile bool fast_mode_requested = false;
+static bool fast_mode_applied = false;
+
+// Forced mode requested by barometer_setForcedMode() and applied the same
+// way; `conversion_started_us` is the barometer_trigger() time of the
+// conversion not read yet (0 = none)
+static volatile bool forced_mode_requested = false;
+static bool forced_mode_applied = false;
+static int64_t conversion_started_us = 0;
+
+// Bus clock requested by barometer_setBusClock() (applied, like the sampling
+// mode, from barometer_process()), and the clock currently in use.
+static volatile uint32_t bus_clock_requested = I2C_DEFAULT_CLOCK;
+static uint32_t bus_clock_preferred = 0;
+static uint32_t bus_clock_applied = 0;
+static uint8_t consecutive_bus_errors = 0;
+
+// Data-path transaction counters, guarded by `bus_stats_mux`
+static BarometerBusStats bus_stats = {};
+static uint64_t bus_total_us = 0;
+static portMUX_TYPE bus_stats_mux = portMUX_INITIALIZER_UNLOCKED;
+
 // ============================================================================
 // Forward Declarations
 // ============================================================================
@@ -56,13 +219,29 @@ static void configureBME280HighPrecision();
 static void configureBMP280HighPrecision();
 static void configureBME280FastMode();
 static void configureBMP280FastMode();
-static bool validateSensorReadings(float temperature, float pressure);
-static void initializePressureEMA(float initial_pressure);
-static void updatePressureEMA(float raw_pressure);
+static bool validateSensorReadings(int32_t temperature_cdeg, uint32_t pressure_q8);
+static uint32_t filterPressure(uint32_t ema_q8, uint32_t raw_q8);
+static void initializePressureEMA(uint32_t initial_q8);
+static void updatePressureEMA(uint32_t raw_q8);
 static bool attemptBME280Init(uint8_t address);
 static bool attemptBMP280Init(uint8_t address);
 static bool readChipID(uint8_t address, uint8_t &chipid);
-static void scanAndTryInit();
+static void startRescan();
+static void rescanStep();
+static void applySamplingMode(bool fast);
+static void applyForcedMode(bool forced);
+static void applyRequestedModes();
+static bool conversionDone();
+static uint8_t samplingOversampling(bool fast);
+static bool loadCalibration(uint8_t address);
+static void applyBusClock(uint32_t hz);
+static bool readDataBlock(int32_t &adc_T, int32_t &adc_P);
+static int32_t compensateTemperature(int32_t adc_T, int32_t &t_fine);
+static uint32_t compensatePressure(int32_t adc_P, int32_t t_fine);
+static void buildAltitudeTable();
+static int32_t altitudeCm(uint32_t pressure_q8);
+static int32_t updateVerticalSpeed(uint32_t t_ms, int32_t altitude_cm);
+static void updateFlight(int64_t t_us, uint32_t pressure_q8, uint32_t smoothed_q8);
 
 // ============================================================================
 // Helper Functions
@@ -109,7 +288,7 @@ static void configureBME280FastMode() {
     Adafruit_BME280::SAMPLING_X1,
     Adafruit_BME280::SAMPLING_X1,
     Adafruit_BME280::FILTER_OFF,
-    Adafruit_BME280::STANDBY_MS_125
+    Adafruit_BME280::STANDBY_MS_0_5  // ~6 ms cycle, enough for burst rates
   );
 }
 
@@ -129,34 +308,415 @@ static void configureBMP280FastMode() {
 /**
  * @brief Ensures temperature and pressure readings fall within realistic ranges.
  *
- * @param temperature Celsius temperature reading.
- * @param pressure Pressure in hPa.
+ * @param temperature_cdeg Temperature in 0.01 °C.
+ * @param pressure_q8 Pressure in Pa, Q24.8.
  * @return true Valid range, false otherwise.
  */
-static bool validateSensorReadings(float temperature, float pressure) {
-  return (temperature >= TEMPERATURE_MIN && temperature <= TEMPERATURE_MAX) &&
-         (pressure >= PRESSURE_MIN && pressure <= PRESSURE_MAX);
+static bool validateSensorReadings(int32_t temperature_cdeg, uint32_t pressure_q8) {
+  return (temperature_cdeg >= TEMPERATURE_MIN_CDEG && temperature_cdeg <= TEMPERATURE_MAX_CDEG) &&
+         (pressure_q8 >= PRESSURE_MIN_Q8 && pressure_q8 <= PRESSURE_MAX_Q8);
+}
+
+/**
+ * @brief One EMA step, ema + (raw - ema) * alpha, rounded to nearest.
+ *
+ * A shift instead of a multiply; the 1/256 Pa resolution of Q24.8 is far
+ * below the sensor noise, so no extra fraction bits are needed.
+ */
+static uint32_t filterPressure(uint32_t ema_q8, uint32_t raw_q8) {
+  const int32_t diff = (int32_t)(raw_q8 - ema_q8);
+  return ema_q8 + (uint32_t)((diff + (1 << (PRESSURE_EMA_SHIFT - 1))) >> PRESSURE_EMA_SHIFT);
 }
 
 /**
  * @brief Initializes the pressure EMA filter with a first valid reading.
  *
- * @param initial_pressure First pressure value in hPa.
+ * @param initial_q8 First pressure value in Pa, Q24.8.
  */
-static void initializePressureEMA(float initial_pressure) {
-  if (isnan(pressure_ema)) {
-    pressure_ema = initial_pressure;
+static void initializePressureEMA(uint32_t initial_q8) {
+  if (pressure_ema_q8 == 0) {
+    pressure_ema_q8 = initial_q8;
   }
 }
 
 /**
  * @brief Updates the exponential moving average filter for pressure.
  *
- * @param raw_pressure Latest pressure reading in hPa.
+ * @param raw_q8 Latest pressure reading in Pa, Q24.8.
+ */
+static void updatePressureEMA(uint32_t raw_q8) {
+  pressure_ema_q8 = filterPressure(pressure_ema_q8, raw_q8);
+}
+
+/**
+ * @brief Fills the altitude table. Floats, but only once at init.
+ */
+static void buildAltitudeTable() {
+  for (size_t i = 0; i <= ALTITUDE_TABLE_STEPS; i++) {
+    const float ratio = (ALTITUDE_RATIO_MIN_Q24 + (i << ALTITUDE_STEP_SHIFT)) / 16777216.0f;
+    altitude_table_cm[i] = (int32_t)lroundf(ALTITUDE_SCALE_CM * (1.0f - powf(ratio, ALTITUDE_EXPONENT)));
+  }
+}
+
+/**
+ * @brief Altitude above the reference pressure, integer only.
+ *
+ * @param pressure_q8 Pressure in Pa, Q24.8.
+ * @return Altitude in cm; clamped at the ends of the table.
+ */
+static int32_t altitudeCm(uint32_t pressure_q8) {
+  const uint32_t ratio_q24 = (uint32_t)(((uint64_t)pressure_q8 * reference_inverse) >> 24);
+  if (ratio_q24 <= ALTITUDE_RATIO_MIN_Q24) return altitude_table_cm[0];
+  const uint32_t pos = ratio_q24 - ALTITUDE_RATIO_MIN_Q24;
+  const uint32_t index = pos >> ALTITUDE_STEP_SHIFT;
+  if (index >= ALTITUDE_TABLE_STEPS) return altitude_table_cm[ALTITUDE_TABLE_STEPS];
+  const int32_t frac = (int32_t)(pos & ((1u << ALTITUDE_STEP_SHIFT) - 1));
+  const int32_t low = altitude_table_cm[index];
+  const int32_t high = altitude_table_cm[index + 1];
+  return low + (int32_t)(((int64_t)(high - low) * frac) >> ALTITUDE_STEP_SHIFT);
+}
+
+/**
+ * @brief Sets the reference pressure and restarts flight detection.
+ */
+static void applyReference(uint32_t pressure_q8) {
+  reference_q8 = pressure_q8;
+  reference_inverse = (uint32_t)((1ULL << 48) / pressure_q8);
+  vspeed_count = 0;
+  landing_still_since_ms = 0;
+
+  portENTER_CRITICAL(&reading_mux);
+  flight.reference_q8 = pressure_q8;
+  flight.phase = BarometerPhase::Ground;
+  flight.apogee_cm = 0;
+  portEXIT_CRITICAL(&reading_mux);
+
+  LOG_INFO("Barometer: altitude reference %u.%02u hPa",
+           (unsigned)((pressure_q8 >> 8) / 100), (unsigned)((pressure_q8 >> 8) % 100));
+}
+
+/**
+ * @brief Adds a reading to the vertical speed window and fits it.
+ *
+ * A reading closer than one slot to the previous one replaces it, so the
+ * window always ends at the latest reading.
+ *
+ * @return Vertical speed in cm/s, 0 until the window has two readings.
+ */
+static int32_t updateVerticalSpeed(uint32_t t_ms, int32_t altitude_cm) {
+  static const uint32_t SLOT_MS = VSPEED_WINDOW_MS / VSPEED_SLOTS;
+  const auto at = [](uint8_t i) -> AltitudeSample & {
+    return vspeed_window[(vspeed_first + i) % VSPEED_SLOTS];
+  };
+
+  if (vspeed_count >= 2 && t_ms - at(vspeed_count - 2).t_ms < SLOT_MS) {
+    at(vspeed_count - 1) = {t_ms, altitude_cm};
+  } else {
+    if (vspeed_count == VSPEED_SLOTS) {
+      vspeed_first = (uint8_t)((vspeed_first + 1) % VSPEED_SLOTS);
+      vspeed_count--;
+    }
+    at(vspeed_count++) = {t_ms, altitude_cm};
+  }
+  // Keep one reading at least a window old, if there is one
+  while (vspeed_count > 2 && t_ms - at(1).t_ms >= VSPEED_WINDOW_MS) {
+    vspeed_first = (uint8_t)((vspeed_first + 1) % VSPEED_SLOTS);
+    vspeed_count--;
+  }
+  if (vspeed_count < 2) return 0;
+
+  // Least squares around the latest reading keeps the sums small
+  int64_t sx = 0, sy = 0, sxx = 0, sxy = 0;
+  for (uint8_t i = 0; i < vspeed_count; i++) {
+    const int64_t x = -(int64_t)(t_ms - at(i).t_ms);
+    const int64_t y = at(i).altitude_cm - altitude_cm;
+    sx += x;
+    sy += y;
+    sxx += x * x;
+    sxy += x * y;
+  }
+  const int64_t n = vspeed_count;
+  const int64_t den = n * sxx - sx * sx;
+  if (den == 0) return 0;
+  const int64_t num = (n * sxy - sx * sy) * 1000; // cm/ms -> cm/s
+  return (int32_t)((num + (num >= 0 ? den / 2 : -den / 2)) / den);
+}
+
+/**
+ * @brief Updates altitude, vertical speed and flight phase with one
+ * reading, flagging launch, apogee and landing as they are detected.
+ *
+ * @param t_us esp_timer time of the reading.
+ * @param pressure_q8 Compensated pressure, Pa Q24.8.
+ * @param smoothed_q8 EMA-smoothed pressure, used to capture the reference.
+ */
+static void updateFlight(int64_t t_us, uint32_t pressure_q8, uint32_t smoothed_q8) {
+  portENTER_CRITICAL(&reading_mux);
+  const bool requested = reference_requested;
+  const uint32_t requested_q8 = reference_request_q8;
+  reference_requested = false;
+  portEXIT_CRITICAL(&reading_mux);
+  if (requested || reference_q8 == 0) applyReference(requested_q8 ? requested_q8 : smoothed_q8);
+
+  const uint32_t t_ms = (uint32_t)(t_us / 1000);
+  const int32_t altitude_cm = altitudeCm(pressure_q8);
+  const int32_t vspeed_cms = updateVerticalSpeed(t_ms, altitude_cm);
+
+  BarometerPhase phase = flight.phase; // only written from this task
+  int32_t apogee_cm = flight.apogee_cm;
+  BarometerEvent event = BarometerEvent::None;
+  int64_t event_us = t_us;
+  int32_t event_cm = altitude_cm;
+  switch (phase) {
+    case BarometerPhase::Ground:
+      if (altitude_cm >= LAUNCH_ALTITUDE_CM && vspeed_cms >= LAUNCH_SPEED_CMS) {
+        phase = BarometerPhase::Ascent;
+        event = BarometerEvent::Launch;
+        apogee_cm = altitude_cm;
+        apogee_t_us = t_us;
+      }
+      break;
+    case BarometerPhase::Ascent:
+      if (altitude_cm > apogee_cm) {
+        apogee_cm = altitude_cm;
+        apogee_t_us = t_us;
+      } else if (altitude_cm <= apogee_cm - APOGEE_DROP_CM && vspeed_cms < 0) {
+        phase = BarometerPhase::Descent;
+        event = BarometerEvent::Apogee;
+        event_us = apogee_t_us;
+        event_cm = apogee_cm;
+      }
+      break;
+    case BarometerPhase::Descent: {
+      const int32_t speed = vspeed_cms < 0 ? -vspeed_cms : vspeed_cms;
+      if (speed >= LANDING_SPEED_CMS) {
+        landing_still_since_ms = 0;
+      } else if (landing_still_since_ms == 0) {
+        landing_still_since_ms = t_ms ? t_ms : 1;
+      } else if (t_ms - landing_still_since_ms >= LANDING_HOLD_MS) {
+        phase = BarometerPhase::Landed;
+        event = BarometerEvent::Landing;
+      }
+      break;
+    }
+    case BarometerPhase::Landed:
+      break;
+  }
+
+  portENTER_CRITICAL(&reading_mux);
+  flight.valid = true;
+  flight.t_us = t_us;
+  flight.altitude_cm = altitude_cm;
+  flight.vspeed_cms = vspeed_cms;
+  flight.phase = phase;
+  flight.apogee_cm = apogee_cm;
+  if (event != BarometerEvent::None) {
+    flight.event_count++;
+    flight.last_event = event;
+    flight.last_event_us = event_us;
+    flight.last_event_cm = event_cm;
+  }
+  portEXIT_CRITICAL(&reading_mux);
+
+  if (event != BarometerEvent::None) {
+    static const char* const EVENT_NAMES[] = {"", "launch", "apogee", "landing"};
+    const uint32_t magnitude_cm = event_cm < 0 ? (uint32_t)-event_cm : (uint32_t)event_cm;
+    LOG_INFO("Barometer: %s at %s%u.%02u m", EVENT_NAMES[(uint8_t)event],
+             event_cm < 0 ? "-" : "", (unsigned)(magnitude_cm / 100),
+             (unsigned)(magnitude_cm % 100));
+  }
+}
+
+/**
+ * @brief Sets the I2C clock and records it as the active bus speed.
+ *
+ * @param hz Bus clock in Hz.
+ */
+static void applyBusClock(uint32_t hz) {
+  Wire.setClock(hz);
+  bus_clock_applied = hz;
+  consecutive_bus_errors = 0;
+
+  portENTER_CRITICAL(&bus_stats_mux);
+  bus_stats.clock_hz = hz;
+  bus_stats.configured_clock_hz = bus_clock_preferred;
+  portEXIT_CRITICAL(&bus_stats_mux);
+
+  LOG_INFO("Barometer: I2C clock set to %u Hz", (unsigned)hz);
+}
+
+/**
+ * @brief Drops the bus to the next slower clock step, if there is one.
+ */
+static void fallBackBusClock() {
+  for (uint8_t i = 0; i < I2C_CLOCK_STEP_COUNT; i++) {
+    if (I2C_CLOCK_STEPS[i] < bus_clock_applied) {
+      LOG_WARN("Barometer: I2C errors at %u Hz, falling back", (unsigned)bus_clock_applied);
+      portENTER_CRITICAL(&bus_stats_mux);
+      bus_stats.fallbacks++;
+      portEXIT_CRITICAL(&bus_stats_mux);
+      applyBusClock(I2C_CLOCK_STEPS[i]);
+      return;
+    }
+  }
+}
+
+/**
+ * @brief Accounts one data-path transaction and handles clock fallback.
+ *
+ * @param elapsed_us Transaction duration.
+ * @param err Wire.endTransmission() result (0 = ACK).
+ * @param short_read true if fewer bytes than requested arrived.
+ */
+static void recordBusTransaction(uint32_t elapsed_us, uint8_t err, bool short_read) {
+  const bool failed = err != 0 || short_read;
+
+  portENTER_CRITICAL(&bus_stats_mux);
+  bus_stats.transactions++;
+  bus_stats.last_us = elapsed_us;
+  if (elapsed_us > bus_stats.max_us) bus_stats.max_us = elapsed_us;
+  bus_total_us += elapsed_us;
+  if (failed) {
+    bus_stats.errors++;
+    if (err == I2C_ERR_NACK_ADDR) bus_stats.nack_addr++;
+    else if (err == I2C_ERR_NACK_DATA) bus_stats.nack_data++;
+    else if (err == I2C_ERR_TIMEOUT) bus_stats.timeouts++;
+    else if (err != 0) bus_stats.other_errors++;
+    else bus_stats.short_reads++;
+  }
+  portEXIT_CRITICAL(&bus_stats_mux);
+
+  if (!failed) {
+    consecutive_bus_errors = 0;
+  } else if (++consecutive_bus_errors >= I2C_FALLBACK_ERRORS) {
+    fallBackBusClock();
+  }
+}
+
+/**
+ * @brief Reads `len` consecutive registers in a single I2C transaction.
+ *
+ * Every call is timed and counted in the bus diagnostics.
+ *
+ * @param address I2C device address.
+ * @param reg First register.
+ * @param out Destination buffer.
+ * @param len Number of bytes.
+ * @return true if all bytes were received.
  */
-static void updatePressureEMA(float raw_pressure) {
-  pressure_ema = PRESSURE_EMA_ALPHA * raw_pressure +
-                 (1.0f - PRESSURE_EMA_ALPHA) * pressure_ema;
+static bool readRegisters(uint8_t address, uint8_t reg, uint8_t* out, uint8_t len) {
+  const uint32_t t0 = micros();
+  Wire.beginTransmission(address);
+  Wire.write(reg);
+  const uint8_t err = Wire.endTransmission(false);
+  const bool complete = (err == 0) && Wire.requestFrom(address, len) == len;
+  if (complete) {
+    for (uint8_t i = 0; i < len; i++) out[i] = (uint8_t)Wire.read();
+  }
+  recordBusTransaction(micros() - t0, err, err == 0 && !complete);
+  return complete;
+}
+
+/**
+ * @brief Writes one register of the sensor, timed and counted like the reads.
+ *
+ * @return true if the sensor acknowledged the write.
+ */
+static bool writeRegister(uint8_t reg, uint8_t value) {
+  const uint32_t t0 = micros();
+  Wire.beginTransmission(sensor_address);
+  Wire.write(reg);
+  Wire.write(value);
+  const uint8_t err = Wire.endTransmission();
+  recordBusTransaction(micros() - t0, err, false);
+  return err == 0;
+}
+
+/**
+ * @brief Reads and caches the Bosch trimming coefficients (0x88–0x9F).
+ *
+ * @param address I2C address of the initialized sensor.
+ * @return true on success.
+ */
+static bool loadCalibration(uint8_t address) {
+  uint8_t raw[CALIB_LENGTH];
+  calib_ok = readRegisters(address, REG_CALIB_START, raw, CALIB_LENGTH);
+  if (!calib_ok) {
+    LOG_ERROR("Barometer: failed to read calibration data");
+    return false;
+  }
+
+  auto u16 = [&raw](uint8_t i) { return (uint16_t)(raw[i] | (raw[i + 1] << 8)); };
+  calib.T1 = u16(0);
+  calib.T2 = (int16_t)u16(2);
+  calib.T3 = (int16_t)u16(4);
+  calib.P1 = u16(6);
+  calib.P2 = (int16_t)u16(8);
+  calib.P3 = (int16_t)u16(10);
+  calib.P4 = (int16_t)u16(12);
+  calib.P5 = (int16_t)u16(14);
+  calib.P6 = (int16_t)u16(16);
+  calib.P7 = (int16_t)u16(18);
+  calib.P8 = (int16_t)u16(20);
+  calib.P9 = (int16_t)u16(22);
+  return true;
+}
+
+/**
+ * @brief Burst-reads the pressure and temperature ADC values (0xF7–0xFC).
+ *
+ * One transaction replaces the separate temperature and pressure reads of
+ * the Adafruit drivers (which also re-read temperature for compensation).
+ *
+ * @param adc_T Raw 20-bit temperature.
+ * @param adc_P Raw 20-bit pressure.
+ * @return true if the block was read and both channels hold a measurement.
+ */
+static bool readDataBlock(int32_t &adc_T, int32_t &adc_P) {
+  uint8_t raw[DATA_LENGTH];
+  if (!readRegisters(sensor_address, REG_DATA_START, raw, DATA_LENGTH)) return false;
+  adc_P = ((int32_t)raw[0] << 12) | ((int32_t)raw[1] << 4) | (raw[2] >> 4);
+  adc_T = ((int32_t)raw[3] << 12) | ((int32_t)raw[4] << 4) | (raw[5] >> 4);
+  return adc_T != ADC_SKIPPED && adc_P != ADC_SKIPPED;
+}
+
+/**
+ * @brief Bosch integer temperature compensation (datasheet 4.2.3).
+ *
+ * @param adc_T Raw temperature.
+ * @param t_fine Output fine temperature used by pressure compensation.
+ * @return Temperature in 0.01 °C.
+ */
+static int32_t compensateTemperature(int32_t adc_T, int32_t &t_fine) {
+  const int32_t var1 = ((((adc_T >> 3) - ((int32_t)calib.T1 << 1))) * (int32_t)calib.T2) >> 11;
+  const int32_t d = (adc_T >> 4) - (int32_t)calib.T1;
+  const int32_t var2 = (((d * d) >> 12) * (int32_t)calib.T3) >> 14;
+  t_fine = var1 + var2;
+  return (t_fine * 5 + 128) >> 8;
+}
+
+/**
+ * @brief Bosch 64-bit integer pressure compensation (datasheet 4.2.3).
+ *
+ * @param adc_P Raw pressure.
+ * @param t_fine Fine temperature from compensateTemperature().
+ * @return Pressure in Pa as Q24.8 fixed point, or 0 on invalid calibration.
+ */
+static uint32_t compensatePressure(int32_t adc_P, int32_t t_fine) {
+  int64_t var1 = (int64_t)t_fine - 128000;
+  int64_t var2 = var1 * var1 * (int64_t)calib.P6;
+  var2 = var2 + ((var1 * (int64_t)calib.P5) << 17);
+  var2 = var2 + ((int64_t)calib.P4 << 35);
+  var1 = ((var1 * var1 * (int64_t)calib.P3) >> 8) + ((var1 * (int64_t)calib.P2) << 12);
+  var1 = ((((int64_t)1 << 47) + var1) * (int64_t)calib.P1) >> 33;
+  if (var1 == 0) return 0; // avoid division by zero
+
+  int64_t p = 1048576 - adc_P;
+  p = (((p << 31) - var2) * 3125) / var1;
+  var1 = ((int64_t)calib.P9 * (p >> 13) * (p >> 13)) >> 25;
+  var2 = ((int64_t)calib.P8 * p) >> 19;
+  p = ((p + var1 + var2) >> 8) + ((int64_t)calib.P7 << 4);
+  return (uint32_t)p;
 }
 
 // ============================================================================
@@ -167,77 +727,125 @@ static void updatePressureEMA(float raw_pressure) {
  * @brief Initializes the barometer module.
  *
  * This performs a simple probe on the primary BME280 address.  
- * Full I2C scanning and fallback initialization occurs later inside barometer_process().
+ * If that fails, barometer_process() scans the bus incrementally, a few
+ * addresses per call.
  */
 void barometer_init() {
+  bus_clock_preferred = bus_clock_requested;
+  applyBusClock(bus_clock_preferred);
   bme_ok = bme.begin(BME280_ADDRESS_PRIMARY);
   bmp_used = false;
   bad_read_count = 0;
-  lastTemp = NAN;
-  lastPressure = NAN;
+  portENTER_CRITICAL(&reading_mux);
+  lastValid = false;
+  portEXIT_CRITICAL(&reading_mux);
   deviceCount = 0;
 
+  fast_mode_applied = false;
+  forced_mode_applied = false;
+  buildAltitudeTable();
+
   if (bme_ok) {
+    sensor_address = BME280_ADDRESS_PRIMARY;
+    loadCalibration(sensor_address);
     configureBME280HighPrecision();
-    Serial.println("Barometer: BME/BMP280 initialized with high precision oversampling.");
+    LOG_INFO("Barometer: BME/BMP280 initialized with high precision oversampling.");
   } else {
-    Serial.println("Barometer: Initial probe failed — will scan on process().");
+    LOG_WARN("Barometer: Initial probe failed — will scan on process().");
+    startRescan();
   }
 }
 
 /**
- * @brief Scans the entire I2C bus searching for a BME280 or BMP280.
- *
- * Performs structured fallback:
- *  - Try BME280 at primary address
- *  - Try BME280 at secondary address
- *  - Try BMP280 if chip ID matches
+ * @brief Restarts the incremental bus scan from the known addresses.
  */
-static void scanAndTryInit() {
-  Serial.println("Barometer: Scanning I2C bus...");
-  byte count = 0;
-  uint8_t chipid = 0;
-
-  for (byte i = 1; i < 120; i++) {
-    Wire.beginTransmission(i);
-
-    if (Wire.endTransmission() == 0) {
-      Serial.print("  I2C device at 0x");
-      if (i < 16) Serial.print("0");
-      Serial.println(i, HEX);
-
-      count++;
+static void startRescan() {
+  rescan_state = RescanState::Probing;
+  rescan_index = 0;
+  rescan_found = 0;
+}
 
-      if (i == BME280_ADDRESS_PRIMARY && !bme_ok) {
+/**
+ * @brief Maps a position in the probe order to an I2C address.
+ *
+ * @param index Position, 0 .. RESCAN_ORDER_LENGTH-1.
+ * @return Address to probe, or 0 if this position repeats a known address.
+ */
+static uint8_t rescanAddressAt(uint8_t index) {
+  if (index == 0) return BME280_ADDRESS_PRIMARY;
+  if (index == 1) return BME280_ADDRESS_SECONDARY;
+  const uint8_t address = I2C_FIRST_ADDRESS + (index - RESCAN_KNOWN_COUNT);
+  if (address == BME280_ADDRESS_PRIMARY || address == BME280_ADDRESS_SECONDARY) return 0;
+  return address;
+}
 
-        if (attemptBME280Init(BME280_ADDRESS_PRIMARY)) break;
+/**
+ * @brief Tries to bring up the driver matching the chip ID at `address`.
+ *
+ * Unknown IDs get the BME280 driver first, then BMP280.
+ *
+ * @return true if a sensor was initialized.
+ */
+static bool tryInitAt(uint8_t address) {
+  uint8_t chipid = 0;
+  if (readChipID(address, chipid)) {
+    LOG_DEBUG("  Chip ID at 0x%02X: 0x%02X", address, chipid);
+  }
+  if (chipid == BMP280_CHIP_ID) return attemptBMP280Init(address);
+  if (attemptBME280Init(address)) return true;
+  return chipid != BME280_CHIP_ID && attemptBMP280Init(address);
+}
 
-        if (readChipID(BME280_ADDRESS_PRIMARY, chipid)) {
-          Serial.print("  Chip ID: 0x");
-          Serial.println(chipid, HEX);
-        }
+/**
+ * @brief Advances the bus scan by a few addresses.
+ *
+ * Each call probes at most RESCAN_PROBES_PER_CALL addresses and makes at
+ * most one driver initialization attempt, so a missing or faulty sensor
+ * costs a bounded slice of time per call instead of a full blocking scan.
+ * After an unsuccessful full pass the scan waits with exponential backoff
+ * (RESCAN_BACKOFF_MIN_MS doubling up to RESCAN_BACKOFF_MAX_MS).
+ */
+static void rescanStep() {
+  const uint32_t now = millis();
+  if (rescan_state == RescanState::Backoff) {
+    if ((int32_t)(now - rescan_resume_ms) < 0) return;
+    startRescan();
+  }
+  if (rescan_index == 0) LOG_DEBUG("Barometer: Scanning I2C bus...");
 
-        if (attemptBME280Init(BME280_ADDRESS_PRIMARY)) break;
+  uint8_t probes = 0;
+  while (probes < RESCAN_PROBES_PER_CALL && rescan_index < RESCAN_ORDER_LENGTH) {
+    const uint8_t index = rescan_index++;
+    const uint8_t address = rescanAddressAt(index);
+    if (address == 0) continue;
+    probes++;
 
-        if (attemptBME280Init(BME280_ADDRESS_SECONDARY)) break;
+    Wire.beginTransmission(address);
+    if (Wire.endTransmission() != 0) continue;
 
-        if (chipid == BME280_CHIP_ID && attemptBMP280Init(BME280_ADDRESS_PRIMARY)) break;
+    rescan_found++;
+    LOG_DEBUG("  I2C device at 0x%02X", address);
 
-        Serial.println("  Barometer init failed — continuing scan.");
+    if (address == BME280_ADDRESS_PRIMARY || address == BME280_ADDRESS_SECONDARY) {
+      if (tryInitAt(address)) {
+        rescan_backoff_ms = RESCAN_BACKOFF_MIN_MS;
+        return;
       }
-
-      delay(I2C_SCAN_TIMEOUT);
+      LOG_DEBUG("  Barometer init failed — continuing scan.");
+      return; // one init attempt per call
     }
   }
 
-  deviceCount = count;
+  if (rescan_index < RESCAN_ORDER_LENGTH) return;
 
-  if (count == 0) {
-    Serial.println("Barometer: No I2C devices found.");
-  } else {
-    Serial.print("Barometer: Total devices found: ");
-    Serial.println(count);
-  }
+  deviceCount = rescan_found;
+  LOG_WARN_EVERY(LOGGER_REPEAT_INTERVAL_MS,
+                 "Barometer: scan done, %u device(s) found, no sensor; next scan in %u ms",
+                 (unsigned)rescan_found, (unsigned)rescan_backoff_ms);
+  rescan_state = RescanState::Backoff;
+  rescan_resume_ms = now + rescan_backoff_ms;
+  rescan_backoff_ms = rescan_backoff_ms * 2 > RESCAN_BACKOFF_MAX_MS
+                        ? RESCAN_BACKOFF_MAX_MS : rescan_backoff_ms * 2;
 }
 
 /**
@@ -251,11 +859,13 @@ static bool attemptBME280Init(uint8_t address) {
 
   bme_ok = true;
   bmp_used = false;
+  sensor_address = address;
+  loadCalibration(address);
   configureBME280HighPrecision();
+  fast_mode_applied = false;
+  forced_mode_applied = false;
 
-  Serial.print("Barometer: BME280 initialized at 0x");
-  if (address < 16) Serial.print("0");
-  Serial.println(address, HEX);
+  LOG_INFO("Barometer: BME280 initialized at 0x%02X", address);
   return true;
 }
 
@@ -270,11 +880,13 @@ static bool attemptBMP280Init(uint8_t address) {
 
   bme_ok = true;
   bmp_used = true;
+  sensor_address = address;
+  loadCalibration(address);
   configureBMP280HighPrecision();
+  fast_mode_applied = false;
+  forced_mode_applied = false;
 
-  Serial.print("Barometer: BMP280 initialized at 0x");
-  if (address < 16) Serial.print("0");
-  Serial.println(address, HEX);
+  LOG_INFO("Barometer: BMP280 initialized at 0x%02X", address);
   return true;
 }
 
@@ -287,12 +899,12 @@ static bool attemptBMP280Init(uint8_t address) {
  */
 static bool readChipID(uint8_t address, uint8_t &chipid) {
   Wire.beginTransmission(address);
-  Wire.write(0xD0);
+  Wire.write(REG_CHIP_ID);
   Wire.endTransmission();
   Wire.requestFrom(address, (uint8_t)1);
 
   if (!Wire.available()) {
-    Serial.println("  Failed to read chip ID.");
+    LOG_DEBUG("  Failed to read chip ID.");
     return false;
   }
 
@@ -303,45 +915,76 @@ static bool readChipID(uint8_t address, uint8_t &chipid) {
 /**
  * @brief Performs a complete sensor read cycle (temperature and pressure).
  *
- * Handles detection fallback, bad reading tolerance, and pressure smoothing.
+ * Reads the whole data block in one I2C burst and compensates it once with
+ * the cached calibration, in integer arithmetic. Handles detection fallback,
+ * bad reading tolerance, and pressure smoothing, all in fixed point.
+ * In forced mode the sensor is only read once the conversion started by
+ * barometer_trigger() is complete; other calls return without bus traffic.
+ *
+ * @return true if a new reading was stored.
  */
-void barometer_process() {
+bool barometer_process() {
+  PERF_SCOPE(BarometerProcess);
+  if (bus_clock_requested != bus_clock_preferred) {
+    bus_clock_preferred = bus_clock_requested;
+    applyBusClock(bus_clock_preferred);
+  }
+
   if (!bme_ok) {
-    scanAndTryInit();
-    return;
+    rescanStep();
+    return false;
   }
 
-  float temperature;
-  float raw_pressure;
+  applyRequestedModes();
+  if (forced_mode_applied && !conversionDone()) return false;
 
-  if (bmp_used) {
-    temperature = bmp.readTemperature();
-    raw_pressure = bmp.readPressure() / 100.0F;
-  } else {
-    temperature = bme.readTemperature();
-    raw_pressure = bme.readPressure() / 100.0F;
-  }
+  int32_t adc_T = 0;
+  int32_t adc_P = 0;
+  int32_t temperature_cdeg = 0;
+  uint32_t raw_pressure_q8 = 0;
+  bool stored = false;
+
+  if (!calib_ok) loadCalibration(sensor_address);
+  if (calib_ok && readDataBlock(adc_T, adc_P)) {
+    const int64_t t_us = esp_timer_get_time();
+    int32_t t_fine;
+    temperature_cdeg = compensateTemperature(adc_T, t_fine);
+    raw_pressure_q8 = compensatePressure(adc_P, t_fine);
 
-  initializePressureEMA(raw_pressure);
-  updatePressureEMA(raw_pressure);
+    initializePressureEMA(raw_pressure_q8);
+    updatePressureEMA(raw_pressure_q8);
 
-  lastTemp = temperature;
-  lastPressure = pressure_ema;
+    portENTER_CRITICAL(&reading_mux);
+    lastValid = true;
+    lastTemp_cdeg = temperature_cdeg;
+    lastPressure_q8 = pressure_ema_q8;
+    lastRawPressure_q8 = raw_pressure_q8;
+    reading_seq++;
+    reading_t_us = t_us;
+    portEXIT_CRITICAL(&reading_mux);
+    stored = true;
 
-  if (validateSensorReadings(temperature, raw_pressure)) {
+    if (validateSensorReadings(temperature_cdeg, raw_pressure_q8)) {
+      updateFlight(t_us, raw_pressure_q8, pressure_ema_q8);
+    }
+  }
+  // A failed bus read leaves a zero pressure here and counts as a bad reading below
+
+  if (validateSensorReadings(temperature_cdeg, raw_pressure_q8)) {
     bad_read_count = 0;
   } else {
     bad_read_count++;
-    Serial.print("Barometer: Bad reading #");
-    Serial.println(bad_read_count);
+    LOG_WARN_EVERY(LOGGER_REPEAT_INTERVAL_MS, "Barometer: Bad reading #%d", bad_read_count);
 
     if (bad_read_count >= BAD_READS_MAX) {
-      Serial.println("Barometer: Consecutive bad readings — forcing re-scan.");
+      LOG_WARN("Barometer: Consecutive bad readings — forcing re-scan.");
       bme_ok = false;
       bmp_used = false;
       bad_read_count = 0;
+      startRescan();
     }
   }
+  return stored;
 }
 
 /**
@@ -368,7 +1011,7 @@ bool barometer_isBMP() {
  * @return Celsius temperature, or NAN if unavailable.
  */
 float barometer_getTemperature() {
-  return lastTemp;
+  return lastValid ? lastTemp_cdeg / 100.0F : NAN;
 }
 
 /**
@@ -379,33 +1022,360 @@ float barometer_getTemperature() {
  * @return Pressure in hPa, or NAN if unavailable.
  */
 float barometer_getPressure() {
-  return lastPressure;
+  return lastValid ? lastPressure_q8 / 25600.0F : NAN; // Q24.8 Pa -> hPa
 }
 
 /**
- * @brief Switches between fast (low-latency) and high-precision sampling modes.
+ * @brief Latest temperature in the sensor's fixed-point unit.
  *
- * @param fast true → Fast mode (low oversampling).  
- *             false → High precision mode (maximum oversampling).
+ * @return Temperature in 0.01 °C (saturated to int16), or INT16_MIN if unavailable.
  */
-void barometer_setFastMode(bool fast) {
-  if (!bme_ok) return;
+int16_t barometer_getTemperatureCdeg() {
+  if (!lastValid) return INT16_MIN;
+  if (lastTemp_cdeg > INT16_MAX) return INT16_MAX;
+  if (lastTemp_cdeg <= INT16_MIN) return INT16_MIN + 1;
+  return (int16_t)lastTemp_cdeg;
+}
 
+/**
+ * @brief Latest EMA-smoothed pressure in fixed point.
+ *
+ * @return Pressure in Pa as Q24.8, or 0 if unavailable.
+ */
+uint32_t barometer_getPressureQ8() {
+  return lastValid ? lastPressure_q8 : 0;
+}
+
+/**
+ * @brief Latest compensated pressure, without the EMA. The FDR runs its
+ * own per-session filter chain on these.
+ *
+ * @return Pressure in Pa as Q24.8, or 0 if unavailable.
+ */
+uint32_t barometer_getRawPressureQ8() {
+  return lastValid ? lastRawPressure_q8 : 0;
+}
+
+/**
+ * @brief Copies the latest temperature and pressure as one consistent pair.
+ *
+ * Unlike the getters above, safe to call from any task (e.g. the HTTP
+ * server) while barometer_process() runs in the sampler task. `seq` and
+ * `t_us` identify the reading, so a consumer polling faster than the
+ * sensor is read can tell a new one from the cached one.
+ *
+ * @param reading Output structure.
+ */
+void barometer_getReading(BarometerReading &reading) {
+  portENTER_CRITICAL(&reading_mux);
+  const bool valid = lastValid;
+  const int32_t temperature_cdeg = lastTemp_cdeg;
+  const uint32_t pressure_q8 = lastPressure_q8;
+  reading.seq = reading_seq;
+  reading.t_us = reading_t_us;
+  portEXIT_CRITICAL(&reading_mux);
+  reading.ready = bme_ok;
+  reading.temperature_cdeg = valid ? temperature_cdeg : 0;
+  reading.pressure_q8 = valid ? pressure_q8 : 0;
+  reading.temperature = valid ? temperature_cdeg / 100.0F : NAN;
+  reading.pressure = valid ? pressure_q8 / 25600.0F : NAN;
+}
+
+/**
+ * @brief Captures the current smoothed pressure as the altitude reference.
+ * Safe from any task; applied by the next barometer_process() call.
+ */
+void barometer_setReference() {
+  barometer_setReferencePressure(0);
+}
+
+/**
+ * @brief Sets the altitude reference pressure explicitly.
+ *
+ * @param pressure_q8 Pa, Q24.8; 0 captures the current pressure. Values
+ *                    outside the sensor range are ignored.
+ */
+void barometer_setReferencePressure(uint32_t pressure_q8) {
+  if (pressure_q8 != 0 && (pressure_q8 < PRESSURE_MIN_Q8 || pressure_q8 > PRESSURE_MAX_Q8)) return;
+  portENTER_CRITICAL(&reading_mux);
+  reference_requested = true;
+  reference_request_q8 = pressure_q8;
+  portEXIT_CRITICAL(&reading_mux);
+}
+
+/**
+ * @brief Copies the latest altitude, vertical speed and flight state.
+ * Safe from any task.
+ */
+void barometer_getFlight(BarometerFlight &out) {
+  portENTER_CRITICAL(&reading_mux);
+  out = flight;
+  portEXIT_CRITICAL(&reading_mux);
+}
+
+/**
+ * @brief Reconfigures the detected sensor for fast or high-precision sampling.
+ *
+ * Runs in the context of barometer_process(), which owns the I2C bus.
+ *
+ * @param fast true → Fast mode (low oversampling).
+ *             false → High precision mode (maximum oversampling).
+ */
+static void applySamplingMode(bool fast) {
+  forced_mode_applied = false; // the configure*() calls restart normal mode
   if (bmp_used) {
     if (fast) {
       configureBMP280FastMode();
-      Serial.println("Barometer: BMP280 fast mode enabled (low latency)");
+      LOG_INFO("Barometer: BMP280 fast mode enabled (low latency)");
     } else {
       configureBMP280HighPrecision();
-      Serial.println("Barometer: BMP280 high precision mode restored");
+      LOG_INFO("Barometer: BMP280 high precision mode restored");
     }
   } else {
     if (fast) {
       configureBME280FastMode();
-      Serial.println("Barometer: BME280 fast mode enabled (low latency)");
+      LOG_INFO("Barometer: BME280 fast mode enabled (low latency)");
     } else {
       configureBME280HighPrecision();
-      Serial.println("Barometer: BME280 high precision mode restored");
+      LOG_INFO("Barometer: BME280 high precision mode restored");
     }
   }
+  fast_mode_applied = fast;
+}
+
+/**
+ * @brief Switches between fast (low-latency) and high-precision sampling modes.
+ *
+ * Safe to call from any task: the request is recorded and applied by the
+ * next barometer_process() call. It is also re-applied automatically after
+ * the sensor is re-detected.
+ *
+ * @param fast true → Fast mode (low oversampling).  
+ *             false → High precision mode (maximum oversampling).
+ */
+void barometer_setFastMode(bool fast) {
+  fast_mode_requested = fast;
+}
+
+/**
+ * @brief ctrl_meas oversampling bits matching a sampling mode.
+ */
+static uint8_t samplingOversampling(bool fast) {
+  if (fast) return OSRS_FAST;
+  return bmp_used ? OSRS_BMP_PRECISION : OSRS_BME_PRECISION;
+}
+
+/**
+ * @brief Puts the sensor to sleep between forced conversions, or back into
+ * normal mode with the current sampling settings.
+ *
+ * Runs in the context of barometer_process(), which owns the I2C bus.
+ */
+static void applyForcedMode(bool forced) {
+  conversion_started_us = 0;
+  if (!forced) {
+    applySamplingMode(fast_mode_applied);
+    return;
+  }
+  // ctrl_hum only takes effect with the next ctrl_meas write
+  if (!bmp_used) writeRegister(REG_CTRL_HUM, 0);
+  if (!writeRegister(REG_CTRL_MEAS, samplingOversampling(fast_mode_applied))) return;
+  forced_mode_applied = true;
+  LOG_INFO("Barometer: forced mode, %u us per conversion",
+           (unsigned)barometer_getConversionUs(fast_mode_applied));
+}
+
+/**
+ * @brief Applies the sampling and forced mode requests, in this order.
+ */
+static void applyRequestedModes() {
+  if (fast_mode_requested != fast_mode_applied) {
+    applySamplingMode(fast_mode_requested);
+  }
+  if (forced_mode_requested != forced_mode_applied) {
+    applyForcedMode(forced_mode_requested);
+  }
+}
+
+/**
+ * @brief Whether the triggered conversion can be read.
+ *
+ * Past the datasheet maximum it is complete without asking the sensor;
+ * before that the status register tells (typical conversions are ~15%
+ * shorter). A completed conversion is consumed.
+ */
+static bool conversionDone() {
+  if (conversion_started_us == 0) return false;
+  const int64_t elapsed_us = esp_timer_get_time() - conversion_started_us;
+  if (elapsed_us < (int64_t)barometer_getConversionUs(fast_mode_applied)) {
+    uint8_t status = 0;
+    if (!readRegisters(sensor_address, REG_STATUS, &status, 1)) return false;
+    if (status & STATUS_MEASURING) return false;
+  }
+  conversion_started_us = 0;
+  return true;
+}
+
+/**
+ * @brief Selects forced or normal mode.
+ *
+ * Safe to call from any task: the request is recorded and applied by the
+ * next barometer_process() or barometer_trigger() call, and re-applied
+ * after the sensor is re-detected.
+ *
+ * @param forced true → one conversion per barometer_trigger().
+ *               false → the sensor converts continuously on its own timer.
+ */
+void barometer_setForcedMode(bool forced) {
+  forced_mode_requested = forced;
 }
+
+/**
+ * @brief Starts one forced conversion. Sampler task context.
+ *
+ * @return true if the conversion was started; false if the sensor is not
+ *         ready, not in forced mode or did not acknowledge the write.
+ */
+bool barometer_trigger() {
+  if (!bme_ok) return false;
+  applyRequestedModes();
+  if (!forced_mode_applied) return false;
+  if (!writeRegister(REG_CTRL_MEAS, samplingOversampling(fast_mode_applied) | CTRL_MODE_FORCED)) {
+    return false;
+  }
+  conversion_started_us = esp_timer_get_time();
+  if (conversion_started_us == 0) conversion_started_us = 1;
+  return true;
+}
+
+/**
+ * @brief Datasheet maximum duration of one forced conversion.
+ *
+ * @param fast Sampling mode the conversion would run in.
+ * @return Microseconds.
+ */
+uint32_t barometer_getConversionUs(bool fast) {
+  const uint8_t osrs = samplingOversampling(fast);
+  const uint8_t t = (uint8_t)(osrs >> 5);
+  const uint8_t p = (uint8_t)((osrs >> 2) & 0x07);
+  // Code n selects 2^(n-1) oversamples
+  const uint32_t samples = (t ? 1u << (t - 1) : 0) + (p ? 1u << (p - 1) : 0);
+  return CONVERSION_BASE_US + samples * CONVERSION_PER_OVERSAMPLE_US;
+}
+
+/**
+ * @brief Sets the preferred I2C bus clock.
+ *
+ * The bus runs at this speed until transactions start failing, then steps
+ * down through 1 MHz / 400 kHz / 100 kHz. Calling again restores the
+ * preferred speed. Safe from any task; before barometer_init() it sets the
+ * initial clock, afterwards the next barometer_process() call applies it.
+ *
+ * @param hz Preferred clock in Hz (clamped to 100 kHz – 1 MHz).
+ */
+void barometer_setBusClock(uint32_t hz) {
+  if (hz > I2C_CLOCK_STEPS[0]) hz = I2C_CLOCK_STEPS[0];
+  if (hz < I2C_CLOCK_STEPS[I2C_CLOCK_STEP_COUNT - 1]) hz = I2C_CLOCK_STEPS[I2C_CLOCK_STEP_COUNT - 1];
+  bus_clock_requested = hz;
+}
+
+/**
+ * @brief Reports I2C data-path timing and error counters.
+ *
+ * Counts the sample reads made by barometer_process(); detection and
+ * configuration traffic of the Adafruit drivers is not included.
+ *
+ * @param stats Output structure.
+ */
+void barometer_getBusStats(BarometerBusStats &stats) {
+  portENTER_CRITICAL(&bus_stats_mux);
+  stats = bus_stats;
+  stats.avg_us = bus_stats.transactions ? (uint32_t)(bus_total_us / bus_stats.transactions) : 0;
+  portEXIT_CRITICAL(&bus_stats_mux);
+}
+
+#if BAROMETER_BENCH
+
+// ============================================================================
+// Benchmark
+// ============================================================================
+
+static const uint32_t BENCH_SAMPLES = 4096;
+static const uint8_t BENCH_INPUTS = 16;
+
+/**
+ * @brief Per-sample conversion of the float pipeline this module used to
+ * run: hPa/°C floats, float EMA, float range check, then back to the FDR
+ * record units. Kept only as the benchmark reference.
+ */
+static bool floatPipelineStep(int32_t temperature_cdeg, uint32_t pressure_q8, float &ema,
+                              uint32_t &record_q8, int16_t &record_cdeg) {
+  const float temperature = temperature_cdeg / 100.0F;
+  const float raw_pressure = pressure_q8 / 25600.0F;
+  ema = 0.25f * raw_pressure + (1.0f - 0.25f) * ema;
+  const bool valid = (temperature >= -40.0F && temperature <= 85.0F) &&
+                     (raw_pressure >= 300.0F && raw_pressure <= 1100.0F);
+  record_q8 = (uint32_t)(ema * 25600.0f + 0.5f);
+  const float scaled = temperature * 100.0f;
+  record_cdeg = (int16_t)(scaled < 0.0f ? scaled - 0.5f : scaled + 0.5f);
+  return valid;
+}
+
+/**
+ * @brief Fixed-point counterpart of floatPipelineStep(), as run by
+ * barometer_process() and the FDR sampler.
+ */
+static bool fixedPipelineStep(int32_t temperature_cdeg, uint32_t pressure_q8, uint32_t &ema_q8,
+                              uint32_t &record_q8, int16_t &record_cdeg) {
+  ema_q8 = filterPressure(ema_q8, pressure_q8);
+  const bool valid = validateSensorReadings(temperature_cdeg, pressure_q8);
+  record_q8 = ema_q8;
+  record_cdeg = (int16_t)temperature_cdeg;
+  return valid;
+}
+
+/**
+ * @brief Times both pipelines on the same compensated readings with the
+ * CPU cycle counter and logs the cycles per sample with LOG_INFO(), so
+ * they appear in /api/logs as well as on the serial console.
+ */
+void barometer_runBenchmark() {
+  // Volatile so the compiler can neither precompute nor drop the work
+  static volatile uint32_t input_q8[BENCH_INPUTS];
+  static volatile int32_t input_cdeg[BENCH_INPUTS];
+  static volatile uint32_t sink;
+  for (uint8_t i = 0; i < BENCH_INPUTS; i++) {
+    input_q8[i] = (101325UL << 8) + i * 97;
+    input_cdeg[i] = 2150 + i;
+  }
+
+  float ema = input_q8[0] / 25600.0F;
+  uint32_t started = ESP.getCycleCount();
+  for (uint32_t n = 0; n < BENCH_SAMPLES; n++) {
+    uint32_t record_q8;
+    int16_t record_cdeg;
+    const bool valid = floatPipelineStep(input_cdeg[n % BENCH_INPUTS], input_q8[n % BENCH_INPUTS],
+                                         ema, record_q8, record_cdeg);
+    sink = record_q8 + (uint32_t)record_cdeg + valid;
+  }
+  const uint32_t float_cycles = ESP.getCycleCount() - started;
+
+  uint32_t ema_q8 = input_q8[0];
+  started = ESP.getCycleCount();
+  for (uint32_t n = 0; n < BENCH_SAMPLES; n++) {
+    uint32_t record_q8;
+    int16_t record_cdeg;
+    const bool valid = fixedPipelineStep(input_cdeg[n % BENCH_INPUTS], input_q8[n % BENCH_INPUTS],
+                                         ema_q8, record_q8, record_cdeg);
+    sink = record_q8 + (uint32_t)record_cdeg + valid;
+  }
+  const uint32_t fixed_cycles = ESP.getCycleCount() - started;
+  (void)sink;
+
+  LOG_INFO("Barometer benchmark (%u samples): float %u cycles/sample, "
+           "fixed point %u cycles/sample",
+           (unsigned)BENCH_SAMPLES, (unsigned)(float_cycles / BENCH_SAMPLES),
+           (unsigned)(fixed_cycles / BENCH_SAMPLES));
+}
+
+#endif // BAROMETER_BENCH
@@ -3,23 +3,124 @@
 
 #include <Arduino.h>
 
+// Build with -DBAROMETER_BENCH=1 to time the fixed-point pressure path
+// against the former float one at boot (barometer_runBenchmark()).
+#ifndef BAROMETER_BENCH
+#define BAROMETER_BENCH 0
+#endif
+
 // Inicializa el módulo de barómetro. Llamar después de `Wire.begin(...)`.
 void barometer_init();
 
-// Ejecutar periódicamente desde `loop()` para permitir scans/reintentos.
-void barometer_process();
+// Ejecutar periódicamente (tarea de muestreo del FDR) para leer el sensor
+// y permitir scans/reintentos. Returns true if a new reading was stored.
+bool barometer_process();
 
 // Estado
 bool barometer_isReady();
 bool barometer_isBMP();
 
-// Últimas lecturas (temperatura en °C, presión en hPa)
+// Últimas lecturas (temperatura en °C, presión en hPa), para la tarea que
+// ejecuta barometer_process()
 float barometer_getTemperature();
 float barometer_getPressure();
 
+// Las mismas lecturas en punto fijo, sin float (ruta de muestreo del FDR):
+// 0.01 °C (INT16_MIN si no hay lectura) y Pa en Q24.8 (0 si no hay lectura)
+int16_t barometer_getTemperatureCdeg();
+uint32_t barometer_getPressureQ8();
+// Presión compensada sin suavizar (Pa en Q24.8, 0 si no hay lectura)
+uint32_t barometer_getRawPressureQ8();
+
+// Consistent snapshot of the latest readings, safe from any task. Compare
+// `seq` with the last one seen to tell a new reading from the cached one.
+struct BarometerReading {
+  bool ready;               // sensor initialized and operational
+  float temperature;        // °C, NAN if unavailable
+  float pressure;           // hPa (EMA-smoothed), NAN if unavailable
+  int32_t temperature_cdeg; // same values in fixed point, 0 if unavailable
+  uint32_t pressure_q8;     // Pa, Q24.8
+  uint32_t seq;             // readings stored since boot; unchanged = same reading
+  int64_t t_us;             // esp_timer time it was read, 0 if none
+};
+void barometer_getReading(BarometerReading &reading);
+
+// Altitude above a reference (ground) pressure, computed on every reading.
+// The first reading after boot is the reference until one is set:
+// barometer_setReference() captures the current pressure,
+// barometer_setReferencePressure() takes one in Pa Q24.8 (0 = capture).
+// Either restarts flight detection. Safe from any task; applied by the next
+// barometer_process() call.
+void barometer_setReference();
+void barometer_setReferencePressure(uint32_t pressure_q8);
+
+enum class BarometerPhase : uint8_t { Ground, Ascent, Descent, Landed };
+// Values match FdrFlightEvent
+enum class BarometerEvent : uint8_t { None = 0, Launch = 1, Apogee = 2, Landing = 3 };
+
+struct BarometerFlight {
+  bool valid;               // a reading has been converted since boot
+  int64_t t_us;             // esp_timer time of that reading
+  uint32_t reference_q8;    // reference pressure, Pa Q24.8
+  int32_t altitude_cm;      // above the reference
+  int32_t vspeed_cms;       // least-squares slope over the last 0.5 s
+  BarometerPhase phase;
+  int32_t apogee_cm;        // highest altitude since launch
+  uint32_t event_count;     // events flagged since boot; watch it for new ones
+  BarometerEvent last_event;
+  int64_t last_event_us;    // when it happened (apogee: the highest reading)
+  int32_t last_event_cm;
+};
+void barometer_getFlight(BarometerFlight &flight);
+
 // Switch sensor between normal (high-precision) and fast (low-latency) sampling.
 // Call `barometer_setFastMode(true)` before starting high-rate recordings,
 // and `barometer_setFastMode(false)` to restore high-precision mode.
+// Safe from any task; applied by the next barometer_process() call.
 void barometer_setFastMode(bool fast);
 
+// Forced mode: the sensor sleeps between conversions and measures once per
+// barometer_trigger(), so every reading comes from a conversion started on
+// the caller's schedule instead of the sensor's own standby timer. In this
+// mode barometer_process() only reads the sensor (and returns true) once
+// the triggered conversion is complete. Safe from any task; applied by the
+// next barometer_process() or barometer_trigger() call.
+void barometer_setForcedMode(bool forced);
+
+// Starts a forced conversion (sampler task). Returns false if the sensor is
+// not ready or the write failed.
+bool barometer_trigger();
+
+// Datasheet maximum time (µs) of one forced conversion in fast or
+// high-precision sampling, for the sensor currently detected
+uint32_t barometer_getConversionUs(bool fast);
+
+// Preferred I2C clock (Hz). Falls back to slower speeds automatically when
+// transactions fail; calling again restores the preferred speed.
+// Safe from any task; applied by the next barometer_process() call.
+void barometer_setBusClock(uint32_t hz);
+
+// I2C data-path diagnostics (sample reads only)
+struct BarometerBusStats {
+  uint32_t configured_clock_hz; // preferred clock from barometer_setBusClock()
+  uint32_t clock_hz;            // clock currently in use
+  uint32_t fallbacks;           // automatic speed reductions
+  uint32_t transactions;
+  uint32_t errors;              // failed transactions (sum of the counters below)
+  uint32_t nack_addr;
+  uint32_t nack_data;
+  uint32_t timeouts;
+  uint32_t other_errors;
+  uint32_t short_reads;         // ACKed but fewer bytes than requested
+  uint32_t last_us;             // duration of the last transaction
+  uint32_t avg_us;
+  uint32_t max_us;
+};
+void barometer_getBusStats(BarometerBusStats &stats);
+
+#if BAROMETER_BENCH
+// Times the per-sample pressure pipeline and logs the results (LOG_INFO).
+void barometer_runBenchmark();
+#endif
+
 #endif // BAROMETER_H
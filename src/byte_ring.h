@@ -0,0 +1,93 @@
+/**
+ * @file byte_ring.h
+ * @brief Fixed-capacity, statically allocated byte ring buffer
+ * @author slopez.tech
+ * @date 2025-11-30
+ */
+
+#ifndef BYTE_RING_H
+#define BYTE_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/**
+ * @brief Byte FIFO with O(1) append and zero-copy draining.
+ *
+ * Storage is a plain member array, so a static instance never touches the
+ * heap. Read and write positions are free-running counters masked into the
+ * buffer, which keeps every operation constant time.
+ *
+ * @tparam N Capacity in bytes; must be a power of two.
+ */
+template <size_t N>
+class ByteRing {
+  static_assert(N > 0 && (N & (N - 1)) == 0, "ByteRing capacity must be a power of two");
+
+ public:
+  /** @brief Total capacity in bytes. */
+  static constexpr size_t capacity() { return N; }
+
+  /** @brief Number of bytes currently stored. */
+  size_t size() const { return (size_t)(write_pos_ - read_pos_); }
+
+  /** @brief Number of bytes that can still be appended. */
+  size_t available() const { return N - size(); }
+
+  /** @brief True when no data is stored. */
+  bool empty() const { return write_pos_ == read_pos_; }
+
+  /** @brief Discards all stored data. */
+  void clear() { read_pos_ = write_pos_ = 0; }
+
+  /**
+   * @brief Appends a block of bytes, all or nothing.
+   *
+   * @param data Bytes to copy into the ring.
+   * @param len Number of bytes.
+   * @return false (and nothing written) if the block does not fit.
+   */
+  bool append(const void* data, size_t len) {
+    if (len > available()) return false;
+    const size_t start = (size_t)(write_pos_ & (N - 1));
+    const size_t first = (len < N - start) ? len : N - start;
+    memcpy(buf_ + start, data, first);
+    memcpy(buf_, (const uint8_t*)data + first, len - first);
+    write_pos_ += (uint32_t)len;
+    return true;
+  }
+
+  /**
+   * @brief Returns the longest readable span that is contiguous in memory.
+   *
+   * The data stays in the ring until consume() is called, so a partial
+   * write only needs to consume what was actually written.
+   *
+   * @param data Output pointer to the first stored byte.
+   * @return Length of the span (0 if empty).
+   */
+  size_t peekContiguous(const uint8_t*& data) const {
+    const size_t start = (size_t)(read_pos_ & (N - 1));
+    const size_t used = size();
+    data = buf_ + start;
+    return (used < N - start) ? used : N - start;
+  }
+
+  /**
+   * @brief Drops bytes from the front of the ring.
+   *
+   * @param len Number of bytes to drop (clamped to size()).
+   */
+  void consume(size_t len) {
+    const size_t used = size();
+    read_pos_ += (uint32_t)(len < used ? len : used);
+  }
+
+ private:
+  uint8_t buf_[N];
+  uint32_t read_pos_ = 0;
+  uint32_t write_pos_ = 0;
+};
+
+#endif // BYTE_RING_H
@@ -6,340 +6,4363 @@
  */
 
 #include "fdr.h"
+#include "fdr_format.h"
+#include "fdr_codec.h"
+#include "pressure_filter.h"
+#include "byte_ring.h"
+#include "spsc_queue.h"
+#include "fdr_storage.h"
 #include "barometer.h"
+#include "imu.h"
 #include "led.h"
-#include <SPIFFS.h>
-#include <FS.h>
+#include "http_util.h"
+#include "perf.h"
+#include "logger.h"
+#include "power.h"
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <esp_timer.h>
+#include <esp_rom_crc.h>
+#include <Preferences.h>
 
 // ============================================================================
 // Configuration
 // ============================================================================
 
 /**
- * @brief Path where the FDR CSV file is stored in SPIFFS.
+ * @brief Size of the serialized session index (header plus a full table).
  */
-static constexpr const char* FDR_PATH = "/fdr.csv";
+static constexpr size_t INDEX_BLOB_SIZE =
+  sizeof(FdrIndexHeader) + FDR_MAX_SESSIONS * sizeof(FdrIndexEntry);
 
 /**
- * @brief Default sample interval (1 Hz).
+ * @brief Free space (bytes) a new session needs; older sessions are
+ * deleted until this much is available.
  */
-static constexpr uint32_t DEFAULT_SAMPLE_INTERVAL_MS = 1000;
+static constexpr uint32_t MIN_FREE_BYTES_AT_START = 64 * 1024;
+
+/**
+ * @brief While recording, the LED flags the storage as nearly full once
+ * less than this share of it (percent) is left.
+ */
+static constexpr uint32_t STORAGE_LOW_PERCENT = 10;
+
+/**
+ * @brief Space (bytes) the storage plan keeps out of a session's reach,
+ * for the file system metadata and the session index.
+ */
+static constexpr uint32_t STORAGE_RESERVE_BYTES = 16 * 1024;
+
+/**
+ * @brief Rate reductions the storage plan tries before rejecting a session
+ * that does not fit; each lowers the rates in proportion to the excess.
+ */
+static constexpr uint8_t PLAN_DECIMATE_ATTEMPTS = 4;
+
+/**
+ * @brief Flight events a session records at most (launch, apogee, landing
+ * and trigger), in the storage plan.
+ */
+static constexpr uint32_t PLAN_FLIGHT_EVENTS = 4;
+
+/**
+ * @brief Header lines emitted when the log is converted to CSV, per channel.
+ */
+static constexpr const char* FDR_CSV_HEADER = "timestamp_s,pressure_hpa\n";
+static constexpr const char* FDR_IMU_CSV_HEADER =
+  "timestamp_s,ax_g,ay_g,az_g,gx_dps,gy_dps,gz_dps\n";
+static constexpr const char* FDR_ALT_CSV_HEADER = "timestamp_s,altitude_m,vertical_speed_m_s\n";
+static constexpr const char* FDR_EVENT_CSV_HEADER = "timestamp_s,event,altitude_m\n";
+
+/**
+ * @brief Names of the FdrFlightEvent values, in CSV exports and live events.
+ */
+static constexpr const char* FDR_EVENT_NAMES[] = {"unknown", "launch", "apogee", "landing",
+                                                   "trigger"};
+
+/**
+ * @brief Bytes read from flash per CSV conversion batch.
+ */
+static constexpr size_t CSV_READ_CHUNK = 512;
+
+/**
+ * @brief Size of the CSV output staging buffer.
+ */
+static constexpr size_t CSV_OUTPUT_BUFFER = 1024;
+
+/**
+ * @brief Upper bound for one formatted CSV row
+ * ("4294967.295,-16.000,-16.000,-16.000,-2000.0,-2000.0,-2000.0\n").
+ */
+static constexpr size_t CSV_MAX_ROW_LEN = 64;
+
+/**
+ * @brief Default sampling rate in millihertz (1 Hz).
+ */
+static constexpr uint32_t DEFAULT_SAMPLE_RATE_MHZ = 1000;
 
 /**
  * @brief Maximum supported sampling frequency (50 Hz).
  */
-static constexpr uint32_t MAX_SAMPLES_PER_SEC = 50;
+static constexpr uint32_t MAX_SAMPLES_PER_SEC = 50;
+
+/**
+ * @brief Maximum sampling frequency of a burst window (200 Hz).
+ *
+ * Above 50 Hz samples are only ever captured to RAM, never streamed to flash.
+ */
+static constexpr uint32_t MAX_BURST_SAMPLES_PER_SEC = 200;
+
+/**
+ * @brief Burst sampling frequency used when none is requested.
+ */
+static constexpr float DEFAULT_BURST_SAMPLES_PER_SEC = 200.0f;
+
+/**
+ * @brief Capacity (bytes) of the RAM burst buffer: about 12 s of barometer
+ * records at 200 Hz, or 5 s with the IMU recording at 200 Hz as well.
+ */
+static constexpr size_t BURST_BUFFER_BYTES = 28 * 1024;
+
+/**
+ * @brief Window (ms) over which an armed session measures the drop rate of
+ * the filtered pressure for its trigger.
+ */
+static constexpr uint32_t TRIGGER_RATE_WINDOW_MS = 500;
+
+/**
+ * @brief Minimum supported sampling rate in millihertz (one sample per 100 s).
+ */
+static constexpr uint32_t MIN_SAMPLE_RATE_MHZ = 10;
+
+/**
+ * @brief Microseconds per second times 1000, the numerator of the
+ * period computed from a rate in millihertz.
+ */
+static constexpr uint32_t US_PER_SEC_X1000 = 1000000000UL;
+
+/**
+ * @brief Size threshold (bytes) at which the RAM buffer is flushed to disk.
+ *
+ * Large batches are fine: the journal bounds what a power loss can cost
+ * to the data since the last commit, not the whole session.
+ */
+static constexpr uint32_t BUFFER_FLUSH_THRESHOLD = 4096;
+
+/**
+ * @brief Capacity (bytes) of the RAM record buffer.
+ *
+ * Leaves room for several flush thresholds of backlog while a slow flash
+ * write is in progress before records start being dropped.
+ */
+static constexpr size_t BUFFER_CAPACITY = 4 * BUFFER_FLUSH_THRESHOLD;
+
+/**
+ * @brief Time interval (ms) after which a flush is forced even if buffer is small.
+ */
+static constexpr uint32_t BUFFER_FLUSH_INTERVAL_MS = 1000;
+
+/**
+ * @brief Interval (ms) between journal commits while recording.
+ *
+ * A commit appends an FdrCommitRecord and syncs the storage (file system
+ * metadata commit), the expensive part of a write; flushes in between only
+ * hand data to the backend. This is the most a power loss can lose beyond
+ * what is still in RAM.
+ */
+static constexpr uint32_t COMMIT_INTERVAL_MS = 1000;
+
+/**
+ * @brief Adaptive backpressure while recording. The store decimation
+ * doubles when the RAM buffer holds BACKPRESSURE_BUFFER_HIGH bytes, or when
+ * the storage left would not hold the rest of the session at the data rate
+ * measured over the last BACKPRESSURE_STEP_MS. It halves once the buffer is
+ * back under BUFFER_FLUSH_THRESHOLD and the storage would hold the rest at
+ * twice that rate with BACKPRESSURE_MARGIN_PERCENT to spare. One step per
+ * BACKPRESSURE_STEP_MS at most, so each is measured before the next.
+ */
+static constexpr uint32_t BACKPRESSURE_BUFFER_HIGH = BUFFER_CAPACITY / 2;
+static constexpr uint32_t BACKPRESSURE_STEP_MS = 1000;
+static constexpr uint32_t BACKPRESSURE_MARGIN_PERCENT = 25;
+static constexpr uint8_t MAX_STORE_DECIMATION = 16;
+
+/**
+ * @brief Depth (records) of the queues between the sampler and writer tasks.
+ *
+ * Each channel has its own queue so a high-rate stream cannot crowd out the
+ * other. The barometer queue also carries the altitude and event records
+ * (same size); 256 records cover about 2.5 s at 50 Hz of writer stall,
+ * 256 IMU records about 1.3 s at 200 Hz.
+ */
+static constexpr size_t SAMPLE_QUEUE_DEPTH = 256;
+static constexpr size_t IMU_QUEUE_DEPTH = 256;
+
+/**
+ * @brief Interval (µs) at which the sampler drains the IMU FIFO during a
+ * session. The FIFO itself holds 85 frames (425 ms at 200 Hz).
+ */
+static constexpr int64_t IMU_DRAIN_INTERVAL_US = 20000;
+
+/**
+ * @brief Slack (µs) a forced barometer conversion must leave in the sample
+ * period for the sampler's own wake-up latency; faster sessions keep the
+ * sensor in normal mode.
+ */
+static constexpr uint32_t FORCED_CONVERSION_MARGIN_US = 1000;
+
+/**
+ * @brief IMU samples fetched per FIFO drain (40 ms at 500 Hz).
+ */
+static constexpr size_t IMU_DRAIN_BATCH = 20;
+
+/**
+ * @brief Barometer rate between sessions while no live client is attached
+ * (fdr_setIdleRate()): the cached reading only serves the HTTP API then.
+ */
+static constexpr uint32_t DEFAULT_IDLE_RATE_MHZ = 1000;
+static constexpr uint32_t MIN_IDLE_RATE_MHZ = 100;
+static constexpr uint32_t MAX_IDLE_RATE_MHZ = 100000;
+
+/**
+ * @brief Idle intervals of the sampler task: barometer_process() calls
+ * while the sensor is being searched for (the bus scan advances a few
+ * addresses per call), IMU FIFO drains (its 1 KB FIFO lasts 170 ms at
+ * 500 Hz) and wakeups while a live client is attached.
+ */
+static constexpr int64_t IDLE_RESCAN_INTERVAL_US = 10000;
+static constexpr int64_t IDLE_IMU_DRAIN_INTERVAL_US = 100000;
+static constexpr int64_t IDLE_LIVE_INTERVAL_US = 10000;
+
+/**
+ * @brief Maximum time (ms) the writer task sleeps between queue drains.
+ */
+static constexpr uint32_t WRITER_POLL_INTERVAL_MS = 50;
+
+/**
+ * @brief Live telemetry tap: queue depths between the sampler and the HTTP
+ * server task, how often a batch is sent to the clients, the barometer rate
+ * of the tap while no session is recording, and the comment line sent to
+ * idle clients to detect dead connections.
+ */
+static constexpr size_t LIVE_BARO_QUEUE_DEPTH = 64; // barometer, altitude and events
+static constexpr size_t LIVE_IMU_QUEUE_DEPTH = 128;
+static constexpr uint32_t LIVE_BATCH_INTERVAL_MS = 100;
+static constexpr int64_t LIVE_IDLE_BARO_PERIOD_US = 100000;
+static constexpr uint32_t LIVE_IDLE_BARO_RATE_MHZ = (uint32_t)(US_PER_SEC_X1000 / LIVE_IDLE_BARO_PERIOD_US);
+static constexpr uint32_t LIVE_KEEPALIVE_MS = 5000;
+
+/**
+ * @brief Largest accepted `?decimation=` (send one sample in N).
+ */
+static constexpr uint32_t LIVE_MAX_DECIMATION = 1000;
+
+/**
+ * @brief Staging buffer for one client write; events are written in
+ * pieces of this size.
+ */
+static constexpr size_t LIVE_WRITE_BUFFER = 1024;
+
+/**
+ * @brief CSV bytes a download converts per step on the HTTP server task;
+ * the server handles its other connections between steps.
+ */
+static constexpr uint32_t DOWNLOAD_STEP_BYTES = 4096;
+
+/**
+ * @brief Session bytes a time-range query reads at most before it stops
+ * and tells the client where to continue. It runs in the request handler.
+ */
+static constexpr uint32_t QUERY_MAX_SCAN_BYTES = 256 * 1024;
+
+/**
+ * @brief Records of different channels reach the stream up to this much
+ * out of time order (IMU batches, writer steps); a query reads this far
+ * past its end before it stops.
+ */
+static constexpr uint32_t QUERY_ORDER_SLACK_MS = 1000;
+
+/**
+ * @brief Longest JSON row of a query: a CSV row plus the channel name.
+ */
+static constexpr size_t QUERY_MAX_ROW_LEN = 80;
+
+/**
+ * @brief NVS namespace and key of the resume record: the configuration of
+ * the session being recorded, stored when it starts and removed when it
+ * closes. One found at boot names a session cut off by a reset.
+ */
+static constexpr const char* RESUME_NVS_NAMESPACE = "fdr";
+static constexpr const char* RESUME_NVS_KEY = "resume";
+static constexpr uint16_t RESUME_RECORD_VERSION = 1;
+
+/**
+ * @brief An interrupted session with less than this left to record is not
+ * resumed.
+ */
+static constexpr uint32_t RESUME_MIN_REMAINING_MS = 1000;
+
+/**
+ * @brief FreeRTOS priorities. The sampler preempts everything else we run;
+ * the writer sits just above the HTTP server task (priority 1).
+ */
+static constexpr UBaseType_t SAMPLER_TASK_PRIORITY = 5;
+static constexpr UBaseType_t WRITER_TASK_PRIORITY = 2;
+
+/**
+ * @brief Stack sizes (bytes) of the FDR tasks.
+ */
+static constexpr uint32_t SAMPLER_TASK_STACK = 4096;
+static constexpr uint32_t WRITER_TASK_STACK = 4096;
+
+// ============================================================================
+// Module State
+// ============================================================================
+
+/**
+ * @brief True while a session is open (file open, writer draining records).
+ */
+static std::atomic<bool> fdr_active{false};
+
+/**
+ * @brief True while the sampler task should produce records.
+ *
+ * Cleared by the sampler itself when the session duration elapses; the
+ * writer then drains the queue and closes the session.
+ */
+static std::atomic<bool> fdr_sampling{false};
+
+/**
+ * @brief Time (esp_timer, µs) when FDR recording ends.
+ *
+ * Moved by the sampler when a trigger fires and read by the writer for its
+ * backpressure estimate; atomic because a 64-bit store is two words on the
+ * ESP32-C3.
+ */
+static std::atomic<int64_t> fdr_end_us{0};
+
+/**
+ * @brief Time (esp_timer, µs) when FDR recording started; deadline of sample 0.
+ */
+static int64_t fdr_start_us = 0;
+
+/**
+ * @brief A sampling rate with its period split into whole microseconds plus
+ * a remainder in units of 1/rate_mhz µs, so deadlines never accumulate rounding.
+ */
+struct SamplePeriod {
+  uint32_t rate_mhz;
+  uint32_t period_us;
+  uint32_t period_rem;
+};
+
+/**
+ * @brief Regular session sampling period (can be changed at fdr_start()).
+ */
+static SamplePeriod fdr_period = {
+  DEFAULT_SAMPLE_RATE_MHZ, US_PER_SEC_X1000 / DEFAULT_SAMPLE_RATE_MHZ, 0
+};
+
+/**
+ * @brief Sampling period used during the burst window.
+ */
+static SamplePeriod burst_period = fdr_period;
+
+/**
+ * @brief Session duration as requested at fdr_start() (seconds).
+ */
+static uint32_t fdr_duration_s = 0;
+
+/**
+ * @brief Time (esp_timer, µs) when the burst window ends; equal to
+ * `fdr_start_us` when the session has no burst.
+ */
+static int64_t burst_end_us = 0;
+
+/**
+ * @brief IMU output rate of the current session (Hz), 0 if the session
+ * records the barometer only.
+ */
+static uint16_t fdr_imu_rate_hz = 0;
+
+/**
+ * @brief Pressure filter chain of the current session, and whether the
+ * unfiltered samples are recorded too. The chain state is only touched by
+ * the sampler, which sets it up at the start of each session.
+ */
+static PressureFilterConfig fdr_filter_config;
+static PressureFilterChain fdr_filter;
+static bool fdr_record_raw = false;
+
+/**
+ * @brief Whether the session records the altitude channel, and the
+ * barometer's flight event counter the sampler has already handled.
+ */
+static bool fdr_record_altitude = true;
+static uint32_t flight_events_seen = 0;
+
+/**
+ * @brief Whether the session drives the barometer in forced mode, and the
+ * conversion time the sampler triggers ahead of each deadline.
+ */
+static bool fdr_baro_forced = false;
+static uint32_t baro_conversion_us = 0;
+
+/**
+ * @brief Barometer rate between sessions without a live client, set by
+ * fdr_setIdleRate() from any task.
+ */
+static std::atomic<uint32_t> idle_rate_mhz{DEFAULT_IDLE_RATE_MHZ};
+
+/**
+ * @brief RAM-resident capture buffer for the burst window, holding tagged
+ * records of every channel.
+ *
+ * Written only by the sampler; `burst_bytes` publishes each new record and
+ * `burst_count` counts them. The writer commits the buffer to flash in one
+ * write once the window is over.
+ */
+static uint8_t burst_buffer[BURST_BUFFER_BYTES];
+static std::atomic<uint32_t> burst_bytes{0};
+static std::atomic<uint32_t> burst_count{0};
+
+/**
+ * @brief Set by the sampler when the burst window has ended.
+ */
+static std::atomic<bool> burst_done{false};
+
+/**
+ * @brief True once the burst buffer has been written to the session file
+ * (or if the session has no burst).
+ */
+static bool burst_committed = true;
+
+/**
+ * @brief Burst samples dropped because the burst buffer was full.
+ */
+static std::atomic<uint32_t> burst_dropped{0};
+
+/**
+ * @brief Armed session parameters: the pre-trigger window (0 if the session
+ * is not armed), the trigger conditions and the acceleration threshold as
+ * a squared magnitude in sensor LSB.
+ */
+static uint32_t fdr_pretrigger_ms = 0;
+static FdrTriggerConfig fdr_trigger;
+static uint64_t trigger_accel_lsb_sq = 0;
+
+/**
+ * @brief Set while an armed session waits for its trigger. Only the
+ * sampler clears it, when the trigger fires; `trigger_t_ms` and
+ * `trigger_cause` are set before.
+ */
+static std::atomic<bool> fdr_armed{false};
+static std::atomic<uint32_t> trigger_t_ms{0};
+static const char* trigger_cause = nullptr;
+
+/**
+ * @brief Session the current one continues after a reset, 0 if it was
+ * started normally.
+ */
+static uint32_t resumed_from_id = 0;
+
+/**
+ * @brief Pre-trigger ring, in the burst buffer memory (an armed session has
+ * no burst window): whole absolute records from `pretrigger_tail`, wrapping
+ * at the end of the buffer.
+ *
+ * Written only by the sampler while armed. The trigger sets
+ * `pretrigger_done`, after which the ring no longer changes and the writer
+ * commits it oldest first.
+ */
+static uint32_t pretrigger_head = 0;
+static uint32_t pretrigger_tail = 0;
+static std::atomic<uint32_t> pretrigger_used{0};
+static std::atomic<bool> pretrigger_done{false};
+
+/**
+ * @brief True once the pre-trigger ring has been written to the session
+ * file (or if the session is not armed).
+ */
+static bool pretrigger_committed = true;
+
+/**
+ * @brief Start of the current pressure drop measurement window. Sampler
+ * task only.
+ */
+static uint32_t trigger_anchor_t_ms = 0;
+static uint32_t trigger_anchor_q8 = 0;
+static bool trigger_anchor_valid = false;
+
+/**
+ * @brief Incremented by every fdr_start() so the sampler can tell a restarted
+ * session from the one it is currently scheduling.
+ */
+static std::atomic<uint32_t> session_generation{0};
+
+/**
+ * @brief One-shot timer that wakes the sampler task at each sample deadline.
+ */
+static esp_timer_handle_t sample_timer = nullptr;
+
+/**
+ * @brief Per-session scheduling statistics, guarded by `stats_mux`.
+ */
+static FdrTimingStats timing_stats = {};
+static uint64_t jitter_sum_us = 0;
+static portMUX_TYPE stats_mux = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Storage backend selected at build time (FDR_STORAGE_BACKEND).
+ */
+static FdrStorage &storage = fdr_storage();
+
+/**
+ * @brief True if the storage backend has already been mounted.
+ */
+static bool storage_mounted = false;
+
+/**
+ * @brief True while the current session is open for appending.
+ */
+static bool session_open = false;
+
+/**
+ * @brief RAM copy of the session index, oldest first. Loaded when storage is
+ * mounted; the last entry is the current session while one is active.
+ */
+static FdrIndexEntry session_index[FDR_MAX_SESSIONS];
+static size_t session_count = 0;
+
+/**
+ * @brief Summary of the session being recorded, updated by the writer as
+ * records reach the RAM buffer and file.
+ */
+static uint32_t session_bytes = 0;
+static uint32_t session_last_t_ms = 0;
+
+/**
+ * @brief Length of the current session at its last commit record: what a
+ * reader can use without draining or syncing it.
+ */
+static uint32_t committed_bytes = 0;
+static uint32_t session_pressure_min_q8 = UINT32_MAX;
+static uint32_t session_pressure_max_q8 = 0;
+
+/**
+ * @brief Storage free and total when the session started; free space is
+ * then tracked from the bytes written, without querying the backend.
+ */
+static uint32_t session_free_start_bytes = 0;
+static uint32_t storage_total_bytes = 0;
+
+/**
+ * @brief Journal state of the current session: CRC and length of the bytes
+ * appended since the last commit record, and the next commit sequence.
+ * `journal_ok` is cleared once the stream stops on a partial record or a
+ * commit record could not be written whole; nothing after that point would
+ * be recoverable, so no more commits are attempted.
+ */
+static uint32_t journal_crc = 0;
+static uint32_t journal_pending = 0;
+static uint32_t journal_sequence = 0;
+static bool journal_ok = false;
+
+/**
+ * @brief In-RAM buffer for binary records waiting to be flushed to disk.
+ */
+static ByteRing<BUFFER_CAPACITY> fdr_write_buffer;
+
+/**
+ * @brief Highest buffer fill level (bytes) seen since the session started.
+ */
+static uint32_t buffer_high_water = 0;
+
+/**
+ * @brief Records dropped because the buffer was full.
+ */
+static uint32_t overflow_records = 0;
+
+/**
+ * @brief Bytes dropped because the buffer was full.
+ */
+static uint32_t overflow_bytes = 0;
+
+/**
+ * @brief Storage plan of the current/last fdr_start() and the backpressure
+ * counters of its session.
+ */
+static FdrStoragePlan storage_plan = {};
+
+/**
+ * @brief Writer state of the backpressure: samples of each channel seen
+ * by the store decimation, whether the barometer sample being drained is
+ * kept (its raw and altitude records follow it), and the bytes the queues
+ * stored since the measurement window started.
+ */
+static uint32_t decimate_baro_seen = 0;
+static uint32_t decimate_imu_seen = 0;
+static bool decimate_keep_baro = true;
+static uint32_t stream_bytes = 0;
+static uint32_t backpressure_window_ms = 0;
+
+/**
+ * @brief Records accepted into the RAM buffer (or burst buffer), per channel.
+ */
+static uint32_t baro_records = 0;
+static uint32_t imu_records = 0;
+
+/**
+ * @brief Delta encoder state of the current session: the last sample of
+ * each channel that reached the RAM buffer.
+ */
+static FdrCodecState encode_state;
+
+/**
+ * @brief Sample bytes before and after delta encoding this session.
+ */
+static uint32_t raw_bytes = 0;
+static uint32_t encoded_bytes = 0;
+
+/**
+ * @brief Time index of the current session: its sync points so far, and
+ * the session offset where the next one is due. When the index fills up
+ * every other entry is dropped and the interval doubles, so it always
+ * spans the whole session. Written at the end of the session by
+ * appendTimeIndexLocked(); read by queries while recording.
+ */
+static FdrTimeIndexRecord time_index[FDR_TIME_INDEX_MAX_ENTRIES];
+static size_t time_index_count = 0;
+static uint32_t sync_interval_bytes = FDR_SYNC_INTERVAL_BYTES;
+static uint32_t next_sync_offset = 0;
+
+/**
+ * @brief Timestamp (millis) of last buffer flush and last journal commit.
+ */
+static uint32_t last_flush_ms = 0;
+static uint32_t last_commit_ms = 0;
+
+/**
+ * @brief Storage write latency counters, guarded by `fdr_lock`.
+ */
+static FdrStorageStats storage_stats = {};
+static uint64_t flush_total_us = 0;
+
+/**
+ * @brief Records handed from the sampler task to the writer task.
+ *
+ * The sampler is the only producer. Consumers must hold `fdr_lock`, which
+ * keeps a single consumer at any time.
+ */
+static SpscQueue<FdrBaroRecord, SAMPLE_QUEUE_DEPTH> sample_queue;
+static SpscQueue<FdrImuRecord, IMU_QUEUE_DEPTH> imu_queue;
+
+/**
+ * @brief Copies of the sampled records for the live telemetry stream, with
+ * timestamps in device uptime. Filled by the sampler only while a client is
+ * connected (`live_enabled`) and drained by the HTTP server task; a full
+ * queue drops the record for the live stream only.
+ */
+static SpscQueue<FdrBaroRecord, LIVE_BARO_QUEUE_DEPTH> live_baro_queue;
+static SpscQueue<FdrImuRecord, LIVE_IMU_QUEUE_DEPTH> live_imu_queue;
+static std::atomic<bool> live_enabled{false};
+static std::atomic<uint32_t> live_dropped{0};
+
+/**
+ * @brief One Server-Sent Events client, on a connection taken over from the
+ * HTTP server. Only the server task touches these.
+ *
+ * A slot stays `active` until the server has closed the connection
+ * (liveClosed()), so a batch is never written to a reused socket.
+ */
+struct LiveClient {
+  bool active;
+  bool closing;         ///< A write failed, close requested
+  httpd_handle_t server;
+  int fd;
+  bool baro;            ///< Barometer samples requested
+  bool imu;             ///< IMU samples requested
+  uint32_t decimation;  ///< Send one sample in `decimation`, per channel
+  uint32_t baro_phase;
+  uint32_t alt_phase;
+  uint32_t imu_phase;
+  uint32_t last_send_ms;
+};
+static LiveClient live_clients[FDR_LIVE_MAX_CLIENTS];
+
+/**
+ * @brief Periodic timer that queues liveProcess() on the HTTP server task
+ * while clients are attached; `live_step_queued` keeps at most one run
+ * pending when the server falls behind.
+ */
+static esp_timer_handle_t live_timer = nullptr;
+static bool live_timer_running = false;
+static httpd_handle_t live_server = nullptr;
+static std::atomic<bool> live_step_queued{false};
+
+/**
+ * @brief Records dropped because a sample queue was full.
+ */
+static std::atomic<uint32_t> queue_dropped{0};
+static std::atomic<uint32_t> imu_queue_dropped{0};
+
+/**
+ * @brief Highest sample queue depths seen since the session started.
+ */
+static uint32_t queue_high_water = 0;
+static uint32_t imu_queue_high_water = 0;
+
+/**
+ * @brief Serializes file access and session state changes between the
+ * writer task and the HTTP server task. The sampler never takes it.
+ */
+static SemaphoreHandle_t fdr_lock = nullptr;
+
+/**
+ * @brief FDR task handles.
+ */
+static TaskHandle_t sampler_task = nullptr;
+static TaskHandle_t writer_task = nullptr;
+
+// ============================================================================
+// Helpers (small, focused functions to improve readability)
+// ============================================================================
+
+/**
+ * @brief Loads the session index into RAM. A missing or unreadable index
+ * leaves an empty list.
+ */
+static void loadIndex() {
+  static uint8_t blob[INDEX_BLOB_SIZE];
+  session_count = 0;
+  const size_t len = storage.loadIndex(blob, sizeof(blob));
+  if (len == 0) return;
+
+  FdrIndexHeader header;
+  memcpy(&header, blob, sizeof(header));
+  if (len < sizeof(header) || header.magic != FDR_INDEX_MAGIC ||
+      header.version != FDR_INDEX_VERSION || header.entry_size != sizeof(FdrIndexEntry)) {
+    LOG_ERROR("FDR: session index unreadable, starting a new one");
+    return;
+  }
+
+  size_t count = header.count < FDR_MAX_SESSIONS ? header.count : FDR_MAX_SESSIONS;
+  const size_t stored = (len - sizeof(header)) / sizeof(FdrIndexEntry);
+  if (stored < count) count = stored;
+  memcpy(session_index, blob + sizeof(header), count * sizeof(FdrIndexEntry));
+  session_count = count;
+  LOG_INFO("FDR: %u stored sessions", (unsigned)session_count);
+}
+
+/**
+ * @brief Writes the RAM index to storage. The backend keeps the previous
+ * index if the update is interrupted.
+ *
+ * @return true on success.
+ */
+static bool saveIndex() {
+  static uint8_t blob[INDEX_BLOB_SIZE];
+  FdrIndexHeader header = {};
+  header.magic = FDR_INDEX_MAGIC;
+  header.version = FDR_INDEX_VERSION;
+  header.entry_size = sizeof(FdrIndexEntry);
+  header.count = (uint32_t)session_count;
+  memcpy(blob, &header, sizeof(header));
+  const size_t body = session_count * sizeof(FdrIndexEntry);
+  memcpy(blob + sizeof(header), session_index, body);
+  return storage.saveIndex(blob, sizeof(header) + body);
+}
+
+/**
+ * @brief Deletes the oldest stored session (data and index entry).
+ */
+static void dropOldestSession() {
+  if (session_count == 0) return;
+  storage.remove(session_index[0].session_id);
+  LOG_WARN("FDR: session %u deleted to make room", (unsigned)session_index[0].session_id);
+  memmove(session_index, session_index + 1, (session_count - 1) * sizeof(FdrIndexEntry));
+  session_count--;
+}
+
+/**
+ * @brief Copies the live counters of the current session into its index entry.
+ *
+ * @param open false once the session has been closed.
+ */
+static void updateCurrentEntry(bool open) {
+  if (session_count == 0) return;
+  FdrIndexEntry &entry = session_index[session_count - 1];
+  entry.flags = (entry.flags & FDR_SESSION_RESUMED) | (open ? FDR_SESSION_OPEN : 0);
+  entry.duration_ms = session_last_t_ms;
+  entry.baro_records = baro_records;
+  entry.imu_records = imu_records;
+  entry.bytes = session_bytes;
+  entry.pressure_min_q8 = session_pressure_min_q8;
+  entry.pressure_max_q8 = session_pressure_max_q8;
+}
+
+/**
+ * @brief Finds a stored session by ID.
+ *
+ * @return Its index entry, or nullptr.
+ */
+static const FdrIndexEntry* findSession(uint32_t id) {
+  for (size_t i = 0; i < session_count; i++) {
+    if (session_index[i].session_id == id) return &session_index[i];
+  }
+  return nullptr;
+}
+
+/**
+ * @brief Creates the data file of a new session, writes its binary header
+ * and adds the session to the index.
+ *
+ * Earlier sessions are kept; the oldest one is deleted once
+ * FDR_MAX_SESSIONS are stored, or while the free space is short of
+ * `need_bytes` (at least MIN_FREE_BYTES_AT_START).
+ *
+ * @param rate_mhz Session barometer rate (millihertz) stored in the header.
+ * @param imu_rate_hz Session IMU rate, 0 if the IMU is not recorded.
+ * @param need_bytes Free space the storage plan needs for the session.
+ * The filter chain and the optional channels come from `fdr_filter_config`,
+ * `fdr_record_raw` and `fdr_record_altitude`.
+ * @return true on success, false on failure.
+ */
+static bool openFdrFileForWrite(uint32_t rate_mhz, uint16_t imu_rate_hz, uint32_t need_bytes) {
+  if (session_open) storage.close();
+  session_open = false;
+  if (session_count >= FDR_MAX_SESSIONS) dropOldestSession();
+  if (need_bytes < MIN_FREE_BYTES_AT_START) need_bytes = MIN_FREE_BYTES_AT_START;
+  while (session_count > 0 && storage.freeBytes() < need_bytes) {
+    dropOldestSession();
+  }
+
+  const uint32_t id = session_count ? session_index[session_count - 1].session_id + 1 : 1;
+  if (!storage.create(id)) return false;
+
+  FdrFileHeader header = {};
+  header.magic = FDR_FORMAT_MAGIC;
+  header.version = FDR_FORMAT_VERSION;
+  header.header_size = sizeof(FdrFileHeader);
+  header.channels = FDR_CHANNEL_BARO | (imu_rate_hz ? FDR_CHANNEL_IMU : 0) |
+                    (fdr_record_raw ? FDR_CHANNEL_BARO_RAW : 0) |
+                    (fdr_record_altitude ? FDR_CHANNEL_ALT : 0);
+  header.sample_rate_hz = (uint16_t)((rate_mhz + 500) / 1000);
+  header.sample_rate_mhz = rate_mhz;
+  header.imu_rate_hz = imu_rate_hz;
+  header.accel_lsb_per_g = IMU_ACCEL_LSB_PER_G;
+  header.gyro_lsb_per_dps_x10 = IMU_GYRO_LSB_PER_DPS_X10;
+  header.filter = pressureFilter_pack(fdr_filter_config);
+  if (storage.append((const uint8_t*)&header, sizeof(header)) != sizeof(header)) {
+    storage.close();
+    storage.remove(id);
+    return false;
+  }
+  session_open = true;
+
+  FdrIndexEntry &entry = session_index[session_count++];
+  entry = {};
+  entry.session_id = id;
+  entry.start_uptime_ms = millis();
+  entry.rate_mhz = rate_mhz;
+  entry.imu_rate_hz = imu_rate_hz;
+  entry.flags = FDR_SESSION_OPEN;
+  entry.bytes = sizeof(header);
+  entry.pressure_min_q8 = UINT32_MAX;
+  session_bytes = sizeof(header);
+  committed_bytes = sizeof(header);
+  session_last_t_ms = 0;
+  session_pressure_min_q8 = UINT32_MAX;
+  session_pressure_max_q8 = 0;
+  journal_crc = 0;
+  journal_pending = 0;
+  journal_sequence = 1;
+  journal_ok = true;
+  fdr_codecReset(encode_state);
+  time_index_count = 0;
+  sync_interval_bytes = FDR_SYNC_INTERVAL_BYTES;
+  next_sync_offset = sizeof(header) + sync_interval_bytes;
+  if (!saveIndex()) LOG_ERROR("FDR: cannot write session index");
+  return true;
+}
+
+/**
+ * @brief Reads and validates the binary header of a stored session.
+ *
+ * @param id Session to read.
+ * @param header Output header; header_size is the offset of the first record.
+ * @return true if the header is present and its version is supported.
+ */
+static bool readFdrHeader(uint32_t id, FdrFileHeader &header) {
+  if (storage.read(id, 0, (uint8_t*)&header, sizeof(header)) != sizeof(header)) return false;
+  if (header.magic != FDR_FORMAT_MAGIC) return false;
+  if (header.version < FDR_FORMAT_MIN_VERSION || header.version > FDR_FORMAT_VERSION) return false;
+  if (header.header_size < sizeof(FdrFileHeader)) return false;
+  if (header.accel_lsb_per_g == 0 || header.gyro_lsb_per_dps_x10 == 0) return false;
+  return true;
+}
+
+/**
+ * @brief Adds one complete record to the totals of an index entry.
+ */
+static void accumulateRecord(FdrIndexEntry &entry, const uint8_t* rec) {
+  uint32_t t_ms;
+  memcpy(&t_ms, rec + offsetof(FdrBaroRecord, t_ms), sizeof(t_ms));
+  if (t_ms > entry.duration_ms) entry.duration_ms = t_ms;
+  if (rec[0] == FDR_REC_IMU) {
+    entry.imu_records++;
+  } else if (rec[0] == FDR_REC_BARO) {
+    entry.baro_records++;
+    uint32_t pressure_q8;
+    memcpy(&pressure_q8, rec + offsetof(FdrBaroRecord, pressure_q8), sizeof(pressure_q8));
+    if (pressure_q8 < entry.pressure_min_q8) entry.pressure_min_q8 = pressure_q8;
+    if (pressure_q8 > entry.pressure_max_q8) entry.pressure_max_q8 = pressure_q8;
+  }
+}
+
+/**
+ * @brief Closes a session left open by a reset or power loss.
+ *
+ * Replays the journal from the header: records are only kept up to the
+ * last commit record whose length and CRC match, and the index entry is
+ * rebuilt from them, decoding delta records on the way. Sessions written
+ * before the journal format have no commit records; every complete record
+ * is kept.
+ *
+ * @param entry Index entry of the session, updated in place.
+ */
+static void recoverSession(FdrIndexEntry &entry) {
+  FdrFileHeader header;
+  FdrIndexEntry committed = entry;
+  committed.flags = (entry.flags & FDR_SESSION_RESUMED) | FDR_SESSION_RECOVERED;
+  committed.duration_ms = 0;
+  committed.baro_records = 0;
+  committed.imu_records = 0;
+  committed.bytes = 0;
+  committed.pressure_min_q8 = UINT32_MAX;
+  committed.pressure_max_q8 = 0;
+
+  if (readFdrHeader(entry.session_id, header)) {
+    const bool journaled = header.version >= 3;
+    FdrIndexEntry pending = committed;
+    uint32_t crc = 0;
+    uint32_t length = 0;
+    uint32_t sequence = 1;
+    uint32_t offset = header.header_size;
+    committed.bytes = offset;
+    FdrCodecState codec;
+    fdr_codecReset(codec);
+
+    uint8_t raw[CSV_READ_CHUNK + FDR_MAX_RECORD_SIZE];
+    uint8_t decoded[FDR_MAX_RECORD_SIZE];
+    size_t have = 0;
+    bool done = false;
+    while (!done) {
+      const size_t got = storage.read(entry.session_id, offset + have, raw + have, CSV_READ_CHUNK);
+      if (got == 0) break;
+      have += got;
+
+      size_t pos = 0;
+      while (pos < have) {
+        const size_t rec_len = fdr_recordLength(raw + pos, have - pos);
+        if (rec_len == 0) {
+          done = true;
+          break;
+        }
+        if (have - pos < rec_len) break;
+        const uint8_t* rec = raw + pos;
+        if (fdr_decodeRecord(codec, rec, rec_len, decoded) == 0) {
+          done = true;
+          break;
+        }
+        if (rec[0] == FDR_REC_COMMIT) {
+          FdrCommitRecord commit;
+          memcpy(&commit, rec, sizeof(commit));
+          if (!journaled || commit.sequence != sequence ||
+              commit.length != length || commit.crc != crc) {
+            done = true;
+            break;
+          }
+          sequence++;
+          crc = 0;
+          length = 0;
+          pending.bytes = offset + (uint32_t)(pos + rec_len);
+          committed = pending;
+        } else {
+          accumulateRecord(pending, decoded);
+          crc = esp_rom_crc32_le(crc, rec, rec_len);
+          length += (uint32_t)rec_len;
+          if (!journaled) {
+            pending.bytes = offset + (uint32_t)(pos + rec_len);
+            committed = pending;
+          }
+        }
+        pos += rec_len;
+      }
+      memmove(raw, raw + pos, have - pos);
+      have -= pos;
+      offset += (uint32_t)pos;
+    }
+    storage.endRead();
+  }
+
+  LOG_WARN("FDR: recovered session %u, %u of %u bytes committed",
+           (unsigned)entry.session_id, (unsigned)committed.bytes,
+           (unsigned)storage.size(entry.session_id));
+  entry = committed;
+}
+
+/**
+ * @brief Mounts the storage backend lazily, loads the session index and
+ * recovers any session that was not closed cleanly.
+ * The backend formats its medium if it cannot be mounted.
+ *
+ * @return true if storage is mounted successfully, false otherwise.
+ */
+static bool ensureStorage() {
+  if (storage_mounted) return true;
+  storage_mounted = storage.mount();
+  if (!storage_mounted) return false;
+  LOG_INFO("FDR: %s storage mounted successfully", storage.name());
+  loadIndex();
+
+  bool recovered = false;
+  for (size_t i = 0; i < session_count; i++) {
+    if (!(session_index[i].flags & FDR_SESSION_OPEN)) continue;
+    recoverSession(session_index[i]);
+    recovered = true;
+  }
+  if (recovered && !saveIndex()) LOG_ERROR("FDR: cannot write session index");
+  return true;
+}
+
+/**
+ * @brief NVS resume record. The session configuration is stored as is; a
+ * firmware with another layout sees a different size and ignores it.
+ */
+struct ResumeRecord {
+  uint16_t version;     ///< RESUME_RECORD_VERSION
+  uint16_t config_size; ///< sizeof(FdrSessionConfig)
+  uint32_t session_id;
+  FdrSessionConfig config;
+};
+
+/**
+ * @brief Stores the resume record of a session that is starting.
+ */
+static void saveResumeRecord(const FdrSessionConfig &config, uint32_t session_id) {
+  ResumeRecord record;
+  record.version = RESUME_RECORD_VERSION;
+  record.config_size = sizeof(FdrSessionConfig);
+  record.session_id = session_id;
+  record.config = config;
+  Preferences prefs;
+  if (!prefs.begin(RESUME_NVS_NAMESPACE, false) ||
+      prefs.putBytes(RESUME_NVS_KEY, &record, sizeof(record)) != sizeof(record)) {
+    LOG_WARN("FDR: resume record not stored, a reset will end the session");
+  }
+  prefs.end();
+}
+
+/**
+ * @brief Reads the resume record left by the last session, if any.
+ *
+ * @return true if there is one this firmware can use.
+ */
+static bool loadResumeRecord(ResumeRecord &record) {
+  Preferences prefs;
+  if (!prefs.begin(RESUME_NVS_NAMESPACE, true)) return false;
+  const size_t len = prefs.getBytes(RESUME_NVS_KEY, &record, sizeof(record));
+  prefs.end();
+  return len == sizeof(record) && record.version == RESUME_RECORD_VERSION &&
+         record.config_size == sizeof(FdrSessionConfig);
+}
+
+/**
+ * @brief Removes the resume record once its session is closed.
+ */
+static void clearResumeRecord() {
+  Preferences prefs;
+  if (!prefs.begin(RESUME_NVS_NAMESPACE, false)) return;
+  if (prefs.isKey(RESUME_NVS_KEY)) prefs.remove(RESUME_NVS_KEY);
+  prefs.end();
+}
+
+/**
+ * @brief Writes an unsigned integer in decimal, zero-padded to `width` digits.
+ *
+ * @return Pointer just past the last written character.
+ */
+static char* appendUnsigned(char* out, uint32_t value, uint8_t width = 1) {
+  char tmp[10];
+  uint8_t n = 0;
+  do {
+    tmp[n++] = (char)('0' + value % 10);
+    value /= 10;
+  } while (value != 0);
+  while (n < width) tmp[n++] = '0';
+  while (n > 0) *out++ = tmp[--n];
+  return out;
+}
+
+/**
+ * @brief Writes a signed fixed-point value with `decimals` fractional digits.
+ *
+ * @param value Value scaled by 10^decimals.
+ * @return Pointer just past the last written character.
+ */
+static char* appendFixed(char* out, int32_t value, uint32_t scale, uint8_t decimals) {
+  if (value < 0) *out++ = '-';
+  const uint32_t magnitude = value < 0 ? (uint32_t)(-(int64_t)value) : (uint32_t)value;
+  out = appendUnsigned(out, magnitude / scale);
+  *out++ = '.';
+  return appendUnsigned(out, magnitude % scale, decimals);
+}
+
+/**
+ * @brief Writes a record timestamp as seconds with millisecond resolution.
+ *
+ * @return Pointer just past the last written character.
+ */
+static char* appendTimestamp(char* out, uint32_t t_ms) {
+  out = appendUnsigned(out, t_ms / 1000);
+  *out++ = '.';
+  return appendUnsigned(out, t_ms % 1000, 3);
+}
+
+/**
+ * @brief Divides a raw sensor value by its scale, rounding to nearest.
+ */
+static int32_t scaleRounded(int32_t value, int32_t multiplier, int32_t divisor) {
+  const int32_t scaled = value * multiplier;
+  return (scaled >= 0 ? scaled + divisor / 2 : scaled - divisor / 2) / divisor;
+}
+
+/**
+ * @brief Formats a barometer record as one CSV row matching the historic
+ *        "%.3f,%.2f\n" layout, using integer arithmetic only.
+ *
+ * @param rec Record to format.
+ * @param out Destination with room for CSV_MAX_ROW_LEN characters.
+ * @return Number of characters written.
+ */
+static size_t formatCsvRow(const FdrBaroRecord &rec, char* out) {
+  char* p = appendTimestamp(out, rec.t_ms);
+  *p++ = ',';
+  const uint32_t pa = (rec.pressure_q8 + 128) >> 8;
+  p = appendUnsigned(p, pa / 100);
+  *p++ = '.';
+  p = appendUnsigned(p, pa % 100, 2);
+  *p++ = '\n';
+  return (size_t)(p - out);
+}
+
+/**
+ * @brief Formats an IMU record as one CSV row: acceleration in g with three
+ *        decimals and angular rate in °/s with one, scaled per the file header.
+ *
+ * @param rec Record to format.
+ * @param header Header of the file the record belongs to.
+ * @param out Destination with room for CSV_MAX_ROW_LEN characters.
+ * @return Number of characters written.
+ */
+static size_t formatImuCsvRow(const FdrImuRecord &rec, const FdrFileHeader &header, char* out) {
+  char* p = appendTimestamp(out, rec.t_ms);
+  for (uint8_t axis = 0; axis < 3; axis++) {
+    *p++ = ',';
+    p = appendFixed(p, scaleRounded(rec.accel[axis], 1000, header.accel_lsb_per_g), 1000, 3);
+  }
+  for (uint8_t axis = 0; axis < 3; axis++) {
+    *p++ = ',';
+    p = appendFixed(p, scaleRounded(rec.gyro[axis], 100, header.gyro_lsb_per_dps_x10), 10, 1);
+  }
+  *p++ = '\n';
+  return (size_t)(p - out);
+}
+
+/**
+ * @brief Formats an altitude record as one CSV row: metres and m/s with
+ *        two decimals.
+ *
+ * @param rec Record to format.
+ * @param out Destination with room for CSV_MAX_ROW_LEN characters.
+ * @return Number of characters written.
+ */
+static size_t formatAltCsvRow(const FdrAltRecord &rec, char* out) {
+  char* p = appendTimestamp(out, rec.t_ms);
+  *p++ = ',';
+  p = appendFixed(p, rec.altitude_cm, 100, 2);
+  *p++ = ',';
+  p = appendFixed(p, rec.vspeed_cms, 100, 2);
+  *p++ = '\n';
+  return (size_t)(p - out);
+}
+
+/**
+ * @brief Name of a FdrFlightEvent value.
+ */
+static const char* eventName(uint8_t event) {
+  return event < sizeof(FDR_EVENT_NAMES) / sizeof(FDR_EVENT_NAMES[0]) ? FDR_EVENT_NAMES[event]
+                                                                       : FDR_EVENT_NAMES[0];
+}
+
+/**
+ * @brief Formats a flight event record as one CSV row.
+ *
+ * @param rec Record to format.
+ * @param out Destination with room for CSV_MAX_ROW_LEN characters.
+ * @return Number of characters written.
+ */
+static size_t formatEventCsvRow(const FdrEventRecord &rec, char* out) {
+  char* p = appendTimestamp(out, rec.t_ms);
+  *p++ = ',';
+  const char* name = eventName(rec.event);
+  const size_t len = strlen(name);
+  memcpy(p, name, len);
+  p += len;
+  *p++ = ',';
+  p = appendFixed(p, rec.altitude_cm, 100, 2);
+  *p++ = '\n';
+  return (size_t)(p - out);
+}
+
+/**
+ * @brief Records the duration of one flush in the storage stats.
+ */
+static void recordFlushTime(uint32_t started_us, size_t bytes) {
+  const uint32_t elapsed_us = (uint32_t)esp_timer_get_time() - started_us;
+  storage_stats.flushes++;
+  storage_stats.write_bytes += (uint32_t)bytes;
+  storage_stats.flush_last_us = elapsed_us;
+  if (elapsed_us > storage_stats.flush_max_us) storage_stats.flush_max_us = elapsed_us;
+  flush_total_us += elapsed_us;
+}
+
+/**
+ * @brief Appends session data to storage and adds it to the journal CRC.
+ *
+ * @return Number of bytes stored.
+ */
+static size_t journalAppend(const uint8_t* data, size_t len) {
+  const size_t wrote = storage.append(data, len);
+  journal_crc = esp_rom_crc32_le(journal_crc, data, wrote);
+  journal_pending += (uint32_t)wrote;
+  session_bytes += (uint32_t)wrote;
+  return wrote;
+}
+
+/**
+ * @brief Flags the storage on the LED as nearly full, from the space left
+ * when the session started minus what it wrote since.
+ */
+static void updateStorageLow() {
+  const uint32_t written = session_bytes - sizeof(FdrFileHeader);
+  const uint32_t free_bytes = session_free_start_bytes > written ? session_free_start_bytes - written : 0;
+  led_setCondition(LED_STORAGE_LOW,
+                   (uint64_t)free_bytes * 100 < (uint64_t)storage_total_bytes * STORAGE_LOW_PERCENT);
+}
+
+/**
+ * @brief Commits the journal if the commit interval has elapsed, or
+ * unconditionally with `force`: appends a commit record covering the data
+ * written since the previous one, then syncs the storage.
+ *
+ * A commit record is only written when everything buffered so far has
+ * reached storage, so it always lands on a record boundary.
+ */
+static void commitSession(bool force) {
+  if (!session_open) return;
+  if (!force && (millis() - last_commit_ms) < COMMIT_INTERVAL_MS) return;
+  PERF_SCOPE(FdrCommit);
+  const uint32_t started_us = (uint32_t)esp_timer_get_time();
+
+  if (journal_ok && journal_pending > 0 && fdr_write_buffer.empty()) {
+    FdrCommitRecord rec;
+    rec.type = FDR_REC_COMMIT;
+    rec.t_ms = session_last_t_ms;
+    rec.sequence = journal_sequence;
+    rec.length = journal_pending;
+    rec.crc = journal_crc;
+    const size_t wrote = storage.append((const uint8_t*)&rec, sizeof(rec));
+    session_bytes += (uint32_t)wrote;
+    if (wrote == sizeof(rec)) {
+      committed_bytes = session_bytes;
+      journal_sequence++;
+      storage_stats.commits++;
+    } else {
+      journal_ok = false;
+      LOG_ERROR("FDR: commit record not written, journal stops here");
+    }
+    journal_crc = 0;
+    journal_pending = 0;
+  }
+
+  storage.sync();
+  const uint32_t elapsed_us = (uint32_t)esp_timer_get_time() - started_us;
+  storage_stats.syncs++;
+  if (elapsed_us > storage_stats.sync_max_us) storage_stats.sync_max_us = elapsed_us;
+  last_commit_ms = millis();
+  updateStorageLow();
+}
+
+/**
+ * @brief Flushes the RAM buffer to the session in storage.
+ *
+ * The buffer is drained in place; if only part of it is written, the
+ * unwritten tail remains without being copied. Durability comes from the
+ * periodic commitSession().
+ */
+static void flushBufferToFile() {
+  if (fdr_write_buffer.empty()) return;
+  if (!session_open) {
+    LOG_ERROR("FDR: no open session, cannot flush buffer");
+    return;
+  }
+
+  const uint32_t started_us = (uint32_t)esp_timer_get_time();
+  size_t flushed = 0;
+  {
+    PERF_SCOPE(FdrFlush);
+    // At most two spans: up to the end of the ring, then the wrapped part
+    for (int span = 0; span < 2 && !fdr_write_buffer.empty(); span++) {
+      const uint8_t* data;
+      const size_t len = fdr_write_buffer.peekContiguous(data);
+      const size_t wrote = journalAppend(data, len);
+      fdr_write_buffer.consume(wrote);
+      flushed += wrote;
+      if (wrote < len) break;
+    }
+  }
+  recordFlushTime(started_us, flushed);
+  last_flush_ms = millis();
+  commitSession(false);
+}
+
+/**
+ * @brief Appends one tagged record to the RAM buffer, counting it if dropped.
+ *
+ * @param rec Record to append.
+ * @param len Record size.
+ * @return true if the record was buffered.
+ */
+static bool bufferRecord(const void* rec, size_t len) {
+  if (!fdr_write_buffer.append(rec, len)) {
+    overflow_records++;
+    overflow_bytes += len;
+    return false;
+  }
+  if (fdr_write_buffer.size() > buffer_high_water) {
+    buffer_high_water = (uint32_t)fdr_write_buffer.size();
+  }
+  return true;
+}
+
+/**
+ * @brief Updates the per-channel counters and session summary for one
+ * record that made it into the session.
+ *
+ * @param rec Start of a tagged record (any alignment).
+ */
+static void accountRecord(const uint8_t* rec) {
+  static_assert(offsetof(FdrBaroRecord, t_ms) == offsetof(FdrImuRecord, t_ms),
+                "record timestamps must share an offset");
+  uint32_t t_ms;
+  memcpy(&t_ms, rec + offsetof(FdrBaroRecord, t_ms), sizeof(t_ms));
+  if (t_ms > session_last_t_ms) session_last_t_ms = t_ms;
+
+  // The raw and altitude channels follow the barometer samples; only
+  // filtered ones count
+  if (rec[0] == FDR_REC_IMU) {
+    imu_records++;
+    return;
+  }
+  if (rec[0] != FDR_REC_BARO) return;
+  baro_records++;
+  uint32_t pressure_q8;
+  memcpy(&pressure_q8, rec + offsetof(FdrBaroRecord, pressure_q8), sizeof(pressure_q8));
+  if (pressure_q8 < session_pressure_min_q8) session_pressure_min_q8 = pressure_q8;
+  if (pressure_q8 > session_pressure_max_q8) session_pressure_max_q8 = pressure_q8;
+}
+
+/**
+ * @brief Buffers a sync point at session offset `offset`, restarting the
+ * delta references, and adds it to the time index.
+ *
+ * The point carries the newest timestamp written so far, not the next
+ * one: records after it may be older (an IMU batch drained after later
+ * barometer samples), but none before it is newer, so a seek to the last
+ * point before T never skips a record at or after T.
+ */
+static void markSyncPoint(uint32_t offset) {
+  FdrSyncRecord sync;
+  sync.type = FDR_REC_SYNC;
+  sync.t_ms = session_last_t_ms;
+  if (!bufferRecord(&sync, sizeof(sync))) return;
+  fdr_codecAccept(encode_state, (const uint8_t*)&sync);
+
+  if (time_index_count == FDR_TIME_INDEX_MAX_ENTRIES) {
+    for (size_t i = 0; i < FDR_TIME_INDEX_MAX_ENTRIES / 2; i++) time_index[i] = time_index[2 * i];
+    time_index_count = FDR_TIME_INDEX_MAX_ENTRIES / 2;
+    sync_interval_bytes *= 2;
+  }
+  FdrTimeIndexRecord &entry = time_index[time_index_count++];
+  entry.type = FDR_REC_TIME_INDEX;
+  entry.t_ms = sync.t_ms;
+  entry.offset = offset;
+  next_sync_offset = offset + sync_interval_bytes;
+}
+
+/**
+ * @brief Delta-encodes one sample record into the RAM buffer and accounts
+ * it, after a sync point when one is due. A dropped record does not become
+ * the reference of the next delta.
+ *
+ * @param rec Absolute FdrBaroRecord or FdrImuRecord (any alignment).
+ * @return true if the record was buffered.
+ */
+static bool storeRecord(const uint8_t* rec) {
+  // Commit records only go out with the buffer empty, so this is where
+  // the next buffered byte lands
+  const uint32_t offset = session_bytes + (uint32_t)fdr_write_buffer.size();
+  if (offset >= next_sync_offset) markSyncPoint(offset);
+  uint8_t encoded[FDR_MAX_RECORD_SIZE];
+  const size_t len = fdr_encodeRecord(encode_state, rec, encoded);
+  if (!bufferRecord(encoded, len)) return false;
+  fdr_codecAccept(encode_state, rec);
+  accountRecord(rec);
+  raw_bytes += (uint32_t)fdr_recordSize(rec[0]);
+  encoded_bytes += (uint32_t)len;
+  return true;
+}
+
+/**
+ * @brief Writes the burst buffer to the session file in one go.
+ *
+ * Anything already in the RAM buffer is flushed first so records stay in
+ * time order. The burst records are encoded through the RAM buffer like
+ * any other, flushing whenever it reaches the flush threshold, and
+ * committed at the end. Caller holds `fdr_lock`.
+ */
+static void commitBurstLocked() {
+  if (burst_committed) return;
+  burst_committed = true;
+  led_setHold(false);
+
+  const uint32_t total = burst_bytes.load(std::memory_order_acquire);
+  const uint32_t count = burst_count.load(std::memory_order_relaxed);
+  if (total == 0) return;
+
+  flushBufferToFile();
+  if (!session_open) {
+    LOG_ERROR("FDR: no open session, cannot commit burst");
+    overflow_records += count;
+    overflow_bytes += total;
+    return;
+  }
+
+  size_t offset = 0;
+  while (offset < total) {
+    const uint8_t* rec = burst_buffer + offset;
+    offset += fdr_recordSize(rec[0]);
+    storeRecord(rec);
+    if ((uint32_t)fdr_write_buffer.size() >= BUFFER_FLUSH_THRESHOLD) flushBufferToFile();
+  }
+  flushBufferToFile();
+  commitSession(true);
+  LOG_INFO("FDR: burst committed (%u records)", (unsigned)count);
+}
+
+/**
+ * @brief Copies the record starting at offset `pos` of the pre-trigger
+ * ring, which may wrap at the end of the buffer.
+ *
+ * @param rec Destination, at least FDR_MAX_RECORD_SIZE bytes.
+ * @return Length of the record.
+ */
+static size_t pretriggerRecord(uint32_t pos, uint8_t* rec) {
+  const size_t len = fdr_recordSize(burst_buffer[pos]);
+  const size_t first = len < BURST_BUFFER_BYTES - pos ? len : BURST_BUFFER_BYTES - pos;
+  memcpy(rec, burst_buffer + pos, first);
+  memcpy(rec + first, burst_buffer, len - first);
+  return len;
+}
+
+/**
+ * @brief Writes the pre-trigger ring to the session file, oldest record
+ * first, the same way as a burst. Caller holds `fdr_lock`.
+ */
+static void commitPretriggerLocked() {
+  if (pretrigger_committed) return;
+  pretrigger_committed = true;
+
+  uint32_t pos = pretrigger_tail;
+  uint32_t left = pretrigger_used.load(std::memory_order_acquire);
+  uint32_t count = 0;
+  uint8_t rec[FDR_MAX_RECORD_SIZE];
+  while (left > 0) {
+    const size_t len = pretriggerRecord(pos, rec);
+    pos = (uint32_t)((pos + len) % BURST_BUFFER_BYTES);
+    left -= (uint32_t)len;
+    storeRecord(rec);
+    count++;
+    if ((uint32_t)fdr_write_buffer.size() >= BUFFER_FLUSH_THRESHOLD) flushBufferToFile();
+  }
+  flushBufferToFile();
+  commitSession(true);
+  led_setMode(LedMode::Recording);
+  LOG_INFO("FDR: pre-trigger window committed (%u records)", (unsigned)count);
+}
+
+/**
+ * @brief Deletes an armed session stopped before its trigger; it holds no
+ * samples. Caller holds `fdr_lock`.
+ */
+static void discardArmedSessionLocked() {
+  pretrigger_committed = true;
+  if (session_open) storage.close();
+  session_open = false;
+  if (session_count > 0) {
+    storage.remove(session_index[session_count - 1].session_id);
+    session_count--;
+  }
+  LOG_INFO("FDR: not triggered, armed session deleted");
+}
+
+/**
+ * @brief Appends the time index to a session about to be closed, committed
+ * on its own so readers find it from the last commit record. Skipped if
+ * the journal or the last flush failed. Caller holds `fdr_lock`.
+ */
+static void appendTimeIndexLocked() {
+  if (!session_open || !journal_ok || time_index_count == 0 || !fdr_write_buffer.empty()) return;
+  commitSession(true);
+  const size_t len = time_index_count * sizeof(FdrTimeIndexRecord);
+  if (journalAppend((const uint8_t*)time_index, len) != len) {
+    LOG_WARN("FDR: time index not stored, queries will scan this session");
+  }
+}
+
+/**
+ * @brief Syncs and closes the session in storage if open.
+ */
+static void closeFdrFileIfOpen() {
+  if (!session_open) return;
+  commitSession(true);
+  storage.close();
+  session_open = false;
+}
+
+/**
+ * @brief RAII helper holding `fdr_lock` for the current scope.
+ */
+class FdrLockGuard {
+ public:
+  FdrLockGuard() { xSemaphoreTake(fdr_lock, portMAX_DELAY); }
+  ~FdrLockGuard() { xSemaphoreGive(fdr_lock); }
+  FdrLockGuard(const FdrLockGuard&) = delete;
+  FdrLockGuard& operator=(const FdrLockGuard&) = delete;
+};
+
+/**
+ * @brief Moves all queued records into the RAM buffer. Caller holds `fdr_lock`.
+ *
+ * The barometer queue goes first: if the RAM buffer runs short, the
+ * low-rate channel keeps its records and the IMU absorbs the loss. Under
+ * backpressure only one sample of each channel out of the store decimation
+ * is kept; flight events always are.
+ */
+static void drainQueueLocked() {
+  uint32_t depth = (uint32_t)sample_queue.size();
+  if (depth > queue_high_water) queue_high_water = depth;
+  depth = (uint32_t)imu_queue.size();
+  if (depth > imu_queue_high_water) imu_queue_high_water = depth;
+
+  const uint32_t stored_before = encoded_bytes;
+  const uint32_t decimation = storage_plan.decimation;
+  FdrBaroRecord baro;
+  while (sample_queue.pop(baro)) {
+    if (baro.type == FDR_REC_BARO) decimate_keep_baro = decimate_baro_seen++ % decimation == 0;
+    if (decimate_keep_baro || baro.type == FDR_REC_EVENT) {
+      storeRecord((const uint8_t*)&baro);
+    } else {
+      storage_plan.decimated_records++;
+    }
+  }
+  FdrImuRecord imu;
+  while (imu_queue.pop(imu)) {
+    if (decimate_imu_seen++ % decimation == 0) {
+      storeRecord((const uint8_t*)&imu);
+    } else {
+      storage_plan.decimated_records++;
+    }
+  }
+  stream_bytes += encoded_bytes - stored_before;
+}
+
+/**
+ * @brief Adjusts the store decimation once per BACKPRESSURE_STEP_MS, from
+ * the RAM buffer fill and the storage the rest of the session needs at the
+ * rate the queues were stored at over the last step. Writer task context,
+ * once a burst or pre-trigger window has been committed (so the session
+ * end is settled); caller holds `fdr_lock`.
+ */
+static void updateBackpressureLocked() {
+  const uint32_t now_ms = millis();
+  const uint32_t elapsed_ms = now_ms - backpressure_window_ms;
+  if (elapsed_ms < BACKPRESSURE_STEP_MS) return;
+
+  const uint32_t buffered = (uint32_t)fdr_write_buffer.size();
+  const uint32_t used = session_bytes - sizeof(FdrFileHeader) + buffered + STORAGE_RESERVE_BYTES;
+  const uint32_t free_bytes = session_free_start_bytes > used ? session_free_start_bytes - used : 0;
+  const int64_t now_us = esp_timer_get_time();
+  const int64_t end_us = fdr_end_us.load(std::memory_order_relaxed);
+  const uint64_t left_ms = end_us > now_us ? (uint64_t)(end_us - now_us) / 1000 : 0;
+  const uint64_t need = (uint64_t)stream_bytes * left_ms / elapsed_ms;
+  backpressure_window_ms = now_ms;
+  stream_bytes = 0;
+
+  const char* cause = nullptr;
+  if (buffered >= BACKPRESSURE_BUFFER_HIGH) {
+    cause = "buffer";
+  } else if (need > free_bytes) {
+    cause = "storage";
+  }
+  const uint8_t decimation = storage_plan.decimation;
+  if (cause != nullptr && decimation < MAX_STORE_DECIMATION) {
+    storage_plan.decimation = decimation * 2;
+    storage_plan.backpressure_cause = cause;
+    storage_plan.backpressure_steps++;
+    if (storage_plan.decimation > storage_plan.max_decimation) {
+      storage_plan.max_decimation = storage_plan.decimation;
+    }
+    LOG_WARN("FDR: %s backpressure, storing 1 sample in %u", cause,
+             (unsigned)storage_plan.decimation);
+  } else if (cause == nullptr && decimation > 1 && buffered < BUFFER_FLUSH_THRESHOLD &&
+             need * 2 * (100 + BACKPRESSURE_MARGIN_PERCENT) / 100 <= free_bytes) {
+    storage_plan.decimation = decimation / 2;
+    storage_plan.backpressure_steps++;
+    LOG_INFO("FDR: backpressure eased, storing 1 sample in %u", (unsigned)storage_plan.decimation);
+  }
+}
+
+/**
+ * @brief Flushes everything still in RAM and closes the session; an armed
+ * session that never triggered is deleted instead. Caller holds `fdr_lock`.
+ */
+static void finishSessionLocked() {
+  if (!pretrigger_committed && !pretrigger_done.load(std::memory_order_acquire)) {
+    discardArmedSessionLocked();
+  } else {
+    commitPretriggerLocked();
+    commitBurstLocked();
+    drainQueueLocked();
+    flushBufferToFile();
+    appendTimeIndexLocked();
+    closeFdrFileIfOpen();
+    updateCurrentEntry(false);
+  }
+  if (!saveIndex()) LOG_ERROR("FDR: cannot write session index");
+  clearResumeRecord();
+
+  fdr_active = false;
+  barometer_setFastMode(false);
+  barometer_setForcedMode(false);
+  power_holdFlight(false);
+  led_setMode(LedMode::Idle);
+  led_setCondition(LED_STORAGE_LOW, false);
+  led_setHold(false);
+  LOG_INFO("FDR: stopped (file flushed and closed)");
+}
+
+/**
+ * @brief Brings the session being recorded up to date in storage for a
+ * reader: a triggered pre-trigger ring is committed first, as writerStep()
+ * does, so records stay in time order; then the queues are drained,
+ * flushed and committed. An armed session still waiting for its trigger
+ * has nothing to write. Caller holds `fdr_lock`, with any burst committed.
+ */
+static void syncLiveSessionLocked() {
+  if (!pretrigger_committed) {
+    if (!pretrigger_done.load(std::memory_order_acquire)) return;
+    commitPretriggerLocked();
+  }
+  drainQueueLocked();
+  flushBufferToFile();
+  commitSession(true);
+}
+
+/**
+ * @brief Appends a tagged record to the burst buffer, counting it if it does
+ * not fit. Sampler task context.
+ */
+static void burstAppend(const void* rec, size_t len) {
+  const uint32_t used = burst_bytes.load(std::memory_order_relaxed);
+  if (used + len > BURST_BUFFER_BYTES) {
+    burst_dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  memcpy(burst_buffer + used, rec, len);
+  burst_count.fetch_add(1, std::memory_order_relaxed);
+  burst_bytes.store(used + (uint32_t)len, std::memory_order_release);
+}
+
+/**
+ * @brief Appends an absolute record to the pre-trigger ring. The oldest
+ * records are dropped to make room, and so are those that fell out of the
+ * pre-trigger window. Sampler task context.
+ */
+static void pretriggerAppend(const void* rec, size_t len) {
+  uint32_t used = pretrigger_used.load(std::memory_order_relaxed);
+  uint8_t oldest[FDR_MAX_RECORD_SIZE];
+  while (used + len > BURST_BUFFER_BYTES) {
+    const size_t n = pretriggerRecord(pretrigger_tail, oldest);
+    pretrigger_tail = (uint32_t)((pretrigger_tail + n) % BURST_BUFFER_BYTES);
+    used -= (uint32_t)n;
+  }
+
+  const size_t first = len < BURST_BUFFER_BYTES - pretrigger_head ? len
+                                                                  : BURST_BUFFER_BYTES - pretrigger_head;
+  memcpy(burst_buffer + pretrigger_head, rec, first);
+  memcpy(burst_buffer, (const uint8_t*)rec + first, len - first);
+  pretrigger_head = (uint32_t)((pretrigger_head + len) % BURST_BUFFER_BYTES);
+  used += (uint32_t)len;
+
+  // Every record has t_ms right after its type byte
+  uint32_t t_ms;
+  memcpy(&t_ms, (const uint8_t*)rec + 1, sizeof(t_ms));
+  while (used > len) {
+    const size_t n = pretriggerRecord(pretrigger_tail, oldest);
+    uint32_t oldest_t_ms;
+    memcpy(&oldest_t_ms, oldest + 1, sizeof(oldest_t_ms));
+    if ((int32_t)(t_ms - oldest_t_ms) <= (int32_t)fdr_pretrigger_ms) break;
+    pretrigger_tail = (uint32_t)((pretrigger_tail + n) % BURST_BUFFER_BYTES);
+    used -= (uint32_t)n;
+  }
+  pretrigger_used.store(used, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Builds a barometer record with the current temperature.
+ */
+static FdrBaroRecord makeBaroRecord(uint8_t type, uint32_t t_ms, uint32_t pressure_q8) {
+  FdrBaroRecord rec;
+  rec.type = type;
+  rec.t_ms = t_ms;
+  rec.pressure_q8 = pressure_q8;
+  rec.temperature_cdeg = barometer_getTemperatureCdeg();
+  return rec;
+}
+
+/**
+ * @brief Altitude and event records travel through the barometer queues,
+ * which carry any record of the FdrBaroRecord size.
+ */
+template <typename Record>
+static FdrBaroRecord asBaroLayout(const Record &rec) {
+  static_assert(sizeof(Record) == sizeof(FdrBaroRecord), "record does not fit the queue");
+  FdrBaroRecord out;
+  memcpy(&out, &rec, sizeof(out));
+  return out;
+}
+
+/**
+ * @brief Builds an altitude record from the barometer's flight state.
+ */
+static FdrAltRecord makeAltRecord(const BarometerFlight &flight, uint32_t t_ms) {
+  FdrAltRecord rec;
+  rec.type = FDR_REC_ALT;
+  rec.t_ms = t_ms;
+  rec.altitude_cm = flight.altitude_cm;
+  rec.vspeed_cms = (int16_t)(flight.vspeed_cms > INT16_MAX   ? INT16_MAX
+                             : flight.vspeed_cms < -INT16_MAX ? -INT16_MAX
+                                                              : flight.vspeed_cms);
+  return rec;
+}
+
+/**
+ * @brief Builds the record of a flight event the barometer flagged since
+ * the last call. Sampler task context.
+ *
+ * @param start_us Time origin of the record (session start, or 0 for uptime).
+ * @return false if there is no new event.
+ */
+static bool takeFlightEvent(const BarometerFlight &flight, int64_t start_us, FdrEventRecord &rec) {
+  if (flight.event_count == flight_events_seen) return false;
+  flight_events_seen = flight.event_count;
+  rec.type = FDR_REC_EVENT;
+  rec.t_ms = flight.last_event_us > start_us ? (uint32_t)((flight.last_event_us - start_us) / 1000) : 0;
+  rec.altitude_cm = flight.last_event_cm;
+  rec.event = (uint8_t)flight.last_event;
+  rec.reserved = 0;
+  return true;
+}
+
+/**
+ * @brief Hands a record to the writer task through the barometer queue.
+ */
+static void queueSample(const FdrBaroRecord &rec) {
+  if (!sample_queue.push(rec)) queue_dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Builds an IMU record from one FIFO sample.
+ */
+static FdrImuRecord makeImuRecord(const ImuSample &sample, uint32_t t_ms) {
+  FdrImuRecord rec;
+  rec.type = FDR_REC_IMU;
+  rec.t_ms = t_ms;
+  memcpy(rec.accel, sample.accel, sizeof(rec.accel));
+  memcpy(rec.gyro, sample.gyro, sizeof(rec.gyro));
+  return rec;
+}
+
+/**
+ * @brief Offers a record to the live telemetry tap, restamped with the
+ * device uptime. Sampler task context; never blocks.
+ */
+static void livePush(FdrBaroRecord rec, int64_t t_us) {
+  if (!live_enabled.load(std::memory_order_relaxed)) return;
+  rec.t_ms = (uint32_t)(t_us / 1000);
+  if (!live_baro_queue.push(rec)) live_dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void livePush(FdrImuRecord rec, int64_t t_us) {
+  if (!live_enabled.load(std::memory_order_relaxed)) return;
+  rec.t_ms = (uint32_t)(t_us / 1000);
+  if (!live_imu_queue.push(rec)) live_dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Fires the trigger of an armed session: marks the moment with an
+ * FDR_EVENT_TRIGGER record, hands the pre-trigger ring to the writer and
+ * starts the session duration. Later samples take the regular path.
+ * Sampler task context.
+ */
+static void fireTrigger(int64_t t_us, const char* cause) {
+  BarometerFlight flight;
+  barometer_getFlight(flight);
+  FdrEventRecord rec;
+  rec.type = FDR_REC_EVENT;
+  rec.t_ms = t_us > fdr_start_us ? (uint32_t)((t_us - fdr_start_us) / 1000) : 0;
+  rec.altitude_cm = flight.valid ? flight.altitude_cm : 0;
+  rec.event = FDR_EVENT_TRIGGER;
+  rec.reserved = 0;
+  if (fdr_record_altitude) pretriggerAppend(&rec, sizeof(rec));
+  livePush(asBaroLayout(rec), t_us);
+
+  trigger_t_ms.store(rec.t_ms, std::memory_order_relaxed);
+  trigger_cause = cause;
+  fdr_end_us.store(t_us + (int64_t)fdr_duration_s * 1000000LL, std::memory_order_relaxed);
+  fdr_armed.store(false, std::memory_order_release);
+  pretrigger_done.store(true, std::memory_order_release);
+  power_holdFlight(true); // full clock and no light sleep until the session ends
+  xTaskNotifyGive(writer_task);
+  LOG_INFO("FDR: triggered (%s) at %u ms", cause, (unsigned)rec.t_ms);
+}
+
+/**
+ * @brief Checks the barometer trigger conditions of an armed session on one
+ * sample. The pressure drop rate is measured over TRIGGER_RATE_WINDOW_MS,
+ * or the sample interval if longer. Sampler task context.
+ *
+ * @param event FdrFlightEvent flagged on this sample, 0 if none.
+ * @return The trigger cause, nullptr if none fired.
+ */
+static const char* baroTrigger(uint32_t t_ms, uint32_t pressure_q8, uint8_t event) {
+  if (fdr_trigger.launch && event == FDR_EVENT_LAUNCH) return "launch";
+  if (fdr_trigger.pressure_drop_pa_s == 0) return nullptr;
+
+  if (!trigger_anchor_valid) {
+    trigger_anchor_t_ms = t_ms;
+    trigger_anchor_q8 = pressure_q8;
+    trigger_anchor_valid = true;
+    return nullptr;
+  }
+  const uint32_t dt_ms = t_ms - trigger_anchor_t_ms;
+  if (dt_ms < TRIGGER_RATE_WINDOW_MS) return nullptr;
+  // Pa/s from Pa * 256 over milliseconds
+  const int64_t drop_pa_s =
+    ((int64_t)trigger_anchor_q8 - (int64_t)pressure_q8) * 1000 / (256 * (int64_t)dt_ms);
+  trigger_anchor_t_ms = t_ms;
+  trigger_anchor_q8 = pressure_q8;
+  return drop_pa_s >= (int64_t)fdr_trigger.pressure_drop_pa_s ? "pressure" : nullptr;
+}
+
+/**
+ * @brief True if an IMU sample exceeds the acceleration trigger threshold.
+ */
+static bool accelTrigger(const ImuSample &sample) {
+  if (trigger_accel_lsb_sq == 0) return false;
+  uint64_t sq = 0;
+  for (uint8_t axis = 0; axis < 3; axis++) {
+    sq += (uint64_t)((int32_t)sample.accel[axis] * sample.accel[axis]);
+  }
+  return sq > trigger_accel_lsb_sq;
+}
+
+/**
+ * @brief Feeds the live tap between sessions: each new barometer reading
+ * (read every LIVE_IDLE_BARO_PERIOD_US while a client is attached) with its
+ * altitude, flight events and every IMU sample. Sampler task context.
+ *
+ * @param baro_fresh true if barometer_process() just stored a reading.
+ */
+static void liveIdleSample(bool baro_fresh) {
+  const int64_t now_us = esp_timer_get_time();
+  BarometerFlight flight;
+  barometer_getFlight(flight);
+  FdrEventRecord event;
+  if (takeFlightEvent(flight, 0, event)) livePush(asBaroLayout(event), flight.last_event_us);
+  if (baro_fresh) {
+    livePush(makeBaroRecord(FDR_REC_BARO, 0, barometer_getPressureQ8()), now_us);
+    if (flight.valid) livePush(asBaroLayout(makeAltRecord(flight, 0)), now_us);
+  }
+  ImuSample samples[IMU_DRAIN_BATCH];
+  const size_t got = imu_process(samples, IMU_DRAIN_BATCH);
+  for (size_t i = 0; i < got; i++) {
+    livePush(makeImuRecord(samples[i], 0), samples[i].t_us);
+  }
+}
+
+/**
+ * @brief Takes one sample if a session is running. Sampler task context.
+ *
+ * Only reads the barometer cache, runs the session's filter chain and stores
+ * into RAM (the burst buffer or the lock-free queue), so it never waits on
+ * flash or on the HTTP server. With the raw channel enabled the unfiltered
+ * sample follows the filtered one, then the altitude and any flight event
+ * the barometer flagged on this reading. While the session is armed,
+ * samples go into the pre-trigger ring and are checked against the
+ * trigger conditions.
+ *
+ * @param now_us Wake-up time of this sample (esp_timer µs).
+ * @param burst true to store into the burst buffer.
+ * @param fresh false if barometer_process() stored no new reading for this
+ *              deadline (forced mode only); the sample is then skipped
+ *              rather than repeating the previous one.
+ */
+static void sampleOnce(int64_t now_us, bool burst, bool fresh) {
+  PERF_SCOPE(FdrSample);
+  if (now_us >= fdr_end_us.load(std::memory_order_relaxed)) {
+    fdr_sampling = false;
+    xTaskNotifyGive(writer_task);
+    return;
+  }
+
+  if (!barometer_isReady()) {
+    LOG_WARN_EVERY(LOGGER_REPEAT_INTERVAL_MS, "FDR: barometer not ready, skipping sample");
+    portENTER_CRITICAL(&stats_mux);
+    timing_stats.skipped_not_ready++;
+    portEXIT_CRITICAL(&stats_mux);
+    return;
+  }
+  if (!fresh) {
+    LOG_WARN_EVERY(LOGGER_REPEAT_INTERVAL_MS, "FDR: barometer conversion not ready, skipping sample");
+    portENTER_CRITICAL(&stats_mux);
+    timing_stats.skipped_stale++;
+    portEXIT_CRITICAL(&stats_mux);
+    return;
+  }
+
+  const uint32_t t_ms = (uint32_t)((now_us - fdr_start_us) / 1000);
+  const uint32_t raw_q8 = barometer_getRawPressureQ8();
+  const FdrBaroRecord rec =
+    makeBaroRecord(FDR_REC_BARO, t_ms, pressureFilter_apply(fdr_filter, t_ms, raw_q8));
+  livePush(rec, now_us);
+  const FdrBaroRecord raw = makeBaroRecord(FDR_REC_BARO_RAW, t_ms, raw_q8);
+
+  BarometerFlight flight;
+  barometer_getFlight(flight);
+  const FdrAltRecord alt = makeAltRecord(flight, t_ms);
+  FdrEventRecord event;
+  const bool has_event = takeFlightEvent(flight, fdr_start_us, event);
+  if (flight.valid) livePush(asBaroLayout(alt), now_us);
+  if (has_event) livePush(asBaroLayout(event), flight.last_event_us);
+  const bool record_alt = fdr_record_altitude && flight.valid;
+  const bool record_event = fdr_record_altitude && has_event;
+
+  const bool armed = fdr_armed.load(std::memory_order_relaxed);
+  if (burst || armed) {
+    const auto append = burst ? burstAppend : pretriggerAppend;
+    append(&rec, sizeof(rec));
+    if (fdr_record_raw) append(&raw, sizeof(raw));
+    if (record_alt) append(&alt, sizeof(alt));
+    if (record_event) append(&event, sizeof(event));
+    if (!armed) return;
+    const char* cause = baroTrigger(t_ms, rec.pressure_q8, has_event ? event.event : 0);
+    if (cause != nullptr) fireTrigger(now_us, cause);
+    return;
+  }
+
+  queueSample(rec);
+  if (fdr_record_raw) queueSample(raw);
+  if (record_alt) queueSample(asBaroLayout(alt));
+  if (record_event) queueSample(asBaroLayout(event));
+}
+
+/**
+ * @brief Moves the samples waiting in the IMU FIFO into the session.
+ * Sampler task context.
+ *
+ * Samples taken before the session started (still queued in the FIFO when
+ * it began) are discarded. An armed session keeps them in the pre-trigger
+ * ring and checks them against the acceleration trigger.
+ *
+ * @param burst true to store into the burst buffer.
+ */
+static void drainImu(bool burst) {
+  PERF_SCOPE(FdrImuDrain);
+  ImuSample samples[IMU_DRAIN_BATCH];
+  const size_t got = imu_process(samples, IMU_DRAIN_BATCH);
+  for (size_t i = 0; i < got; i++) {
+    if (samples[i].t_us < fdr_start_us) continue;
+
+    const FdrImuRecord rec =
+      makeImuRecord(samples[i], (uint32_t)((samples[i].t_us - fdr_start_us) / 1000));
+    livePush(rec, samples[i].t_us);
+
+    if (burst) {
+      burstAppend(&rec, sizeof(rec));
+    } else if (fdr_armed.load(std::memory_order_relaxed)) {
+      pretriggerAppend(&rec, sizeof(rec));
+      if (accelTrigger(samples[i])) fireTrigger(samples[i].t_us, "accel");
+    } else if (!imu_queue.push(rec)) {
+      imu_queue_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+}
+
+/**
+ * @brief Builds a SamplePeriod for a rate in millihertz.
+ */
+static SamplePeriod makePeriod(uint32_t rate_mhz) {
+  SamplePeriod p;
+  p.rate_mhz = rate_mhz;
+  p.period_us = US_PER_SEC_X1000 / rate_mhz;
+  p.period_rem = US_PER_SEC_X1000 % rate_mhz;
+  return p;
+}
+
+/**
+ * @brief Converts a rate in Hz to millihertz, clamped to [min_mhz, max_mhz].
+ *
+ * @param samples_per_sec Requested rate; values <= 0 select `fallback_mhz`.
+ */
+static uint32_t clampRateMhz(float samples_per_sec, uint32_t fallback_mhz,
+                             uint32_t min_mhz, uint32_t max_mhz) {
+  uint32_t rate_mhz = fallback_mhz;
+  if (samples_per_sec > 0.0f) {
+    const float mhz = samples_per_sec * 1000.0f + 0.5f;
+    rate_mhz = mhz >= (float)max_mhz ? max_mhz : (uint32_t)mhz;
+  }
+  if (rate_mhz > max_mhz) rate_mhz = max_mhz;
+  if (rate_mhz < min_mhz) rate_mhz = min_mhz;
+  return rate_mhz;
+}
+
+/**
+ * @brief Moves a deadline forward by exactly one sample period.
+ *
+ * @param deadline_us Deadline to advance.
+ * @param rem_acc Remainder accumulator owned by the caller.
+ * @param period Period to advance by.
+ */
+static void advanceDeadline(int64_t &deadline_us, uint32_t &rem_acc, const SamplePeriod &period) {
+  deadline_us += period.period_us;
+  rem_acc += period.period_rem;
+  if (rem_acc >= period.rate_mhz) {
+    rem_acc -= period.rate_mhz;
+    deadline_us++;
+  }
+}
+
+/**
+ * @brief Records the lateness of one sample and any deadlines it skipped.
+ *
+ * @param late_us Wake-up time minus deadline.
+ * @param missed Number of whole periods skipped because of the delay.
+ */
+static void recordTiming(uint32_t late_us, uint32_t missed) {
+  size_t bucket = 0;
+  while (bucket < FDR_JITTER_BUCKETS - 1 && late_us >= FDR_JITTER_BUCKET_LIMITS_US[bucket]) {
+    bucket++;
+  }
+
+  portENTER_CRITICAL(&stats_mux);
+  timing_stats.samples++;
+  timing_stats.missed_deadlines += missed;
+  timing_stats.jitter_hist[bucket]++;
+  if (late_us < timing_stats.jitter_min_us) timing_stats.jitter_min_us = late_us;
+  if (late_us > timing_stats.jitter_max_us) timing_stats.jitter_max_us = late_us;
+  jitter_sum_us += late_us;
+  portEXIT_CRITICAL(&stats_mux);
+}
+
+/**
+ * @brief Clears the per-session scheduling statistics.
+ */
+static void resetTimingStats() {
+  portENTER_CRITICAL(&stats_mux);
+  timing_stats = {};
+  timing_stats.rate_mhz = fdr_period.rate_mhz;
+  timing_stats.period_us = fdr_period.period_us;
+  timing_stats.jitter_min_us = UINT32_MAX;
+  jitter_sum_us = 0;
+  portEXIT_CRITICAL(&stats_mux);
+}
+
+/**
+ * @brief esp_timer callback: wakes the sampler task at a sample deadline.
+ */
+static void onSampleTimer(void*) {
+  xTaskNotifyGive(sampler_task);
+}
+
+/**
+ * @brief esp_timer callback of the live telemetry batches, next to the
+ * live stream code at the end of this file.
+ */
+static void onLiveTimer(void*);
+
+/**
+ * @brief Runs one recording session on an absolute-deadline schedule.
+ *
+ * Deadline k is start + k * period, advanced in integer µs with a remainder
+ * accumulator, so late wake-ups never shift later samples and non-integer-ms
+ * periods (e.g. 30 Hz) keep their exact average rate. If a wake-up is more
+ * than a period late, the skipped deadlines are counted rather than sampled
+ * in a catch-up burst.
+ *
+ * A session with a burst window starts on the burst period, capturing into
+ * RAM, and switches to the regular period at `burst_end_us`; the regular
+ * schedule is anchored there.
+ *
+ * When the IMU is recorded its FIFO is drained on a separate, relaxed
+ * schedule: the sensor timestamps its own samples, so only the drain
+ * interval matters, and the barometer deadlines are unaffected by it.
+ *
+ * With the barometer in forced mode each conversion is triggered one
+ * conversion time ahead of its deadline, so the reading taken at the
+ * deadline is always the one measured just before it. A late trigger
+ * makes its sample late (and counted as such) rather than stale.
+ */
+static void runSession() {
+  const uint32_t generation = session_generation.load(std::memory_order_acquire);
+  int64_t deadline_us = fdr_start_us;
+  uint32_t rem_acc = 0;
+  bool in_burst = burst_end_us > fdr_start_us;
+  const SamplePeriod* period = in_burst ? &burst_period : &fdr_period;
+  const bool record_imu = fdr_imu_rate_hz > 0;
+  int64_t imu_deadline_us = fdr_start_us + IMU_DRAIN_INTERVAL_US;
+  const int64_t lead_us = fdr_baro_forced ? baro_conversion_us : 0;
+  bool triggered = !fdr_baro_forced;
+  int64_t converted_us = 0; // when the triggered conversion is complete
+  pressureFilter_init(fdr_filter, fdr_filter_config);
+  BarometerFlight flight;
+  barometer_getFlight(flight);
+  flight_events_seen = flight.event_count; // events before the session are not recorded
+  trigger_anchor_valid = false;
+
+  while (fdr_sampling.load(std::memory_order_acquire) &&
+         session_generation.load(std::memory_order_acquire) == generation) {
+    const int64_t now_us = esp_timer_get_time();
+    if (record_imu && now_us >= imu_deadline_us) {
+      drainImu(in_burst);
+      imu_deadline_us = now_us + IMU_DRAIN_INTERVAL_US;
+    }
+
+    if (!triggered && now_us >= deadline_us - lead_us) {
+      barometer_trigger(); // a failed start shows as a stale reading
+      triggered = true;
+      converted_us = now_us + lead_us;
+    }
+
+    // A trigger delayed by a flash stall delays its sample rather than
+    // reading the conversion before it is complete
+    const int64_t baro_wake_us = !triggered ? deadline_us - lead_us
+                                 : (converted_us > deadline_us ? converted_us : deadline_us);
+    const int64_t wake_us = (record_imu && imu_deadline_us < baro_wake_us)
+                              ? imu_deadline_us : baro_wake_us;
+    if (now_us < wake_us) {
+      power_prepareWait(wake_us);
+      esp_timer_start_once(sample_timer, (uint64_t)(wake_us - now_us));
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      esp_timer_stop(sample_timer); // no-op unless woken early by start/stop
+      continue;
+    }
+
+    const uint32_t late_us = (uint32_t)(now_us - deadline_us);
+    const bool burst_sample = in_burst;
+    uint32_t missed = 0;
+    advanceDeadline(deadline_us, rem_acc, *period);
+    if (in_burst && deadline_us >= burst_end_us) {
+      in_burst = false;
+      period = &fdr_period;
+      deadline_us = burst_end_us;
+      rem_acc = 0;
+    }
+    while (deadline_us <= now_us) {
+      advanceDeadline(deadline_us, rem_acc, *period);
+      missed++;
+    }
+    recordTiming(late_us, missed);
+
+    const bool fresh = barometer_process();
+    led_setCondition(LED_SENSOR_LOST, !barometer_isReady());
+    triggered = !fdr_baro_forced;
+    sampleOnce(now_us, burst_sample, fresh || !fdr_baro_forced);
+
+    if (burst_sample && !in_burst) {
+      burst_done.store(true, std::memory_order_release);
+      xTaskNotifyGive(writer_task);
+    }
+  }
+
+  if (in_burst) {
+    burst_done.store(true, std::memory_order_release);
+    xTaskNotifyGive(writer_task);
+  }
+}
+
+/**
+ * @brief Barometer read interval between sessions: the live tap's rate
+ * while a client is attached, the idle rate otherwise, and short steps
+ * while the bus scan looks for a sensor.
+ */
+static int64_t idleBaroIntervalUs() {
+  if (!barometer_isReady()) return IDLE_RESCAN_INTERVAL_US;
+  const uint32_t rate_mhz = live_enabled.load(std::memory_order_relaxed)
+                              ? LIVE_IDLE_BARO_RATE_MHZ
+                              : idle_rate_mhz.load(std::memory_order_relaxed);
+  return (int64_t)(US_PER_SEC_X1000 / rate_mhz);
+}
+
+/**
+ * @brief One wakeup of the sampler task between sessions. Sampler task
+ * context.
+ *
+ * Reads the barometer only when its interval has passed, so an idle device
+ * costs one bus transaction per idle period, and drains the IMU FIFO
+ * before it can overflow. With a live client attached every IMU sample
+ * and each new barometer reading go to the tap.
+ *
+ * @return Time (µs) until the next wakeup is due.
+ */
+static int64_t idleStep() {
+  static int64_t last_baro_us = INT64_MIN / 2;
+  static int64_t last_imu_us = INT64_MIN / 2;
+  const int64_t now_us = esp_timer_get_time();
+  // Recomputed on every wakeup, so a rate change applies right away
+  const int64_t baro_due_us = last_baro_us + idleBaroIntervalUs();
+  bool fresh = false;
+  if (now_us >= baro_due_us) {
+    fresh = barometer_process();
+    led_setCondition(LED_SENSOR_LOST, !barometer_isReady());
+    last_baro_us = now_us;
+  }
+
+  if (live_enabled.load(std::memory_order_relaxed)) {
+    liveIdleSample(fresh);
+    return IDLE_LIVE_INTERVAL_US;
+  }
+  if (now_us - last_imu_us >= IDLE_IMU_DRAIN_INTERVAL_US) {
+    imu_process(nullptr, 0);
+    last_imu_us = now_us;
+  }
+  const int64_t next_us = last_baro_us + idleBaroIntervalUs();
+  const int64_t imu_next_us = last_imu_us + IDLE_IMU_DRAIN_INTERVAL_US;
+  const int64_t wake_us = next_us < imu_next_us ? next_us : imu_next_us;
+  return wake_us > now_us ? wake_us - now_us : 0;
+}
+
+/**
+ * @brief High-priority sampling task.
+ *
+ * While a session is recording it follows runSession()'s deadline schedule,
+ * woken by a one-shot esp_timer, so HTTP traffic cannot delay it.
+ * Between sessions it reads the sensors only as fast as someone consumes
+ * them (idleStep()); starting a session, attaching a live client or
+ * changing the idle rate wakes it early. Before blocking it tells the
+ * power module when it has to run next, the limit of a light sleep.
+ */
+static void samplerTask(void*) {
+  for (;;) {
+    if (fdr_sampling.load(std::memory_order_acquire)) {
+      runSession();
+      continue;
+    }
+    const int64_t wait_us = idleStep();
+    power_prepareWait(esp_timer_get_time() + wait_us);
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS((uint32_t)((wait_us + 999) / 1000)));
+  }
+}
+
+/**
+ * @brief One wakeup of the writer task.
+ *
+ * Drains the sample queue into the RAM buffer, flushes it to storage by
+ * size or age and closes the session once the sampler has finished. During
+ * a burst window it stays off the flash entirely (a flash write stalls the
+ * whole CPU, sampler included) and commits the burst buffer afterwards.
+ * An armed session only gets maintenance steps until its trigger, then the
+ * pre-trigger ring is committed the same way.
+ * Otherwise each wakeup also gives the backend one bounded maintenance step
+ * (the raw log erases sectors ahead of its write pointer here).
+ */
+static void writerStep() {
+  PERF_SCOPE(FdrWriterStep);
+  FdrLockGuard lock;
+  if (!fdr_active) {
+    if (storage_mounted) storage.maintain();
+    return;
+  }
+
+  if (!fdr_sampling.load(std::memory_order_acquire)) {
+    finishSessionLocked();
+    return;
+  }
+
+  if (!pretrigger_committed) {
+    // Armed: nothing to write until the trigger hands over the ring
+    if (!pretrigger_done.load(std::memory_order_acquire)) {
+      storage.maintain();
+      return;
+    }
+    commitPretriggerLocked();
+  }
+
+  if (!burst_committed) {
+    // No flash I/O at all while the burst window is capturing
+    if (!burst_done.load(std::memory_order_acquire)) return;
+    commitBurstLocked();
+  }
+
+  drainQueueLocked();
+  updateBackpressureLocked();
+  if ((uint32_t)fdr_write_buffer.size() >= BUFFER_FLUSH_THRESHOLD ||
+      (millis() - last_flush_ms) >= BUFFER_FLUSH_INTERVAL_MS) {
+    flushBufferToFile();
+  }
+  storage.maintain();
+}
+
+/**
+ * @brief Lower-priority writer task: a writerStep() per notification from
+ * the sampler, or every WRITER_POLL_INTERVAL_MS.
+ */
+static void writerTask(void*) {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(WRITER_POLL_INTERVAL_MS));
+    writerStep();
+  }
+}
+
+/**
+ * @brief Continues the session a reset cut off, as told by its resume
+ * record. Runs once the recovery scan has closed it, and only for the
+ * latest session.
+ *
+ * A session that had recorded data goes on as a new, unarmed session for
+ * the rest of its duration (counted from the trigger for an armed one) and
+ * without its burst window: the flight is already under way. An armed
+ * session still waiting for its trigger is armed again, and its empty file
+ * deleted.
+ */
+static void resumeInterruptedSession() {
+  ResumeRecord record;
+  if (!loadResumeRecord(record)) return;
+  FdrSessionConfig config = record.config;
+  bool flight = false;
+  {
+    FdrLockGuard lock;
+    const FdrIndexEntry* entry = session_count ? &session_index[session_count - 1] : nullptr;
+    if (entry == nullptr || entry->session_id != record.session_id ||
+        !(entry->flags & FDR_SESSION_RECOVERED)) {
+      clearResumeRecord();
+      return;
+    }
+    if (config.pretrigger_ms > 0 && entry->baro_records == 0) {
+      storage.remove(entry->session_id);
+      session_count--;
+      if (!saveIndex()) LOG_ERROR("FDR: cannot write session index");
+      LOG_WARN("FDR: armed session %u cut off by a reset, arming again",
+               (unsigned)record.session_id);
+    } else {
+      // An armed session's pre-trigger window was recorded before its trigger
+      const uint32_t recorded_ms = entry->duration_ms > config.pretrigger_ms
+                                     ? entry->duration_ms - config.pretrigger_ms : 0;
+      const uint64_t total_ms = (uint64_t)config.duration_s * 1000;
+      if (recorded_ms + RESUME_MIN_REMAINING_MS >= total_ms) {
+        LOG_INFO("FDR: session %u cut off by a reset near its end, not resumed",
+                 (unsigned)record.session_id);
+        clearResumeRecord();
+        return;
+      }
+      flight = config.pretrigger_ms > 0;
+      config.duration_s = (uint32_t)((total_ms - recorded_ms + 999) / 1000);
+      config.pretrigger_ms = 0;
+      config.burst_ms = 0;
+      LOG_WARN("FDR: session %u cut off by a reset after %u ms, resuming for %u s",
+               (unsigned)record.session_id, (unsigned)recorded_ms, (unsigned)config.duration_s);
+    }
+  }
+
+  if (!fdr_start(config)) {
+    LOG_ERROR("FDR: cannot resume session %u", (unsigned)record.session_id);
+    clearResumeRecord();
+    return;
+  }
+  if (flight) power_holdFlight(true);
+  FdrLockGuard lock;
+  resumed_from_id = record.session_id;
+  session_index[session_count - 1].flags |= FDR_SESSION_RESUMED;
+  if (!saveIndex()) LOG_ERROR("FDR: cannot write session index");
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+/**
+ * @brief Initializes the FDR module and starts its sampler and writer tasks.
+ *
+ * Mounts the storage and runs the recovery scan first, so a session cut
+ * off by a power loss is truncated to its last valid commit and closed
+ * before anything else can append to or list it. Only an unclosed session
+ * is read, which bounds the time this adds to setup(). That session is
+ * then resumed once the tasks run (see resumeInterruptedSession()).
+ * Call after barometer_init() and imu_init(): from here on the sampler
+ * task owns barometer_process().
+ */
+void fdr_init() {
+  fdr_lock = xSemaphoreCreateMutex();
+  if (!ensureStorage()) LOG_ERROR("FDR: storage not available, will retry on start");
+
+  esp_timer_create_args_t timer_args = {};
+  timer_args.callback = onSampleTimer;
+  timer_args.dispatch_method = ESP_TIMER_TASK;
+  timer_args.name = "fdr_sample";
+  esp_timer_create(&timer_args, &sample_timer);
+  timer_args.callback = onLiveTimer;
+  timer_args.name = "fdr_live";
+  esp_timer_create(&timer_args, &live_timer);
+
+  xTaskCreate(writerTask, "fdr_writer", WRITER_TASK_STACK, nullptr,
+              WRITER_TASK_PRIORITY, &writer_task);
+  xTaskCreate(samplerTask, "fdr_sampler", SAMPLER_TASK_STACK, nullptr,
+              SAMPLER_TASK_PRIORITY, &sampler_task);
+  LOG_INFO("FDR: initialized (sampler task running)");
+  if (storage_mounted) resumeInterruptedSession();
+}
+
+/**
+ * @brief Bytes per 1000 s the sample channels of a session take at a
+ * barometer and an IMU rate, every record at its absolute size.
+ */
+static uint64_t channelBytesPerKs(const FdrSessionConfig &config, uint32_t rate_mhz,
+                                  uint16_t imu_rate_hz) {
+  return (uint64_t)rate_mhz * sizeof(FdrBaroRecord) *
+           (1 + (config.record_raw ? 1 : 0) + (config.record_altitude ? 1 : 0)) +
+         (uint64_t)imu_rate_hz * 1000ULL * sizeof(FdrImuRecord);
+}
+
+/**
+ * @brief Longest window (ms) the burst buffer holds at a barometer and an
+ * IMU rate, with every channel of a session.
+ */
+static uint32_t ramWindowFitMs(const FdrSessionConfig &config, uint32_t rate_mhz,
+                               uint16_t imu_rate_hz) {
+  return (uint32_t)((uint64_t)BURST_BUFFER_BYTES * 1000000ULL /
+                    channelBytesPerKs(config, rate_mhz, imu_rate_hz));
+}
+
+/**
+ * @brief Upper bound of the storage a session takes: its records at their
+ * absolute size (the delta encoding never stores more), a sync point per
+ * FDR_SYNC_INTERVAL_BYTES and a commit record per COMMIT_INTERVAL_MS, plus
+ * the header, the flight events and a full time index.
+ *
+ * @param window_ms Time recorded: the duration plus the pre-trigger window.
+ * @param burst_ms Part of it recorded at `burst_rate_mhz`.
+ */
+static uint64_t sessionBytesEstimate(const FdrSessionConfig &config, uint32_t rate_mhz,
+                                     uint16_t imu_rate_hz, uint64_t window_ms,
+                                     uint32_t burst_ms, uint32_t burst_rate_mhz) {
+  const uint64_t data = (channelBytesPerKs(config, rate_mhz, imu_rate_hz) * (window_ms - burst_ms) +
+                         channelBytesPerKs(config, burst_rate_mhz, imu_rate_hz) * burst_ms) /
+                        1000000ULL;
+  return sizeof(FdrFileHeader) + data + data / FDR_SYNC_INTERVAL_BYTES * sizeof(FdrSyncRecord) +
+         (window_ms / COMMIT_INTERVAL_MS + 1) * sizeof(FdrCommitRecord) +
+         PLAN_FLIGHT_EVENTS * sizeof(FdrEventRecord) +
+         FDR_TIME_INDEX_MAX_ENTRIES * sizeof(FdrTimeIndexRecord);
+}
+
+/**
+ * @brief Admission control of a session being set up, once its channels,
+ * IMU rate and windows are settled: fills `plan` and, when the session does
+ * not fit, lowers the barometer and IMU rates in proportion with the
+ * Decimate policy (the IMU channel is dropped below IMU_MIN_RATE_HZ). The
+ * burst window keeps its rate. Nothing is applied, so a session still
+ * running is left as it is. Caller holds `fdr_lock`.
+ *
+ * @param rate_mhz Barometer rate, lowered to fit.
+ * @param imu_rate_hz IMU rate, lowered to one the sensor supports, or 0.
+ * @param need_bytes Set to the free space the session needs.
+ * @return false if the session is rejected.
+ */
+static bool planStorage(const FdrSessionConfig &config, uint32_t pretrigger_ms,
+                        uint32_t &rate_mhz, uint16_t &imu_rate_hz, uint32_t burst_ms,
+                        uint32_t burst_rate_mhz, FdrStoragePlan &plan, uint32_t &need_bytes) {
+  const uint64_t window_ms = (uint64_t)config.duration_s * 1000 + pretrigger_ms;
+  // Every stored session may be deleted, oldest first, to make room; the one
+  // still recording is closed first and takes what it has written so far
+  uint64_t available = storage.freeBytes();
+  for (size_t i = 0; i < session_count; i++) {
+    const bool current = fdr_active && i == session_count - 1;
+    available += current ? session_bytes : session_index[i].bytes;
+  }
+  const uint64_t budget = available > STORAGE_RESERVE_BYTES ? available - STORAGE_RESERVE_BYTES : 0;
+
+  plan = {};
+  plan.available_bytes = available < UINT32_MAX ? (uint32_t)available : UINT32_MAX;
+  plan.requested_rate_mhz = rate_mhz;
+  plan.requested_imu_rate_hz = imu_rate_hz;
+  plan.decimation = 1;
+  plan.max_decimation = 1;
+
+  uint64_t estimate =
+    sessionBytesEstimate(config, rate_mhz, imu_rate_hz, window_ms, burst_ms, burst_rate_mhz);
+  if (config.storage_policy == FdrStoragePolicy::Decimate) {
+    // The header, commit records and time index do not scale with the rates
+    const uint64_t fixed = sessionBytesEstimate(config, 0, 0, window_ms, 0, 0);
+    for (uint8_t i = 0; i < PLAN_DECIMATE_ATTEMPTS && estimate > budget && budget > fixed &&
+                        rate_mhz >= MIN_SAMPLE_RATE_MHZ; i++) {
+      const uint64_t scale_ppm = (budget - fixed) * 1000000ULL / (estimate - fixed);
+      rate_mhz = (uint32_t)(rate_mhz * scale_ppm / 1000000ULL);
+      if (imu_rate_hz > 0) {
+        const uint32_t imu_hz = (uint32_t)(imu_rate_hz * scale_ppm / 1000000ULL);
+        imu_rate_hz = imu_hz >= IMU_MIN_RATE_HZ ? imu_rateFor((uint16_t)imu_hz) : 0;
+      }
+      estimate =
+        sessionBytesEstimate(config, rate_mhz, imu_rate_hz, window_ms, burst_ms, burst_rate_mhz);
+      plan.decimated = true;
+    }
+  }
+
+  plan.session_bytes = estimate < UINT32_MAX ? (uint32_t)estimate : UINT32_MAX;
+  plan.bytes_per_s = (uint32_t)(channelBytesPerKs(config, rate_mhz, imu_rate_hz) / 1000 +
+                                sizeof(FdrCommitRecord) * 1000 / COMMIT_INTERVAL_MS);
+  if (estimate > budget || rate_mhz < MIN_SAMPLE_RATE_MHZ) {
+    plan.rejected = true;
+    LOG_WARN("FDR: session needs %u bytes, %u available, not started",
+             (unsigned)plan.session_bytes, (unsigned)plan.available_bytes);
+    return false;
+  }
+  if (plan.decimated) {
+    LOG_WARN("FDR: lowered to %u.%03u samples/sec (IMU %u) to fit %u bytes",
+             (unsigned)(rate_mhz / 1000), (unsigned)(rate_mhz % 1000),
+             (unsigned)imu_rate_hz, (unsigned)plan.session_bytes);
+  }
+  const uint64_t need = estimate + STORAGE_RESERVE_BYTES;
+  need_bytes = need < UINT32_MAX ? (uint32_t)need : UINT32_MAX;
+  return true;
+}
+
+/**
+ * @brief Starts the FDR recording session.
+ *
+ * The IMU channel is only recorded if the sensor is detected at this point.
+ * Barometer samples go through the requested filter chain. The burst
+ * window, if any, is clamped to the session duration and to what fits in
+ * the RAM burst buffer at the burst and IMU rates. An armed session's
+ * pre-trigger window is clamped to what the same buffer holds at the
+ * session rates; it needs at least one trigger condition. Last, the storage
+ * plan admits the session, lowers its rates to fit or rejects it (see
+ * planStorage()). All of this is settled before anything is applied: a
+ * session that is already running is only closed once the new one is
+ * admitted, and keeps recording otherwise.
+ *
+ * @param config Requested session parameters; see fdr_getSessionInfo() for
+ *               the effective values after clamping.
+ *
+ * @return true if recording successfully started.
+ */
+bool fdr_start(const FdrSessionConfig &config) {
+  FdrLockGuard lock;
+  if (!ensureStorage()) return false;
+
+  uint32_t rate_mhz = clampRateMhz(config.samples_per_sec, DEFAULT_SAMPLE_RATE_MHZ,
+                                   MIN_SAMPLE_RATE_MHZ, MAX_SAMPLES_PER_SEC * 1000);
+  if (config.samples_per_sec > (float)MAX_SAMPLES_PER_SEC) {
+    LOG_WARN("FDR: requested %.3f samples/sec too high, capping to %u",
+             config.samples_per_sec, (unsigned)MAX_SAMPLES_PER_SEC);
+  }
+
+  uint16_t imu_rate_hz = 0;
+  if (config.imu_rate_hz > 0) {
+    if (imu_isReady()) {
+      imu_rate_hz = imu_rateFor(config.imu_rate_hz);
+    } else {
+      LOG_WARN("FDR: IMU not ready, recording barometer only");
+    }
+  }
+
+  FdrTriggerConfig trigger = config.trigger;
+  uint32_t pretrigger_ms = 0;
+  uint64_t accel_lsb_sq = 0;
+  if (config.pretrigger_ms > 0) {
+    if (trigger.accel_mg > 0 && imu_rate_hz == 0) {
+      LOG_WARN("FDR: IMU not recorded, acceleration trigger disabled");
+      trigger.accel_mg = 0;
+    }
+    if (trigger.pressure_drop_pa_s == 0 && trigger.accel_mg == 0 && !trigger.launch) {
+      LOG_WARN("FDR: armed session without a trigger condition");
+      return false;
+    }
+    const uint64_t accel_lsb = (uint64_t)trigger.accel_mg * IMU_ACCEL_LSB_PER_G / 1000;
+    accel_lsb_sq = accel_lsb * accel_lsb;
+    pretrigger_ms = config.pretrigger_ms;
+    const uint32_t fit_ms = ramWindowFitMs(config, rate_mhz, imu_rate_hz);
+    if (pretrigger_ms > fit_ms) pretrigger_ms = fit_ms;
+    if (pretrigger_ms == 0) pretrigger_ms = 1;
+  }
+
+  uint32_t burst_ms = 0;
+  uint32_t burst_rate_mhz = rate_mhz;
+  if (config.burst_ms > 0 && pretrigger_ms > 0) {
+    LOG_WARN("FDR: armed session, burst window ignored");
+  } else if (config.burst_ms > 0) {
+    const float burst_rate = config.burst_samples_per_sec > 0.0f
+                               ? config.burst_samples_per_sec : DEFAULT_BURST_SAMPLES_PER_SEC;
+    burst_rate_mhz = clampRateMhz(burst_rate, rate_mhz, rate_mhz, MAX_BURST_SAMPLES_PER_SEC * 1000);
+    const uint32_t fit_ms = ramWindowFitMs(config, burst_rate_mhz, imu_rate_hz);
+    burst_ms = config.burst_ms;
+    if (burst_ms > fit_ms) burst_ms = fit_ms;
+    if (burst_ms > config.duration_s * 1000UL) burst_ms = config.duration_s * 1000UL;
+  }
+
+  FdrStoragePlan plan;
+  uint32_t need_bytes = 0;
+  if (!planStorage(config, pretrigger_ms, rate_mhz, imu_rate_hz, burst_ms, burst_rate_mhz, plan,
+                   need_bytes)) {
+    // Reported as the last start; a session still running keeps its backpressure
+    if (fdr_active) {
+      plan.decimation = storage_plan.decimation;
+      plan.max_decimation = storage_plan.max_decimation;
+      plan.decimated_records = storage_plan.decimated_records;
+      plan.backpressure_steps = storage_plan.backpressure_steps;
+      plan.backpressure_cause = storage_plan.backpressure_cause;
+    }
+    storage_plan = plan;
+    return false;
+  }
+
+  // Admitted: only now is a running session closed and the new one applied
+  fdr_sampling = false;
+  xTaskNotifyGive(sampler_task);
+  if (fdr_active) finishSessionLocked();
+
+  storage_plan = plan;
+  fdr_period = makePeriod(rate_mhz);
+  burst_period = burst_ms > 0 ? makePeriod(burst_rate_mhz) : fdr_period;
+  fdr_filter_config = config.filter;
+  fdr_record_raw = config.record_raw;
+  fdr_record_altitude = config.record_altitude;
+  fdr_imu_rate_hz = imu_rate_hz > 0 ? imu_setRate(imu_rate_hz) : 0;
+  fdr_trigger = trigger;
+  fdr_pretrigger_ms = pretrigger_ms;
+  trigger_accel_lsb_sq = accel_lsb_sq;
+
+  if (!openFdrFileForWrite(rate_mhz, fdr_imu_rate_hz, need_bytes)) {
+    LOG_ERROR("FDR: failed to create file");
+    return false;
+  }
+  saveResumeRecord(config, session_index[session_count - 1].session_id);
+  session_free_start_bytes = storage.freeBytes();
+  storage_total_bytes = storage.totalBytes();
+  updateStorageLow();
+  resumed_from_id = 0;
+
+  // Discard anything a previous session left in the queues
+  FdrBaroRecord stale;
+  while (sample_queue.pop(stale)) {}
+  FdrImuRecord stale_imu;
+  while (imu_queue.pop(stale_imu)) {}
+  fdr_write_buffer.clear();
+  buffer_high_water = 0;
+  overflow_records = 0;
+  overflow_bytes = 0;
+  queue_high_water = 0;
+  queue_dropped = 0;
+  imu_queue_high_water = 0;
+  imu_queue_dropped = 0;
+  baro_records = 0;
+  imu_records = 0;
+  raw_bytes = 0;
+  encoded_bytes = 0;
+  burst_bytes = 0;
+  burst_count = 0;
+  burst_dropped = 0;
+  burst_done = false;
+  burst_committed = (burst_ms == 0);
+  pretrigger_head = 0;
+  pretrigger_tail = 0;
+  pretrigger_used = 0;
+  pretrigger_done = false;
+  pretrigger_committed = (fdr_pretrigger_ms == 0);
+  trigger_t_ms = 0;
+  trigger_cause = nullptr;
+  fdr_armed = fdr_pretrigger_ms > 0;
+  last_flush_ms = millis();
+  last_commit_ms = last_flush_ms;
+  decimate_baro_seen = 0;
+  decimate_imu_seen = 0;
+  decimate_keep_baro = true;
+  stream_bytes = 0;
+  backpressure_window_ms = last_flush_ms;
+  storage_stats = {};
+  flush_total_us = 0;
+  resetTimingStats();
+
+  // Forced mode needs every period, burst included, to fit a conversion
+  baro_conversion_us = barometer_getConversionUs(true);
+  const uint32_t shortest_period_us =
+    burst_ms > 0 ? burst_period.period_us : fdr_period.period_us;
+  fdr_baro_forced = config.baro_forced &&
+                    baro_conversion_us + FORCED_CONVERSION_MARGIN_US <= shortest_period_us;
+  if (config.baro_forced && !fdr_baro_forced) {
+    LOG_INFO("FDR: %u us period too short for forced conversions, barometer in normal mode",
+             (unsigned)shortest_period_us);
+  }
+
+  fdr_active = true;
+  fdr_duration_s = config.duration_s;
+  // Sample 0 is due once its forced conversion, started right away, is done
+  fdr_start_us = esp_timer_get_time() + (fdr_baro_forced ? baro_conversion_us : 0);
+  // An armed session ends `duration_s` after its trigger instead
+  fdr_end_us.store(fdr_pretrigger_ms ? INT64_MAX
+                                     : fdr_start_us + (int64_t)config.duration_s * 1000000LL,
+                   std::memory_order_relaxed);
+  burst_end_us = fdr_start_us + (int64_t)burst_ms * 1000LL;
+
+  barometer_setFastMode(true);
+  barometer_setForcedMode(fdr_baro_forced);
+  // The LED task shows the new mode; no frame goes out during a burst
+  // window. Only the burst is held: the rest of the session, triggered or
+  // not, runs at most MAX_SAMPLES_PER_SEC, and a frame (about 30 us with
+  // interrupts off) fits well within its 20 ms periods
+  led_setMode(fdr_pretrigger_ms > 0 ? LedMode::Armed : LedMode::Recording);
+  led_setHold(burst_ms > 0);
+  LOG_INFO("FDR: started for %u seconds at %u.%03u samples/sec (period %u us)",
+           (unsigned)config.duration_s, (unsigned)(rate_mhz / 1000),
+           (unsigned)(rate_mhz % 1000), (unsigned)fdr_period.period_us);
+  if (fdr_imu_rate_hz > 0) {
+    LOG_INFO("FDR: IMU channel at %u samples/sec", (unsigned)fdr_imu_rate_hz);
+  }
+  char filter[64];
+  pressureFilter_describe(fdr_filter_config, filter, sizeof(filter));
+  LOG_INFO("FDR: pressure filter %s%s", filter, fdr_record_raw ? ", raw samples recorded" : "");
+  if (fdr_pretrigger_ms > 0) {
+    LOG_INFO("FDR: armed, %u ms pre-trigger window", (unsigned)fdr_pretrigger_ms);
+  }
+  if (burst_ms > 0) {
+    LOG_INFO("FDR: burst window %u ms at %u.%03u samples/sec to RAM",
+             (unsigned)burst_ms, (unsigned)(burst_period.rate_mhz / 1000),
+             (unsigned)(burst_period.rate_mhz % 1000));
+  }
+
+  // Publish the session to the sampler last, once all state above is set
+  session_generation.fetch_add(1, std::memory_order_release);
+  fdr_sampling.store(true, std::memory_order_release);
+  xTaskNotifyGive(sampler_task);
+  return true;
+}
+
+/**
+ * @brief Starts a session without a burst window.
+ *
+ * @param duration_s Duration of recording in seconds.
+ * @param samples_per_sec Sampling rate (Hz), fractional rates allowed.
+ *                        Clamped to the supported range; 0 selects 1 Hz.
+ *
+ * @return true if recording successfully started.
+ */
+bool fdr_start(uint32_t duration_s, float samples_per_sec) {
+  FdrSessionConfig config;
+  config.duration_s = duration_s;
+  config.samples_per_sec = samples_per_sec;
+  return fdr_start(config);
+}
+
+/**
+ * @brief Stops FDR recording, flushes buffers and closes files.
+ */
+void fdr_stop() {
+  fdr_sampling = false;
+  xTaskNotifyGive(sampler_task);
+  FdrLockGuard lock;
+  if (!fdr_active) return;
+  finishSessionLocked();
+}
+
+/**
+ * @brief Stops any running session and deletes every stored session and
+ * the index.
+ */
+void fdr_reset() {
+  fdr_sampling = false;
+  xTaskNotifyGive(sampler_task);
+  FdrLockGuard lock;
+  if (fdr_active) finishSessionLocked();
+  if (!ensureStorage()) return;
+  for (size_t i = 0; i < session_count; i++) {
+    storage.remove(session_index[i].session_id);
+  }
+  LOG_INFO("FDR: data reset (%u sessions removed)", (unsigned)session_count);
+  session_count = 0;
+  if (!saveIndex()) LOG_ERROR("FDR: cannot write session index");
+}
+
+/**
+ * @brief Returns whether FDR recording is active.
+ *
+ * @return true if recording, false otherwise.
+ */
+bool fdr_isActive() {
+  return fdr_active;
+}
+
+/**
+ * @brief Sets the barometer rate between sessions while no live client is
+ * attached.
+ *
+ * @param samples_per_sec Clamped to 0.1-100 Hz; 0 selects the default 1 Hz.
+ */
+void fdr_setIdleRate(float samples_per_sec) {
+  idle_rate_mhz.store(clampRateMhz(samples_per_sec, DEFAULT_IDLE_RATE_MHZ,
+                                   MIN_IDLE_RATE_MHZ, MAX_IDLE_RATE_MHZ),
+                      std::memory_order_relaxed);
+  xTaskNotifyGive(sampler_task);
+}
+
+/**
+ * @brief Reports who the barometer is currently read for, and how often.
+ *
+ * @param info Output structure.
+ */
+void fdr_getAcquisitionInfo(FdrAcquisitionInfo &info) {
+  FdrLockGuard lock;
+  info.idle_rate_mhz = idle_rate_mhz.load(std::memory_order_relaxed);
+  if (fdr_sampling.load(std::memory_order_acquire)) {
+    info.mode = "session";
+    info.rate_mhz = fdr_period.rate_mhz;
+  } else if (live_enabled.load(std::memory_order_relaxed)) {
+    info.mode = "live";
+    info.rate_mhz = LIVE_IDLE_BARO_RATE_MHZ;
+  } else {
+    info.mode = "idle";
+    info.rate_mhz = info.idle_rate_mhz;
+  }
+}
+
+/**
+ * @brief Reports RAM buffer usage and overflow counters.
+ *
+ * Counters are reset at the start of every session.
+ *
+ * @param stats Output structure.
+ */
+void fdr_getBufferStats(FdrBufferStats &stats) {
+  FdrLockGuard lock;
+  stats.buffered_bytes = (uint32_t)fdr_write_buffer.size();
+  stats.capacity_bytes = (uint32_t)fdr_write_buffer.capacity();
+  stats.high_water_bytes = buffer_high_water;
+  stats.overflow_records = overflow_records;
+  stats.overflow_bytes = overflow_bytes;
+  stats.queue_depth = (uint32_t)sample_queue.size();
+  stats.queue_capacity = (uint32_t)sample_queue.capacity();
+  stats.queue_high_water = queue_high_water;
+  stats.queue_dropped = queue_dropped.load(std::memory_order_relaxed);
+  stats.imu_queue_depth = (uint32_t)imu_queue.size();
+  stats.imu_queue_capacity = (uint32_t)imu_queue.capacity();
+  stats.imu_queue_high_water = imu_queue_high_water;
+  stats.imu_queue_dropped = imu_queue_dropped.load(std::memory_order_relaxed);
+  stats.baro_records = baro_records;
+  stats.imu_records = imu_records;
+  stats.raw_bytes = raw_bytes;
+  stats.encoded_bytes = encoded_bytes;
+}
 
 /**
- * @brief Size threshold (bytes) at which the RAM buffer is flushed to disk.
+ * @brief Reports the effective parameters of the current or last session.
+ *
+ * @param info Output structure.
  */
-static constexpr uint32_t BUFFER_FLUSH_THRESHOLD = 1024;
+void fdr_getSessionInfo(FdrSessionInfo &info) {
+  FdrLockGuard lock;
+  info.session_id = (fdr_active && session_count) ? session_index[session_count - 1].session_id : 0;
+  info.duration_s = fdr_duration_s;
+  info.rate_mhz = fdr_period.rate_mhz;
+  info.period_us = fdr_period.period_us;
+  info.imu_rate_hz = fdr_imu_rate_hz;
+  info.filter = fdr_filter_config;
+  info.record_raw = fdr_record_raw;
+  info.record_altitude = fdr_record_altitude;
+  info.baro_forced = fdr_baro_forced;
+  info.burst_ms = (uint32_t)((burst_end_us - fdr_start_us) / 1000);
+  info.burst_rate_mhz = info.burst_ms ? burst_period.rate_mhz : 0;
+  info.burst_period_us = info.burst_ms ? burst_period.period_us : 0;
+  info.burst_capacity_bytes = BURST_BUFFER_BYTES;
+  info.burst_bytes = burst_bytes.load(std::memory_order_acquire);
+  info.burst_records = burst_count.load(std::memory_order_acquire);
+  info.burst_dropped = burst_dropped.load(std::memory_order_relaxed);
+  info.burst_committed = burst_committed;
+  info.pretrigger_ms = fdr_pretrigger_ms;
+  info.pretrigger_capacity_bytes = BURST_BUFFER_BYTES;
+  info.pretrigger_bytes = pretrigger_used.load(std::memory_order_relaxed);
+  info.trigger = fdr_trigger;
+  info.armed = fdr_active && fdr_armed.load(std::memory_order_acquire);
+  info.triggered = pretrigger_done.load(std::memory_order_acquire);
+  info.trigger_t_ms = trigger_t_ms.load(std::memory_order_relaxed);
+  info.trigger_cause = info.triggered ? trigger_cause : nullptr;
+  info.resumed_from = fdr_active ? resumed_from_id : 0;
+}
 
 /**
- * @brief Time interval (ms) after which a flush is forced even if buffer is small.
+ * @brief Reports the scheduling statistics of the current or last session.
+ *
+ * @param stats Output structure.
  */
-static constexpr uint32_t BUFFER_FLUSH_INTERVAL_MS = 250;
-
-// ============================================================================
-// Module State
-// ============================================================================
+void fdr_getTimingStats(FdrTimingStats &stats) {
+  portENTER_CRITICAL(&stats_mux);
+  stats = timing_stats;
+  stats.jitter_avg_us = timing_stats.samples ? (uint32_t)(jitter_sum_us / timing_stats.samples) : 0;
+  if (timing_stats.samples == 0) stats.jitter_min_us = 0;
+  portEXIT_CRITICAL(&stats_mux);
+}
 
 /**
- * @brief True while FDR is actively recording.
+ * @brief Reports the storage backend usage and write latency.
+ *
+ * @param stats Output structure.
  */
-static bool fdr_active = false;
+void fdr_getStorageStats(FdrStorageStats &stats) {
+  FdrLockGuard lock;
+  stats = storage_stats;
+  stats.backend = storage.name();
+  stats.flush_avg_us = storage_stats.flushes ? (uint32_t)(flush_total_us / storage_stats.flushes) : 0;
+  stats.total_bytes = storage_mounted ? storage.totalBytes() : 0;
+  stats.free_bytes = storage_mounted ? storage.freeBytes() : 0;
+  FdrEraseStats erase;
+  storage.getEraseStats(erase);
+  stats.erases = erase.erases;
+  stats.erase_max_us = erase.max_us;
+  stats.erase_stalls = erase.stalls;
+}
 
 /**
- * @brief Time (millis) when FDR recording ends.
+ * @brief Reports the storage plan of the current or last fdr_start() and
+ * the backpressure of its session.
+ *
+ * @param plan Output structure.
  */
-static uint32_t fdr_end_ms = 0;
+void fdr_getStoragePlan(FdrStoragePlan &plan) {
+  FdrLockGuard lock;
+  plan = storage_plan;
+}
 
 /**
- * @brief Time (millis) when FDR recording started.
+ * @brief Lists the stored sessions from the RAM copy of the index.
+ *
+ * No data file is opened. The entry of a session being recorded reflects
+ * the records written so far.
+ *
+ * @param out Destination array.
+ * @param max Capacity of `out`.
+ * @return Number of entries stored in `out`, oldest first.
  */
-static uint32_t fdr_start_ms = 0;
+size_t fdr_listSessions(FdrSessionSummary* out, size_t max) {
+  FdrLockGuard lock;
+  if (!ensureStorage()) return 0;
+  if (fdr_active) updateCurrentEntry(true);
+
+  const size_t count = session_count < max ? session_count : max;
+  for (size_t i = 0; i < count; i++) {
+    const FdrIndexEntry &entry = session_index[i];
+    FdrSessionSummary &summary = out[i];
+    summary.id = entry.session_id;
+    summary.start_uptime_ms = entry.start_uptime_ms;
+    summary.rate_mhz = entry.rate_mhz;
+    summary.imu_rate_hz = entry.imu_rate_hz;
+    summary.open = (entry.flags & FDR_SESSION_OPEN) != 0;
+    summary.recovered = (entry.flags & FDR_SESSION_RECOVERED) != 0;
+    summary.resumed = (entry.flags & FDR_SESSION_RESUMED) != 0;
+    summary.duration_ms = entry.duration_ms;
+    summary.baro_records = entry.baro_records;
+    summary.imu_records = entry.imu_records;
+    summary.bytes = entry.bytes;
+    const bool has_pressure = entry.baro_records > 0;
+    summary.pressure_min_hpa = has_pressure ? entry.pressure_min_q8 / 25600.0f : NAN;
+    summary.pressure_max_hpa = has_pressure ? entry.pressure_max_q8 / 25600.0f : NAN;
+  }
+  return count;
+}
 
 /**
- * @brief Timestamp (millis) of last recorded sample.
+ * @brief DownloadCursor::type of a raw download: the session bytes as
+ * stored, header included, with no conversion.
  */
-static uint32_t last_sample_ms = 0;
+static constexpr uint8_t EXPORT_BINARY = 0;
 
 /**
- * @brief Interval between samples in milliseconds (can be changed at fdr_start()).
+ * @brief A known position in the CSV export of a session: `bin_offset` is
+ * a record boundary in the session data and `csv_offset` the number of CSV
+ * bytes produced before it.
+ *
+ * The cursor of the last download is kept so that resuming it with a Range
+ * request converts only the missing part. It also caches the total CSV
+ * length once a conversion has reached the end. Only the HTTP server task
+ * touches it.
  */
-static uint32_t fdr_sample_interval_ms = DEFAULT_SAMPLE_INTERVAL_MS;
+struct DownloadCursor {
+  uint32_t session_id;
+  uint32_t end;        ///< Valid length of the session data
+  uint8_t type;        ///< Exported record type, or EXPORT_BINARY
+  uint32_t bin_offset;
+  uint32_t csv_offset;
+  uint32_t csv_length; ///< Total CSV length, 0 if not known yet
+  FdrCodecState codec; ///< Decoder state at bin_offset
+};
+static DownloadCursor download_cursor = {};
 
 /**
- * @brief True if SPIFFS has already been mounted.
+ * @brief Output of a CSV conversion. Drops the first `skip` bytes and sends
+ * up to `limit` bytes after them to connection `fd`, or only counts when
+ * `fd` is negative. Stops once `budget` more bytes have been produced.
  */
-static bool spiffs_mounted = false;
+struct CsvOutput {
+  httpd_handle_t server;
+  int fd;
+  bool chunked;      ///< Frame the data with chunked transfer encoding
+  uint32_t skip;
+  uint32_t limit;
+  uint32_t produced; ///< CSV offset reached, skipped bytes included
+  uint32_t budget;
+  bool failed;       ///< The connection broke
+
+  /**
+   * @return false once the requested range is complete, the budget is used
+   *         up or the client left.
+   */
+  bool write(const char* data, size_t len) {
+    produced += (uint32_t)len;
+    budget = len < budget ? budget - (uint32_t)len : 0;
+    if (skip >= len) {
+      skip -= (uint32_t)len;
+      return budget > 0;
+    }
+    data += skip;
+    len -= skip;
+    skip = 0;
+    if (fd < 0) return budget > 0;
+    if (len > limit) len = limit;
+    if (!send(data, len)) {
+      failed = true;
+      return false;
+    }
+    limit -= (uint32_t)len;
+    return limit > 0 && budget > 0;
+  }
+
+  bool send(const char* data, size_t len) {
+    if (!chunked) return http_sendRaw(server, fd, data, len);
+    char size[12];
+    snprintf(size, sizeof(size), "%x\r\n", (unsigned)len);
+    return http_sendRaw(server, fd, size) && http_sendRaw(server, fd, data, len) &&
+           http_sendRaw(server, fd, "\r\n", 2);
+  }
+};
 
 /**
- * @brief Open file handle used during active recording.
+ * @brief Converts one channel of a session to CSV from a known position.
+ *
+ * Flash is read in CSV_READ_CHUNK blocks with the FDR lock held only for
+ * the read itself, and output is handed over in batches of at most
+ * CSV_OUTPUT_BUFFER bytes. After every batch `cursor`, if given, is moved
+ * to the position reached, so a conversion stopped by `out` can be resumed
+ * from there. Records of the exported channel are decoded on the way; the
+ * others are only skipped, except for sync points, which reset the decoder.
+ *
+ * @param from Start position; csv_offset 0 includes the CSV header line.
+ * @param end Session data length to stop at.
+ * @param out Destination; out.produced must equal from.csv_offset.
+ * @return true if the end of the session data was reached, which makes
+ *         out.produced the total CSV length.
  */
-static File fdr_file;
+static bool convertToCsv(const FdrFileHeader &header, const DownloadCursor &from, uint32_t end,
+                         CsvOutput &out, DownloadCursor* cursor) {
+  if (from.csv_offset == 0) {
+    const char* line = from.type == FDR_REC_IMU     ? FDR_IMU_CSV_HEADER
+                       : from.type == FDR_REC_ALT   ? FDR_ALT_CSV_HEADER
+                       : from.type == FDR_REC_EVENT ? FDR_EVENT_CSV_HEADER
+                                                    : FDR_CSV_HEADER;
+    const bool more = out.write(line, strlen(line));
+    if (cursor != nullptr) cursor->csv_offset = out.produced;
+    if (!more) return false;
+  }
+
+  // A record can straddle two reads; the partial tail is carried over
+  uint8_t raw[CSV_READ_CHUNK + FDR_MAX_RECORD_SIZE];
+  size_t have = 0;
+  uint32_t base = from.bin_offset; // session offset of raw[0]
+  FdrCodecState codec = from.codec;
+  uint8_t decoded[FDR_MAX_RECORD_SIZE];
+  char csv[CSV_OUTPUT_BUFFER];
+  size_t len = 0;
+  for (;;) {
+    // Hold the lock only while touching flash, never while sending
+    size_t got;
+    {
+      FdrLockGuard lock;
+      const uint32_t offset = base + (uint32_t)have;
+      const size_t want = end - offset < CSV_READ_CHUNK ? end - offset : CSV_READ_CHUNK;
+      got = offset < end ? storage.read(from.session_id, offset, raw + have, want) : 0;
+    }
+    if (got == 0) break;
+    have += got;
+
+    size_t pos = 0;
+    while (pos < have) {
+      const size_t rec_len = fdr_recordLength(raw + pos, have - pos);
+      if (rec_len == 0) {
+        LOG_ERROR("FDR: unknown record type, download truncated");
+        end = base + (uint32_t)pos;
+        break;
+      }
+      if (have - pos < rec_len) break;
+      if (fdr_recordChannel(raw[pos]) == from.type) {
+        if (len + CSV_MAX_ROW_LEN > sizeof(csv)) {
+          const bool more = out.write(csv, len);
+          len = 0;
+          if (cursor != nullptr) {
+            cursor->bin_offset = base + (uint32_t)pos;
+            cursor->csv_offset = out.produced;
+            cursor->codec = codec;
+          }
+          if (!more) return false;
+        }
+        if (fdr_decodeRecord(codec, raw + pos, rec_len, decoded) == 0) {
+          LOG_ERROR("FDR: undecodable record, download truncated");
+          end = base + (uint32_t)pos;
+          break;
+        }
+        if (from.type == FDR_REC_IMU) {
+          FdrImuRecord rec;
+          memcpy(&rec, decoded, sizeof(rec));
+          len += formatImuCsvRow(rec, header, csv + len);
+        } else if (from.type == FDR_REC_ALT) {
+          FdrAltRecord rec;
+          memcpy(&rec, decoded, sizeof(rec));
+          len += formatAltCsvRow(rec, csv + len);
+        } else if (from.type == FDR_REC_EVENT) {
+          FdrEventRecord rec;
+          memcpy(&rec, decoded, sizeof(rec));
+          len += formatEventCsvRow(rec, csv + len);
+        } else {
+          FdrBaroRecord rec;
+          memcpy(&rec, decoded, sizeof(rec));
+          len += formatCsvRow(rec, csv + len);
+        }
+      } else if (raw[pos] == FDR_REC_SYNC) {
+        fdr_codecReset(codec);
+      }
+      pos += rec_len;
+    }
+    memmove(raw, raw + pos, have - pos);
+    have -= pos;
+    base += (uint32_t)pos;
+    if (base >= end) break;
+  }
+  // Everything has been produced once this batch is handed over, even if
+  // `out` stops here; a failed send shows in out.failed
+  if (len > 0) out.write(csv, len);
+  if (cursor != nullptr) {
+    cursor->bin_offset = base;
+    cursor->csv_offset = out.produced;
+    cursor->codec = codec;
+  }
+  return true;
+}
 
 /**
- * @brief In-RAM buffer for CSV lines waiting to be flushed to disk.
+ * @brief Copies the stored bytes of a session from a known position, the
+ * raw counterpart of convertToCsv(). Offsets in the output are session
+ * offsets, so csv_offset follows bin_offset.
+ *
+ * @return true if `end` was reached.
  */
-static String fdr_write_buffer;
+static bool copyBinary(const DownloadCursor &from, uint32_t end, CsvOutput &out,
+                       DownloadCursor &cursor) {
+  uint8_t raw[CSV_READ_CHUNK];
+  uint32_t offset = from.bin_offset;
+  bool more = true;
+  while (more && offset < end) {
+    size_t got;
+    {
+      FdrLockGuard lock;
+      const size_t want = end - offset < CSV_READ_CHUNK ? end - offset : CSV_READ_CHUNK;
+      got = storage.read(from.session_id, offset, raw, want);
+    }
+    if (got == 0) break;
+    more = out.write((const char*)raw, got);
+    offset += (uint32_t)got;
+  }
+  cursor.bin_offset = offset;
+  cursor.csv_offset = offset;
+  return more || offset >= end;
+}
 
 /**
- * @brief Timestamp (millis) of last buffer flush.
+ * @brief Parses a single-range "bytes=" Range header.
+ *
+ * @param value Header value.
+ * @param total Length of the full CSV.
+ * @param first Output, first byte of the range.
+ * @param last Output, last byte of the range (inclusive).
+ * @return 1 for a satisfiable range, -1 for an unsatisfiable one, 0 for a
+ *         header that should be ignored (absent, malformed or multi-range).
  */
-static uint32_t last_flush_ms = 0;
+static int parseRange(const char* value, uint32_t total, uint32_t &first, uint32_t &last) {
+  const char* p = value;
+  if (strncmp(p, "bytes=", 6) != 0 || strchr(p, ',') != nullptr) return 0;
+  p += 6;
+  const char* dash = strchr(p, '-');
+  if (dash == nullptr) return 0;
 
-// ============================================================================
-// Helpers (small, focused functions to improve readability)
-// ============================================================================
+  char* parse_end;
+  if (dash == p) {
+    // Suffix range: the last N bytes
+    const unsigned long n = strtoul(dash + 1, &parse_end, 10);
+    if (parse_end == dash + 1 || *parse_end != '\0') return 0;
+    if (n == 0 || total == 0) return -1;
+    first = n < total ? total - (uint32_t)n : 0;
+    last = total - 1;
+    return 1;
+  }
+  first = (uint32_t)strtoul(p, &parse_end, 10);
+  if (parse_end != dash) return 0;
+  last = total ? total - 1 : 0;
+  if (dash[1] != '\0') {
+    const unsigned long l = strtoul(dash + 1, &parse_end, 10);
+    if (*parse_end != '\0' || l < first) return 0;
+    if (l < last) last = (uint32_t)l;
+  }
+  return first < total ? 1 : -1;
+}
+
+/**
+ * @brief Answers a request handled here with a JSON error body.
+ */
+static void sendError(httpd_req_t* req, const char* status, const char* body) {
+  httpd_resp_set_status(req, status);
+  httpd_resp_set_type(req, "application/json");
+  httpd_resp_sendstr(req, body);
+}
 
 /**
- * @brief Attempts to mount SPIFFS lazily. Formats if mount fails.
+ * @brief One download in progress, on a connection taken over from the
+ * HTTP server once its handler returned. It is converted and sent in steps
+ * of DOWNLOAD_STEP_BYTES queued on the server task, which serves its other
+ * connections in between. Only the server task touches these.
  *
- * @return true if SPIFFS is mounted successfully, false otherwise.
+ * A slot is released once the transfer has stopped (`running` cleared) and
+ * the server has closed the connection (`connected` cleared by
+ * downloadClosed()), so a step never writes to a reused socket.
  */
-static bool ensureSpiffs() {
-  if (spiffs_mounted) return true;
-  if (SPIFFS.begin(false)) {
-    spiffs_mounted = true;
-    Serial.println("FDR: SPIFFS mounted successfully");
-    return true;
-  }
-  // last-resort: format and mount
-  Serial.println("FDR: SPIFFS mount failed, attempting format...");
-  spiffs_mounted = SPIFFS.begin(true);
-  if (spiffs_mounted) {
-    Serial.println("FDR: SPIFFS formatted and mounted");
-  } else {
-    Serial.println("FDR: SPIFFS format/mount failed -- check partition table");
+struct DownloadTransfer {
+  bool in_use;
+  bool running;
+  bool connected;
+  bool answered;         ///< Response header sent
+  bool counting;         ///< Counting the CSV length a Range request needs first
+  bool resumable;        ///< Closed session: ETag, Range and the shared cursor
+  httpd_handle_t server;
+  int fd;
+  FdrFileHeader header;
+  DownloadCursor pos;    ///< Next position to convert
+  DownloadCursor count;  ///< Position of the length count
+  uint32_t csv_length;   ///< Total CSV length, 0 if not known
+  CsvOutput out;
+  char range[48];        ///< Range header to apply, "" for the whole file
+};
+static DownloadTransfer downloads[FDR_MAX_DOWNLOADS];
+
+/**
+ * @return true if `cursor` belongs to the same export as `pos`.
+ */
+static bool sameExport(const DownloadCursor &cursor, const DownloadCursor &pos) {
+  return cursor.session_id == pos.session_id && cursor.end == pos.end && cursor.type == pos.type;
+}
+
+/**
+ * @brief Formats the ETag of an export: session, length and channel.
+ */
+static void formatEtag(const DownloadCursor &pos, char* out, size_t len) {
+  const char* kind = pos.type == EXPORT_BINARY      ? "bin"
+                     : pos.type == FDR_REC_IMU      ? "imu"
+                     : pos.type == FDR_REC_BARO_RAW ? "baro_raw"
+                     : pos.type == FDR_REC_ALT      ? "alt"
+                     : pos.type == FDR_REC_EVENT    ? "events"
+                                                    : "baro";
+  snprintf(out, len, "\"%u-%u-%s\"", (unsigned)pos.session_id, (unsigned)pos.end, kind);
+}
+
+/**
+ * @brief Frees a transfer slot once it is neither sending nor connected.
+ */
+static void downloadRelease(DownloadTransfer &t) {
+  if (t.running || t.connected) return;
+  t.in_use = false;
+  for (const DownloadTransfer &other : downloads) {
+    if (other.in_use) return;
   }
-  return spiffs_mounted;
+  FdrLockGuard lock;
+  storage.endRead();
 }
 
 /**
- * @brief Opens the FDR file for writing and writes the CSV header.
- *
- * @return true on success, false on failure.
+ * @brief Session context destructor: the server closed the connection.
  */
-static bool openFdrFileForWrite() {
-  if (fdr_file) fdr_file.close();
-  if (SPIFFS.exists(FDR_PATH)) SPIFFS.remove(FDR_PATH);
-  fdr_file = SPIFFS.open(FDR_PATH, FILE_WRITE);
-  if (!fdr_file) return false;
-  fdr_file.println("timestamp_s,pressure_hpa");
-  fdr_file.flush();
-  return true;
+static void downloadClosed(void* ctx) {
+  DownloadTransfer &t = *static_cast<DownloadTransfer*>(ctx);
+  t.connected = false;
+  downloadRelease(t);
 }
 
 /**
- * @brief Opens the FDR file for appending. No header written.
+ * @brief Ends a transfer and has the server close its connection.
+ */
+static void downloadStop(DownloadTransfer &t) {
+  t.running = false;
+  if (t.connected && httpd_sess_trigger_close(t.server, t.fd) != ESP_OK) t.connected = false;
+  downloadRelease(t);
+}
+
+/**
+ * @brief Writes the response header of a transfer.
  *
- * @return true on success.
+ * @param length Content length, or UINT32_MAX to send the body chunked.
+ * @param content_range Content-Range value, or nullptr.
  */
-static bool openFdrFileForAppend() {
-  if (!fdr_file) {
-    fdr_file = SPIFFS.open(FDR_PATH, FILE_APPEND);
+static bool downloadSendHeader(DownloadTransfer &t, const char* status, uint32_t length,
+                               const char* content_range) {
+  char head[384];
+  const bool binary = t.pos.type == EXPORT_BINARY;
+  size_t len = snprintf(head, sizeof(head),
+                        "HTTP/1.1 %s\r\nContent-Type: %s\r\n"
+                        "Content-Disposition: attachment; filename=fdrecord_%u%s.%s\r\n",
+                        status, binary ? "application/octet-stream" : "text/csv",
+                        (unsigned)t.pos.session_id,
+                        t.pos.type == FDR_REC_IMU        ? "_imu"
+                        : t.pos.type == FDR_REC_BARO_RAW ? "_raw"
+                        : t.pos.type == FDR_REC_ALT      ? "_alt"
+                        : t.pos.type == FDR_REC_EVENT    ? "_events"
+                                                         : "",
+                        binary ? "bin" : "csv");
+  if (t.resumable) {
+    char etag[40];
+    formatEtag(t.pos, etag, sizeof(etag));
+    len += snprintf(head + len, sizeof(head) - len, "ETag: %s\r\nAccept-Ranges: bytes\r\n", etag);
+  }
+  if (content_range != nullptr) {
+    len += snprintf(head + len, sizeof(head) - len, "Content-Range: %s\r\n", content_range);
+  }
+  if (length == UINT32_MAX) {
+    len += snprintf(head + len, sizeof(head) - len, "Transfer-Encoding: chunked\r\n");
+  } else {
+    len += snprintf(head + len, sizeof(head) - len, "Content-Length: %u\r\n", (unsigned)length);
   }
-  return (bool)fdr_file;
+  len += snprintf(head + len, sizeof(head) - len, "Connection: close\r\n\r\n");
+  t.out.chunked = length == UINT32_MAX;
+  return http_sendRaw(t.server, t.fd, head, len);
 }
 
 /**
- * @brief Flushes the RAM buffer to the FDR file.
+ * @brief Answers the request of a transfer, now that the CSV length its
+ * Range header needs is known, and positions it at the first byte to send.
  *
- * If the file is not open, attempts to reopen it.
- * If only part of the buffer is written, the unwritten tail remains.
+ * @return false if there is nothing more to send.
  */
-static void flushBufferToFile() {
-  if (fdr_write_buffer.length() == 0) return;
-  if (!fdr_file) {
-    if (!ensureSpiffs()) {
-      Serial.println("FDR: SPIFFS lost, cannot flush buffer");
-      return;
-    }
-    if (!openFdrFileForAppend()) {
-      Serial.println("FDR: cannot open file to flush buffer");
-      return;
-    }
+static bool downloadAnswer(DownloadTransfer &t) {
+  uint32_t first = 0;
+  uint32_t last = 0;
+  const int range = t.range[0] ? parseRange(t.range, t.csv_length, first, last) : 0;
+  char value[48];
+  if (range < 0) {
+    static const char body[] = R"({"error":"range not satisfiable"})";
+    char head[192];
+    const int len = snprintf(head, sizeof(head),
+                             "HTTP/1.1 416 Range Not Satisfiable\r\n"
+                             "Content-Type: application/json\r\nContent-Range: bytes */%u\r\n"
+                             "Content-Length: %u\r\nConnection: close\r\n\r\n%s",
+                             (unsigned)t.csv_length, (unsigned)(sizeof(body) - 1), body);
+    http_sendRaw(t.server, t.fd, head, (size_t)len);
+    return false;
   }
-
-  size_t wrote = fdr_file.write((const uint8_t*)fdr_write_buffer.c_str(), fdr_write_buffer.length());
-  fdr_file.flush();
-
-  if (wrote == (size_t)fdr_write_buffer.length()) {
-    fdr_write_buffer = "";
-  } else if (wrote > 0 && wrote < (size_t)fdr_write_buffer.length()) {
-    // remove the written prefix
-    fdr_write_buffer = fdr_write_buffer.substring(wrote);
+  if (range > 0) {
+    snprintf(value, sizeof(value), "bytes %u-%u/%u", (unsigned)first, (unsigned)last,
+             (unsigned)t.csv_length);
+    if (!downloadSendHeader(t, "206 Partial Content", last - first + 1, value)) return false;
+    const DownloadCursor &cursor = download_cursor;
+    if (t.pos.type == EXPORT_BINARY) {
+      // Raw bytes: the range maps straight to the session data
+      t.pos.bin_offset = first;
+      t.pos.csv_offset = first;
+    } else if (sameExport(cursor, t.pos) && first >= cursor.csv_offset) {
+      // Resume from where the last download stopped when that is not past `first`
+      t.pos.bin_offset = cursor.bin_offset;
+      t.pos.csv_offset = cursor.csv_offset;
+      t.pos.codec = cursor.codec;
+    }
+    t.out.skip = first - t.pos.csv_offset;
+    t.out.limit = last - first + 1;
+    t.out.produced = t.pos.csv_offset;
+    return true;
   }
-  last_flush_ms = millis();
+  return downloadSendHeader(t, "200 OK", t.csv_length ? t.csv_length : UINT32_MAX, nullptr);
 }
 
 /**
- * @brief Closes the FDR file if open.
+ * @brief Keeps the furthest position reached in an export of a closed
+ * session, and its total length once known.
  */
-static void closeFdrFileIfOpen() {
-  if (fdr_file) {
-    fdr_file.close();
+static void rememberCursor(const DownloadCursor &pos, uint32_t csv_length) {
+  DownloadCursor &cursor = download_cursor;
+  if (!sameExport(cursor, pos)) {
+    cursor = pos;
+    cursor.csv_length = 0;
+  } else if (pos.csv_offset > cursor.csv_offset) {
+    cursor.bin_offset = pos.bin_offset;
+    cursor.csv_offset = pos.csv_offset;
+    cursor.codec = pos.codec;
   }
+  if (csv_length) cursor.csv_length = csv_length;
 }
 
-// ============================================================================
-// Public API
-// ============================================================================
-
 /**
- * @brief Initializes the FDR module.
- *
- * Does NOT mount SPIFFS immediately to avoid blocking setup().
+ * @brief One step of a transfer: counts, answers or sends up to
+ * DOWNLOAD_STEP_BYTES, then queues the next step. Server task context.
  */
-void fdr_init() {
-  Serial.println("FDR: initialized (SPIFFS mount deferred)");
+static void downloadStep(void* arg) {
+  PERF_SCOPE(FdrDownloadStep);
+  DownloadTransfer &t = *static_cast<DownloadTransfer*>(arg);
+  if (!t.connected) {
+    t.running = false;
+    downloadRelease(t);
+    return;
+  }
+
+  bool more = true;
+  if (t.counting) {
+    // Fresh copy of the start: the count must not move the shared cursor
+    CsvOutput counter = {nullptr, -1, false, 0, 0, t.count.csv_offset, DOWNLOAD_STEP_BYTES, false};
+    const DownloadCursor from = t.count;
+    if (convertToCsv(t.header, from, t.pos.end, counter, &t.count)) {
+      t.counting = false;
+      t.csv_length = counter.produced;
+      if (sameExport(download_cursor, t.pos)) download_cursor.csv_length = t.csv_length;
+    }
+  } else if (!t.answered) {
+    t.answered = true;
+    more = downloadAnswer(t);
+  } else {
+    t.out.budget = DOWNLOAD_STEP_BYTES;
+    const DownloadCursor from = t.pos;
+    bool complete;
+    if (t.pos.type == EXPORT_BINARY) {
+      complete = copyBinary(from, t.pos.end, t.out, t.pos);
+    } else {
+      complete = convertToCsv(t.header, from, t.pos.end, t.out, &t.pos);
+      if (t.resumable) rememberCursor(t.pos, complete ? t.out.produced : 0);
+    }
+    if (t.out.failed || complete || t.out.limit == 0) {
+      if (complete && t.out.chunked && !t.out.failed) http_sendRaw(t.server, t.fd, "0\r\n\r\n");
+      more = false;
+    }
+  }
+  if (!more || httpd_queue_work(t.server, downloadStep, &t) != ESP_OK) downloadStop(t);
 }
 
 /**
- * @brief Starts the FDR recording session.
+ * @brief Streams the recorded FDR log via HTTP as CSV.
  *
- * @param duration_s Duration of recording in seconds.
- * @param samples_per_sec Sampling rate (Hz). Clamped to max allowed.
+ * The tagged binary records are converted to CSV rows on the fly in small
+ * batches. The latest session is sent unless `?session=<id>` selects
+ * another one. One channel is exported per download: by default the
+ * barometer, whose output is identical to the historic CSV file, the
+ * IMU with `?channel=imu`, the unfiltered barometer samples with
+ * `?channel=baro_raw`, the altitude with `?channel=alt` or the flight
+ * events with `?channel=events`, if the session recorded them.
  *
- * @return true if recording successfully started.
+ * The handler only validates the request and takes the connection over;
+ * the transfer then runs in steps queued on the server task (downloadStep()),
+ * so up to FDR_MAX_DOWNLOADS downloads and any other request are served
+ * concurrently instead of one download holding the server.
+ *
+ * A closed session never changes, so it is served with an ETag (session,
+ * length and channel) and single `Range: bytes=` requests are answered with
+ * 206 (honouring `If-Range`). A resumed download restarts the conversion
+ * from where the previous one stopped, so it costs only the missing bytes;
+ * the total length is counted once from there when it is not known yet.
+ * The session being recorded is flushed and committed first and always
+ * sent whole, chunked.
+ *
+ * `?format=bin` sends the session as stored instead, header and delta
+ * records included, with no conversion: a fraction of the CSV size. Its
+ * length is known up front, so Range requests are served without a count,
+ * also for the session being recorded (up to what is stored at the time).
+ *
+ * @param req Request being handled.
+ * @return true if the transfer was started.
  */
-bool fdr_start(uint32_t duration_s, uint32_t samples_per_sec) {
-  if (!ensureSpiffs()) return false;
-
-  if (samples_per_sec == 0) samples_per_sec = 1;
-  if (samples_per_sec > MAX_SAMPLES_PER_SEC) {
-    Serial.printf("FDR: requested %u samples/sec too high, capping to %u\n",
-                  (unsigned)samples_per_sec, (unsigned)MAX_SAMPLES_PER_SEC);
-    samples_per_sec = MAX_SAMPLES_PER_SEC;
+bool fdr_streamFile(httpd_req_t* req) {
+  bool too_long = false;
+  char channel[12];
+  http_queryArg(req, "channel", channel, sizeof(channel), too_long);
+  const uint8_t want_type = strcmp(channel, "imu") == 0        ? FDR_REC_IMU
+                            : strcmp(channel, "baro_raw") == 0 ? FDR_REC_BARO_RAW
+                            : strcmp(channel, "alt") == 0      ? FDR_REC_ALT
+                            : strcmp(channel, "events") == 0   ? FDR_REC_EVENT
+                                                               : FDR_REC_BARO;
+  const uint16_t want_channel = want_type == FDR_REC_IMU        ? FDR_CHANNEL_IMU
+                                : want_type == FDR_REC_BARO_RAW ? FDR_CHANNEL_BARO_RAW
+                                : want_type == FDR_REC_ALT ||
+                                    want_type == FDR_REC_EVENT  ? FDR_CHANNEL_ALT
+                                                                : FDR_CHANNEL_BARO;
+  char format[8];
+  http_queryArg(req, "format", format, sizeof(format), too_long);
+  const bool binary = strcmp(format, "bin") == 0;
+  char session_arg[12];
+  const bool has_session =
+      http_queryArg(req, "session", session_arg, sizeof(session_arg), too_long) &&
+      session_arg[0] != '\0';
+  if (too_long) {
+    sendError(req, HTTPD_400, R"({"error":"parameter too long"})");
+    return false;
   }
 
-  fdr_sample_interval_ms = 1000 / samples_per_sec;
-
-  if (!openFdrFileForWrite()) {
-    Serial.println("FDR: failed to create file");
+  DownloadTransfer* t = nullptr;
+  for (DownloadTransfer &slot : downloads) {
+    if (!slot.in_use) {
+      t = &slot;
+      break;
+    }
+  }
+  if (t == nullptr) {
+    sendError(req, "503 Service Unavailable", R"({"error":"too many downloads"})");
     return false;
   }
 
-  fdr_write_buffer = "";
-  last_flush_ms = millis();
+  FdrFileHeader header;
+  uint32_t session_id;
+  bool closed = false;
+  uint32_t end = UINT32_MAX;
+  {
+    FdrLockGuard lock;
+    if (!ensureStorage()) {
+      sendError(req, HTTPD_500, R"({"error":"storage mount failed"})");
+      return false;
+    }
 
-  fdr_active = true;
-  fdr_start_ms = millis();
-  fdr_end_ms = fdr_start_ms + duration_s * 1000UL;
-  last_sample_ms = 0;
+    if (fdr_active && !burst_committed) {
+      // Reading flash would stall the RAM-only capture window
+      sendError(req, "503 Service Unavailable", R"({"error":"burst capture in progress"})");
+      return false;
+    }
 
-  barometer_setFastMode(true);
-  led_setColor(0, 255, 0); // green
-  Serial.printf("FDR: started for %u seconds at %u samples/sec (interval %u ms)\n",
-                (unsigned)duration_s, (unsigned)samples_per_sec,
-                (unsigned)fdr_sample_interval_ms);
+    if (session_count == 0) {
+      sendError(req, HTTPD_404, R"({"error":"no data"})");
+      return false;
+    }
+    const uint32_t latest_id = session_index[session_count - 1].session_id;
+    session_id = has_session ? (uint32_t)strtoul(session_arg, nullptr, 10) : latest_id;
+    const FdrIndexEntry* entry = findSession(session_id);
+    if (entry == nullptr) {
+      sendError(req, HTTPD_404, R"({"error":"unknown session"})");
+      return false;
+    }
+    // A closed session ends at its last valid commit, whatever follows it
+    closed = !(entry->flags & FDR_SESSION_OPEN);
+    if (closed) end = entry->bytes;
+
+    // If the requested session is still recording, flush what has been sampled so far
+    if (fdr_active && session_id == latest_id) syncLiveSessionLocked();
+    // A raw download of an open session takes what is stored right now
+    if (binary && !closed) end = storage.size(session_id);
+
+    if (!readFdrHeader(session_id, header)) {
+      storage.endRead();
+      sendError(req, HTTPD_500, R"({"error":"unsupported file format"})");
+      return false;
+    }
+
+    if (!binary && !(header.channels & want_channel)) {
+      storage.endRead();
+      sendError(req, HTTPD_404, R"({"error":"channel not recorded"})");
+      return false;
+    }
+  }
+
+  *t = {};
+  t->server = req->handle;
+  t->fd = httpd_req_to_sockfd(req);
+  t->header = header;
+  // Stored bytes never change below `end`, even while recording
+  t->resumable = closed || binary;
+  t->pos.session_id = session_id;
+  t->pos.end = end;
+  if (binary) {
+    t->pos.type = EXPORT_BINARY;
+    t->csv_length = end;
+  } else {
+    t->pos.type = want_type;
+    t->pos.bin_offset = header.header_size;
+  }
+  fdr_codecReset(t->pos.codec);
+  t->out = {t->server, t->fd, false, 0, UINT32_MAX, 0, 0, false};
+  if (closed || binary) {
+    char etag[40];
+    formatEtag(t->pos, etag, sizeof(etag));
+    char if_range[48];
+    const bool if_range_ok = httpd_req_get_hdr_value_len(req, "If-Range") == 0 ||
+                             (http_header(req, "If-Range", if_range, sizeof(if_range)) &&
+                              strcmp(if_range, etag) == 0);
+    if (if_range_ok) http_header(req, "Range", t->range, sizeof(t->range));
+    const bool known = !binary && sameExport(download_cursor, t->pos);
+    if (known) t->csv_length = download_cursor.csv_length;
+    if (t->range[0] != '\0' && t->csv_length == 0) {
+      // Count the total once, from the furthest known position
+      t->counting = true;
+      t->count = known ? download_cursor : t->pos;
+    }
+  }
+
+  if (httpd_queue_work(req->handle, downloadStep, t) != ESP_OK) {
+    sendError(req, "503 Service Unavailable", R"({"error":"server busy"})");
+    return false;
+  }
+  t->in_use = true;
+  t->running = true;
+  t->connected = true;
+  req->sess_ctx = t;
+  req->free_ctx = downloadClosed;
   return true;
 }
 
 /**
- * @brief Stops FDR recording, flushes buffers and closes files.
+ * @brief Channels a query can return, in the order of the `channels`
+ * names; the FDR_REC_* type and header channel bit of each.
  */
-void fdr_stop() {
-  if (!fdr_active) return;
+static constexpr size_t QUERY_CHANNELS = 5;
+static constexpr const char* QUERY_CHANNEL_NAMES[QUERY_CHANNELS] = {
+  "baro", "baro_raw", "alt", "imu", "events"};
+static constexpr uint8_t QUERY_CHANNEL_TYPES[QUERY_CHANNELS] = {
+  FDR_REC_BARO, FDR_REC_BARO_RAW, FDR_REC_ALT, FDR_REC_IMU, FDR_REC_EVENT};
+static constexpr uint16_t QUERY_CHANNEL_BITS[QUERY_CHANNELS] = {
+  FDR_CHANNEL_BARO, FDR_CHANNEL_BARO_RAW, FDR_CHANNEL_ALT, FDR_CHANNEL_IMU, FDR_CHANNEL_ALT};
+static constexpr size_t QUERY_EVENTS = 4; ///< Slot of the events, never decimated
 
-  flushBufferToFile();
-  closeFdrFileIfOpen();
+/**
+ * @brief Sync points of a queried session: the RAM index while it is
+ * being recorded, the time index at its end once closed. Sessions without
+ * one (recorded before format 7, or recovered after a reset) are decoded
+ * from the header.
+ */
+struct QueryIndex {
+  uint32_t session_id;
+  bool live;      ///< time_index[] of the current session
+  uint32_t first; ///< Session offset of the first FdrTimeIndexRecord
+  uint32_t count; ///< Entries, 0 without an index
+  uint32_t end;   ///< Data the scan reads; later sync points are ignored
+};
 
-  fdr_active = false;
-  barometer_setFastMode(false);
-  led_setBlue();
-  Serial.println("FDR: stopped (file flushed and closed)");
+/**
+ * @brief Locates the time index of a closed session: the records covered
+ * by its last commit. Caller holds `fdr_lock`.
+ *
+ * @param end Valid length of the session data.
+ * @return true if the session has one.
+ */
+static bool findTimeIndex(uint32_t id, uint32_t data_start, uint32_t end, QueryIndex &index) {
+  FdrCommitRecord commit;
+  if (end < data_start + sizeof(commit)) return false;
+  const uint32_t at = end - sizeof(commit);
+  if (storage.read(id, at, (uint8_t*)&commit, sizeof(commit)) != sizeof(commit)) return false;
+  if (commit.type != FDR_REC_COMMIT || commit.length == 0 ||
+      commit.length % sizeof(FdrTimeIndexRecord) != 0 || commit.length > at - data_start) {
+    return false;
+  }
+  index.first = at - commit.length;
+  index.count = commit.length / sizeof(FdrTimeIndexRecord);
+  // Both ends must be index records; the CRC was checked when it was written
+  uint8_t tags[2];
+  const uint32_t last = index.first + (index.count - 1) * sizeof(FdrTimeIndexRecord);
+  if (storage.read(id, index.first, &tags[0], 1) != 1 || storage.read(id, last, &tags[1], 1) != 1 ||
+      tags[0] != FDR_REC_TIME_INDEX || tags[1] != FDR_REC_TIME_INDEX) {
+    index.count = 0;
+    return false;
+  }
+  return true;
 }
 
 /**
- * @brief Deletes the recorded data file (if it exists).
+ * @brief Session offset of the last sync point before `t_ms`, by binary
+ * search of the index. Caller holds `fdr_lock`.
+ *
+ * @return 0 if there is none.
  */
-void fdr_reset() {
-  if (!ensureSpiffs()) return;
-  closeFdrFileIfOpen();
-  if (SPIFFS.exists(FDR_PATH)) SPIFFS.remove(FDR_PATH);
-  Serial.println("FDR: data reset (file removed)");
+static uint32_t syncPointBefore(const QueryIndex &index, uint32_t t_ms) {
+  const bool live = index.live && session_count > 0 &&
+                    session_index[session_count - 1].session_id == index.session_id;
+  const uint32_t count = live ? (uint32_t)time_index_count : index.live ? 0 : index.count;
+  const auto entryAt = [&](uint32_t i, FdrTimeIndexRecord &rec) {
+    if (live) {
+      rec = time_index[i];
+      return true;
+    }
+    return storage.read(index.session_id, index.first + i * sizeof(rec), (uint8_t*)&rec,
+                        sizeof(rec)) == sizeof(rec);
+  };
+  uint32_t lo = 0;
+  uint32_t hi = count; // entries [0, lo) are before t_ms, [hi, count) are not
+  uint32_t offset = 0;
+  while (lo < hi) {
+    const uint32_t mid = lo + (hi - lo) / 2;
+    FdrTimeIndexRecord rec;
+    if (!entryAt(mid, rec)) return 0;
+    if (rec.t_ms < t_ms && rec.offset < index.end) {
+      offset = rec.offset;
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return offset;
 }
 
 /**
- * @brief Returns whether FDR recording is active.
+ * @brief Formats a decoded record as one JSON row: the channel name, then
+ * the columns of its CSV export.
  *
- * @return true if recording, false otherwise.
+ * @param out Destination with room for QUERY_MAX_ROW_LEN characters.
+ * @return Number of characters written.
  */
-bool fdr_isActive() {
-  return fdr_active;
+static size_t formatQueryRow(size_t slot, const uint8_t* rec, const FdrFileHeader &header,
+                             char* out) {
+  char* p = out;
+  *p++ = '[';
+  *p++ = '"';
+  const size_t name_len = strlen(QUERY_CHANNEL_NAMES[slot]);
+  memcpy(p, QUERY_CHANNEL_NAMES[slot], name_len);
+  p += name_len;
+  *p++ = '"';
+  *p++ = ',';
+  if (slot == QUERY_EVENTS) {
+    FdrEventRecord r;
+    memcpy(&r, rec, sizeof(r));
+    p = appendTimestamp(p, r.t_ms);
+    *p++ = ',';
+    *p++ = '"';
+    const char* name = eventName(r.event);
+    memcpy(p, name, strlen(name));
+    p += strlen(name);
+    *p++ = '"';
+    *p++ = ',';
+    p = appendFixed(p, r.altitude_cm, 100, 2);
+    *p++ = ']';
+    return (size_t)(p - out);
+  }
+  if (rec[0] == FDR_REC_IMU) {
+    FdrImuRecord r;
+    memcpy(&r, rec, sizeof(r));
+    p += formatImuCsvRow(r, header, p);
+  } else if (rec[0] == FDR_REC_ALT) {
+    FdrAltRecord r;
+    memcpy(&r, rec, sizeof(r));
+    p += formatAltCsvRow(r, p);
+  } else {
+    FdrBaroRecord r;
+    memcpy(&r, rec, sizeof(r));
+    p += formatCsvRow(r, p);
+  }
+  p[-1] = ']'; // in place of the CSV line end
+  return (size_t)(p - out);
 }
 
 /**
- * @brief Main FDR loop handler. Must be called frequently.
+ * @brief Chunked response of a query, sent in batches of CSV_OUTPUT_BUFFER
+ * bytes.
+ */
+struct QueryOutput {
+  httpd_req_t* req;
+  char buf[CSV_OUTPUT_BUFFER];
+  size_t len;
+  bool failed;
+
+  void write(const void* data, size_t n) {
+    if (len + n > sizeof(buf)) flush();
+    memcpy(buf + len, data, n);
+    len += n;
+  }
+
+  void flush() {
+    if (len > 0 && !failed && httpd_resp_send_chunk(req, buf, len) != ESP_OK) failed = true;
+    len = 0;
+  }
+};
+
+/**
+ * @brief Parses a time argument in seconds into milliseconds.
  *
- * Takes samples according to the configured rate, stores them in the
- * buffer and flushes periodically.
+ * @return false if it is present but not a time; an over-long one sets
+ * `too_long` instead.
  */
-void fdr_process() {
-  if (!fdr_active) return;
-  const uint32_t now = millis();
-  if (now >= fdr_end_ms) {
-    fdr_stop();
-    return;
+static bool queryTimeArg(httpd_req_t* req, const char* key, uint32_t &t_ms, bool &too_long) {
+  char arg[16];
+  if (!http_queryArg(req, key, arg, sizeof(arg), too_long) || arg[0] == '\0') return true;
+  char* end;
+  const float s = strtof(arg, &end);
+  if (*end != '\0' || !(s >= 0.0f && s < 4.0e6f)) return false;
+  t_ms = (uint32_t)(s * 1000.0f + 0.5f);
+  return true;
+}
+
+/**
+ * @brief Answers a time-range query over a stored session; see fdr.h.
+ *
+ * The scan starts at the last sync point before `from` instead of the
+ * start of the session. With a `step`, each sample channel keeps the first
+ * sample of every step, and once all of them have one the scan jumps to
+ * the last sync point before the next step rather than reading the samples
+ * in between (not when the events are asked for: they would be skipped
+ * too). The session being recorded is answered up to its last commit,
+ * without draining or syncing it. Flash is read with the FDR lock held only
+ * for the read itself.
+ *
+ * @return true if data was sent.
+ */
+bool fdr_query(httpd_req_t* req) {
+  char arg[48];
+  uint32_t from_ms = 0;
+  uint32_t to_ms = UINT32_MAX;
+  uint32_t step_ms = 0;
+  bool too_long = false;
+  const bool times_valid = queryTimeArg(req, "from", from_ms, too_long) &&
+                           queryTimeArg(req, "to", to_ms, too_long) &&
+                           queryTimeArg(req, "step", step_ms, too_long);
+  if (too_long) {
+    sendError(req, HTTPD_400, R"({"error":"parameter too long"})");
+    return false;
+  }
+  if (!times_valid || to_ms <= from_ms) {
+    sendError(req, HTTPD_400, R"({"error":"invalid time range"})");
+    return false;
+  }
+  bool wanted[QUERY_CHANNELS] = {true, true, true, true, true};
+  if (http_queryArg(req, "channels", arg, sizeof(arg), too_long) && arg[0] != '\0') {
+    for (bool &w : wanted) w = false;
+    char* save = nullptr;
+    for (char* name = strtok_r(arg, ",", &save); name != nullptr;
+         name = strtok_r(nullptr, ",", &save)) {
+      size_t slot = 0;
+      while (slot < QUERY_CHANNELS && strcmp(name, QUERY_CHANNEL_NAMES[slot]) != 0) slot++;
+      if (slot == QUERY_CHANNELS) {
+        sendError(req, HTTPD_400, R"({"error":"invalid channel"})");
+        return false;
+      }
+      wanted[slot] = true;
+    }
+  }
+  char format[8];
+  http_queryArg(req, "format", format, sizeof(format), too_long);
+  const bool binary = strcmp(format, "bin") == 0;
+  char session_arg[12];
+  const bool has_session =
+      http_queryArg(req, "session", session_arg, sizeof(session_arg), too_long) &&
+      session_arg[0] != '\0';
+  if (too_long) {
+    sendError(req, HTTPD_400, R"({"error":"parameter too long"})");
+    return false;
+  }
+
+  FdrFileHeader header;
+  QueryIndex index = {};
+  uint32_t end;
+  uint32_t start;
+  {
+    FdrLockGuard lock;
+    if (!ensureStorage()) {
+      sendError(req, HTTPD_500, R"({"error":"storage mount failed"})");
+      return false;
+    }
+    if (fdr_active && !burst_committed) {
+      sendError(req, "503 Service Unavailable", R"({"error":"burst capture in progress"})");
+      return false;
+    }
+    if (session_count == 0) {
+      sendError(req, HTTPD_404, R"({"error":"no data"})");
+      return false;
+    }
+    const uint32_t latest_id = session_index[session_count - 1].session_id;
+    index.session_id = has_session ? (uint32_t)strtoul(session_arg, nullptr, 10) : latest_id;
+    const FdrIndexEntry* entry = findSession(index.session_id);
+    if (entry == nullptr) {
+      sendError(req, HTTPD_404, R"({"error":"unknown session"})");
+      return false;
+    }
+    end = entry->bytes;
+    if (fdr_active && index.session_id == latest_id) {
+      end = committed_bytes;
+      index.live = true;
+    }
+    index.end = end;
+    if (!readFdrHeader(index.session_id, header)) {
+      storage.endRead();
+      sendError(req, HTTPD_500, R"({"error":"unsupported file format"})");
+      return false;
+    }
+    bool recorded = false;
+    for (size_t slot = 0; slot < QUERY_CHANNELS; slot++) {
+      wanted[slot] = wanted[slot] && (header.channels & QUERY_CHANNEL_BITS[slot]);
+      recorded = recorded || wanted[slot];
+    }
+    if (!recorded) {
+      storage.endRead();
+      sendError(req, HTTPD_404, R"({"error":"channel not recorded"})");
+      return false;
+    }
+    if (!index.live) findTimeIndex(index.session_id, header.header_size, end, index);
+    start = syncPointBefore(index, from_ms);
+    if (start < header.header_size) start = header.header_size;
+  }
+  const bool indexed = index.live || index.count > 0;
+  const bool jumps = step_ms > 0 && indexed && !wanted[QUERY_EVENTS];
+
+  static QueryOutput out; // handlers run one at a time on the server task
+  out.req = req;
+  out.len = 0;
+  out.failed = false;
+  httpd_resp_set_type(req, binary ? "application/octet-stream" : "application/json");
+  if (binary) {
+    FdrFileHeader copy = header;
+    copy.header_size = sizeof(copy);
+    out.write(&copy, sizeof(copy));
+  } else {
+    char from_s[16], to_s[16], step_s[16];
+    *appendTimestamp(from_s, from_ms) = '\0';
+    *appendTimestamp(to_s, to_ms) = '\0';
+    *appendTimestamp(step_s, step_ms) = '\0';
+    char head[128];
+    const int n = snprintf(head, sizeof(head),
+                           "{\"session\":%u,\"from\":%s,\"to\":%s,\"step\":%s,\"indexed\":%s,"
+                           "\"rows\":[",
+                           (unsigned)index.session_id, from_s,
+                           to_ms == UINT32_MAX ? "null" : to_s, step_s,
+                           indexed ? "true" : "false");
+    out.write(head, (size_t)n);
   }
 
-  if (last_sample_ms == 0 || (now - last_sample_ms) >= fdr_sample_interval_ms) {
-    last_sample_ms = now;
+  uint32_t next_due[QUERY_CHANNELS];
+  for (uint32_t &due : next_due) due = from_ms;
+  uint32_t rows = 0;
+  uint32_t scanned = 0;
+  bool truncated = false;
+  uint32_t resume_ms = 0;
+  bool done = false;
 
-    if (!barometer_isReady()) {
-      Serial.println("FDR: barometer not ready, skipping sample");
-      return;
+  uint8_t raw[CSV_READ_CHUNK + FDR_MAX_RECORD_SIZE];
+  size_t have = 0;
+  uint32_t base = start; // session offset of raw[0]
+  FdrCodecState codec;
+  fdr_codecReset(codec);
+  uint8_t decoded[FDR_MAX_RECORD_SIZE];
+  while (!done && !out.failed && base + have < end) {
+    size_t got;
+    {
+      FdrLockGuard lock;
+      const uint32_t offset = base + (uint32_t)have;
+      const size_t want = end - offset < CSV_READ_CHUNK ? end - offset : CSV_READ_CHUNK;
+      got = storage.read(index.session_id, offset, raw + have, want);
+    }
+    if (got == 0) break;
+    have += got;
+    scanned += (uint32_t)got;
+
+    size_t pos = 0;
+    uint32_t jump_to = 0;
+    while (pos < have && !done && jump_to == 0) {
+      const size_t rec_len = fdr_recordLength(raw + pos, have - pos);
+      if (rec_len == 0 || (have - pos >= rec_len &&
+                           fdr_decodeRecord(codec, raw + pos, rec_len, decoded) == 0)) {
+        LOG_ERROR("FDR: undecodable record, query truncated");
+        done = true;
+        break;
+      }
+      if (have - pos < rec_len) break;
+      pos += rec_len;
+
+      size_t slot = 0;
+      while (slot < QUERY_CHANNELS && QUERY_CHANNEL_TYPES[slot] != decoded[0]) slot++;
+      if (slot == QUERY_CHANNELS) continue; // sync, commit and index records
+      uint32_t t_ms;
+      memcpy(&t_ms, decoded + offsetof(FdrBaroRecord, t_ms), sizeof(t_ms));
+      if (to_ms != UINT32_MAX && t_ms >= to_ms + QUERY_ORDER_SLACK_MS) {
+        done = true;
+        break;
+      }
+      if (scanned > QUERY_MAX_SCAN_BYTES) {
+        truncated = true;
+        resume_ms = t_ms > from_ms ? t_ms : from_ms;
+        done = true;
+        break;
+      }
+      if (!wanted[slot] || t_ms < from_ms || t_ms >= to_ms) continue;
+      if (step_ms > 0 && slot != QUERY_EVENTS) {
+        if (t_ms < next_due[slot]) continue;
+        next_due[slot] = t_ms - (t_ms - from_ms) % step_ms + step_ms;
+      }
+      if (rows == FDR_QUERY_MAX_ROWS) {
+        truncated = true;
+        resume_ms = t_ms;
+        done = true;
+        break;
+      }
+      if (binary) {
+        out.write(decoded, fdr_recordSize(decoded[0]));
+      } else {
+        char row[QUERY_MAX_ROW_LEN + 1];
+        row[0] = ',';
+        const size_t len = formatQueryRow(slot, decoded, header, row + 1);
+        out.write(rows ? row : row + 1, rows ? len + 1 : len);
+      }
+      rows++;
+
+      if (jumps) {
+        uint32_t target = UINT32_MAX;
+        for (size_t s = 0; s < QUERY_EVENTS; s++) {
+          if (wanted[s] && next_due[s] < target) target = next_due[s];
+        }
+        FdrLockGuard lock;
+        const uint32_t sync = syncPointBefore(index, target);
+        if (sync > base + (uint32_t)pos) jump_to = sync;
+      }
+    }
+    if (jump_to != 0) {
+      base = jump_to;
+      have = 0;
+      fdr_codecReset(codec);
+      continue;
     }
+    memmove(raw, raw + pos, have - pos);
+    have -= pos;
+    base += (uint32_t)pos;
+  }
+  {
+    FdrLockGuard lock;
+    storage.endRead();
+  }
+
+  if (binary) {
+    if (truncated) {
+      FdrSyncRecord resume;
+      resume.type = FDR_REC_SYNC;
+      resume.t_ms = resume_ms;
+      out.write(&resume, sizeof(resume));
+    }
+  } else {
+    char next_s[16] = "null";
+    if (truncated) *appendTimestamp(next_s, resume_ms) = '\0';
+    char tail[80];
+    const int n = snprintf(tail, sizeof(tail), "],\"count\":%u,\"next\":%s,\"scanned_bytes\":%u}",
+                           (unsigned)rows, next_s, (unsigned)scanned);
+    out.write(tail, (size_t)n);
+  }
+  out.flush();
+  if (!out.failed) httpd_resp_send_chunk(req, nullptr, 0);
+  return !out.failed;
+}
+
+/**
+ * @brief Buffered writer for one live client; marks the client as closing
+ * once a write does not go through.
+ */
+struct LiveWriter {
+  LiveClient &target;
+  char buf[LIVE_WRITE_BUFFER];
+  size_t len;
+
+  /** @brief Makes room for `n` more characters. */
+  char* reserve(size_t n) {
+    if (len + n > sizeof(buf)) flush();
+    return buf + len;
+  }
 
-    const float pressure = barometer_getPressure();
-    const float t_sec = (float)(now - fdr_start_ms) / 1000.0f;
+  void commit(char* end) { len = (size_t)(end - buf); }
 
-    char line[64];
-    snprintf(line, sizeof(line), "%.3f,%.2f\n", t_sec, pressure);
-    fdr_write_buffer += String(line);
+  void append(const char* text) {
+    const size_t n = strlen(text);
+    memcpy(reserve(n), text, n);
+    len += n;
+  }
+
+  void flush() {
+    if (len > 0 && !target.closing && !http_sendRaw(target.server, target.fd, buf, len)) {
+      target.closing = true;
+    }
+    len = 0;
+  }
+};
 
-    if ((uint32_t)fdr_write_buffer.length() >= BUFFER_FLUSH_THRESHOLD ||
-        (now - last_flush_ms) >= BUFFER_FLUSH_INTERVAL_MS) {
-      flushBufferToFile();
+/**
+ * @brief Sends one batch event to a client, applying its channel selection
+ * and decimation:
+ *
+ *   event: samples
+ *   data: {"baro":[[t,hPa,°C],...],"alt":[[t,m,m/s],...],"events":[[t,"apogee",m],...],
+ *          "imu":[[t,ax,ay,az,gx,gy,gz],...],"dropped":n}
+ *
+ * `t` is the device uptime in seconds, acceleration is in g and angular
+ * rate in °/s; `dropped` counts samples the live tap had to skip since boot.
+ * The altitude follows the barometer selection and decimation; flight
+ * events are never decimated.
+ */
+static void liveSendBatch(LiveClient &c, const FdrBaroRecord* baro, size_t baro_count,
+                          const FdrImuRecord* imu, size_t imu_count) {
+  LiveWriter w = {c, {}, 0};
+  w.append("event: samples\ndata: {\"baro\":[");
+  bool first = true;
+  for (size_t i = 0; c.baro && i < baro_count; i++) {
+    if (baro[i].type != FDR_REC_BARO || c.baro_phase++ % c.decimation != 0) continue;
+    char* p = w.reserve(CSV_MAX_ROW_LEN);
+    if (!first) *p++ = ',';
+    first = false;
+    *p++ = '[';
+    p = appendTimestamp(p, baro[i].t_ms);
+    *p++ = ',';
+    const uint32_t pa = (baro[i].pressure_q8 + 128) >> 8;
+    p = appendFixed(p, (int32_t)pa, 100, 2);
+    *p++ = ',';
+    if (baro[i].temperature_cdeg == INT16_MIN) {
+      memcpy(p, "null", 4);
+      p += 4;
+    } else {
+      p = appendFixed(p, baro[i].temperature_cdeg, 100, 2);
+    }
+    *p++ = ']';
+    w.commit(p);
+  }
+  w.append("],\"alt\":[");
+  first = true;
+  for (size_t i = 0; c.baro && i < baro_count; i++) {
+    if (baro[i].type != FDR_REC_ALT || c.alt_phase++ % c.decimation != 0) continue;
+    FdrAltRecord rec;
+    memcpy(&rec, &baro[i], sizeof(rec));
+    char* p = w.reserve(CSV_MAX_ROW_LEN);
+    if (!first) *p++ = ',';
+    first = false;
+    *p++ = '[';
+    p = appendTimestamp(p, rec.t_ms);
+    *p++ = ',';
+    p = appendFixed(p, rec.altitude_cm, 100, 2);
+    *p++ = ',';
+    p = appendFixed(p, rec.vspeed_cms, 100, 2);
+    *p++ = ']';
+    w.commit(p);
+  }
+  w.append("],\"events\":[");
+  first = true;
+  for (size_t i = 0; i < baro_count; i++) {
+    if (baro[i].type != FDR_REC_EVENT) continue;
+    FdrEventRecord rec;
+    memcpy(&rec, &baro[i], sizeof(rec));
+    char* p = w.reserve(CSV_MAX_ROW_LEN);
+    if (!first) *p++ = ',';
+    first = false;
+    *p++ = '[';
+    p = appendTimestamp(p, rec.t_ms);
+    p += snprintf(p, CSV_MAX_ROW_LEN / 2, ",\"%s\",", eventName(rec.event));
+    p = appendFixed(p, rec.altitude_cm, 100, 2);
+    *p++ = ']';
+    w.commit(p);
+  }
+  w.append("],\"imu\":[");
+  first = true;
+  for (size_t i = 0; c.imu && i < imu_count; i++) {
+    if (c.imu_phase++ % c.decimation != 0) continue;
+    char* p = w.reserve(CSV_MAX_ROW_LEN + 8);
+    if (!first) *p++ = ',';
+    first = false;
+    *p++ = '[';
+    p = appendTimestamp(p, imu[i].t_ms);
+    for (uint8_t axis = 0; axis < 3; axis++) {
+      *p++ = ',';
+      p = appendFixed(p, scaleRounded(imu[i].accel[axis], 1000, IMU_ACCEL_LSB_PER_G), 1000, 3);
     }
+    for (uint8_t axis = 0; axis < 3; axis++) {
+      *p++ = ',';
+      p = appendFixed(p, scaleRounded(imu[i].gyro[axis], 100, IMU_GYRO_LSB_PER_DPS_X10), 10, 1);
+    }
+    *p++ = ']';
+    w.commit(p);
   }
+  char tail[40];
+  snprintf(tail, sizeof(tail), "],\"dropped\":%u}\n\n",
+           (unsigned)live_dropped.load(std::memory_order_relaxed));
+  w.append(tail);
+  w.flush();
+}
+
+/**
+ * @brief Session context destructor: the server closed a live connection.
+ */
+static void liveClosed(void* ctx) {
+  static_cast<LiveClient*>(ctx)->active = false;
+  LOG_INFO("FDR: live client disconnected");
 }
 
 /**
- * @brief Streams the recorded FDR CSV file via HTTP.
+ * @brief Starts a live telemetry stream on the current request.
  *
- * Flushes any pending buffer first if recording is active.
+ * Answers with a `text/event-stream` header and keeps the connection; the
+ * samples are then sent by liveProcess() on the server task. `?decimation=<n>`
+ * sends one sample in n (default 1, every sample), `?channel=baro|imu`
+ * restricts the stream to one channel. The tap works whether or not a
+ * session is recording, and never delays the sampler: when the server falls
+ * behind, live samples are dropped, never recorded ones.
  *
- * @param server Reference to the WebServer handling the request.
- * @return true on successful transfer.
+ * @param req Request being handled.
+ * @return true if the client was attached.
  */
-bool fdr_streamFile(WebServer &server) {
-  if (!ensureSpiffs()) {
-    server.send(500, "application/json", R"({"error":"SPIFFS mount failed"})");
+bool fdr_liveAttach(httpd_req_t* req) {
+  LiveClient* slot = nullptr;
+  for (size_t i = 0; i < FDR_LIVE_MAX_CLIENTS; i++) {
+    if (!live_clients[i].active) {
+      slot = &live_clients[i];
+      break;
+    }
+  }
+  if (slot == nullptr) {
+    sendError(req, "503 Service Unavailable", R"({"error":"too many live clients"})");
     return false;
   }
 
-  if (!SPIFFS.exists(FDR_PATH)) {
-    server.send(404, "application/json", R"({"error":"no data"})");
+  bool too_long = false;
+  char value[12];
+  http_queryArg(req, "decimation", value, sizeof(value), too_long);
+  long decimation = strtol(value, nullptr, 10);
+  if (decimation < 1) decimation = 1;
+  if (decimation > (long)LIVE_MAX_DECIMATION) decimation = LIVE_MAX_DECIMATION;
+  char channel[8];
+  http_queryArg(req, "channel", channel, sizeof(channel), too_long);
+  if (too_long) {
+    sendError(req, HTTPD_400, R"({"error":"parameter too long"})");
     return false;
   }
 
-  // If FDR is still active, flush the buffer before sending
-  if (fdr_active && fdr_write_buffer.length() > 0) {
-    flushBufferToFile();
+  if (!live_enabled.load(std::memory_order_relaxed)) {
+    // Whatever is queued dates from the previous client
+    FdrBaroRecord baro;
+    while (live_baro_queue.pop(baro)) {}
+    FdrImuRecord imu;
+    while (live_imu_queue.pop(imu)) {}
   }
 
-  File f = SPIFFS.open(FDR_PATH, FILE_READ);
-  if (!f) {
-    server.send(500, "application/json", R"({"error":"cannot open file"})");
+  const int fd = httpd_req_to_sockfd(req);
+  if (!http_sendRaw(req->handle, fd,
+                    "HTTP/1.1 200 OK\r\n"
+                    "Content-Type: text/event-stream\r\n"
+                    "Cache-Control: no-cache\r\n"
+                    "Access-Control-Allow-Origin: *\r\n"
+                    "Connection: close\r\n\r\n"
+                    "retry: 2000\n\n")) {
     return false;
   }
+  slot->active = true;
+  slot->closing = false;
+  slot->server = req->handle;
+  slot->fd = fd;
+  slot->baro = strcmp(channel, "imu") != 0;
+  slot->imu = strcmp(channel, "baro") != 0;
+  slot->decimation = (uint32_t)decimation;
+  slot->baro_phase = 0;
+  slot->alt_phase = 0;
+  slot->imu_phase = 0;
+  slot->last_send_ms = millis();
+  req->sess_ctx = slot;
+  req->free_ctx = liveClosed;
 
-  server.sendHeader("Content-Type", "text/csv");
-  server.sendHeader("Content-Disposition", "attachment; filename=fdrecord.csv");
-  server.streamFile(f, "text/csv");
-  f.close();
+  live_server = req->handle;
+  live_enabled.store(true, std::memory_order_relaxed);
+  xTaskNotifyGive(sampler_task); // to the live rate now
+  if (!live_timer_running) {
+    esp_timer_start_periodic(live_timer, LIVE_BATCH_INTERVAL_MS * 1000ULL);
+    live_timer_running = true;
+  }
+  LOG_INFO("FDR: live client attached (decimation %u)", (unsigned)decimation);
   return true;
 }
+
+/**
+ * @brief Sends the samples collected since the last run to every live
+ * client. Queued on the server task by onLiveTimer() every
+ * LIVE_BATCH_INTERVAL_MS.
+ *
+ * Closes connections whose writes fail, and turns the tap and the timer
+ * off once no client is left.
+ */
+static void liveProcess(void*) {
+  PERF_SCOPE(FdrLiveBatch);
+  live_step_queued.store(false, std::memory_order_relaxed);
+  const uint32_t now_ms = millis();
+
+  static FdrBaroRecord baro[LIVE_BARO_QUEUE_DEPTH];
+  static FdrImuRecord imu[LIVE_IMU_QUEUE_DEPTH];
+  size_t baro_count = 0;
+  while (baro_count < LIVE_BARO_QUEUE_DEPTH && live_baro_queue.pop(baro[baro_count])) baro_count++;
+  size_t imu_count = 0;
+  while (imu_count < LIVE_IMU_QUEUE_DEPTH && live_imu_queue.pop(imu[imu_count])) imu_count++;
+
+  bool any = false;
+  for (size_t i = 0; i < FDR_LIVE_MAX_CLIENTS; i++) {
+    LiveClient &c = live_clients[i];
+    if (!c.active) continue;
+    any = true;
+    if (c.closing) continue;
+    if ((c.baro && baro_count > 0) || (c.imu && imu_count > 0)) {
+      liveSendBatch(c, baro, baro_count, imu, imu_count);
+      c.last_send_ms = now_ms;
+    } else if (now_ms - c.last_send_ms >= LIVE_KEEPALIVE_MS) {
+      if (!http_sendRaw(c.server, c.fd, ":\n\n")) c.closing = true;
+      c.last_send_ms = now_ms;
+    }
+    // liveClosed() frees the slot once the server has closed the socket
+    if (c.closing && httpd_sess_trigger_close(c.server, c.fd) != ESP_OK) c.active = false;
+  }
+  if (!any) {
+    live_enabled.store(false, std::memory_order_relaxed);
+    esp_timer_stop(live_timer);
+    live_timer_running = false;
+  }
+}
+
+/**
+ * @brief esp_timer callback: queues a live batch on the server task unless
+ * one is still pending.
+ */
+static void onLiveTimer(void*) {
+  if (live_step_queued.exchange(true, std::memory_order_relaxed)) return;
+  if (httpd_queue_work(live_server, liveProcess, nullptr) != ESP_OK) {
+    live_step_queued.store(false, std::memory_order_relaxed);
+  }
+}
@@ -2,23 +2,256 @@
 #define FDR_H
 
 #include <Arduino.h>
-#include <WebServer.h>
+#include <esp_http_server.h>
+#include "pressure_filter.h"
 
-// Inicializa el módulo FDR. Llamar en setup.
+// Inicializa el módulo FDR y arranca sus tareas de muestreo y escritura.
+// Llamar en setup, después de barometer_init() e imu_init(): a partir de
+// aquí la tarea de muestreo ejecuta barometer_process(). Una sesión cortada
+// por un reinicio (guardada en NVS al empezar) continúa aquí mismo.
 void fdr_init();
 
-// Ejecutar desde loop() para muestreo y control de tiempo.
-void fdr_process();
-
 // Control API
 // duration_s: recording duration in seconds
-// samples_per_sec: sampling frequency (e.g., 1 = 1 sample/sec, 10 = 10 samples/sec); default 1 if 0
-bool fdr_start(uint32_t duration_s, uint32_t samples_per_sec);
+// samples_per_sec: sampling frequency (e.g., 1 = 1 sample/sec, 10 = 10 samples/sec,
+//                  0.5 = one sample every 2 s); default 1 if 0, max 50
+bool fdr_start(uint32_t duration_s, float samples_per_sec);
+
+// Full session parameters. A burst window records the first `burst_ms` of
+// the session at up to 200 Hz into RAM only and commits it to flash after
+// the window; it is clamped to the session duration and RAM buffer size.
+// The IMU, if present, is recorded as a second channel at its own rate.
+// Barometer samples go through `filter`; with `record_raw` the unfiltered
+// samples are stored too, as a separate channel. The barometer's altitude,
+// vertical speed and flight events are recorded unless `record_altitude`
+// is cleared.
+//
+// With `pretrigger_ms` set the session starts armed: samples only go into a
+// RAM ring holding the last `pretrigger_ms`, and nothing reaches flash
+// until one of the `trigger` conditions fires. The ring is then committed
+// and the session records normally for `duration_s`. An armed session has
+// no burst window; stopped before the trigger, it is deleted.
+//
+// With `baro_forced` the barometer sleeps between samples and converts once
+// per deadline, triggered one conversion time ahead of it, so every sample
+// is a fresh measurement. Sessions whose period (burst included) is too
+// short for a conversion keep the sensor in normal mode.
+//
+// Before anything is created the session's storage is planned: an upper
+// bound of its size, from the record formats of its channels and rates, is
+// compared with the free space plus the earlier sessions it may replace
+// (deleted oldest first, as usual). A session that does not fit is started
+// at rates lowered to fit with `storage_policy` Decimate, and rejected
+// (fdr_start() returns false, and a session still running keeps recording)
+// with Reject or below the minimum rates; see fdr_getStoragePlan(). While
+// recording, records are decimated instead of lost when the storage falls
+// behind or would run out.
+enum class FdrStoragePolicy : uint8_t {
+  Decimate,                            // lower the rates until the session fits
+  Reject,                              // do not start a session that does not fit
+};
+struct FdrTriggerConfig {
+  uint32_t pressure_drop_pa_s = 0;     // filtered pressure falling faster (Pa/s); 0 = off
+  uint32_t accel_mg = 0;               // acceleration magnitude above (mg), IMU only; 0 = off
+  bool launch = false;                 // barometer launch event
+};
+struct FdrSessionConfig {
+  uint32_t duration_s = 180;
+  float samples_per_sec = 1.0f;        // barometer rate
+  uint32_t burst_ms = 0;               // 0 = no burst
+  float burst_samples_per_sec = 200.0f;
+  uint16_t imu_rate_hz = 200;          // 0 = barometer only; max 500
+  PressureFilterConfig filter;         // default: EMA, alpha 0.25
+  bool record_raw = false;
+  bool record_altitude = true;
+  uint32_t pretrigger_ms = 0;          // 0 = not armed, record from the start
+  FdrTriggerConfig trigger;
+  bool baro_forced = true;
+  FdrStoragePolicy storage_policy = FdrStoragePolicy::Decimate;
+};
+bool fdr_start(const FdrSessionConfig &config);
+
+// Effective parameters of the current/last session after clamping
+struct FdrSessionInfo {
+  uint32_t session_id;             // 0 if no session has been started
+  uint32_t duration_s;
+  uint32_t rate_mhz;               // regular rate in millihertz
+  uint32_t period_us;
+  uint16_t imu_rate_hz;            // 0 if the IMU is not recorded
+  PressureFilterConfig filter;
+  bool record_raw;                 // unfiltered barometer channel recorded
+  bool record_altitude;            // altitude channel and flight events recorded
+  bool baro_forced;                // one forced barometer conversion per sample
+  uint32_t burst_ms;               // 0 if the session has no burst
+  uint32_t burst_rate_mhz;
+  uint32_t burst_period_us;
+  uint32_t burst_capacity_bytes;   // RAM burst buffer size
+  uint32_t burst_bytes;            // bytes captured in the burst so far
+  uint32_t burst_records;          // records (all channels) captured so far
+  uint32_t burst_dropped;          // burst samples that did not fit
+  bool burst_committed;            // burst written to flash (or no burst)
+  uint32_t pretrigger_ms;          // 0 if the session was not armed
+  uint32_t pretrigger_capacity_bytes;
+  uint32_t pretrigger_bytes;       // bytes held in the pre-trigger ring
+  FdrTriggerConfig trigger;
+  bool armed;                      // waiting for the trigger
+  bool triggered;
+  uint32_t trigger_t_ms;           // session time of the trigger
+  const char* trigger_cause;       // "pressure", "accel", "launch" or nullptr
+  uint32_t resumed_from;           // session continued after a reset, 0 if none
+};
+void fdr_getSessionInfo(FdrSessionInfo &info);
 void fdr_stop();
 void fdr_reset();
 bool fdr_isActive();
 
-// Stream the stored CSV file via WebServer (returns true on success)
-bool fdr_streamFile(WebServer &server);
+// Barometer acquisition. A session reads it at its own rate; between
+// sessions it is read at 10 Hz while a live client is attached and at the
+// idle rate otherwise (default 1 Hz, 0.1-100 Hz), only to keep the cached
+// reading of the HTTP API fresh. Safe from any task.
+void fdr_setIdleRate(float samples_per_sec);
+struct FdrAcquisitionInfo {
+  const char* mode;          // "session", "live" or "idle"
+  uint32_t rate_mhz;         // barometer reads per 1000 s in this mode
+  uint32_t idle_rate_mhz;
+};
+void fdr_getAcquisitionInfo(FdrAcquisitionInfo &info);
+
+// RAM buffer usage and dropped-data counters (reset on each fdr_start)
+struct FdrBufferStats {
+  uint32_t buffered_bytes;   // bytes waiting to be flushed
+  uint32_t capacity_bytes;   // fixed buffer capacity
+  uint32_t high_water_bytes; // highest fill level this session
+  uint32_t overflow_records; // records dropped because the buffer was full
+  uint32_t overflow_bytes;   // bytes dropped because the buffer was full
+  uint32_t queue_depth;      // barometer records waiting between sampler and writer
+  uint32_t queue_capacity;   // fixed sample queue capacity
+  uint32_t queue_high_water; // deepest queue level this session
+  uint32_t queue_dropped;    // records dropped because the queue was full
+  uint32_t imu_queue_depth;  // same four counters for the IMU queue
+  uint32_t imu_queue_capacity;
+  uint32_t imu_queue_high_water;
+  uint32_t imu_queue_dropped;
+  uint32_t baro_records;     // records accepted per channel this session
+  uint32_t imu_records;
+  uint32_t raw_bytes;        // size of those records before delta encoding
+  uint32_t encoded_bytes;    // and after
+};
+void fdr_getBufferStats(FdrBufferStats &stats);
+
+// Sample scheduling quality of the current/last session (reset on each fdr_start).
+// Jitter is wake-up time minus the absolute deadline of each sample.
+static constexpr size_t FDR_JITTER_BUCKETS = 8;
+// Upper bound (exclusive, µs) of each histogram bucket; the last bucket is open
+static constexpr uint32_t FDR_JITTER_BUCKET_LIMITS_US[FDR_JITTER_BUCKETS - 1] = {
+  50, 100, 250, 500, 1000, 2500, 5000
+};
+struct FdrTimingStats {
+  uint32_t rate_mhz;          // session rate in millihertz
+  uint32_t period_us;         // whole-µs part of the sample period
+  uint32_t samples;           // deadlines serviced
+  uint32_t missed_deadlines;  // deadlines skipped because the sampler was late
+  uint32_t skipped_not_ready; // deadlines serviced without a sensor reading
+  uint32_t skipped_stale;     // forced conversion not complete at the deadline
+  uint32_t jitter_min_us;
+  uint32_t jitter_max_us;
+  uint32_t jitter_avg_us;
+  uint32_t jitter_hist[FDR_JITTER_BUCKETS];
+};
+void fdr_getTimingStats(FdrTimingStats &stats);
+
+// Storage backend activity. Write counters are reset on each fdr_start;
+// space and erase counters are not. A flush hands buffered records to the
+// backend, a sync commits them to flash.
+struct FdrStorageStats {
+  const char* backend;      // "littlefs", "spiffs" or "rawlog"
+  uint32_t total_bytes;
+  uint32_t free_bytes;
+  uint32_t flushes;
+  uint32_t write_bytes;
+  uint32_t flush_last_us;
+  uint32_t flush_avg_us;
+  uint32_t flush_max_us;
+  uint32_t commits;          // journal commit records written
+  uint32_t syncs;
+  uint32_t sync_max_us;
+  uint32_t erases;          // sectors erased by the raw log (0 on file systems)
+  uint32_t erase_max_us;
+  uint32_t erase_stalls;    // erases that had to run inside a flush
+};
+void fdr_getStorageStats(FdrStorageStats &stats);
+
+// Storage plan of the current/last fdr_start() and the adaptive
+// backpressure of its session. Estimates count every record at its
+// absolute size, the most the delta encoding stores. Under backpressure
+// the writer stores one barometer sample (with its raw and altitude
+// records) and one IMU sample out of `decimation`; flight events are
+// always kept. It doubles when the RAM buffer fills up or the storage
+// would run out before the end at the measured data rate, and halves
+// again once both have cleared.
+struct FdrStoragePlan {
+  uint32_t bytes_per_s;            // data rate at the effective rates
+  uint32_t session_bytes;          // whole session
+  uint32_t available_bytes;        // free space plus the sessions it may replace
+  uint32_t requested_rate_mhz;     // rates asked for, before any decimation
+  uint16_t requested_imu_rate_hz;
+  bool decimated;                  // rates lowered at start to fit
+  bool rejected;                   // did not fit; no session was started
+  uint8_t decimation;              // 1 = every sample stored
+  uint8_t max_decimation;          // highest reached this session
+  uint32_t decimated_records;      // records left out by backpressure
+  uint32_t backpressure_steps;     // decimation changes this session
+  const char* backpressure_cause;  // last raise: "buffer", "storage" or nullptr
+};
+void fdr_getStoragePlan(FdrStoragePlan &plan);
+
+// Stored sessions, from the on-flash index. Each start creates a new numbered
+// session; once FDR_MAX_SESSIONS are stored the oldest one is deleted.
+static constexpr size_t FDR_MAX_SESSIONS = 32;
+struct FdrSessionSummary {
+  uint32_t id;
+  uint32_t start_uptime_ms;  // millis() when the session started
+  uint32_t rate_mhz;         // barometer rate in millihertz
+  uint16_t imu_rate_hz;      // 0 if the IMU was not recorded
+  bool open;                 // still recording
+  bool recovered;            // closed by the recovery scan after a reset
+  bool resumed;              // continues a session cut off by a reset
+  uint32_t duration_ms;      // timestamp of the last record
+  uint32_t baro_records;
+  uint32_t imu_records;
+  uint32_t bytes;            // valid data size, up to the last commit
+  float pressure_min_hpa;    // NAN if no barometer record
+  float pressure_max_hpa;
+};
+// Fills `out` oldest first; returns the number of sessions stored
+size_t fdr_listSessions(FdrSessionSummary* out, size_t max);
+
+// Stream the stored log over HTTP, converted to CSV (returns true if the
+// transfer was started). Latest session by default, another one with
+// `?session=<id>`. Barometer channel by default, IMU channel with
+// `?channel=imu`, unfiltered barometer with `?channel=baro_raw`, altitude
+// with `?channel=alt`, flight events with `?channel=events`; `?format=bin`
+// sends the stored binary log instead. The transfer continues in small steps
+// queued on the server task, so several downloads and other requests are
+// served at once.
+static constexpr size_t FDR_MAX_DOWNLOADS = 2;
+bool fdr_streamFile(httpd_req_t* req);
+
+// Time-range query over a stored session, answered in the request handler
+// (returns true if data was sent): `?session=<id>&from=<s>&to=<s>&step=<s>`
+// `&channels=baro,baro_raw,alt,imu,events&format=json|bin`, latest session,
+// whole session and every recorded channel by default. It seeks with the
+// session's time index instead of reading from the start; `step` keeps one
+// sample per channel and step. At most FDR_QUERY_MAX_ROWS records per
+// answer, which tells where to continue.
+static constexpr size_t FDR_QUERY_MAX_ROWS = 2000;
+bool fdr_query(httpd_req_t* req);
+
+// Live telemetry over Server-Sent Events. fdr_liveAttach() takes over the
+// request's connection (`?decimation=<n>`, `?channel=baro|imu`; the altitude
+// follows `baro`, flight events are always sent); batches are
+// then pushed from the server task every 100 ms until the client leaves.
+static constexpr size_t FDR_LIVE_MAX_CLIENTS = 2;
+bool fdr_liveAttach(httpd_req_t* req);
 
 #endif // FDR_H
@@ -0,0 +1,304 @@
+/**
+ * @file fdr_codec.cpp
+ * @brief Delta encoding of FDR records
+ * @author slopez.tech
+ * @date 2025-11-30
+ *
+ * Integer-only and allocation-free: encoding a sample costs a handful of
+ * subtractions and at most seven varints, whatever the session length.
+ */
+
+#include "fdr_codec.h"
+#include <string.h>
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+/**
+ * @brief Longest varint accepted, enough for any 32-bit value.
+ */
+static constexpr size_t VARINT_MAX_BYTES = 5;
+
+/**
+ * @brief Scratch space for an encoding that may turn out longer than the
+ * absolute record: tag, explicit interval and six 16-bit differences.
+ */
+static constexpr size_t ENCODE_SCRATCH_BYTES = 1 + VARINT_MAX_BYTES + 6 * 3;
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static inline uint32_t zigzag(int32_t value) {
+  return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t value) {
+  return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+/**
+ * @brief Writes an unsigned LEB128 varint.
+ *
+ * @return Pointer just past the last written byte.
+ */
+static uint8_t* putVarint(uint8_t* out, uint32_t value) {
+  while (value >= 0x80) {
+    *out++ = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  *out++ = (uint8_t)value;
+  return out;
+}
+
+/**
+ * @brief Reads an unsigned LEB128 varint, never past `end`.
+ *
+ * @return Pointer just past the varint, or nullptr if it is truncated.
+ */
+static const uint8_t* getVarint(const uint8_t* in, const uint8_t* end, uint32_t &value) {
+  value = 0;
+  for (size_t i = 0; i < VARINT_MAX_BYTES && in < end; i++) {
+    const uint8_t byte = *in++;
+    value |= (uint32_t)(byte & 0x7F) << (7 * i);
+    if (!(byte & 0x80)) return in;
+  }
+  return nullptr;
+}
+
+/**
+ * @brief Writes the time code of a sample into the tag and, if the
+ * interval cannot be predicted, the explicit interval after it.
+ *
+ * @param tag Tag being built; its low nibble is set.
+ * @return Pointer just past the bytes written.
+ */
+static uint8_t* putTime(uint8_t &tag, uint8_t* out, uint32_t dt_ms, uint32_t prev_dt_ms) {
+  const int32_t change = (int32_t)(dt_ms - prev_dt_ms);
+  if (change >= -(int32_t)FDR_DELTA_DT_BIAS &&
+      change <= (int32_t)(FDR_DELTA_DT_EXPLICIT - 1 - FDR_DELTA_DT_BIAS)) {
+    tag |= (uint8_t)(change + FDR_DELTA_DT_BIAS);
+    return out;
+  }
+  tag |= FDR_DELTA_DT_EXPLICIT;
+  return putVarint(out, zigzag((int32_t)dt_ms));
+}
+
+/**
+ * @brief Reads the interval of a delta record back from its time code.
+ *
+ * @return Pointer just past the explicit interval, if any; nullptr if truncated.
+ */
+static const uint8_t* getTime(uint8_t tag, const uint8_t* in, const uint8_t* end,
+                              uint32_t prev_dt_ms, uint32_t &dt_ms) {
+  const uint8_t code = tag & FDR_DELTA_CODE_MASK;
+  if (code != FDR_DELTA_DT_EXPLICIT) {
+    dt_ms = prev_dt_ms + (uint32_t)((int32_t)code - FDR_DELTA_DT_BIAS);
+    return in;
+  }
+  uint32_t value;
+  in = getVarint(in, end, value);
+  dt_ms = (uint32_t)unzigzag(value);
+  return in;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+/**
+ * @brief Clears the state for the start of a session.
+ */
+void fdr_codecReset(FdrCodecState &state) {
+  memset(&state, 0, sizeof(state));
+}
+
+/**
+ * @brief Absolute and delta tags of the channels in the FdrBaroRecord
+ * layout, by FdrCodecState slot.
+ */
+static constexpr uint8_t BARO_LAYOUT_TYPES[FDR_CODEC_BARO_CHANNELS] = {
+  FDR_REC_BARO, FDR_REC_BARO_RAW, FDR_REC_ALT};
+static constexpr uint8_t BARO_LAYOUT_DELTAS[FDR_CODEC_BARO_CHANNELS] = {
+  FDR_REC_BARO_DELTA, FDR_REC_BARO_RAW_DELTA, FDR_REC_ALT_DELTA};
+
+/**
+ * @brief State slot of an absolute record type, or of a delta tag with
+ * `delta` set.
+ *
+ * @return FDR_CODEC_BARO_CHANNELS if it is not a channel in the
+ *         FdrBaroRecord layout.
+ */
+static size_t baroSlot(uint8_t tag, bool delta) {
+  const uint8_t* tags = delta ? BARO_LAYOUT_DELTAS : BARO_LAYOUT_TYPES;
+  if (delta) tag &= FDR_DELTA_TYPE_MASK;
+  size_t slot = 0;
+  while (slot < FDR_CODEC_BARO_CHANNELS && tags[slot] != tag) slot++;
+  return slot;
+}
+
+/**
+ * @brief Encodes an absolute record against the previous sample of its
+ * channel; see fdr_codec.h.
+ */
+size_t fdr_encodeRecord(const FdrCodecState &state, const uint8_t* rec, uint8_t* out) {
+  uint8_t scratch[ENCODE_SCRATCH_BYTES];
+  uint8_t* p = scratch + 1;
+  size_t absolute;
+
+  const size_t slot = baroSlot(rec[0], false);
+  if (slot < FDR_CODEC_BARO_CHANNELS && state.have_baro[slot]) {
+    const FdrBaroRecord &prev = state.baro[slot];
+    FdrBaroRecord r;
+    memcpy(&r, rec, sizeof(r));
+    absolute = sizeof(r);
+    scratch[0] = BARO_LAYOUT_DELTAS[slot];
+    p = putTime(scratch[0], p, r.t_ms - prev.t_ms, state.baro_dt_ms[slot]);
+    p = putVarint(p, zigzag((int32_t)(r.pressure_q8 - prev.pressure_q8)));
+    p = putVarint(p, zigzag((int16_t)(r.temperature_cdeg - prev.temperature_cdeg)));
+  } else if (rec[0] == FDR_REC_IMU && state.have_imu) {
+    FdrImuRecord r;
+    memcpy(&r, rec, sizeof(r));
+    absolute = sizeof(r);
+    scratch[0] = FDR_REC_IMU_DELTA;
+    p = putTime(scratch[0], p, r.t_ms - state.imu.t_ms, state.imu_dt_ms);
+    for (uint8_t axis = 0; axis < 3; axis++) {
+      p = putVarint(p, zigzag((int16_t)(r.accel[axis] - state.imu.accel[axis])));
+    }
+    for (uint8_t axis = 0; axis < 3; axis++) {
+      p = putVarint(p, zigzag((int16_t)(r.gyro[axis] - state.imu.gyro[axis])));
+    }
+  } else {
+    // First sample of the channel, or not a sample
+    const size_t len = fdr_recordSize(rec[0]);
+    memcpy(out, rec, len);
+    return len;
+  }
+
+  const size_t len = (size_t)(p - scratch);
+  if (len >= absolute) {
+    memcpy(out, rec, absolute);
+    return absolute;
+  }
+  memcpy(out, scratch, len);
+  return len;
+}
+
+/**
+ * @brief Makes an absolute record the reference of its channel; a sync
+ * record clears every reference.
+ */
+void fdr_codecAccept(FdrCodecState &state, const uint8_t* rec) {
+  if (rec[0] == FDR_REC_SYNC) {
+    fdr_codecReset(state);
+    return;
+  }
+  const size_t slot = baroSlot(rec[0], false);
+  if (slot < FDR_CODEC_BARO_CHANNELS) {
+    FdrBaroRecord r;
+    memcpy(&r, rec, sizeof(r));
+    state.baro_dt_ms[slot] = state.have_baro[slot] ? r.t_ms - state.baro[slot].t_ms : 0;
+    state.baro[slot] = r;
+    state.have_baro[slot] = true;
+  } else if (rec[0] == FDR_REC_IMU) {
+    FdrImuRecord r;
+    memcpy(&r, rec, sizeof(r));
+    state.imu_dt_ms = state.have_imu ? r.t_ms - state.imu.t_ms : 0;
+    state.imu = r;
+    state.have_imu = true;
+  }
+}
+
+/**
+ * @brief Length of the record starting at `rec`; see fdr_codec.h.
+ */
+size_t fdr_recordLength(const uint8_t* rec, size_t avail) {
+  if (avail == 0) return 1;
+  const uint8_t tag = rec[0];
+  const size_t fixed = fdr_recordSize(tag);
+  if (fixed > 0) return fixed;
+
+  size_t varints;
+  if (baroSlot(tag, true) < FDR_CODEC_BARO_CHANNELS) {
+    varints = 2;
+  } else if ((tag & FDR_DELTA_TYPE_MASK) == FDR_REC_IMU_DELTA) {
+    varints = 6;
+  } else {
+    return 0;
+  }
+  if ((tag & FDR_DELTA_CODE_MASK) == FDR_DELTA_DT_EXPLICIT) varints++;
+
+  size_t pos = 1;
+  for (size_t i = 0; i < varints; i++) {
+    for (size_t n = 0;; n++) {
+      // Never longer than the absolute record (see fdr_format.h)
+      if (n == VARINT_MAX_BYTES || pos >= FDR_MAX_RECORD_SIZE) return 0;
+      if (pos >= avail) return avail + 1;
+      if (!(rec[pos++] & 0x80)) break;
+    }
+  }
+  return pos;
+}
+
+/**
+ * @brief Channel of a record tag.
+ */
+uint8_t fdr_recordChannel(uint8_t tag) {
+  if (fdr_recordSize(tag) > 0) return tag;
+  const size_t slot = baroSlot(tag, true);
+  if (slot < FDR_CODEC_BARO_CHANNELS) return BARO_LAYOUT_TYPES[slot];
+  return (tag & FDR_DELTA_TYPE_MASK) == FDR_REC_IMU_DELTA ? FDR_REC_IMU : 0;
+}
+
+/**
+ * @brief Decodes one complete record and updates the state; see fdr_codec.h.
+ */
+size_t fdr_decodeRecord(FdrCodecState &state, const uint8_t* rec, size_t len, uint8_t* out) {
+  const uint8_t tag = rec[0];
+  const size_t fixed = fdr_recordSize(tag);
+  if (fixed > 0) {
+    if (len < fixed) return 0;
+    memcpy(out, rec, fixed);
+    fdr_codecAccept(state, rec);
+    return fixed;
+  }
+
+  const uint8_t* p = rec + 1;
+  const uint8_t* end = rec + len;
+  uint32_t dt_ms;
+  uint32_t value;
+  const size_t slot = baroSlot(tag, true);
+  if (slot < FDR_CODEC_BARO_CHANNELS) {
+    if (!state.have_baro[slot]) return 0;
+    FdrBaroRecord r = state.baro[slot];
+    p = getTime(tag, p, end, state.baro_dt_ms[slot], dt_ms);
+    if (p == nullptr || (p = getVarint(p, end, value)) == nullptr) return 0;
+    r.pressure_q8 += (uint32_t)unzigzag(value);
+    if ((p = getVarint(p, end, value)) == nullptr) return 0;
+    r.temperature_cdeg = (int16_t)(r.temperature_cdeg + unzigzag(value));
+    r.t_ms += dt_ms;
+    memcpy(out, &r, sizeof(r));
+    fdr_codecAccept(state, out);
+    return sizeof(r);
+  }
+  if ((tag & FDR_DELTA_TYPE_MASK) == FDR_REC_IMU_DELTA) {
+    if (!state.have_imu) return 0;
+    FdrImuRecord r = state.imu;
+    p = getTime(tag, p, end, state.imu_dt_ms, dt_ms);
+    for (uint8_t axis = 0; axis < 3 && p != nullptr; axis++) {
+      p = getVarint(p, end, value);
+      r.accel[axis] = (int16_t)(r.accel[axis] + unzigzag(value));
+    }
+    for (uint8_t axis = 0; axis < 3 && p != nullptr; axis++) {
+      p = getVarint(p, end, value);
+      r.gyro[axis] = (int16_t)(r.gyro[axis] + unzigzag(value));
+    }
+    if (p == nullptr) return 0;
+    r.t_ms += dt_ms;
+    memcpy(out, &r, sizeof(r));
+    fdr_codecAccept(state, out);
+    return sizeof(r);
+  }
+  return 0;
+}
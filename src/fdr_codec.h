@@ -0,0 +1,92 @@
+/**
+ * @file fdr_codec.h
+ * @brief Delta encoding of FDR records
+ * @author slopez.tech
+ * @date 2025-11-30
+ *
+ * The writer task encodes every sample against the previous one of its
+ * channel before buffering it (fdr_encodeRecord(), then fdr_codecAccept()
+ * once the record is stored); readers walk the session with
+ * fdr_recordLength() and turn each record back into its absolute form with
+ * fdr_decodeRecord(). Both sides keep the same FdrCodecState, starting from
+ * fdr_codecReset() at the first record of the session or at a sync
+ * record. The record layout is described in fdr_format.h.
+ */
+
+#ifndef FDR_CODEC_H
+#define FDR_CODEC_H
+
+#include "fdr_format.h"
+
+/**
+ * @brief Channels stored in the FdrBaroRecord layout: barometer, raw
+ * barometer and altitude, in this order.
+ */
+static constexpr size_t FDR_CODEC_BARO_CHANNELS = 3;
+
+/**
+ * @brief Previous sample of each channel, the reference of the next delta.
+ */
+struct FdrCodecState {
+  FdrBaroRecord baro[FDR_CODEC_BARO_CHANNELS];
+  FdrImuRecord imu;
+  uint32_t baro_dt_ms[FDR_CODEC_BARO_CHANNELS]; ///< Interval between the last two samples
+  uint32_t imu_dt_ms;
+  bool have_baro[FDR_CODEC_BARO_CHANNELS];
+  bool have_imu;
+};
+
+/**
+ * @brief Clears the state for the start of a session.
+ */
+void fdr_codecReset(FdrCodecState &state);
+
+/**
+ * @brief Encodes an absolute record as a delta record, or copies it when
+ * that is not shorter. The state is not changed.
+ *
+ * @param rec Absolute FDR_REC_BARO, FDR_REC_BARO_RAW, FDR_REC_ALT or
+ *            FDR_REC_IMU record (any alignment); other records are copied
+ *            as they are.
+ * @param out Destination, at least FDR_MAX_RECORD_SIZE bytes.
+ * @return Length of the encoded record.
+ */
+size_t fdr_encodeRecord(const FdrCodecState &state, const uint8_t* rec, uint8_t* out);
+
+/**
+ * @brief Makes an absolute record the reference of its channel. Call for
+ * every record fdr_encodeRecord() encoded and that was stored. An
+ * FDR_REC_SYNC record resets the state, here and in fdr_decodeRecord().
+ */
+void fdr_codecAccept(FdrCodecState &state, const uint8_t* rec);
+
+/**
+ * @brief Length of the record starting at `rec`.
+ *
+ * @param avail Bytes available at `rec`.
+ * @return 0 for an invalid record. A value larger than `avail` means the
+ *         record is incomplete: at least that many bytes are needed.
+ */
+size_t fdr_recordLength(const uint8_t* rec, size_t avail);
+
+/**
+ * @brief Channel of a record tag.
+ *
+ * @return The absolute record type of the tag (FDR_REC_BARO for
+ *         FDR_REC_BARO_DELTA, etc.); 0 if unknown.
+ */
+uint8_t fdr_recordChannel(uint8_t tag);
+
+/**
+ * @brief Decodes one complete record and updates the state.
+ *
+ * @param rec Record of `len` bytes, as measured by fdr_recordLength().
+ * @param out Absolute record (FdrBaroRecord or a record of the same
+ *            layout, FdrImuRecord or FdrCommitRecord), at least
+ *            FDR_MAX_RECORD_SIZE bytes.
+ * @return Size of the absolute record in `out`; 0 if the record is invalid
+ *         or a delta without a previous sample.
+ */
+size_t fdr_decodeRecord(FdrCodecState &state, const uint8_t* rec, size_t len, uint8_t* out);
+
+#endif // FDR_CODEC_H
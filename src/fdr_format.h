@@ -0,0 +1,309 @@
+/**
+ * @file fdr_format.h
+ * @brief On-flash binary record format used by the FDR module
+ * @author slopez.tech
+ * @date 2025-11-30
+ *
+ * A recording is a single FdrFileHeader followed by a sequence of tagged
+ * records. The first byte of every record is its FdrRecordType, which fixes
+ * the record size, so channels with different rates can be interleaved in
+ * one file. All multi-byte fields are little-endian (native on ESP32).
+ * Values are stored in fixed point so the sampling path never formats text;
+ * conversion to CSV happens at download time.
+ *
+ * Since version 3 the record stream is a journal: every commit appends an
+ * FdrCommitRecord carrying the CRC-32 of all bytes written since the
+ * previous commit record (or since the header). After a power loss only
+ * the data up to the last commit record that checks out is kept.
+ *
+ * Since version 4 most samples are stored as delta records (see
+ * FDR_REC_BARO_DELTA), a few bytes each, encoded and decoded by fdr_codec.h.
+ *
+ * Since version 5 the barometer channel holds the output of the session's
+ * pressure filter chain (FdrFileHeader::filter); the unfiltered samples
+ * can be recorded alongside as FDR_REC_BARO_RAW.
+ *
+ * Since version 6 the barometric altitude and vertical speed computed on
+ * the device are recorded as a channel of their own (FDR_REC_ALT), with the
+ * launch, apogee and landing events flagged as they happen (FDR_REC_EVENT).
+ *
+ * Since version 7 the stream has sync points (FDR_REC_SYNC) where the delta
+ * references restart, so it can be decoded from any of them, and a closed
+ * session ends with a time index of those points (FDR_REC_TIME_INDEX).
+ */
+
+#ifndef FDR_FORMAT_H
+#define FDR_FORMAT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief File magic, the bytes "FDR1" when read from flash.
+ */
+static constexpr uint32_t FDR_FORMAT_MAGIC = 0x31524446;
+
+/**
+ * @brief Current version of the record layout.
+ *
+ * 2: tagged multi-channel records (barometer + IMU).
+ * 3: checksummed commit records (FdrCommitRecord).
+ * 4: variable-length delta records.
+ * 5: filter chain in the header, raw barometer channel.
+ * 6: altitude channel and flight events.
+ * 7: sync points and the time index.
+ */
+static constexpr uint16_t FDR_FORMAT_VERSION = 7;
+
+/**
+ * @brief Oldest version that can still be read; it only lacks commit and
+ * delta records.
+ */
+static constexpr uint16_t FDR_FORMAT_MIN_VERSION = 2;
+
+/**
+ * @brief Channel bits for FdrFileHeader::channels.
+ */
+static constexpr uint16_t FDR_CHANNEL_BARO = 1 << 0;
+static constexpr uint16_t FDR_CHANNEL_IMU = 1 << 1;
+static constexpr uint16_t FDR_CHANNEL_BARO_RAW = 1 << 2;
+static constexpr uint16_t FDR_CHANNEL_ALT = 1 << 3; ///< FDR_REC_ALT and FDR_REC_EVENT
+
+/**
+ * @brief Header written once at the start of every recording.
+ */
+struct __attribute__((packed)) FdrFileHeader {
+  uint32_t magic;                ///< FDR_FORMAT_MAGIC
+  uint16_t version;              ///< FDR_FORMAT_VERSION
+  uint16_t header_size;          ///< sizeof(FdrFileHeader), lets readers skip newer fields
+  uint16_t channels;             ///< FDR_CHANNEL_* bits recorded in this session
+  uint16_t sample_rate_hz;       ///< Barometer rate rounded to whole Hz
+  uint32_t sample_rate_mhz;      ///< Exact barometer rate in millihertz
+  uint16_t imu_rate_hz;          ///< IMU output data rate (0 if not recorded)
+  uint16_t accel_lsb_per_g;      ///< Accelerometer scale of FdrImuRecord::accel
+  uint16_t gyro_lsb_per_dps_x10; ///< Gyroscope scale of FdrImuRecord::gyro, times 10
+  uint16_t filter;               ///< Pressure filter stage kinds, 4 bits each, first in the low bits (0 before v5)
+};
+
+/**
+ * @brief Record type tag, the first byte of every record.
+ */
+enum FdrRecordType : uint8_t {
+  FDR_REC_BARO = 1,
+  FDR_REC_IMU = 2,
+  FDR_REC_COMMIT = 3,
+  FDR_REC_BARO_RAW = 4,          ///< FdrBaroRecord layout, unfiltered pressure
+  FDR_REC_ALT = 5,
+  FDR_REC_EVENT = 6,
+  FDR_REC_SYNC = 7,
+  FDR_REC_TIME_INDEX = 8,
+  FDR_REC_BARO_DELTA = 0x80,     ///< 0x80-0x8F, low nibble is the time code
+  FDR_REC_IMU_DELTA = 0x90,      ///< 0x90-0x9F, low nibble is the time code
+  FDR_REC_BARO_RAW_DELTA = 0xA0, ///< 0xA0-0xAF, low nibble is the time code
+  FDR_REC_ALT_DELTA = 0xB0,      ///< 0xB0-0xBF, low nibble is the time code
+};
+
+/**
+ * @brief Delta records.
+ *
+ * A delta record stores a sample as the difference to the previous sample
+ * of the same channel in the session. After the tag come zigzag-encoded
+ * LEB128 varints: the pressure_q8 and temperature_cdeg differences for the
+ * barometer channels, the altitude_cm and vspeed_cms differences for the
+ * altitude, the accel[0..2] and gyro[0..2] differences for the IMU, all
+ * modulo the field width.
+ *
+ * The low nibble of the tag predicts the timestamp: codes 0-14 mean the
+ * interval to the previous sample is the previous interval plus
+ * (code - FDR_DELTA_DT_BIAS); code FDR_DELTA_DT_EXPLICIT means a varint
+ * with the interval follows the tag. The first sample of a channel, and
+ * any sample whose delta record would not be shorter, is stored as an
+ * absolute record instead, so a delta record is never longer than the
+ * absolute record of its channel.
+ */
+static constexpr uint8_t FDR_DELTA_TYPE_MASK = 0xF0;
+static constexpr uint8_t FDR_DELTA_CODE_MASK = 0x0F;
+static constexpr uint8_t FDR_DELTA_DT_BIAS = 7;
+static constexpr uint8_t FDR_DELTA_DT_EXPLICIT = 15;
+
+/**
+ * @brief One barometer sample.
+ */
+struct __attribute__((packed)) FdrBaroRecord {
+  uint8_t type;             ///< FDR_REC_BARO or FDR_REC_BARO_RAW
+  uint32_t t_ms;            ///< Milliseconds since the session started
+  uint32_t pressure_q8;     ///< Pressure in Pa, Q24.8 fixed point
+  int16_t temperature_cdeg; ///< Temperature in 0.01 °C
+};
+
+/**
+ * @brief One accelerometer + gyroscope sample, raw sensor counts.
+ */
+struct __attribute__((packed)) FdrImuRecord {
+  uint8_t type;             ///< FDR_REC_IMU
+  uint32_t t_ms;            ///< Milliseconds since the session started
+  int16_t accel[3];         ///< X/Y/Z, FdrFileHeader::accel_lsb_per_g per g
+  int16_t gyro[3];          ///< X/Y/Z, FdrFileHeader::gyro_lsb_per_dps_x10 / 10 per °/s
+};
+
+/**
+ * @brief Barometric altitude and vertical speed, as computed by the
+ * barometer module. Same layout as FdrBaroRecord, and delta-encoded the
+ * same way.
+ */
+struct __attribute__((packed)) FdrAltRecord {
+  uint8_t type;             ///< FDR_REC_ALT
+  uint32_t t_ms;            ///< Milliseconds since the session started
+  int32_t altitude_cm;      ///< Above the reference (ground) pressure
+  int16_t vspeed_cms;       ///< Vertical speed in cm/s, saturated at ±327.67 m/s
+};
+
+/**
+ * @brief Flight events, FdrEventRecord::event.
+ */
+enum FdrFlightEvent : uint8_t {
+  FDR_EVENT_LAUNCH = 1,
+  FDR_EVENT_APOGEE = 2,
+  FDR_EVENT_LANDING = 3,
+  FDR_EVENT_TRIGGER = 4,    ///< An armed session was triggered (see fdr.h)
+};
+
+/**
+ * @brief A flight event, written when it is detected. Its timestamp is
+ * when it happened (for the apogee, the highest sample), so it can be a
+ * little older than the records around it. Never delta-encoded.
+ */
+struct __attribute__((packed)) FdrEventRecord {
+  uint8_t type;             ///< FDR_REC_EVENT
+  uint32_t t_ms;            ///< Milliseconds since the session started
+  int32_t altitude_cm;      ///< Altitude at the event
+  uint8_t event;            ///< FdrFlightEvent
+  uint8_t reserved;         ///< 0; keeps the FdrBaroRecord size
+};
+
+/**
+ * @brief Journal commit marker.
+ *
+ * `crc` is esp_rom_crc32_le(0, ...) over the `length` bytes between the end
+ * of the previous commit record (or of the header) and the start of this one.
+ */
+struct __attribute__((packed)) FdrCommitRecord {
+  uint8_t type;             ///< FDR_REC_COMMIT
+  uint32_t t_ms;            ///< Timestamp of the newest record committed
+  uint32_t sequence;        ///< 1 for the first commit of a session, then increasing
+  uint32_t length;          ///< Bytes covered by this commit
+  uint32_t crc;             ///< CRC-32 of those bytes
+};
+
+/**
+ * @brief Sync point: the delta references of every channel restart here,
+ * as at the start of the session, so decoding can begin at this record
+ * with a fresh FdrCodecState. The writer inserts one about every
+ * FDR_SYNC_INTERVAL_BYTES of session data.
+ */
+struct __attribute__((packed)) FdrSyncRecord {
+  uint8_t type;             ///< FDR_REC_SYNC
+  uint32_t t_ms;            ///< Newest timestamp of the records before it
+};
+
+/**
+ * @brief Session data between two sync points, in bytes. One absolute
+ * record per channel after each point costs about 1% of the session size.
+ */
+static constexpr uint32_t FDR_SYNC_INTERVAL_BYTES = 2048;
+
+/**
+ * @brief One entry of the time index: a sync point and its position.
+ *
+ * When a session is closed, the index of its sync points (as many as
+ * FDR_TIME_INDEX_MAX_ENTRIES, evenly thinned out on long sessions)
+ * is appended as consecutive FDR_REC_TIME_INDEX records, in stream order,
+ * and committed on their own: the last commit record of the session
+ * covers exactly the index. No record before the sync point is newer than
+ * `t_ms`, so a reader looking for time T starts at the last entry with
+ * `t_ms` < T.
+ */
+struct __attribute__((packed)) FdrTimeIndexRecord {
+  uint8_t type;             ///< FDR_REC_TIME_INDEX
+  uint32_t t_ms;            ///< FdrSyncRecord::t_ms of the sync point
+  uint32_t offset;          ///< Session offset of the FdrSyncRecord
+};
+
+static constexpr size_t FDR_TIME_INDEX_MAX_ENTRIES = 256;
+
+static_assert(sizeof(FdrFileHeader) == 24, "FdrFileHeader layout changed");
+static_assert(sizeof(FdrBaroRecord) == 11, "FdrBaroRecord layout changed");
+static_assert(sizeof(FdrImuRecord) == 17, "FdrImuRecord layout changed");
+static_assert(sizeof(FdrAltRecord) == sizeof(FdrBaroRecord), "FdrAltRecord must match FdrBaroRecord");
+static_assert(sizeof(FdrEventRecord) == sizeof(FdrBaroRecord), "FdrEventRecord must match FdrBaroRecord");
+static_assert(sizeof(FdrCommitRecord) == 17, "FdrCommitRecord layout changed");
+static_assert(sizeof(FdrSyncRecord) == 5, "FdrSyncRecord layout changed");
+static_assert(sizeof(FdrTimeIndexRecord) == 9, "FdrTimeIndexRecord layout changed");
+
+/**
+ * @brief Size of the largest record type.
+ */
+static constexpr size_t FDR_MAX_RECORD_SIZE = sizeof(FdrImuRecord);
+
+/**
+ * @brief Size in bytes of a fixed-size record given its type tag.
+ *
+ * @return 0 for an unknown type or a delta record; fdr_recordLength()
+ *         measures those.
+ */
+static inline size_t fdr_recordSize(uint8_t type) {
+  switch (type) {
+    case FDR_REC_BARO:
+    case FDR_REC_BARO_RAW: return sizeof(FdrBaroRecord);
+    case FDR_REC_ALT: return sizeof(FdrAltRecord);
+    case FDR_REC_EVENT: return sizeof(FdrEventRecord);
+    case FDR_REC_IMU: return sizeof(FdrImuRecord);
+    case FDR_REC_COMMIT: return sizeof(FdrCommitRecord);
+    case FDR_REC_SYNC: return sizeof(FdrSyncRecord);
+    case FDR_REC_TIME_INDEX: return sizeof(FdrTimeIndexRecord);
+    default: return 0;
+  }
+}
+
+/**
+ * @brief Session index file magic, the bytes "FDRI" when read from flash.
+ *
+ * The index is an FdrIndexHeader followed by one fixed-size FdrIndexEntry
+ * per stored session, oldest first. It summarizes every session so listing
+ * them never opens a data file.
+ */
+static constexpr uint32_t FDR_INDEX_MAGIC = 0x49524446;
+static constexpr uint16_t FDR_INDEX_VERSION = 1;
+
+/**
+ * @brief FdrIndexEntry::flags bits.
+ */
+static constexpr uint16_t FDR_SESSION_OPEN = 1 << 0;      ///< Still recording, or not closed cleanly
+static constexpr uint16_t FDR_SESSION_RECOVERED = 1 << 1; ///< Closed by the recovery scan after a reset
+static constexpr uint16_t FDR_SESSION_RESUMED = 1 << 2;   ///< Continues a session cut off by a reset
+
+struct __attribute__((packed)) FdrIndexHeader {
+  uint32_t magic;      ///< FDR_INDEX_MAGIC
+  uint16_t version;    ///< FDR_INDEX_VERSION
+  uint16_t entry_size; ///< sizeof(FdrIndexEntry)
+  uint32_t count;      ///< Number of entries that follow
+};
+
+struct __attribute__((packed)) FdrIndexEntry {
+  uint32_t session_id;      ///< Data file number, increasing
+  uint32_t start_uptime_ms; ///< millis() at start (no RTC on board)
+  uint32_t rate_mhz;        ///< Barometer rate in millihertz
+  uint16_t imu_rate_hz;     ///< IMU rate, 0 if not recorded
+  uint16_t flags;           ///< FDR_SESSION_* bits
+  uint32_t duration_ms;     ///< Timestamp of the last record written
+  uint32_t baro_records;
+  uint32_t imu_records;
+  uint32_t bytes;           ///< Valid data length including the header
+  uint32_t pressure_min_q8; ///< Pa, Q24.8; UINT32_MAX if no barometer record
+  uint32_t pressure_max_q8; ///< Pa, Q24.8; 0 if no barometer record
+};
+
+static_assert(sizeof(FdrIndexHeader) == 12, "FdrIndexHeader layout changed");
+static_assert(sizeof(FdrIndexEntry) == 40, "FdrIndexEntry layout changed");
+
+#endif // FDR_FORMAT_H
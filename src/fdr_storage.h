@@ -0,0 +1,136 @@
+/**
+ * @file fdr_storage.h
+ * @brief Storage backends for FDR session data
+ * @author slopez.tech
+ * @date 2025-11-30
+ *
+ * The FDR module stores each session as an append-only byte stream plus one
+ * small index blob. Backends implement that on top of a file system
+ * (LittleFS or SPIFFS) or directly on a raw flash partition. The backend is
+ * chosen at build time with FDR_STORAGE_BACKEND.
+ *
+ * Backends are not thread safe; the FDR module serializes every call with
+ * its own lock.
+ */
+
+#ifndef FDR_STORAGE_H
+#define FDR_STORAGE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Values for FDR_STORAGE_BACKEND
+#define FDR_STORAGE_SPIFFS 1
+#define FDR_STORAGE_LITTLEFS 2
+#define FDR_STORAGE_RAW 3
+
+#ifndef FDR_STORAGE_BACKEND
+#define FDR_STORAGE_BACKEND FDR_STORAGE_LITTLEFS
+#endif
+
+/**
+ * @brief Erase activity of backends that manage flash sectors themselves.
+ */
+struct FdrEraseStats {
+  uint32_t erases;   ///< Sectors erased
+  uint32_t max_us;   ///< Slowest single sector erase
+  uint32_t stalls;   ///< Erases forced inside append() because erase-ahead fell behind
+};
+
+/**
+ * @brief Session storage backend.
+ */
+class FdrStorage {
+ public:
+  /** @brief Short backend name for diagnostics. */
+  virtual const char* name() const = 0;
+
+  /**
+   * @brief Mounts (formatting if needed) and loads backend metadata.
+   *
+   * @return true if the storage is usable.
+   */
+  virtual bool mount() = 0;
+
+  /**
+   * @brief Reads the index blob last stored with saveIndex().
+   *
+   * @param out Destination buffer.
+   * @param max Capacity of `out`.
+   * @return Number of bytes read (0 if there is no index).
+   */
+  virtual size_t loadIndex(uint8_t* out, size_t max) = 0;
+
+  /**
+   * @brief Replaces the index blob; a failed update keeps the previous one.
+   */
+  virtual bool saveIndex(const uint8_t* data, size_t len) = 0;
+
+  /**
+   * @brief Creates an empty session and makes it the append target.
+   */
+  virtual bool create(uint32_t id) = 0;
+
+  /**
+   * @brief Appends to the session opened with create().
+   *
+   * @return Number of bytes stored; less than `len` if storage is full or
+   *         failing.
+   */
+  virtual size_t append(const uint8_t* data, size_t len) = 0;
+
+  /**
+   * @brief Makes appended data durable and visible to read().
+   */
+  virtual bool sync() = 0;
+
+  /**
+   * @brief Syncs and closes the append target.
+   */
+  virtual void close() = 0;
+
+  /**
+   * @brief Deletes a stored session.
+   */
+  virtual bool remove(uint32_t id) = 0;
+
+  /**
+   * @brief Size in bytes of a stored session (0 if unknown).
+   */
+  virtual uint32_t size(uint32_t id) = 0;
+
+  /**
+   * @brief Positional read from a stored session.
+   *
+   * @return Number of bytes read; 0 at the end of the session.
+   */
+  virtual size_t read(uint32_t id, uint32_t offset, uint8_t* out, size_t len) = 0;
+
+  /**
+   * @brief Releases any handle cached by read().
+   */
+  virtual void endRead() {}
+
+  /**
+   * @brief Background housekeeping, called by the writer task when it is
+   * idle; each call does a bounded amount of work.
+   */
+  virtual void maintain() {}
+
+  /** @brief Capacity and space left for new data, in bytes. */
+  virtual uint32_t totalBytes() = 0;
+  virtual uint32_t freeBytes() = 0;
+
+  /** @brief Erase counters (zero for file-system backends). */
+  virtual void getEraseStats(FdrEraseStats &stats) { stats = {}; }
+
+ protected:
+  ~FdrStorage() = default;
+};
+
+/**
+ * @brief The backend selected by FDR_STORAGE_BACKEND.
+ */
+FdrStorage &fdr_storage();
+
+#endif // FDR_STORAGE_H
@@ -0,0 +1,193 @@
+/**
+ * @file fdr_storage_fs.cpp
+ * @brief File-system storage backend (LittleFS or SPIFFS) for FDR sessions
+ * @author slopez.tech
+ * @date 2025-11-30
+ *
+ * Each session is a file named after its ID; the index is a separate file
+ * replaced through a temporary file and a rename.
+ */
+
+#include "fdr_storage.h"
+#include "logger.h"
+
+#if FDR_STORAGE_BACKEND == FDR_STORAGE_LITTLEFS || FDR_STORAGE_BACKEND == FDR_STORAGE_SPIFFS
+
+#include <Arduino.h>
+#include <FS.h>
+#if FDR_STORAGE_BACKEND == FDR_STORAGE_LITTLEFS
+#include <LittleFS.h>
+#else
+#include <SPIFFS.h>
+#endif
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+/**
+ * @brief printf format of the per-session data file paths.
+ */
+static constexpr const char* SESSION_PATH_FORMAT = "/fdr_%05u.bin";
+static constexpr size_t SESSION_PATH_LEN = 20;
+
+/**
+ * @brief Index file, and the temporary name it is written under before
+ * being renamed into place.
+ */
+static constexpr const char* INDEX_PATH = "/fdr_index.bin";
+static constexpr const char* INDEX_TMP_PATH = "/fdr_index.tmp";
+
+// ============================================================================
+// Backend
+// ============================================================================
+
+/**
+ * @brief Sessions as files on an Arduino file system.
+ *
+ * @tparam FsT fs::LittleFSFS or fs::SPIFFSFS.
+ */
+template <typename FsT>
+class FsStorage : public FdrStorage {
+ public:
+  FsStorage(FsT &fs, const char* name) : fs_(fs), name_(name) {}
+
+  const char* name() const override { return name_; }
+
+  bool mount() override {
+    if (fs_.begin(false)) return true;
+    LOG_ERROR("FDR: %s mount failed, attempting format...", name_);
+    if (fs_.begin(true)) {
+      LOG_INFO("FDR: %s formatted and mounted", name_);
+      return true;
+    }
+    LOG_ERROR("FDR: %s format/mount failed -- check partition table", name_);
+    return false;
+  }
+
+  size_t loadIndex(uint8_t* out, size_t max) override {
+    File f = fs_.open(INDEX_PATH, FILE_READ);
+    if (!f) return 0;
+    const size_t len = f.read(out, max);
+    f.close();
+    return len;
+  }
+
+  bool saveIndex(const uint8_t* data, size_t len) override {
+    File f = fs_.open(INDEX_TMP_PATH, FILE_WRITE);
+    if (!f) return false;
+    const bool ok = f.write(data, len) == len;
+    f.close();
+    if (!ok) {
+      fs_.remove(INDEX_TMP_PATH);
+      return false;
+    }
+    // LittleFS replaces the target atomically; SPIFFS needs it gone first
+    if (fs_.rename(INDEX_TMP_PATH, INDEX_PATH)) return true;
+    fs_.remove(INDEX_PATH);
+    return fs_.rename(INDEX_TMP_PATH, INDEX_PATH);
+  }
+
+  bool create(uint32_t id) override {
+    close();
+    char path[SESSION_PATH_LEN];
+    sessionPath(id, path);
+    write_file_ = fs_.open(path, FILE_WRITE);
+    if (!write_file_) return false;
+    write_id_ = id;
+    write_size_ = 0;
+    return true;
+  }
+
+  size_t append(const uint8_t* data, size_t len) override {
+    if (!write_file_) {
+      // Reopen after a failed write closed the handle
+      if (write_id_ == 0) return 0;
+      char path[SESSION_PATH_LEN];
+      sessionPath(write_id_, path);
+      write_file_ = fs_.open(path, FILE_APPEND);
+      if (!write_file_) return 0;
+    }
+    const size_t wrote = write_file_.write(data, len);
+    write_size_ += (uint32_t)wrote;
+    return wrote;
+  }
+
+  bool sync() override {
+    if (write_file_) write_file_.flush();
+    return (bool)write_file_;
+  }
+
+  void close() override {
+    if (write_file_) write_file_.close();
+    write_id_ = 0;
+  }
+
+  bool remove(uint32_t id) override {
+    if (id == read_id_) endRead();
+    char path[SESSION_PATH_LEN];
+    sessionPath(id, path);
+    return fs_.remove(path);
+  }
+
+  uint32_t size(uint32_t id) override {
+    if (id == write_id_) return write_size_;
+    if (!openForRead(id)) return 0;
+    return (uint32_t)read_file_.size();
+  }
+
+  size_t read(uint32_t id, uint32_t offset, uint8_t* out, size_t len) override {
+    if (!openForRead(id)) return 0;
+    if (read_file_.position() != offset && !read_file_.seek(offset)) return 0;
+    return read_file_.read(out, len);
+  }
+
+  void endRead() override {
+    if (read_file_) read_file_.close();
+    read_id_ = 0;
+  }
+
+  uint32_t totalBytes() override { return (uint32_t)fs_.totalBytes(); }
+
+  uint32_t freeBytes() override {
+    const size_t total = fs_.totalBytes();
+    const size_t used = fs_.usedBytes();
+    return used < total ? (uint32_t)(total - used) : 0;
+  }
+
+ private:
+  static void sessionPath(uint32_t id, char* out) {
+    snprintf(out, SESSION_PATH_LEN, SESSION_PATH_FORMAT, (unsigned)id);
+  }
+
+  bool openForRead(uint32_t id) {
+    if (read_file_ && id == read_id_) return true;
+    endRead();
+    char path[SESSION_PATH_LEN];
+    sessionPath(id, path);
+    read_file_ = fs_.open(path, FILE_READ);
+    if (!read_file_) return false;
+    read_id_ = id;
+    return true;
+  }
+
+  FsT &fs_;
+  const char* name_;
+  File write_file_;
+  uint32_t write_id_ = 0;
+  uint32_t write_size_ = 0;
+  File read_file_;
+  uint32_t read_id_ = 0;
+};
+
+#if FDR_STORAGE_BACKEND == FDR_STORAGE_LITTLEFS
+static FsStorage<fs::LittleFSFS> storage(LittleFS, "littlefs");
+#else
+static FsStorage<fs::SPIFFSFS> storage(SPIFFS, "spiffs");
+#endif
+
+FdrStorage &fdr_storage() {
+  return storage;
+}
+
+#endif // FDR_STORAGE_BACKEND is a file system
@@ -0,0 +1,445 @@
+/**
+ * @file fdr_storage_raw.cpp
+ * @brief Raw flash partition append log backend for FDR sessions
+ * @author slopez.tech
+ * @date 2025-11-30
+ *
+ * Uses a dedicated data partition (label "fdrlog", see
+ * partitions_rawlog.csv) without any file system:
+ *
+ * - Sectors 0 and 1 are two index slots written alternately. A slot holds
+ *   the extent table (where each session lives) and the FDR index blob,
+ *   protected by a CRC; its header is written last, so an interrupted
+ *   update leaves the other slot as the valid one.
+ * - The remaining sectors are a circular log. Each session starts on a
+ *   sector boundary and grows contiguously; new sessions reuse the sectors
+ *   of the oldest ones once those are removed.
+ *
+ * Flash programming never waits on garbage collection or metadata updates:
+ * an append is a plain write into already-erased sectors. Sectors are
+ * erased ahead of the write pointer from maintain(), one per call, when the
+ * writer task is otherwise idle; append() only erases itself if erase-ahead
+ * fell behind, and counts that as a stall.
+ */
+
+#include "fdr_storage.h"
+#include "logger.h"
+
+#if FDR_STORAGE_BACKEND == FDR_STORAGE_RAW
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include <esp_rom_crc.h>
+#include "fdr.h"
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+/**
+ * @brief Label of the log partition in the partition table.
+ */
+static constexpr const char* PARTITION_LABEL = "fdrlog";
+
+/**
+ * @brief Flash erase unit.
+ */
+static constexpr uint32_t SECTOR_SIZE = 4096;
+
+/**
+ * @brief Sectors reserved for the two index slots at the partition start.
+ */
+static constexpr uint32_t INDEX_SLOTS = 2;
+
+/**
+ * @brief Minimum number of log sectors for the partition to be usable.
+ */
+static constexpr uint32_t MIN_DATA_SECTORS = 8;
+
+/**
+ * @brief Sectors erased synchronously when a session is created (session
+ * start is not time critical), and the distance maintain() keeps erased
+ * ahead of the write pointer afterwards. 16 KB is about 4 s of barometer
+ * and IMU data.
+ */
+static constexpr uint32_t PREALLOCATE_SECTORS = 4;
+static constexpr uint32_t ERASE_AHEAD_SECTORS = 4;
+
+/**
+ * @brief Read size used when scanning for the end of an unclosed session.
+ */
+static constexpr size_t SCAN_CHUNK = 256;
+
+/**
+ * @brief Index slot magic, the bytes "FDRL".
+ */
+static constexpr uint32_t SLOT_MAGIC = 0x4C524446;
+
+/**
+ * @brief Extent::flags bit: session was still being written when the slot
+ * was saved.
+ */
+static constexpr uint32_t EXTENT_OPEN = 1;
+
+struct __attribute__((packed)) SlotHeader {
+  uint32_t magic;        ///< SLOT_MAGIC
+  uint32_t sequence;     ///< Incremented on every save; highest valid slot wins
+  uint16_t extent_count;
+  uint16_t index_len;    ///< Bytes of FDR index blob after the extent table
+  uint32_t head_sector;  ///< Next free log sector when there are no extents
+  uint32_t crc;          ///< CRC-32 of the extent table and index blob
+};
+
+struct __attribute__((packed)) Extent {
+  uint32_t id;           ///< Session ID
+  uint32_t start_sector; ///< First log sector
+  uint32_t length;       ///< Bytes written
+  uint32_t flags;        ///< EXTENT_* bits
+};
+
+static constexpr size_t MAX_EXTENTS = FDR_MAX_SESSIONS;
+static constexpr size_t MAX_INDEX_LEN =
+  SECTOR_SIZE - sizeof(SlotHeader) - MAX_EXTENTS * sizeof(Extent);
+
+// ============================================================================
+// Backend
+// ============================================================================
+
+/**
+ * @brief Sessions as extents of a circular append log on a raw partition.
+ */
+class RawLogStorage : public FdrStorage {
+ public:
+  const char* name() const override { return "rawlog"; }
+
+  bool mount() override {
+    part_ = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                     PARTITION_LABEL);
+    if (part_ == nullptr) {
+      LOG_ERROR("FDR: partition '%s' not found -- check partition table", PARTITION_LABEL);
+      return false;
+    }
+    const uint32_t sectors = part_->size / SECTOR_SIZE;
+    if (sectors < INDEX_SLOTS + MIN_DATA_SECTORS) {
+      LOG_ERROR("FDR: partition '%s' too small", PARTITION_LABEL);
+      part_ = nullptr;
+      return false;
+    }
+    data_sectors_ = sectors - INDEX_SLOTS;
+
+    // Pick the valid slot with the highest sequence number
+    bool found = false;
+    for (uint8_t slot = 0; slot < INDEX_SLOTS; slot++) {
+      SlotHeader header;
+      if (!loadSlot(slot, header)) continue;
+      if (found && header.sequence <= sequence_) continue;
+      found = true;
+      active_slot_ = slot;
+      sequence_ = header.sequence;
+    }
+    extent_count_ = 0;
+    index_len_ = 0;
+    head_sector_ = 0;
+    if (found) {
+      SlotHeader header;
+      loadSlot(active_slot_, header);
+      readSlotBody(active_slot_, header);
+    }
+
+    // A session that was open at reset has a stale length; find its end
+    for (size_t i = 0; i < extent_count_; i++) {
+      if (!(extents_[i].flags & EXTENT_OPEN)) continue;
+      recoverLength(extents_[i]);
+      extents_[i].flags &= ~EXTENT_OPEN;
+      LOG_WARN("FDR: recovered unclosed session %u (%u bytes)",
+               (unsigned)extents_[i].id, (unsigned)extents_[i].length);
+    }
+
+    LOG_INFO("FDR: raw log mounted, %u KB, %u sessions",
+             (unsigned)(data_sectors_ * SECTOR_SIZE / 1024), (unsigned)extent_count_);
+    return true;
+  }
+
+  size_t loadIndex(uint8_t* out, size_t max) override {
+    const size_t len = index_len_ < max ? index_len_ : max;
+    memcpy(out, index_, len);
+    return len;
+  }
+
+  bool saveIndex(const uint8_t* data, size_t len) override {
+    if (part_ == nullptr || len > MAX_INDEX_LEN) return false;
+    memcpy(index_, data, len);
+    index_len_ = len;
+    return writeSlot();
+  }
+
+  bool create(uint32_t id) override {
+    if (part_ == nullptr) return false;
+    close();
+    if (extent_count_ >= MAX_EXTENTS) return false;
+
+    Extent &extent = extents_[extent_count_++];
+    extent.id = id;
+    extent.start_sector = headSector();
+    extent.length = 0;
+    extent.flags = EXTENT_OPEN;
+    writing_ = true;
+    erased_bytes_ = 0;
+
+    for (uint32_t i = 0; i < PREALLOCATE_SECTORS; i++) {
+      if (!eraseNext()) break;
+    }
+    if (erased_bytes_ < 2 * SECTOR_SIZE) {
+      // Not even one sector plus the erased guard sector is free
+      extent_count_--;
+      writing_ = false;
+      return false;
+    }
+    return true;
+  }
+
+  size_t append(const uint8_t* data, size_t len) override {
+    if (!writing_) return 0;
+    Extent &extent = extents_[extent_count_ - 1];
+
+    // Keep one erased sector beyond the data at all times, so the end of
+    // an unclosed session can be found after a reset
+    while (erased_bytes_ < extent.length + len + SECTOR_SIZE) {
+      if (!eraseNext()) break;
+      erase_stats_.stalls++;
+    }
+    const uint32_t limit = erased_bytes_ > SECTOR_SIZE ? erased_bytes_ - SECTOR_SIZE : 0;
+    if (limit <= extent.length) return 0;
+    const size_t n = len < limit - extent.length ? len : limit - extent.length;
+    if (!transfer(extent, extent.length, (uint8_t*)data, n, true)) return 0;
+    extent.length += (uint32_t)n;
+    return n;
+  }
+
+  bool sync() override {
+    // Programmed data is already durable; nothing is cached
+    return writing_;
+  }
+
+  void close() override {
+    if (!writing_) return;
+    extents_[extent_count_ - 1].flags &= ~EXTENT_OPEN;
+    writing_ = false;
+  }
+
+  bool remove(uint32_t id) override {
+    for (size_t i = 0; i < extent_count_; i++) {
+      if (extents_[i].id != id) continue;
+      if (extent_count_ == 1) head_sector_ = headSector();
+      if (writing_ && i == extent_count_ - 1) writing_ = false;
+      memmove(extents_ + i, extents_ + i + 1, (extent_count_ - i - 1) * sizeof(Extent));
+      extent_count_--;
+      return true;
+    }
+    return false;
+  }
+
+  uint32_t size(uint32_t id) override {
+    const Extent* extent = find(id);
+    return extent ? extent->length : 0;
+  }
+
+  size_t read(uint32_t id, uint32_t offset, uint8_t* out, size_t len) override {
+    const Extent* extent = find(id);
+    if (extent == nullptr || offset >= extent->length) return 0;
+    const size_t n = len < extent->length - offset ? len : extent->length - offset;
+    return transfer(*extent, offset, out, n, false) ? n : 0;
+  }
+
+  void maintain() override {
+    if (!writing_) return;
+    const Extent &extent = extents_[extent_count_ - 1];
+    if (erased_bytes_ - extent.length < (ERASE_AHEAD_SECTORS + 1) * SECTOR_SIZE) {
+      eraseNext();
+    }
+  }
+
+  uint32_t totalBytes() override { return data_sectors_ * SECTOR_SIZE; }
+
+  uint32_t freeBytes() override {
+    if (part_ == nullptr) return 0;
+    uint32_t bytes = freeSectors() * SECTOR_SIZE;
+    if (writing_) {
+      const Extent &extent = extents_[extent_count_ - 1];
+      if (erased_bytes_ > extent.length + SECTOR_SIZE) {
+        bytes += erased_bytes_ - extent.length - SECTOR_SIZE;
+      }
+    }
+    return bytes;
+  }
+
+  void getEraseStats(FdrEraseStats &stats) override { stats = erase_stats_; }
+
+ private:
+  /** @brief Sectors owned by an extent (erased ones for the append target). */
+  uint32_t ownedSectors(size_t i) const {
+    if (writing_ && i == extent_count_ - 1) return erased_bytes_ / SECTOR_SIZE;
+    return (extents_[i].length + SECTOR_SIZE - 1) / SECTOR_SIZE;
+  }
+
+  /** @brief First log sector after the newest extent. */
+  uint32_t headSector() const {
+    if (extent_count_ == 0) return head_sector_;
+    const size_t last = extent_count_ - 1;
+    return (extents_[last].start_sector + ownedSectors(last)) % data_sectors_;
+  }
+
+  /** @brief Sectors between the head and the oldest extent holding data. */
+  uint32_t freeSectors() const {
+    for (size_t i = 0; i < extent_count_; i++) {
+      if (ownedSectors(i) == 0) continue;
+      const uint32_t head = headSector();
+      return (extents_[i].start_sector + data_sectors_ - head) % data_sectors_;
+    }
+    return data_sectors_;
+  }
+
+  /** @brief Erases the next sector of the append target, if one is free. */
+  bool eraseNext() {
+    if (freeSectors() == 0) return false;
+    const Extent &extent = extents_[extent_count_ - 1];
+    const uint32_t sector = (extent.start_sector + erased_bytes_ / SECTOR_SIZE) % data_sectors_;
+    const uint32_t t0 = micros();
+    if (esp_partition_erase_range(part_, (INDEX_SLOTS + sector) * SECTOR_SIZE, SECTOR_SIZE) != ESP_OK) {
+      return false;
+    }
+    const uint32_t elapsed = micros() - t0;
+    erased_bytes_ += SECTOR_SIZE;
+    erase_stats_.erases++;
+    if (elapsed > erase_stats_.max_us) erase_stats_.max_us = elapsed;
+    return true;
+  }
+
+  /**
+   * @brief Reads or writes extent bytes, splitting at the end of the log
+   * where the extent wraps around.
+   */
+  bool transfer(const Extent &extent, uint32_t offset, uint8_t* data, size_t len, bool write) {
+    const uint32_t region = data_sectors_ * SECTOR_SIZE;
+    uint32_t pos = (extent.start_sector * SECTOR_SIZE + offset) % region;
+    while (len > 0) {
+      const size_t n = len < region - pos ? len : region - pos;
+      const size_t address = INDEX_SLOTS * SECTOR_SIZE + pos;
+      const esp_err_t err = write ? esp_partition_write(part_, address, data, n)
+                                  : esp_partition_read(part_, address, data, n);
+      if (err != ESP_OK) return false;
+      data += n;
+      len -= n;
+      pos = 0;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Finds the end of an extent whose length was not saved.
+   *
+   * Sectors are filled in order and the sector after the data is always
+   * erased, so the end is in the first sector that is not completely
+   * written: after its last byte that is not 0xFF. A record ending in 0xFF
+   * bytes loses those bytes; new sessions start on a fresh sector, so they
+   * are never overwritten.
+   */
+  void recoverLength(Extent &extent) {
+    uint8_t chunk[SCAN_CHUNK];
+    extent.length = 0;
+    for (uint32_t i = 0; i < data_sectors_; i++) {
+      const uint32_t sector = (extent.start_sector + i) % data_sectors_;
+      const size_t base = (INDEX_SLOTS + sector) * SECTOR_SIZE;
+      int32_t last = -1;
+      for (int32_t off = SECTOR_SIZE - SCAN_CHUNK; off >= 0 && last < 0; off -= SCAN_CHUNK) {
+        if (esp_partition_read(part_, base + off, chunk, SCAN_CHUNK) != ESP_OK) return;
+        for (int32_t j = SCAN_CHUNK - 1; j >= 0; j--) {
+          if (chunk[j] != 0xFF) {
+            last = off + j;
+            break;
+          }
+        }
+      }
+      extent.length = i * SECTOR_SIZE + (uint32_t)(last + 1);
+      if (last != (int32_t)SECTOR_SIZE - 1) return;
+    }
+  }
+
+  /** @brief Reads and validates a slot header, including the body CRC. */
+  bool loadSlot(uint8_t slot, SlotHeader &header) {
+    if (esp_partition_read(part_, slot * SECTOR_SIZE, &header, sizeof(header)) != ESP_OK) return false;
+    if (header.magic != SLOT_MAGIC || header.extent_count > MAX_EXTENTS ||
+        header.index_len > MAX_INDEX_LEN || header.head_sector >= data_sectors_) {
+      return false;
+    }
+    if (!readSlotBody(slot, header)) return false;
+    return bodyCrc() == header.crc;
+  }
+
+  /** @brief Loads a slot's extent table and index blob into RAM. */
+  bool readSlotBody(uint8_t slot, const SlotHeader &header) {
+    const size_t base = slot * SECTOR_SIZE + sizeof(SlotHeader);
+    extent_count_ = header.extent_count;
+    index_len_ = header.index_len;
+    head_sector_ = header.head_sector;
+    return esp_partition_read(part_, base, extents_, extent_count_ * sizeof(Extent)) == ESP_OK &&
+           esp_partition_read(part_, base + MAX_EXTENTS * sizeof(Extent), index_, index_len_) == ESP_OK;
+  }
+
+  uint32_t bodyCrc() const {
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t*)extents_, extent_count_ * sizeof(Extent));
+    return esp_rom_crc32_le(crc, index_, index_len_);
+  }
+
+  /** @brief Saves extents and index to the inactive slot, header last. */
+  bool writeSlot() {
+    const uint8_t slot = active_slot_ ^ 1;
+    const size_t base = slot * SECTOR_SIZE;
+    SlotHeader header;
+    header.magic = SLOT_MAGIC;
+    header.sequence = sequence_ + 1;
+    header.extent_count = (uint16_t)extent_count_;
+    header.index_len = (uint16_t)index_len_;
+    header.head_sector = headSector();
+    header.crc = bodyCrc();
+
+    if (esp_partition_erase_range(part_, base, SECTOR_SIZE) != ESP_OK) return false;
+    const size_t body = base + sizeof(SlotHeader);
+    if (esp_partition_write(part_, body, extents_, extent_count_ * sizeof(Extent)) != ESP_OK ||
+        esp_partition_write(part_, body + MAX_EXTENTS * sizeof(Extent), index_, index_len_) != ESP_OK ||
+        esp_partition_write(part_, base, &header, sizeof(header)) != ESP_OK) {
+      return false;
+    }
+    active_slot_ = slot;
+    sequence_ = header.sequence;
+    return true;
+  }
+
+  const Extent* find(uint32_t id) const {
+    for (size_t i = 0; i < extent_count_; i++) {
+      if (extents_[i].id == id) return &extents_[i];
+    }
+    return nullptr;
+  }
+
+  const esp_partition_t* part_ = nullptr;
+  uint32_t data_sectors_ = 0;
+  Extent extents_[MAX_EXTENTS] = {};   ///< Oldest first; the last may be the append target
+  size_t extent_count_ = 0;
+  uint8_t index_[MAX_INDEX_LEN] = {};
+  size_t index_len_ = 0;
+  uint32_t head_sector_ = 0;
+  uint32_t sequence_ = 0;
+  uint8_t active_slot_ = 0;
+  bool writing_ = false;               ///< Last extent is open for append()
+  uint32_t erased_bytes_ = 0;          ///< Erased bytes from the append target's start
+  FdrEraseStats erase_stats_ = {};
+};
+
+static RawLogStorage storage;
+
+FdrStorage &fdr_storage() {
+  return storage;
+}
+
+#endif // FDR_STORAGE_BACKEND == FDR_STORAGE_RAW
@@ -0,0 +1,127 @@
+/**
+ * @file http_util.h
+ * @brief Small helpers on top of the esp_http_server API
+ * @author slopez.tech
+ * @date 2025-11-30
+ */
+
+#ifndef HTTP_UTIL_H
+#define HTTP_UTIL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <esp_http_server.h>
+
+/**
+ * @brief Longest query string the handlers look at; longer ones are
+ * answered with 400.
+ */
+static constexpr size_t HTTP_MAX_QUERY_LEN = 128;
+
+/**
+ * @brief Outcome of looking up a query parameter.
+ */
+enum class HttpArg : uint8_t {
+  Absent,  ///< Not in the query.
+  Present, ///< Copied, possibly empty.
+  TooLong, ///< Longer than the destination, or the whole query is over HTTP_MAX_QUERY_LEN.
+};
+
+/**
+ * @brief Decodes %XX escapes in place (list values such as filter chains
+ * arrive with ',' and ':' escaped from browsers).
+ */
+static inline void http_urlDecode(char* text) {
+  char* out = text;
+  for (const char* in = text; *in != '\0'; in++) {
+    const auto hex = [](char c) -> int {
+      if (c >= '0' && c <= '9') return c - '0';
+      if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+      if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+      return -1;
+    };
+    if (in[0] == '%' && hex(in[1]) >= 0 && hex(in[2]) >= 0) {
+      *out++ = (char)(hex(in[1]) * 16 + hex(in[2]));
+      in += 2;
+    } else {
+      *out++ = *in;
+    }
+  }
+  *out = '\0';
+}
+
+/**
+ * @brief Copies the value of a query parameter of the request, URL-decoded.
+ *
+ * An over-long value is reported as such rather than as absent, so the
+ * handler refuses the request instead of falling back to its default.
+ *
+ * @param out Destination, set to "" unless the parameter is Present.
+ */
+static inline HttpArg http_queryArg(httpd_req_t* req, const char* key, char* out, size_t len) {
+  out[0] = '\0';
+  char query[HTTP_MAX_QUERY_LEN];
+  const esp_err_t got_query = httpd_req_get_url_query_str(req, query, sizeof(query));
+  if (got_query == ESP_ERR_HTTPD_RESULT_TRUNC) return HttpArg::TooLong;
+  if (got_query != ESP_OK) return HttpArg::Absent;
+  const esp_err_t got_value = httpd_query_key_value(query, key, out, len);
+  if (got_value != ESP_OK) {
+    out[0] = '\0';
+    return got_value == ESP_ERR_HTTPD_RESULT_TRUNC ? HttpArg::TooLong : HttpArg::Absent;
+  }
+  http_urlDecode(out);
+  return HttpArg::Present;
+}
+
+/**
+ * @brief http_queryArg() for handlers that read several parameters before
+ * acting on them: an over-long one sets `too_long`, checked once they are
+ * all read.
+ *
+ * @return true if the parameter is present (possibly empty).
+ */
+static inline bool http_queryArg(httpd_req_t* req, const char* key, char* out, size_t len,
+                                 bool &too_long) {
+  const HttpArg got = http_queryArg(req, key, out, len);
+  if (got == HttpArg::TooLong) too_long = true;
+  return got == HttpArg::Present;
+}
+
+/**
+ * @brief Copies the value of a request header.
+ *
+ * @param out Destination, set to "" if the header is absent or too long.
+ * @return true if the header was copied.
+ */
+static inline bool http_header(httpd_req_t* req, const char* field, char* out, size_t len) {
+  out[0] = '\0';
+  const size_t value_len = httpd_req_get_hdr_value_len(req, field);
+  if (value_len == 0 || value_len >= len) return false;
+  return httpd_req_get_hdr_value_str(req, field, out, len) == ESP_OK;
+}
+
+/**
+ * @brief Writes raw bytes to a connection outside of a request handler.
+ *
+ * For connections taken over by a module after their handler returned
+ * (streamed downloads, live telemetry). Call from the server task only,
+ * e.g. from work queued with httpd_queue_work().
+ *
+ * @return false if the connection failed before everything was sent.
+ */
+static inline bool http_sendRaw(httpd_handle_t server, int fd, const char* data, size_t len) {
+  while (len > 0) {
+    const int sent = httpd_socket_send(server, fd, data, len, 0);
+    if (sent <= 0) return false;
+    data += sent;
+    len -= (size_t)sent;
+  }
+  return true;
+}
+
+static inline bool http_sendRaw(httpd_handle_t server, int fd, const char* text) {
+  return http_sendRaw(server, fd, text, strlen(text));
+}
+
+#endif // HTTP_UTIL_H
@@ -0,0 +1,396 @@
+/**
+ * @file imu.cpp
+ * @brief MPU6050 accelerometer/gyroscope module with FIFO burst reads
+ * @author slopez.tech
+ * @date 2025-11-30
+ *
+ * The sensor is driven at register level rather than through the Adafruit
+ * driver, which has no FIFO support: the MPU6050 samples on its own clock
+ * into its 1 KB FIFO and imu_process() empties it in multi-frame bursts, so
+ * the output rate does not depend on how precisely the caller is scheduled.
+ */
+
+#include "imu.h"
+#include "logger.h"
+#include <Wire.h>
+#include <freertos/FreeRTOS.h>
+#include <esp_timer.h>
+
+// ============================================================================
+// Configuration Constants
+// ============================================================================
+
+// I2C Addresses (AD0 low / high) and identity
+static const uint8_t MPU6050_ADDRESS_PRIMARY = 0x68;
+static const uint8_t MPU6050_ADDRESS_SECONDARY = 0x69;
+static const uint8_t MPU6050_WHO_AM_I = 0x68;
+
+// Register map
+static const uint8_t REG_SMPLRT_DIV = 0x19;
+static const uint8_t REG_CONFIG = 0x1A;
+static const uint8_t REG_GYRO_CONFIG = 0x1B;
+static const uint8_t REG_ACCEL_CONFIG = 0x1C;
+static const uint8_t REG_FIFO_EN = 0x23;
+static const uint8_t REG_USER_CTRL = 0x6A;
+static const uint8_t REG_PWR_MGMT_1 = 0x6B;
+static const uint8_t REG_FIFO_COUNT_H = 0x72;
+static const uint8_t REG_FIFO_R_W = 0x74;
+static const uint8_t REG_WHO_AM_I = 0x75;
+
+// Register values
+static const uint8_t PWR_CLOCK_PLL_XGYRO = 0x01; // awake, PLL on gyro X
+static const uint8_t CONFIG_DLPF_98HZ = 0x02;    // gyro output rate 1 kHz
+static const uint8_t GYRO_FS_2000DPS = 0x18;
+static const uint8_t ACCEL_FS_16G = 0x18;
+static const uint8_t FIFO_EN_ACCEL_GYRO = 0x78;  // XG, YG, ZG, ACCEL
+static const uint8_t USER_CTRL_FIFO_EN = 0x40;
+static const uint8_t USER_CTRL_FIFO_RESET = 0x04;
+
+// FIFO geometry. A frame is accel XYZ then gyro XYZ, big-endian words.
+static const uint16_t FIFO_SIZE = 1024;
+static const uint8_t FRAME_SIZE = 12;
+// Frames per I2C read; keeps each transfer inside the 128-byte Wire buffer
+static const uint8_t FRAMES_PER_READ = 10;
+
+// The sample rate divider counts periods of the 1 kHz gyro output rate
+static const uint32_t BASE_RATE_HZ = 1000;
+static const uint32_t BASE_PERIOD_US = 1000;
+
+// Detection retry interval while no sensor answers
+static const uint32_t DETECT_RETRY_MS = 2000;
+
+// Consecutive failed reads before the sensor is considered lost
+static const uint8_t READ_ERRORS_MAX = 3;
+
+// Timestamp reconstruction: the read-time estimate nudges the timeline by
+// 1/TIMELINE_GAIN of the error per read; beyond TIMELINE_RESYNC_PERIODS the
+// timeline is re-anchored instead.
+static const int64_t TIMELINE_GAIN = 16;
+static const int64_t TIMELINE_RESYNC_PERIODS = 4;
+
+// ============================================================================
+// Static Runtime Variables
+// ============================================================================
+
+static uint8_t sensor_address = 0;
+static bool imu_ok = false;
+static uint8_t consecutive_errors = 0;
+static uint32_t next_detect_ms = 0;
+
+// Rate requested by imu_setRate() (as a divider) and the one in effect. Like
+// the barometer settings it is applied from imu_process() only, so that the
+// task running it is the only one touching the I2C bus.
+static volatile uint8_t divider_requested = (uint8_t)(BASE_RATE_HZ / IMU_DEFAULT_RATE_HZ - 1);
+static uint8_t divider_applied = 0;
+static uint32_t period_us = BASE_PERIOD_US * (BASE_RATE_HZ / IMU_DEFAULT_RATE_HZ);
+
+// Reconstructed time of the next frame to leave the FIFO (0 = not anchored)
+static int64_t next_frame_us = 0;
+
+// Latest sample and counters, guarded by `imu_mux`
+static ImuSample latest = {};
+static bool latest_valid = false;
+static ImuStats stats = {};
+static portMUX_TYPE imu_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// ============================================================================
+// Helper Functions
+// ============================================================================
+
+/**
+ * @brief Writes one register.
+ *
+ * @return true if the device acknowledged.
+ */
+static bool writeRegister(uint8_t reg, uint8_t value) {
+  Wire.beginTransmission(sensor_address);
+  Wire.write(reg);
+  Wire.write(value);
+  return Wire.endTransmission() == 0;
+}
+
+/**
+ * @brief Reads `len` consecutive registers in a single I2C transaction.
+ *
+ * @return true if all bytes were received.
+ */
+static bool readRegisters(uint8_t reg, uint8_t* out, uint8_t len) {
+  Wire.beginTransmission(sensor_address);
+  Wire.write(reg);
+  if (Wire.endTransmission(false) != 0) return false;
+  if (Wire.requestFrom(sensor_address, len) != len) return false;
+  for (uint8_t i = 0; i < len; i++) out[i] = (uint8_t)Wire.read();
+  return true;
+}
+
+/**
+ * @brief Counts a failed transaction; drops the sensor after repeated failures.
+ */
+static void recordReadError() {
+  portENTER_CRITICAL(&imu_mux);
+  stats.read_errors++;
+  portEXIT_CRITICAL(&imu_mux);
+
+  if (++consecutive_errors >= READ_ERRORS_MAX) {
+    LOG_WARN("IMU: sensor not responding, will retry detection");
+    imu_ok = false;
+    next_detect_ms = millis() + DETECT_RETRY_MS;
+  }
+}
+
+/**
+ * @brief Empties the FIFO and restarts it; the timeline is re-anchored on
+ * the next read.
+ */
+static bool resetFifo() {
+  next_frame_us = 0;
+  return writeRegister(REG_USER_CTRL, USER_CTRL_FIFO_RESET) &&
+         writeRegister(REG_USER_CTRL, USER_CTRL_FIFO_EN);
+}
+
+/**
+ * @brief Programs the output data rate and clears the FIFO.
+ */
+static bool applyDivider(uint8_t divider) {
+  if (!writeRegister(REG_SMPLRT_DIV, divider) || !resetFifo()) return false;
+  divider_applied = divider;
+  period_us = BASE_PERIOD_US * (divider + 1u);
+  return true;
+}
+
+/**
+ * @brief Configures ranges, filter, sample rate and FIFO of a detected sensor.
+ *
+ * Every register used is written explicitly, so no device reset (and its
+ * 100 ms wait) is needed and this can run from the sampler task.
+ */
+static bool configureSensor() {
+  const uint8_t divider = divider_requested;
+  return writeRegister(REG_PWR_MGMT_1, PWR_CLOCK_PLL_XGYRO) &&
+         writeRegister(REG_USER_CTRL, 0) &&
+         writeRegister(REG_CONFIG, CONFIG_DLPF_98HZ) &&
+         writeRegister(REG_GYRO_CONFIG, GYRO_FS_2000DPS) &&
+         writeRegister(REG_ACCEL_CONFIG, ACCEL_FS_16G) &&
+         writeRegister(REG_FIFO_EN, FIFO_EN_ACCEL_GYRO) &&
+         applyDivider(divider);
+}
+
+/**
+ * @brief Probes both MPU6050 addresses and configures the first match.
+ *
+ * @return true if a sensor was found and configured.
+ */
+static bool detectSensor() {
+  const uint8_t candidates[] = {MPU6050_ADDRESS_PRIMARY, MPU6050_ADDRESS_SECONDARY};
+  for (uint8_t address : candidates) {
+    sensor_address = address;
+    uint8_t who = 0;
+    if (!readRegisters(REG_WHO_AM_I, &who, 1) || who != MPU6050_WHO_AM_I) continue;
+    if (!configureSensor()) continue;
+
+    imu_ok = true;
+    consecutive_errors = 0;
+    LOG_INFO("IMU: MPU6050 at 0x%02X, %u Hz", address,
+             (unsigned)(BASE_RATE_HZ / (divider_applied + 1u)));
+    return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Decodes one big-endian FIFO frame.
+ */
+static void decodeFrame(const uint8_t* frame, ImuSample &sample) {
+  for (uint8_t axis = 0; axis < 3; axis++) {
+    sample.accel[axis] = (int16_t)((frame[2 * axis] << 8) | frame[2 * axis + 1]);
+    sample.gyro[axis] = (int16_t)((frame[6 + 2 * axis] << 8) | frame[6 + 2 * axis + 1]);
+  }
+}
+
+/**
+ * @brief Aligns the frame timeline with the time of the current FIFO read.
+ *
+ * The newest of `frames` queued frames is between zero and one period old,
+ * so the oldest one was taken about (frames - 0.5) periods ago. The sensor
+ * clock drifts against esp_timer by up to a few percent; small errors are
+ * corrected gradually so consecutive timestamps stay evenly spaced.
+ */
+static void updateTimeline(int64_t now_us, uint16_t frames) {
+  const int64_t estimate = now_us - (int64_t)period_us * frames + period_us / 2;
+  const int64_t error = estimate - next_frame_us;
+  if (next_frame_us == 0 || error > TIMELINE_RESYNC_PERIODS * (int64_t)period_us ||
+      -error > TIMELINE_RESYNC_PERIODS * (int64_t)period_us) {
+    if (next_frame_us != 0) {
+      portENTER_CRITICAL(&imu_mux);
+      stats.resyncs++;
+      portEXIT_CRITICAL(&imu_mux);
+    }
+    next_frame_us = estimate;
+    return;
+  }
+  next_frame_us += error / TIMELINE_GAIN;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+/**
+ * @brief Detects and configures the MPU6050.
+ */
+void imu_init() {
+  if (!detectSensor()) {
+    LOG_WARN_EVERY(LOGGER_REPEAT_INTERVAL_MS, "IMU: no MPU6050 found, will retry");
+    next_detect_ms = millis() + DETECT_RETRY_MS;
+  }
+}
+
+/**
+ * @brief Drains the sensor FIFO. Must be called periodically by the
+ * sampler task.
+ *
+ * Frames are read in bursts of up to FRAMES_PER_READ per I2C transaction.
+ * If the FIFO filled up it may hold a torn frame, so it is reset and the
+ * lost samples are counted instead of decoding misaligned data.
+ *
+ * @param out Destination for the samples, or nullptr to only refresh the
+ *            latest sample.
+ * @param max Capacity of `out`; further frames stay queued in the FIFO.
+ * @return Number of samples stored in `out`.
+ */
+size_t imu_process(ImuSample* out, size_t max) {
+  if (!imu_ok) {
+    if ((int32_t)(millis() - next_detect_ms) < 0) return 0;
+    if (!detectSensor()) {
+      next_detect_ms = millis() + DETECT_RETRY_MS;
+      return 0;
+    }
+  }
+
+  const uint8_t requested = divider_requested;
+  if (requested != divider_applied && !applyDivider(requested)) {
+    recordReadError();
+    return 0;
+  }
+
+  uint8_t count_bytes[2];
+  if (!readRegisters(REG_FIFO_COUNT_H, count_bytes, sizeof(count_bytes))) {
+    recordReadError();
+    return 0;
+  }
+  const int64_t now_us = esp_timer_get_time();
+  consecutive_errors = 0;
+
+  const uint16_t fifo_bytes = (uint16_t)((count_bytes[0] << 8) | count_bytes[1]);
+  if (fifo_bytes + FRAME_SIZE > FIFO_SIZE) {
+    portENTER_CRITICAL(&imu_mux);
+    stats.fifo_overflows++;
+    portEXIT_CRITICAL(&imu_mux);
+    if (!resetFifo()) recordReadError();
+    return 0;
+  }
+
+  uint16_t frames = fifo_bytes / FRAME_SIZE;
+  if (frames == 0) return 0;
+  updateTimeline(now_us, frames);
+  if (out != nullptr && frames > max) frames = (uint16_t)max;
+
+  size_t stored = 0;
+  ImuSample sample = {};
+  uint8_t raw[FRAMES_PER_READ * FRAME_SIZE];
+  while (frames > 0) {
+    const uint8_t batch = frames < FRAMES_PER_READ ? (uint8_t)frames : FRAMES_PER_READ;
+    if (!readRegisters(REG_FIFO_R_W, raw, (uint8_t)(batch * FRAME_SIZE))) {
+      // A partial FIFO read leaves it misaligned; start over
+      recordReadError();
+      resetFifo();
+      break;
+    }
+    for (uint8_t i = 0; i < batch; i++) {
+      decodeFrame(raw + i * FRAME_SIZE, sample);
+      sample.t_us = next_frame_us;
+      next_frame_us += period_us;
+      if (out != nullptr) out[stored++] = sample;
+    }
+    frames -= batch;
+
+    portENTER_CRITICAL(&imu_mux);
+    stats.samples += batch;
+    latest = sample;
+    latest_valid = true;
+    portEXIT_CRITICAL(&imu_mux);
+  }
+  return stored;
+}
+
+/**
+ * @brief Indicates whether an MPU6050 is detected and configured.
+ */
+bool imu_isReady() {
+  return imu_ok;
+}
+
+/**
+ * @brief Sample rate divider closest to a requested rate.
+ *
+ * @param hz Requested rate, clamped to 4..IMU_MAX_RATE_HZ; 0 selects the default.
+ * @return Divider of the 1 kHz base rate, 1..256.
+ */
+static uint32_t dividerFor(uint16_t hz) {
+  if (hz == 0) hz = IMU_DEFAULT_RATE_HZ;
+  if (hz > IMU_MAX_RATE_HZ) hz = IMU_MAX_RATE_HZ;
+  uint32_t divider = (BASE_RATE_HZ + hz / 2) / hz;
+  if (divider < 1) divider = 1;
+  if (divider > 256) divider = 256;
+  return divider;
+}
+
+/**
+ * @brief Requests an output data rate; see imu.h.
+ *
+ * @param hz Requested rate, clamped to 4..IMU_MAX_RATE_HZ; 0 selects the default.
+ * @return Effective rate in Hz (1 kHz divided by a whole number).
+ */
+uint16_t imu_setRate(uint16_t hz) {
+  const uint32_t divider = dividerFor(hz);
+  divider_requested = (uint8_t)(divider - 1);
+  return (uint16_t)((BASE_RATE_HZ + divider / 2) / divider);
+}
+
+/**
+ * @brief Returns the rate imu_setRate() would select, without requesting it.
+ */
+uint16_t imu_rateFor(uint16_t hz) {
+  const uint32_t divider = dividerFor(hz);
+  return (uint16_t)((BASE_RATE_HZ + divider / 2) / divider);
+}
+
+/**
+ * @brief Returns the rate most recently requested through imu_setRate().
+ */
+uint16_t imu_getRate() {
+  const uint32_t divider = divider_requested + 1u;
+  return (uint16_t)((BASE_RATE_HZ + divider / 2) / divider);
+}
+
+/**
+ * @brief Copies the most recent sample.
+ *
+ * @return false if no sample has been read yet.
+ */
+bool imu_getLatest(ImuSample &sample) {
+  portENTER_CRITICAL(&imu_mux);
+  sample = latest;
+  const bool valid = latest_valid;
+  portEXIT_CRITICAL(&imu_mux);
+  return valid && imu_ok;
+}
+
+/**
+ * @brief Copies the FIFO read-path counters.
+ */
+void imu_getStats(ImuStats &out) {
+  portENTER_CRITICAL(&imu_mux);
+  out = stats;
+  portEXIT_CRITICAL(&imu_mux);
+}
@@ -0,0 +1,56 @@
+#ifndef IMU_H
+#define IMU_H
+
+#include <Arduino.h>
+
+// Inicializa el MPU6050 (acelerómetro + giroscopio) con la FIFO activada.
+// Llamar después de `Wire.begin(...)`.
+void imu_init();
+
+// One accelerometer + gyroscope sample in raw sensor counts
+struct ImuSample {
+  int64_t t_us;     // esp_timer time of the sample, reconstructed from the FIFO rate
+  int16_t accel[3]; // X/Y/Z, IMU_ACCEL_LSB_PER_G per g
+  int16_t gyro[3];  // X/Y/Z, IMU_GYRO_LSB_PER_DPS_X10 / 10 per °/s
+};
+
+// Fixed full-scale ranges: ±16 g and ±2000 °/s
+static constexpr uint16_t IMU_ACCEL_LSB_PER_G = 2048;
+static constexpr uint16_t IMU_GYRO_LSB_PER_DPS_X10 = 164;
+
+// Output data rate limits (Hz)
+static constexpr uint16_t IMU_DEFAULT_RATE_HZ = 200;
+static constexpr uint16_t IMU_MAX_RATE_HZ = 500;
+static constexpr uint16_t IMU_MIN_RATE_HZ = 4; // 1 kHz / 256
+
+// Ejecutar periódicamente desde la tarea de muestreo del FDR (dueña del bus
+// I2C), al menos cada 100 ms a 200 Hz para que la FIFO no desborde.
+// Drains up to `max` samples from the FIFO into `out` (oldest first) and
+// returns how many were stored. With `out == nullptr` the FIFO is drained and
+// only the latest sample is kept for imu_getLatest().
+size_t imu_process(ImuSample* out, size_t max);
+
+// Estado
+bool imu_isReady();
+
+// Request an output data rate. The sensor only supports 1 kHz / n, so the
+// effective rate (returned) may differ slightly. Safe from any task; applied
+// by the next imu_process() call, which also clears the FIFO.
+uint16_t imu_setRate(uint16_t hz);
+uint16_t imu_getRate();
+// The effective rate imu_setRate(hz) would select, without requesting it.
+uint16_t imu_rateFor(uint16_t hz);
+
+// Última muestra leída (false si todavía no hay ninguna)
+bool imu_getLatest(ImuSample &sample);
+
+// FIFO read-path counters
+struct ImuStats {
+  uint32_t samples;        // frames read from the FIFO
+  uint32_t fifo_overflows; // FIFO resets because it filled up (samples lost)
+  uint32_t read_errors;    // failed I2C transactions
+  uint32_t resyncs;        // timestamp timeline re-anchored to the read time
+};
+void imu_getStats(ImuStats &stats);
+
+#endif // IMU_H
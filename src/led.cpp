@@ -1,12 +1,20 @@
 /**
  * @file led.cpp
- * @brief NeoPixel LED control module
+ * @brief NeoPixel status LED: patterns generated by a low-priority task
  * @author slopez.tech
  * @date 2025-11-30
+ *
+ * The NeoPixel frame is sent with interrupts disabled, so show() is only
+ * ever called from the LED task, and only when the color changes: a solid
+ * color costs one frame, a blink two per period. The modules driving the
+ * LED just store a mode and condition bits.
  */
 
 #include "led.h"
 #include <Adafruit_NeoPixel.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 
 // ============================================================================
 // Configuration Constants
@@ -22,72 +30,171 @@ static const uint8_t LED_PIN = 10;
  */
 static const uint8_t NUM_LEDS = 1;
 
+/**
+ * @brief LED task priority and stack. The idle priority, below the server
+ * and the logger (1): it only runs when the sampler, the writer and the
+ * server have nothing to do, and it blocks between steps, so the idle task
+ * still gets its turn.
+ */
+static const UBaseType_t LED_TASK_PRIORITY = 0;
+static const uint32_t LED_TASK_STACK = 2048;
+
+/**
+ * @brief Length of the startup blink.
+ */
+static constexpr uint32_t LED_BOOT_MS = LED_BOOT_BLINKS * 2 * LED_BOOT_BLINK_MS;
+
+static constexpr LedColor LED_OFF = {0, 0, 0};
+static constexpr LedColor LED_RED = {255, 0, 0};
+static constexpr LedColor LED_GREEN = {0, 255, 0};
+static constexpr LedColor LED_BLUE = {0, 0, 255};
+static constexpr LedColor LED_AMBER = {255, 160, 0};
+
+// ============================================================================
+// State
+// ============================================================================
+
 /**
  * @brief NeoPixel LED controller instance.
  */
 static Adafruit_NeoPixel leds(NUM_LEDS, LED_PIN, NEO_GRB + NEO_KHZ800);
 
+/** @brief Requested LedMode and LED_* condition bits. */
+static std::atomic<uint8_t> led_mode{(uint8_t)LedMode::Boot};
+static std::atomic<uint8_t> led_conditions{0};
+
+/** @brief show() is held back while set. */
+static std::atomic<bool> led_hold{false};
+
+/**
+ * @brief LED task state: the mode being shown, since when, and the color
+ * on the LED.
+ */
+static LedMode current_mode = LedMode::Boot;
+static uint32_t mode_since_ms = 0;
+static LedColor shown = LED_OFF;
+static std::atomic<uint32_t> show_count{0};
+
+// ============================================================================
+// Helper Functions
+// ============================================================================
+
+static bool sameColor(const LedColor &a, const LedColor &b) {
+  return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+/**
+ * @brief One tick of the LED task: follows the requested mode, ends the
+ * startup blink, and shows the pattern color if it changed.
+ */
+static void ledStep(uint32_t now_ms) {
+  LedMode mode = (LedMode)led_mode.load(std::memory_order_relaxed);
+  if (mode == LedMode::Boot && now_ms - mode_since_ms >= LED_BOOT_MS) {
+    // A mode set meanwhile wins over the end of the blink
+    uint8_t expected = (uint8_t)LedMode::Boot;
+    led_mode.compare_exchange_strong(expected, (uint8_t)LedMode::Idle, std::memory_order_relaxed);
+    mode = (LedMode)led_mode.load(std::memory_order_relaxed);
+  }
+  if (mode != current_mode) {
+    current_mode = mode;
+    mode_since_ms = now_ms;
+  }
+  if (led_hold.load(std::memory_order_relaxed)) return;
+
+  const LedColor color = led_patternColor(mode, led_conditions.load(std::memory_order_relaxed),
+                                          now_ms - mode_since_ms);
+  if (sameColor(color, shown)) return;
+  leds.setPixelColor(0, leds.Color(color.r, color.g, color.b));
+  leds.show();
+  shown = color;
+  show_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief LED task: one step every LED_TICK_MS.
+ */
+static void ledTask(void*) {
+  for (;;) {
+    ledStep(millis());
+    vTaskDelay(pdMS_TO_TICKS(LED_TICK_MS));
+  }
+}
+
 // ============================================================================
 // Public API
 // ============================================================================
 
 /**
- * @brief Initialize the NeoPixel LED system.
- *
- * Must be called before using any LED functions.
+ * @brief Initialize the NeoPixel LED and start the LED task, showing the
+ * startup blink.
  */
 void led_init() {
   leds.begin();
   leds.show();
+  mode_since_ms = millis();
+  xTaskCreate(ledTask, "led", LED_TASK_STACK, nullptr, LED_TASK_PRIORITY, nullptr);
 }
 
 /**
- * @brief Blink the LED in red for a given number of times at startup.
- *
- * @param times Number of blinks.
- * @param delayMs Delay between on/off states in milliseconds.
+ * @brief Select the mode shown. Safe from any task.
  */
-void led_startupBlink(int times, int delayMs) {
-  for (int i = 0; i < times; i++) {
-    leds.setPixelColor(0, leds.Color(255, 0, 0));
-    leds.show();
-    delay(delayMs);
-
-    leds.setPixelColor(0, leds.Color(0, 0, 0));
-    leds.show();
-    delay(delayMs);
-  }
+void led_setMode(LedMode mode) {
+  led_mode.store((uint8_t)mode, std::memory_order_relaxed);
 }
 
 /**
- * @brief Set the LED to a custom RGB color.
- *
- * @param r Red intensity   (0–255)
- * @param g Green intensity (0–255)
- * @param b Blue intensity  (0–255)
+ * @brief Set or clear LED_* condition bits. Safe from any task.
  */
-void led_setColor(uint8_t r, uint8_t g, uint8_t b) {
-  leds.setPixelColor(0, leds.Color(r, g, b));
-  leds.show();
+void led_setCondition(uint8_t condition, bool set) {
+  if (set) {
+    led_conditions.fetch_or(condition, std::memory_order_relaxed);
+  } else {
+    led_conditions.fetch_and((uint8_t)~condition, std::memory_order_relaxed);
+  }
 }
 
 /**
- * @brief Set the LED to blue.
+ * @brief Hold back or release show(). Safe from any task.
  */
-void led_setBlue() {
-  led_setColor(0, 0, 255);
+void led_setHold(bool hold) {
+  led_hold.store(hold, std::memory_order_relaxed);
 }
 
 /**
- * @brief Set the LED to red.
+ * @brief Color of the pattern of a mode and conditions.
+ *
+ * @param t_ms Time since the mode was entered.
  */
-void led_setRed() {
-  led_setColor(255, 0, 0);
+LedColor led_patternColor(LedMode mode, uint8_t conditions, uint32_t t_ms) {
+  if (conditions & LED_SENSOR_LOST) {
+    return t_ms % LED_SENSOR_LOST_PERIOD_MS < LED_SENSOR_LOST_PERIOD_MS / 2 ? LED_RED : LED_OFF;
+  }
+  LedColor color;
+  switch (mode) {
+    case LedMode::Boot:
+      color = (t_ms / LED_BOOT_BLINK_MS) % 2 == 0 ? LED_RED : LED_OFF;
+      break;
+    case LedMode::Armed:
+      color = t_ms % LED_ARMED_PERIOD_MS < LED_ARMED_PERIOD_MS / 2 ? LED_AMBER : LED_OFF;
+      break;
+    case LedMode::Recording:
+      color = LED_GREEN;
+      break;
+    case LedMode::Idle:
+    default:
+      color = LED_BLUE;
+      break;
+  }
+  if ((conditions & LED_STORAGE_LOW) &&
+      t_ms % LED_STORAGE_FLASH_PERIOD_MS >= LED_STORAGE_FLASH_PERIOD_MS - LED_STORAGE_FLASH_MS) {
+    color = LED_RED;
+  }
+  return color;
 }
 
 /**
- * @brief Turn the LED off.
+ * @brief Number of frames sent to the LED since boot.
  */
-void led_off() {
-  led_setColor(0, 0, 0);
+uint32_t led_showCount() {
+  return show_count.load(std::memory_order_relaxed);
 }
@@ -3,16 +3,52 @@
 
 #include <Arduino.h>
 
-// Inicializa el driver del LED (llamar en setup)
+// LED de estado. Una tarea propia de baja prioridad genera los patrones
+// cada LED_TICK_MS y solo llama a show() cuando el color cambia; los demás
+// módulos solo cambian el estado (variables atómicas, seguro desde
+// cualquier tarea, también la de muestreo), nunca tocan el LED.
+
+// Modo principal
+enum class LedMode : uint8_t {
+  Boot,      // parpadeo rojo de arranque (LED_BOOT_BLINKS), luego Idle
+  Idle,      // azul fijo
+  Armed,     // ámbar intermitente, esperando el disparo
+  Recording, // verde fijo
+};
+
+// Condiciones que se superponen al modo (bits)
+static constexpr uint8_t LED_STORAGE_LOW = 1 << 0; // destello rojo cada segundo
+static constexpr uint8_t LED_SENSOR_LOST = 1 << 1; // rojo rápido, tapa lo demás
+
+static constexpr uint32_t LED_TICK_MS = 50;
+static constexpr uint32_t LED_BOOT_BLINKS = 10;
+static constexpr uint32_t LED_BOOT_BLINK_MS = 250;   // encendido y apagado
+static constexpr uint32_t LED_ARMED_PERIOD_MS = 1000;
+static constexpr uint32_t LED_SENSOR_LOST_PERIOD_MS = 200;
+static constexpr uint32_t LED_STORAGE_FLASH_PERIOD_MS = 1000;
+static constexpr uint32_t LED_STORAGE_FLASH_MS = 200;
+
+struct LedColor {
+  uint8_t r, g, b;
+};
+
+// Inicializa el driver del LED y arranca su tarea, en modo Boot
 void led_init();
 
-// Parpadeo de arranque (n veces, ms de delay entre toggles)
-void led_startupBlink(int times = 10, int delayMs = 250);
+// Cambia el modo o una condición; se muestra en el siguiente tick
+void led_setMode(LedMode mode);
+void led_setCondition(uint8_t condition, bool set);
+
+// Congela el LED: ningún show() (interrupciones desactivadas durante la
+// trama) hasta soltarlo, p. ej. durante una ventana de ráfaga. El estado
+// pendiente se muestra al soltar. El FDR solo lo congela durante la ráfaga,
+// no el resto de la sesión (disparada o no), que va a 50 Hz como mucho.
+void led_setHold(bool hold);
+
+// Color del patrón de un estado, `t_ms` después de entrar en el modo
+LedColor led_patternColor(LedMode mode, uint8_t conditions, uint32_t t_ms);
 
-// Colores rápidos
-void led_setColor(uint8_t r, uint8_t g, uint8_t b);
-void led_setBlue();
-void led_setRed();
-void led_off();
+// Llamadas a show() desde el arranque
+uint32_t led_showCount();
 
 #endif // LED_H
@@ -0,0 +1,213 @@
+/**
+ * @file logger.cpp
+ * @brief Leveled, rate-limited logging into a RAM ring, printed on Serial
+ * in the background
+ * @author slopez.tech
+ * @date 2025-11-30
+ */
+
+#include "logger.h"
+#include <Arduino.h>
+#include <stdarg.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// ============================================================================
+// Configuration Constants
+// ============================================================================
+
+/**
+ * @brief Serial printer task: lowest application priority, polling the ring.
+ */
+static const unsigned LOGGER_TASK_PRIORITY = 1;
+static const uint32_t LOGGER_TASK_STACK = 3072;
+static const uint32_t LOGGER_POLL_INTERVAL_MS = 50;
+
+// ============================================================================
+// State
+// ============================================================================
+
+/**
+ * @brief The latest lines, slot seq % LOGGER_RING_LINES.
+ */
+static LoggerLine ring[LOGGER_RING_LINES];
+
+/**
+ * @brief Sequence number of the next line (ring[] holds the lines from
+ * next_seq - LOGGER_RING_LINES on).
+ */
+static uint32_t next_seq = 1;
+
+/**
+ * @brief Next line to print on Serial; printer task only.
+ */
+static uint32_t printed_seq = 1;
+
+/**
+ * @brief Lines never printed on Serial.
+ */
+static uint32_t serial_dropped = 0;
+
+/**
+ * @brief Guards ring[], next_seq and serial_dropped.
+ */
+static portMUX_TYPE logger_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// ============================================================================
+// Helper Functions
+// ============================================================================
+
+/**
+ * @brief Stores one formatted line.
+ */
+static void store(uint8_t level, const char* text) {
+  const uint32_t t_ms = millis();
+  portENTER_CRITICAL(&logger_mux);
+  LoggerLine &line = ring[next_seq % LOGGER_RING_LINES];
+  line.seq = next_seq++;
+  line.t_ms = t_ms;
+  line.level = level;
+  strncpy(line.text, text, sizeof(line.text) - 1);
+  line.text[sizeof(line.text) - 1] = '\0';
+  portEXIT_CRITICAL(&logger_mux);
+}
+
+/**
+ * @brief Prints the lines not printed yet while the port has room for them.
+ * With no host connected they are skipped, so nothing piles up to be
+ * flushed at once when one connects.
+ */
+static void printPending() {
+  for (;;) {
+    LoggerLine line;
+    portENTER_CRITICAL(&logger_mux);
+    if (next_seq - printed_seq > LOGGER_RING_LINES) {
+      serial_dropped += next_seq - LOGGER_RING_LINES - printed_seq;
+      printed_seq = next_seq - LOGGER_RING_LINES;
+    }
+    const bool pending = printed_seq != next_seq;
+    if (pending) line = ring[printed_seq % LOGGER_RING_LINES];
+    portEXIT_CRITICAL(&logger_mux);
+    if (!pending) return;
+
+    if (!Serial) {
+      portENTER_CRITICAL(&logger_mux);
+      serial_dropped += next_seq - printed_seq;
+      portEXIT_CRITICAL(&logger_mux);
+      printed_seq = next_seq;
+      return;
+    }
+    const size_t len = strlen(line.text);
+    if ((size_t)Serial.availableForWrite() < len + 2) return; // retried on the next poll
+    Serial.write((const uint8_t*)line.text, len);
+    Serial.write((const uint8_t*)"\r\n", 2);
+    printed_seq = line.seq + 1;
+  }
+}
+
+/**
+ * @brief Serial printer task.
+ */
+static void loggerTask(void*) {
+  for (;;) {
+    printPending();
+    vTaskDelay(pdMS_TO_TICKS(LOGGER_POLL_INTERVAL_MS));
+  }
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+/**
+ * @brief Starts the task that prints the ring on Serial.
+ *
+ * Serial writes never wait for the host ("TX timeout" 0): the task only
+ * writes what fits in the USB CDC buffer and leaves the rest for later.
+ */
+void logger_init() {
+  Serial.setTxTimeoutMs(0);
+  xTaskCreate(loggerTask, "logger", LOGGER_TASK_STACK, nullptr, LOGGER_TASK_PRIORITY, nullptr);
+}
+
+/**
+ * @brief Formats and stores one line.
+ */
+void logger_write(uint8_t level, const char* format, ...) {
+  char text[LOGGER_LINE_MAX];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(text, sizeof(text), format, args);
+  va_end(args);
+  store(level, text);
+}
+
+/**
+ * @brief logger_write() for at most one line per `interval_ms` per call site.
+ */
+void logger_writeLimited(LoggerLimit &limit, uint32_t interval_ms, uint8_t level,
+                         const char* format, ...) {
+  const uint32_t now_ms = millis();
+  if (limit.seen && now_ms - limit.last_ms < interval_ms) {
+    limit.suppressed++;
+    return;
+  }
+  const uint32_t suppressed = limit.suppressed;
+  limit.seen = true;
+  limit.last_ms = now_ms;
+  limit.suppressed = 0;
+
+  char text[LOGGER_LINE_MAX];
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(text, sizeof(text), format, args);
+  va_end(args);
+  if (suppressed > 0 && len >= 0 && (size_t)len < sizeof(text)) {
+    snprintf(text + len, sizeof(text) - len, " (%u more suppressed)", (unsigned)suppressed);
+  }
+  store(level, text);
+}
+
+/**
+ * @brief Copies the stored lines from sequence number `since`, oldest first.
+ */
+size_t logger_read(uint32_t since, LoggerLine* out, size_t max, uint32_t &lost) {
+  portENTER_CRITICAL(&logger_mux);
+  const uint32_t first = next_seq > LOGGER_RING_LINES ? next_seq - LOGGER_RING_LINES : 1;
+  if (since == 0) since = 1;
+  lost = since < first ? first - since : 0;
+  size_t count = 0;
+  for (uint32_t seq = since > first ? since : first; seq < next_seq && count < max; seq++) {
+    out[count++] = ring[seq % LOGGER_RING_LINES];
+  }
+  portEXIT_CRITICAL(&logger_mux);
+  return count;
+}
+
+/**
+ * @brief Sequence number the next line will get.
+ */
+uint32_t logger_nextSeq() {
+  portENTER_CRITICAL(&logger_mux);
+  const uint32_t seq = next_seq;
+  portEXIT_CRITICAL(&logger_mux);
+  return seq;
+}
+
+/**
+ * @brief Lines never printed on Serial since boot.
+ */
+uint32_t logger_serialDropped() {
+  portENTER_CRITICAL(&logger_mux);
+  const uint32_t dropped = serial_dropped;
+  portEXIT_CRITICAL(&logger_mux);
+  return dropped;
+}
+
+/**
+ * @brief Letter of a level.
+ */
+char logger_levelLetter(uint8_t level) {
+  static const char LETTERS[] = "-EWID";
+  return level < sizeof(LETTERS) - 1 ? LETTERS[level] : '?';
+}
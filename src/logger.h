@@ -0,0 +1,162 @@
+/**
+ * @file logger.h
+ * @brief Leveled, rate-limited logging into a RAM ring, printed on Serial
+ * in the background
+ * @author slopez.tech
+ * @date 2025-11-30
+ *
+ * LOG_ERROR() .. LOG_DEBUG() format one line into a RAM ring of the latest
+ * LOGGER_RING_LINES lines and return; they never touch the serial port.
+ * A low-priority task prints new lines on Serial when the port has room,
+ * and /api/logs reads the ring. Lines that cannot be printed (no host
+ * connected, or overwritten before the port had room) are counted, never
+ * waited for.
+ *
+ * Messages above LOGGER_LEVEL are compiled out, arguments included. The
+ * _EVERY variants print a call site at most once per interval and report
+ * how many repetitions were suppressed; use them on every path that runs
+ * per sample or per retry.
+ */
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define LOGGER_LEVEL_NONE 0
+#define LOGGER_LEVEL_ERROR 1
+#define LOGGER_LEVEL_WARN 2
+#define LOGGER_LEVEL_INFO 3
+#define LOGGER_LEVEL_DEBUG 4
+
+// Build with -DLOGGER_LEVEL=LOGGER_LEVEL_DEBUG for the per-address scan
+// and other chatty messages
+#ifndef LOGGER_LEVEL
+#define LOGGER_LEVEL LOGGER_LEVEL_INFO
+#endif
+
+/**
+ * @brief Longest stored line, terminator included; longer ones are cut.
+ */
+static constexpr size_t LOGGER_LINE_MAX = 96;
+
+/**
+ * @brief Lines kept in the RAM ring.
+ */
+static constexpr size_t LOGGER_RING_LINES = 32;
+
+/**
+ * @brief Interval of the _EVERY messages on the sampling and retry paths.
+ */
+static constexpr uint32_t LOGGER_REPEAT_INTERVAL_MS = 5000;
+
+/**
+ * @brief State of one rate-limited call site.
+ */
+struct LoggerLimit {
+  uint32_t last_ms;
+  uint32_t suppressed; ///< Repetitions since the last printed one
+  bool seen;
+};
+
+/**
+ * @brief One line of the ring.
+ */
+struct LoggerLine {
+  uint32_t seq;       ///< 1 for the first line since boot
+  uint32_t t_ms;      ///< millis() when it was logged
+  uint8_t level;
+  char text[LOGGER_LINE_MAX];
+};
+
+/**
+ * @brief Starts the task that prints the ring on Serial. Lines logged
+ * before are kept and printed then.
+ */
+void logger_init();
+
+/**
+ * @brief Formats and stores one line. Safe from any task; use the LOG_*
+ * macros rather than calling it directly.
+ */
+void logger_write(uint8_t level, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+/**
+ * @brief logger_write() for at most one line per `interval_ms` through
+ * `limit`; a printed line is followed by the count of suppressed ones.
+ */
+void logger_writeLimited(LoggerLimit &limit, uint32_t interval_ms, uint8_t level,
+                         const char* format, ...) __attribute__((format(printf, 4, 5)));
+
+/**
+ * @brief Copies the stored lines with a sequence number of at least `since`,
+ * oldest first.
+ *
+ * @param lost Set to the number of lines after `since` already overwritten.
+ * @return Number of lines copied.
+ */
+size_t logger_read(uint32_t since, LoggerLine* out, size_t max, uint32_t &lost);
+
+/**
+ * @brief Sequence number the next line will get.
+ */
+uint32_t logger_nextSeq();
+
+/**
+ * @brief Lines never printed on Serial since boot: overwritten before the
+ * port had room for them, or logged while no host was connected.
+ */
+uint32_t logger_serialDropped();
+
+/**
+ * @brief Letter of a level: E, W, I or D.
+ */
+char logger_levelLetter(uint8_t level);
+
+#define LOGGER_LIMITED_(level, interval_ms, ...)                                \
+  do {                                                                          \
+    static LoggerLimit logger_limit_;                                           \
+    logger_writeLimited(logger_limit_, (interval_ms), (level), __VA_ARGS__);    \
+  } while (0)
+
+// Compiled out, but still type-checked so disabled levels keep their
+// arguments "used" and their formats checked
+#define LOGGER_DISABLED_(...)                                                   \
+  do {                                                                          \
+    if (false) logger_write(LOGGER_LEVEL_NONE, __VA_ARGS__);                    \
+  } while (0)
+
+#if LOGGER_LEVEL >= LOGGER_LEVEL_ERROR
+#define LOG_ERROR(...) logger_write(LOGGER_LEVEL_ERROR, __VA_ARGS__)
+#define LOG_ERROR_EVERY(ms, ...) LOGGER_LIMITED_(LOGGER_LEVEL_ERROR, ms, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) LOGGER_DISABLED_(__VA_ARGS__)
+#define LOG_ERROR_EVERY(ms, ...) LOGGER_DISABLED_(__VA_ARGS__)
+#endif
+
+#if LOGGER_LEVEL >= LOGGER_LEVEL_WARN
+#define LOG_WARN(...) logger_write(LOGGER_LEVEL_WARN, __VA_ARGS__)
+#define LOG_WARN_EVERY(ms, ...) LOGGER_LIMITED_(LOGGER_LEVEL_WARN, ms, __VA_ARGS__)
+#else
+#define LOG_WARN(...) LOGGER_DISABLED_(__VA_ARGS__)
+#define LOG_WARN_EVERY(ms, ...) LOGGER_DISABLED_(__VA_ARGS__)
+#endif
+
+#if LOGGER_LEVEL >= LOGGER_LEVEL_INFO
+#define LOG_INFO(...) logger_write(LOGGER_LEVEL_INFO, __VA_ARGS__)
+#define LOG_INFO_EVERY(ms, ...) LOGGER_LIMITED_(LOGGER_LEVEL_INFO, ms, __VA_ARGS__)
+#else
+#define LOG_INFO(...) LOGGER_DISABLED_(__VA_ARGS__)
+#define LOG_INFO_EVERY(ms, ...) LOGGER_DISABLED_(__VA_ARGS__)
+#endif
+
+#if LOGGER_LEVEL >= LOGGER_LEVEL_DEBUG
+#define LOG_DEBUG(...) logger_write(LOGGER_LEVEL_DEBUG, __VA_ARGS__)
+#define LOG_DEBUG_EVERY(ms, ...) LOGGER_LIMITED_(LOGGER_LEVEL_DEBUG, ms, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) LOGGER_DISABLED_(__VA_ARGS__)
+#define LOG_DEBUG_EVERY(ms, ...) LOGGER_DISABLED_(__VA_ARGS__)
+#endif
+
+#endif // LOGGER_H
@@ -8,19 +8,27 @@
 #include <WiFi.h>
 #include <Wire.h>
 #include <Adafruit_Sensor.h>
-#include <WebServer.h>
-#include <SPIFFS.h>
-#include <FS.h>
+#include <esp_http_server.h>
+#include <esp_timer.h>
+#include <esp_system.h>
+#include <atomic>
 
 #include "barometer.h"
+#include "imu.h"
 #include "led.h"
 #include "fdr.h"
+#include "http_util.h"
+#include "perf.h"
+#include "logger.h"
+#include "power.h"
 
 
 /**
- * @brief HTTP server instance running on port 80
+ * @brief HTTP server (esp_http_server) on port 80. It runs in its own task;
+ * handlers share state with the sensor and FDR modules only through their
+ * thread-safe accessors.
  */
-WebServer server(80);
+static httpd_handle_t server = nullptr;
 
 // ============================================================================
 // WiFi AP Configuration
@@ -35,111 +43,849 @@ const char* ssid = "MiESP_AP";
  */
 const char* password = "12345678";
 
+/**
+ * @brief Preferred I2C clock; the barometer falls back to slower
+ * speeds automatically if the wiring cannot sustain it.
+ */
+static const uint32_t I2C_CLOCK_HZ = 400000;
+
+/**
+ * @brief HTTP server task priority and stack. Below the FDR writer (2), so
+ * serving clients can never hold back recording.
+ */
+static const unsigned HTTP_TASK_PRIORITY = 1;
+static const size_t HTTP_TASK_STACK = 8192;
+
+// ============================================================================
+// Boot Timing
+// ============================================================================
+
+/**
+ * @brief Boot milestones, esp_timer µs since the application started:
+ * sensors probed, FDR sampling (and any interrupted session resumed),
+ * HTTP server up, access point started. The last one is set from the WiFi
+ * event task; 0 until reached.
+ */
+static int64_t boot_sensors_us = 0;
+static int64_t boot_sampling_us = 0;
+static int64_t boot_http_us = 0;
+static std::atomic<int64_t> boot_ap_us{0};
+
+// ============================================================================
+// HTTP API Endpoints
+// ============================================================================
+
+/**
+ * @brief Sends a complete JSON response.
+ */
+static esp_err_t sendJson(httpd_req_t* req, const char* status, const char* body) {
+  httpd_resp_set_status(req, status);
+  httpd_resp_set_type(req, "application/json");
+  return httpd_resp_sendstr(req, body);
+}
+
+/**
+ * @brief Returns barometer readings, altitude and flight state in JSON format.
+ * Endpoint: /api/barometer
+ */
+static esp_err_t handleBarometer(httpd_req_t* req) {
+  BarometerReading reading;
+  barometer_getReading(reading);
+  if (!reading.ready) {
+    return sendJson(req, "503 Service Unavailable", "{\"error\":\"barometer not ready\"}");
+  }
+  BarometerFlight flight;
+  barometer_getFlight(flight);
+  static const char* const PHASES[] = {"ground", "ascent", "descent", "landed"};
+
+  const int64_t age_us = reading.t_us ? esp_timer_get_time() - reading.t_us : 0;
+
+  char buf[320];
+  // Produce simple JSON with 2 decimals
+  snprintf(buf, sizeof(buf),
+           "{\"temperature\":%.2f,\"pressure\":%.2f,\"reference\":%.2f,\"altitude\":%.2f,"
+           "\"vertical_speed\":%.2f,\"phase\":\"%s\",\"apogee\":%.2f,"
+           "\"seq\":%u,\"age_ms\":%u}",
+           reading.temperature, reading.pressure, flight.reference_q8 / 25600.0f,
+           flight.altitude_cm / 100.0f, flight.vspeed_cms / 100.0f,
+           PHASES[(uint8_t)flight.phase], flight.apogee_cm / 100.0f,
+           (unsigned)reading.seq, (unsigned)(age_us / 1000));
+  return sendJson(req, HTTPD_200, buf);
+}
+
+/**
+ * @brief Sets the altitude reference: the current pressure, or `pressure`
+ * in hPa. Restarts flight detection.
+ * Endpoint: /api/barometer/reference[?pressure=<hPa>]
+ */
+static esp_err_t handleBarometerReference(httpd_req_t* req) {
+  char arg[16];
+  float hpa = 0.0f;
+  const HttpArg pressure = http_queryArg(req, "pressure", arg, sizeof(arg));
+  if (pressure == HttpArg::TooLong) {
+    return sendJson(req, HTTPD_400, "{\"error\":\"parameter too long\"}");
+  }
+  if (pressure == HttpArg::Present && arg[0]) {
+    hpa = strtof(arg, nullptr);
+    if (!(hpa >= 300.0f && hpa <= 1100.0f)) {
+      return sendJson(req, HTTPD_400, "{\"error\":\"pressure out of range\"}");
+    }
+    barometer_setReferencePressure((uint32_t)(hpa * 25600.0f + 0.5f));
+  } else {
+    BarometerReading reading;
+    barometer_getReading(reading);
+    if (!reading.ready || isnan(reading.pressure)) {
+      return sendJson(req, "503 Service Unavailable", "{\"error\":\"barometer not ready\"}");
+    }
+    hpa = reading.pressure;
+    barometer_setReference();
+  }
+
+  char buf[64];
+  snprintf(buf, sizeof(buf), "{\"status\":\"reference set\",\"reference\":%.2f}", hpa);
+  return sendJson(req, HTTPD_200, buf);
+}
+
+/**
+ * @brief Returns I2C bus diagnostics of the barometer read path and its
+ * acquisition rate. Optional `clock=<Hz>` sets the preferred bus speed,
+ * `idle_frequency=<Hz>` the read rate between sessions.
+ * Endpoint: /api/barometer/diag[?clock=<Hz>][&idle_frequency=<Hz>]
+ */
+static esp_err_t handleBarometerDiag(httpd_req_t* req) {
+  bool too_long = false;
+  char clock[12];
+  const bool has_clock =
+      http_queryArg(req, "clock", clock, sizeof(clock), too_long) && clock[0] != '\0';
+  char idle[12];
+  const bool has_idle =
+      http_queryArg(req, "idle_frequency", idle, sizeof(idle), too_long) && idle[0] != '\0';
+  if (too_long) return sendJson(req, HTTPD_400, "{\"error\":\"parameter too long\"}");
+  if (has_clock) barometer_setBusClock((uint32_t)strtoul(clock, nullptr, 10));
+  if (has_idle) fdr_setIdleRate(strtof(idle, nullptr));
+  FdrAcquisitionInfo acquisition;
+  fdr_getAcquisitionInfo(acquisition);
+
+  BarometerBusStats bus;
+  barometer_getBusStats(bus);
+  BarometerReading reading;
+  barometer_getReading(reading);
+  char response[512];
+  snprintf(response, sizeof(response),
+           "{\"ready\":%s,\"clock_hz\":%u,\"configured_clock_hz\":%u,\"fallbacks\":%u,"
+           "\"transactions\":%u,\"errors\":{\"total\":%u,\"nack_addr\":%u,"
+           "\"nack_data\":%u,\"timeout\":%u,\"other\":%u,\"short_read\":%u},"
+           "\"transaction_us\":{\"last\":%u,\"avg\":%u,\"max\":%u},"
+           "\"max_read_rate_hz\":%u,\"acquisition\":{\"mode\":\"%s\",\"frequency\":%u.%03u,"
+           "\"idle_frequency\":%u.%03u}}",
+           reading.ready ? "true" : "false",
+           (unsigned)bus.clock_hz, (unsigned)bus.configured_clock_hz,
+           (unsigned)bus.fallbacks, (unsigned)bus.transactions, (unsigned)bus.errors,
+           (unsigned)bus.nack_addr, (unsigned)bus.nack_data, (unsigned)bus.timeouts,
+           (unsigned)bus.other_errors, (unsigned)bus.short_reads,
+           (unsigned)bus.last_us, (unsigned)bus.avg_us, (unsigned)bus.max_us,
+           (unsigned)(bus.avg_us ? 1000000UL / bus.avg_us : 0), acquisition.mode,
+           (unsigned)(acquisition.rate_mhz / 1000), (unsigned)(acquisition.rate_mhz % 1000),
+           (unsigned)(acquisition.idle_rate_mhz / 1000),
+           (unsigned)(acquisition.idle_rate_mhz % 1000));
+  return sendJson(req, HTTPD_200, response);
+}
+
+/**
+ * @brief Returns the latest IMU sample (g, °/s) and FIFO counters.
+ * Endpoint: /api/imu
+ */
+static esp_err_t handleImu(httpd_req_t* req) {
+  ImuSample sample;
+  if (!imu_getLatest(sample)) {
+    return sendJson(req, "503 Service Unavailable", "{\"error\":\"imu not ready\"}");
+  }
+
+  ImuStats stats;
+  imu_getStats(stats);
+  const float g = (float)IMU_ACCEL_LSB_PER_G;
+  const float dps = (float)IMU_GYRO_LSB_PER_DPS_X10 / 10.0f;
+  char buf[384];
+  snprintf(buf, sizeof(buf),
+           "{\"rate_hz\":%u,\"accel_g\":[%.3f,%.3f,%.3f],\"gyro_dps\":[%.1f,%.1f,%.1f],"
+           "\"fifo\":{\"samples\":%u,\"overflows\":%u,\"read_errors\":%u,\"resyncs\":%u}}",
+           (unsigned)imu_getRate(),
+           sample.accel[0] / g, sample.accel[1] / g, sample.accel[2] / g,
+           sample.gyro[0] / dps, sample.gyro[1] / dps, sample.gyro[2] / dps,
+           (unsigned)stats.samples, (unsigned)stats.fifo_overflows,
+           (unsigned)stats.read_errors, (unsigned)stats.resyncs);
+  return sendJson(req, HTTPD_200, buf);
+}
+
+/**
+ * @brief Start FDR sampling with optional duration, frequency, IMU rate,
+ * burst window and pressure filter chain, or armed with a pre-trigger
+ * window and its trigger conditions. A session too large for the storage
+ * is started at lower rates, or refused with 507 given `on_full=reject`.
+ * Endpoint: /api/fdr/start?duration=<seconds>&frequency=<Hz>
+ *           [&imu_frequency=<Hz>][&burst=<seconds>&burst_frequency=<Hz>]
+ *           [&filter=<chain>][&raw=1][&altitude=0][&forced=0]
+ *           [&pretrigger=<seconds>[&trigger_drop=<Pa/s>][&trigger_accel=<g>]
+ *            [&trigger_launch=1]][&on_full=decimate|reject]
+ */
+static esp_err_t handleFdrStart(httpd_req_t* req) {
+  bool too_long = false;
+  char arg[16];
+  FdrSessionConfig config; // defaults: 180 s at 1 Hz, IMU at 200 Hz, no burst
+
+  if (http_queryArg(req, "duration", arg, sizeof(arg), too_long) && arg[0]) {
+    config.duration_s = (uint32_t)strtoul(arg, nullptr, 10);
+  }
+  if (http_queryArg(req, "frequency", arg, sizeof(arg), too_long) && arg[0]) {
+    config.samples_per_sec = strtof(arg, nullptr);
+  }
+  if (http_queryArg(req, "burst", arg, sizeof(arg), too_long) && arg[0]) {
+    config.burst_ms = (uint32_t)(strtof(arg, nullptr) * 1000.0f);
+  }
+  if (http_queryArg(req, "burst_frequency", arg, sizeof(arg), too_long) && arg[0]) {
+    config.burst_samples_per_sec = strtof(arg, nullptr);
+  }
+  if (http_queryArg(req, "imu_frequency", arg, sizeof(arg), too_long) && arg[0]) {
+    config.imu_rate_hz = (uint16_t)strtoul(arg, nullptr, 10);
+  }
+  char filter[64];
+  if (http_queryArg(req, "filter", filter, sizeof(filter), too_long) && filter[0] &&
+      !pressureFilter_parse(filter, config.filter)) {
+    return sendJson(req, HTTPD_400, "{\"error\":\"invalid filter\"}");
+  }
+  if (http_queryArg(req, "raw", arg, sizeof(arg), too_long)) {
+    config.record_raw = strcmp(arg, "1") == 0;
+  }
+  if (http_queryArg(req, "altitude", arg, sizeof(arg), too_long)) {
+    config.record_altitude = strcmp(arg, "0") != 0;
+  }
+  if (http_queryArg(req, "forced", arg, sizeof(arg), too_long)) {
+    config.baro_forced = strcmp(arg, "0") != 0;
+  }
+  if (http_queryArg(req, "pretrigger", arg, sizeof(arg), too_long) && arg[0]) {
+    config.pretrigger_ms = (uint32_t)(strtof(arg, nullptr) * 1000.0f);
+  }
+  if (http_queryArg(req, "trigger_drop", arg, sizeof(arg), too_long) && arg[0]) {
+    config.trigger.pressure_drop_pa_s = (uint32_t)strtoul(arg, nullptr, 10);
+  }
+  if (http_queryArg(req, "trigger_accel", arg, sizeof(arg), too_long) && arg[0]) {
+    config.trigger.accel_mg = (uint32_t)(strtof(arg, nullptr) * 1000.0f);
+  }
+  if (http_queryArg(req, "trigger_launch", arg, sizeof(arg), too_long)) {
+    config.trigger.launch = strcmp(arg, "1") == 0;
+  }
+  if (http_queryArg(req, "on_full", arg, sizeof(arg), too_long) && arg[0]) {
+    if (strcmp(arg, "reject") == 0) {
+      config.storage_policy = FdrStoragePolicy::Reject;
+    } else if (strcmp(arg, "decimate") != 0) {
+      return sendJson(req, HTTPD_400, "{\"error\":\"invalid on_full\"}");
+    }
+  }
+  if (too_long) return sendJson(req, HTTPD_400, "{\"error\":\"parameter too long\"}");
+  if (config.pretrigger_ms > 0 && config.trigger.pressure_drop_pa_s == 0 &&
+      config.trigger.accel_mg == 0 && !config.trigger.launch) {
+    return sendJson(req, HTTPD_400, "{\"error\":\"no trigger condition\"}");
+  }
+
+  const bool started = fdr_start(config);
+
+  FdrStoragePlan plan;
+  fdr_getStoragePlan(plan);
+  char storage[256];
+  snprintf(storage, sizeof(storage),
+           "{\"bytes_per_s\":%u,\"session_bytes\":%u,\"available_bytes\":%u,"
+           "\"decimated\":%s,\"requested_frequency\":%u.%03u,\"requested_imu_frequency\":%u}",
+           (unsigned)plan.bytes_per_s, (unsigned)plan.session_bytes,
+           (unsigned)plan.available_bytes, plan.decimated ? "true" : "false",
+           (unsigned)(plan.requested_rate_mhz / 1000), (unsigned)(plan.requested_rate_mhz % 1000),
+           (unsigned)plan.requested_imu_rate_hz);
+  char response[896];
+  if (!started) {
+    if (!plan.rejected) return sendJson(req, HTTPD_500, "{\"error\":\"start failed\"}");
+    snprintf(response, sizeof(response), "{\"error\":\"insufficient storage\",\"storage\":%s}",
+             storage);
+    return sendJson(req, "507 Insufficient Storage", response);
+  }
+
+  // Report the effective (clamped) parameters rather than the requested ones
+  FdrSessionInfo info;
+  fdr_getSessionInfo(info);
+  pressureFilter_describe(info.filter, filter, sizeof(filter));
+  snprintf(response, sizeof(response),
+           "{\"status\":\"%s\",\"session\":%u,\"duration\":%u,\"frequency\":%u.%03u,"
+           "\"interval_ms\":%u,\"interval_us\":%u,\"imu_frequency\":%u,"
+           "\"filter\":\"%s\",\"raw\":%s,\"altitude\":%s,\"forced\":%s,"
+           "\"burst\":{\"duration_ms\":%u,\"frequency\":%u.%03u,\"interval_us\":%u,"
+           "\"capacity_bytes\":%u},"
+           "\"pretrigger\":{\"duration_ms\":%u,\"trigger_drop\":%u,"
+           "\"trigger_accel\":%u.%03u,\"trigger_launch\":%s},\"storage\":%s}",
+           info.armed ? "armed" : "started", (unsigned)info.session_id,
+           (unsigned)info.duration_s, (unsigned)(info.rate_mhz / 1000),
+           (unsigned)(info.rate_mhz % 1000),
+           (unsigned)(info.period_us / 1000), (unsigned)info.period_us,
+           (unsigned)info.imu_rate_hz, filter, info.record_raw ? "true" : "false",
+           info.record_altitude ? "true" : "false", info.baro_forced ? "true" : "false",
+           (unsigned)info.burst_ms, (unsigned)(info.burst_rate_mhz / 1000),
+           (unsigned)(info.burst_rate_mhz % 1000), (unsigned)info.burst_period_us,
+           (unsigned)info.burst_capacity_bytes,
+           (unsigned)info.pretrigger_ms, (unsigned)info.trigger.pressure_drop_pa_s,
+           (unsigned)(info.trigger.accel_mg / 1000), (unsigned)(info.trigger.accel_mg % 1000),
+           info.trigger.launch ? "true" : "false", storage);
+  return sendJson(req, HTTPD_200, response);
+}
+
+/**
+ * @brief Stop FDR sampling.
+ * Endpoint: /api/fdr/stop
+ */
+static esp_err_t handleFdrStop(httpd_req_t* req) {
+  fdr_stop();
+  return sendJson(req, HTTPD_200, "{\"status\":\"stopped\"}");
+}
+
+/**
+ * @brief Reset FDR data and counters.
+ * Endpoint: /api/fdr/reset
+ */
+static esp_err_t handleFdrReset(httpd_req_t* req) {
+  fdr_reset();
+  return sendJson(req, HTTPD_200, "{\"status\":\"reset\"}");
+}
+
+/**
+ * @brief Returns FDR recording state and RAM buffer counters.
+ * Endpoint: /api/fdr/status
+ */
+static esp_err_t handleFdrStatus(httpd_req_t* req) {
+  FdrBufferStats stats;
+  fdr_getBufferStats(stats);
+  FdrSessionInfo info;
+  fdr_getSessionInfo(info);
+  char trigger[96];
+  if (info.triggered) {
+    snprintf(trigger, sizeof(trigger), "{\"cause\":\"%s\",\"t_ms\":%u}",
+             info.trigger_cause, (unsigned)info.trigger_t_ms);
+  } else {
+    snprintf(trigger, sizeof(trigger), "null");
+  }
+  char resumed[12] = "null";
+  if (info.resumed_from) snprintf(resumed, sizeof(resumed), "%u", (unsigned)info.resumed_from);
+  char response[800];
+  snprintf(response, sizeof(response),
+           "{\"active\":%s,\"armed\":%s,\"resumed_from\":%s,\"records\":{\"baro\":%u,\"imu\":%u,\"imu_frequency\":%u},"
+           "\"buffer\":{\"used\":%u,\"capacity\":%u,\"high_water\":%u},"
+           "\"queue\":{\"used\":%u,\"capacity\":%u,\"high_water\":%u},"
+           "\"imu_queue\":{\"used\":%u,\"capacity\":%u,\"high_water\":%u},"
+           "\"burst\":{\"records\":%u,\"bytes\":%u,\"capacity\":%u,\"committed\":%s},"
+           "\"pretrigger\":{\"duration_ms\":%u,\"bytes\":%u,\"capacity\":%u,\"trigger\":%s},"
+           "\"compression\":{\"raw_bytes\":%u,\"stored_bytes\":%u},"
+           "\"overflow\":{\"records\":%u,\"bytes\":%u,\"queue_records\":%u,"
+           "\"imu_queue_records\":%u,\"burst_records\":%u}}",
+           fdr_isActive() ? "true" : "false", info.armed ? "true" : "false", resumed,
+           (unsigned)stats.baro_records, (unsigned)stats.imu_records,
+           (unsigned)info.imu_rate_hz,
+           (unsigned)stats.buffered_bytes, (unsigned)stats.capacity_bytes,
+           (unsigned)stats.high_water_bytes,
+           (unsigned)stats.queue_depth, (unsigned)stats.queue_capacity,
+           (unsigned)stats.queue_high_water,
+           (unsigned)stats.imu_queue_depth, (unsigned)stats.imu_queue_capacity,
+           (unsigned)stats.imu_queue_high_water,
+           (unsigned)info.burst_records, (unsigned)info.burst_bytes,
+           (unsigned)info.burst_capacity_bytes,
+           info.burst_committed ? "true" : "false",
+           (unsigned)info.pretrigger_ms, (unsigned)info.pretrigger_bytes,
+           (unsigned)info.pretrigger_capacity_bytes, trigger,
+           (unsigned)stats.raw_bytes, (unsigned)stats.encoded_bytes,
+           (unsigned)stats.overflow_records, (unsigned)stats.overflow_bytes,
+           (unsigned)stats.queue_dropped, (unsigned)stats.imu_queue_dropped,
+           (unsigned)info.burst_dropped);
+  return sendJson(req, HTTPD_200, response);
+}
+
+/**
+ * @brief Returns sample scheduling statistics, storage activity and the
+ * storage plan and backpressure of the current/last session.
+ * Endpoint: /api/fdr/stats
+ */
+static esp_err_t handleFdrStats(httpd_req_t* req) {
+  FdrTimingStats timing;
+  fdr_getTimingStats(timing);
+
+  char hist[128];
+  size_t len = 0;
+  for (size_t i = 0; i < FDR_JITTER_BUCKETS; i++) {
+    len += snprintf(hist + len, sizeof(hist) - len, "%s%u", i ? "," : "",
+                    (unsigned)timing.jitter_hist[i]);
+  }
+  char limits[64];
+  len = 0;
+  for (size_t i = 0; i < FDR_JITTER_BUCKETS - 1; i++) {
+    len += snprintf(limits + len, sizeof(limits) - len, "%s%u", i ? "," : "",
+                    (unsigned)FDR_JITTER_BUCKET_LIMITS_US[i]);
+  }
+
+  FdrStorageStats st;
+  fdr_getStorageStats(st);
+  FdrStoragePlan plan;
+  fdr_getStoragePlan(plan);
+  char cause[12] = "null";
+  if (plan.backpressure_cause) snprintf(cause, sizeof(cause), "\"%s\"", plan.backpressure_cause);
+
+  char response[1280];
+  snprintf(response, sizeof(response),
+           "{\"active\":%s,\"frequency\":%u.%03u,\"period_us\":%u,"
+           "\"samples\":%u,\"missed_deadlines\":%u,\"skipped_not_ready\":%u,"
+           "\"skipped_stale\":%u,\"jitter_us\":{\"min\":%u,\"avg\":%u,\"max\":%u,"
+           "\"bucket_limits\":[%s],\"histogram\":[%s]},"
+           "\"storage\":{\"backend\":\"%s\",\"total_bytes\":%u,\"free_bytes\":%u,"
+           "\"flushes\":%u,\"write_bytes\":%u,"
+           "\"flush_us\":{\"last\":%u,\"avg\":%u,\"max\":%u},"
+           "\"commits\":%u,\"syncs\":%u,\"sync_max_us\":%u,"
+           "\"erases\":%u,\"erase_max_us\":%u,\"erase_stalls\":%u},"
+           "\"plan\":{\"bytes_per_s\":%u,\"session_bytes\":%u,\"available_bytes\":%u,"
+           "\"decimated\":%s,\"rejected\":%s},"
+           "\"backpressure\":{\"decimation\":%u,\"max_decimation\":%u,"
+           "\"decimated_records\":%u,\"steps\":%u,\"cause\":%s}}",
+           fdr_isActive() ? "true" : "false",
+           (unsigned)(timing.rate_mhz / 1000), (unsigned)(timing.rate_mhz % 1000),
+           (unsigned)timing.period_us, (unsigned)timing.samples,
+           (unsigned)timing.missed_deadlines, (unsigned)timing.skipped_not_ready,
+           (unsigned)timing.skipped_stale,
+           (unsigned)timing.jitter_min_us, (unsigned)timing.jitter_avg_us,
+           (unsigned)timing.jitter_max_us, limits, hist,
+           st.backend, (unsigned)st.total_bytes, (unsigned)st.free_bytes,
+           (unsigned)st.flushes, (unsigned)st.write_bytes,
+           (unsigned)st.flush_last_us, (unsigned)st.flush_avg_us, (unsigned)st.flush_max_us,
+           (unsigned)st.commits, (unsigned)st.syncs, (unsigned)st.sync_max_us,
+           (unsigned)st.erases, (unsigned)st.erase_max_us, (unsigned)st.erase_stalls,
+           (unsigned)plan.bytes_per_s, (unsigned)plan.session_bytes,
+           (unsigned)plan.available_bytes, plan.decimated ? "true" : "false",
+           plan.rejected ? "true" : "false",
+           (unsigned)plan.decimation, (unsigned)plan.max_decimation,
+           (unsigned)plan.decimated_records, (unsigned)plan.backpressure_steps, cause);
+  return sendJson(req, HTTPD_200, response);
+}
+
+/**
+ * @brief Lists the stored sessions from the on-flash index.
+ * Endpoint: /api/fdr/sessions
+ */
+static esp_err_t handleFdrSessions(httpd_req_t* req) {
+  // Handlers run one at a time on the server task
+  static FdrSessionSummary sessions[FDR_MAX_SESSIONS];
+  const size_t count = fdr_listSessions(sessions, FDR_MAX_SESSIONS);
+
+  httpd_resp_set_type(req, "application/json");
+  httpd_resp_sendstr_chunk(req, "{\"sessions\":[");
+  char entry[320];
+  for (size_t i = 0; i < count; i++) {
+    const FdrSessionSummary &s = sessions[i];
+    char pressure[48] = "null,\"pressure_max\":null";
+    if (s.baro_records > 0) {
+      snprintf(pressure, sizeof(pressure), "%.2f,\"pressure_max\":%.2f",
+               s.pressure_min_hpa, s.pressure_max_hpa);
+    }
+    snprintf(entry, sizeof(entry),
+             "%s{\"id\":%u,\"start_uptime_ms\":%u,\"frequency\":%u.%03u,"
+             "\"imu_frequency\":%u,\"open\":%s,\"recovered\":%s,\"resumed\":%s,\"duration_ms\":%u,"
+             "\"records\":{\"baro\":%u,\"imu\":%u},\"bytes\":%u,"
+             "\"pressure_min\":%s}",
+             i ? "," : "", (unsigned)s.id, (unsigned)s.start_uptime_ms,
+             (unsigned)(s.rate_mhz / 1000), (unsigned)(s.rate_mhz % 1000),
+             (unsigned)s.imu_rate_hz, s.open ? "true" : "false",
+             s.recovered ? "true" : "false", s.resumed ? "true" : "false",
+             (unsigned)s.duration_ms, (unsigned)s.baro_records,
+             (unsigned)s.imu_records, (unsigned)s.bytes, pressure);
+    if (httpd_resp_sendstr_chunk(req, entry) != ESP_OK) return ESP_FAIL;
+  }
+  httpd_resp_sendstr_chunk(req, "]}");
+  return httpd_resp_send_chunk(req, nullptr, 0);
+}
+
+/**
+ * @brief Download a session as CSV, one channel per download, or as the
+ * stored binary log.
+ * Endpoint: /api/fdr/download[?session=<id>][&channel=baro|baro_raw|alt|imu|events]
+ *           [&format=bin]
+ * Closed sessions support Range/If-Range for resumed downloads.
+ */
+static esp_err_t handleFdrDownload(httpd_req_t* req) {
+  fdr_streamFile(req);
+  return ESP_OK;
+}
+
+/**
+ * @brief Recorded samples of a time range in one JSON or binary response.
+ * Endpoint: /api/fdr/query[?session=<id>][&from=<s>][&to=<s>][&step=<s>]
+ *           [&channels=baro,baro_raw,alt,imu,events][&format=json|bin]
+ */
+static esp_err_t handleFdrQuery(httpd_req_t* req) {
+  fdr_query(req);
+  return ESP_OK;
+}
+
+/**
+ * @brief Live telemetry as Server-Sent Events, batched every 100 ms.
+ * Endpoint: /api/fdr/live[?decimation=<n>][&channel=baro|imu]
+ */
+static esp_err_t handleFdrLive(httpd_req_t* req) {
+  fdr_liveAttach(req);
+  return ESP_OK;
+}
+
+/**
+ * @brief Copies `text` as the contents of a JSON string: quotes and
+ * backslashes escaped, control characters dropped.
+ */
+static void jsonEscape(const char* text, char* out, size_t len) {
+  size_t used = 0;
+  for (; *text != '\0' && used + 2 < len; text++) {
+    const char c = *text;
+    if ((unsigned char)c < 0x20) continue;
+    if (c == '"' || c == '\\') out[used++] = '\\';
+    out[used++] = c;
+  }
+  out[used] = '\0';
+}
+
+/**
+ * @brief Returns the lines of the RAM log ring, oldest first. Pass the
+ * previous `next` as `since` to poll only for new lines; `level` keeps
+ * only lines of that severity or worse.
+ * Endpoint: /api/logs[?since=<seq>][&level=error|warn|info|debug]
+ */
+static esp_err_t handleLogs(httpd_req_t* req) {
+  bool too_long = false;
+  char arg[12];
+  const uint32_t since =
+      http_queryArg(req, "since", arg, sizeof(arg), too_long) ? strtoul(arg, nullptr, 10) : 0;
+  const bool has_level = http_queryArg(req, "level", arg, sizeof(arg), too_long) && arg[0] != '\0';
+  if (too_long) return sendJson(req, HTTPD_400, "{\"error\":\"parameter too long\"}");
+  uint8_t max_level = LOGGER_LEVEL_DEBUG;
+  if (has_level) {
+    static const char* const LEVELS[] = {"error", "warn", "info", "debug"};
+    bool known = false;
+    for (uint8_t i = 0; i < 4; i++) {
+      if (strcmp(arg, LEVELS[i]) == 0) {
+        max_level = LOGGER_LEVEL_ERROR + i;
+        known = true;
+      }
+    }
+    if (!known) return sendJson(req, HTTPD_400, "{\"error\":\"invalid level\"}");
+  }
+
+  // Handlers run one at a time on the server task
+  static LoggerLine lines[LOGGER_RING_LINES];
+  uint32_t lost = 0;
+  const size_t count = logger_read(since, lines, LOGGER_RING_LINES, lost);
+  const uint32_t next = count ? lines[count - 1].seq + 1 : logger_nextSeq();
+
+  char entry[2 * LOGGER_LINE_MAX + 64];
+  snprintf(entry, sizeof(entry), "{\"next\":%u,\"lost\":%u,\"serial_dropped\":%u,\"lines\":[",
+           (unsigned)next, (unsigned)lost, (unsigned)logger_serialDropped());
+  httpd_resp_set_type(req, "application/json");
+  httpd_resp_sendstr_chunk(req, entry);
+  bool first = true;
+  for (size_t i = 0; i < count; i++) {
+    const LoggerLine &line = lines[i];
+    if (line.level > max_level) continue;
+    char text[2 * LOGGER_LINE_MAX];
+    jsonEscape(line.text, text, sizeof(text));
+    snprintf(entry, sizeof(entry), "%s{\"seq\":%u,\"t_ms\":%u,\"level\":\"%c\",\"text\":\"%s\"}",
+             first ? "" : ",", (unsigned)line.seq, (unsigned)line.t_ms,
+             logger_levelLetter(line.level), text);
+    first = false;
+    if (httpd_resp_sendstr_chunk(req, entry) != ESP_OK) return ESP_FAIL;
+  }
+  httpd_resp_sendstr_chunk(req, "]}");
+  return httpd_resp_send_chunk(req, nullptr, 0);
+}
+
+/**
+ * @brief Name of a reset cause.
+ */
+static const char* resetReasonName(esp_reset_reason_t reason) {
+  switch (reason) {
+    case ESP_RST_POWERON: return "poweron";
+    case ESP_RST_EXT: return "external";
+    case ESP_RST_SW: return "software";
+    case ESP_RST_PANIC: return "panic";
+    case ESP_RST_INT_WDT:
+    case ESP_RST_TASK_WDT:
+    case ESP_RST_WDT: return "watchdog";
+    case ESP_RST_DEEPSLEEP: return "deepsleep";
+    case ESP_RST_BROWNOUT: return "brownout";
+    default: return "unknown";
+  }
+}
+
+/**
+ * @brief Returns the reset cause, the boot milestones in ms since the
+ * application started, and the session resumed at boot, if any.
+ * Endpoint: /api/boot
+ */
+static esp_err_t handleBoot(httpd_req_t* req) {
+  FdrSessionInfo info;
+  fdr_getSessionInfo(info);
+  char resumed[12] = "null";
+  if (info.resumed_from) snprintf(resumed, sizeof(resumed), "%u", (unsigned)info.resumed_from);
+  const int64_t ap_us = boot_ap_us.load(std::memory_order_relaxed);
+  char ap[16] = "null";
+  if (ap_us) snprintf(ap, sizeof(ap), "%.1f", ap_us / 1000.0);
+
+  char buf[192];
+  snprintf(buf, sizeof(buf),
+           "{\"reset_reason\":\"%s\",\"sensors_ms\":%.1f,\"sampling_ms\":%.1f,"
+           "\"http_ms\":%.1f,\"ap_ms\":%s,\"resumed_session\":%s}",
+           resetReasonName(esp_reset_reason()), boot_sensors_us / 1000.0,
+           boot_sampling_us / 1000.0, boot_http_us / 1000.0, ap, resumed);
+  return sendJson(req, HTTPD_200, buf);
+}
+
+/**
+ * @brief Returns the power mode, the time spent in each power state and the
+ * modelled current. Optional `mode=performance|saving` selects the mode;
+ * `awake_ma`, `doze_ma` and `sleep_ma` replace the current model of a state
+ * with a bench measurement; `battery_mah` adds the estimated runtime on
+ * that battery at the average current.
+ * Endpoint: /api/power[?mode=performance|saving][&awake_ma=<mA>][&doze_ma=<mA>]
+ *           [&sleep_ma=<mA>][&battery_mah=<mAh>]
+ */
+static esp_err_t handlePower(httpd_req_t* req) {
+  bool too_long = false;
+  char mode[16];
+  const bool has_mode = http_queryArg(req, "mode", mode, sizeof(mode), too_long) && mode[0] != '\0';
+  static const char* const CURRENT_ARGS[POWER_STATE_COUNT] = {"awake_ma", "doze_ma", "sleep_ma"};
+  char currents[POWER_STATE_COUNT][16];
+  for (size_t i = 0; i < POWER_STATE_COUNT; i++) {
+    http_queryArg(req, CURRENT_ARGS[i], currents[i], sizeof(currents[i]), too_long);
+  }
+  char battery[16];
+  http_queryArg(req, "battery_mah", battery, sizeof(battery), too_long);
+  if (too_long) return sendJson(req, HTTPD_400, "{\"error\":\"parameter too long\"}");
+
+  if (has_mode) {
+    if (strcmp(mode, "performance") == 0) {
+      power_setMode(PowerMode::Performance);
+    } else if (strcmp(mode, "saving") == 0) {
+      power_setMode(PowerMode::Saving);
+    } else {
+      return sendJson(req, HTTPD_400, "{\"error\":\"invalid mode\"}");
+    }
+  }
+  for (size_t i = 0; i < POWER_STATE_COUNT; i++) {
+    if (currents[i][0] == '\0') continue;
+    const float ma = strtof(currents[i], nullptr);
+    if (!(ma >= 0.0f && ma <= 1000.0f)) {
+      return sendJson(req, HTTPD_400, "{\"error\":\"current out of range\"}");
+    }
+    power_setStateCurrent((PowerState)i, (uint32_t)(ma * 1000.0f + 0.5f));
+  }
+  const uint32_t battery_mah = (uint32_t)strtoul(battery, nullptr, 10);
+
+  PowerStats stats;
+  power_getStats(stats);
+  char states[POWER_STATE_COUNT][80];
+  for (size_t i = 0; i < POWER_STATE_COUNT; i++) {
+    snprintf(states[i], sizeof(states[i]), "\"%s\":{\"time_s\":%u.%03u,\"current_ma\":%u.%03u}",
+             power_stateName((PowerState)i), (unsigned)(stats.time_us[i] / 1000000),
+             (unsigned)(stats.time_us[i] / 1000 % 1000), (unsigned)(stats.current_ua[i] / 1000),
+             (unsigned)(stats.current_ua[i] % 1000));
+  }
+  char runtime[48] = "";
+  if (battery_mah > 0 && stats.average_ua > 0) {
+    const uint64_t centi_h = (uint64_t)battery_mah * 100000 / stats.average_ua;
+    snprintf(runtime, sizeof(runtime), ",\"battery_mah\":%u,\"runtime_h\":%u.%02u",
+             (unsigned)battery_mah, (unsigned)(centi_h / 100), (unsigned)(centi_h % 100));
+  }
+  char response[448];
+  snprintf(response, sizeof(response),
+           "{\"mode\":\"%s\",\"state\":\"%s\",\"cpu_mhz\":%u,\"clients\":%u,\"flight\":%s,"
+           "\"sleeps\":%u,\"states\":{%s,%s,%s},\"average_ma\":%u.%03u%s}",
+           power_modeName(stats.mode), power_stateName(stats.state), (unsigned)stats.cpu_mhz,
+           (unsigned)stats.clients, stats.flight ? "true" : "false", (unsigned)stats.sleeps,
+           states[0], states[1], states[2], (unsigned)(stats.average_ua / 1000),
+           (unsigned)(stats.average_ua % 1000), runtime);
+  return sendJson(req, HTTPD_200, response);
+}
+
+#if FDR_PERF
+/**
+ * @brief Formats a duration in ns as µs with two decimals.
+ */
+static void formatNsUs(uint32_t ns, char* out, size_t len) {
+  const uint32_t centi_us = ns / 10;
+  snprintf(out, len, "%u.%02u", (unsigned)(centi_us / 100), (unsigned)(centi_us % 100));
+}
+
+/**
+ * @brief Returns the profiling scopes: count and min/avg/max/p50/p99 in µs,
+ * each sample converted at the CPU clock it was taken at. Optional
+ * `reset=1` clears them after the report.
+ * Endpoint: /api/debug/perf[?reset=1] (FDR_PERF builds only)
+ */
+static esp_err_t handleDebugPerf(httpd_req_t* req) {
+  char reset[4];
+  const HttpArg reset_arg = http_queryArg(req, "reset", reset, sizeof(reset));
+  if (reset_arg == HttpArg::TooLong) {
+    return sendJson(req, HTTPD_400, "{\"error\":\"parameter too long\"}");
+  }
+
+  char entry[256];
+  snprintf(entry, sizeof(entry), "{\"cpu_mhz\":%u,\"scopes\":[", (unsigned)perf_cpuMhz());
+  httpd_resp_set_type(req, "application/json");
+  httpd_resp_sendstr_chunk(req, entry);
+  for (size_t i = 0; i < PERF_SCOPE_COUNT; i++) {
+    PerfStats s;
+    perf_getStats((PerfScope)i, s);
+    char us[5][16];
+    const uint32_t ns[5] = {s.min_ns, s.avg_ns, s.max_ns, s.p50_ns, s.p99_ns};
+    for (size_t k = 0; k < 5; k++) formatNsUs(ns[k], us[k], sizeof(us[k]));
+    snprintf(entry, sizeof(entry),
+             "%s{\"name\":\"%s\",\"count\":%u,"
+             "\"us\":{\"min\":%s,\"avg\":%s,\"max\":%s,\"p50\":%s,\"p99\":%s}}",
+             i ? "," : "", s.name, (unsigned)s.count, us[0], us[1], us[2], us[3], us[4]);
+    if (httpd_resp_sendstr_chunk(req, entry) != ESP_OK) return ESP_FAIL;
+  }
+  httpd_resp_sendstr_chunk(req, "]}");
+
+  if (reset_arg == HttpArg::Present && strcmp(reset, "1") == 0) perf_reset();
+  return httpd_resp_send_chunk(req, nullptr, 0);
+}
+
+/**
+ * @brief Runs the API handler stored in the endpoint's user_ctx inside the
+ * http_handler scope; every endpoint is registered through it.
+ */
+static esp_err_t timedHandler(httpd_req_t* req) {
+  PERF_SCOPE(HttpHandler);
+  const auto handler = reinterpret_cast<esp_err_t (*)(httpd_req_t*)>(req->user_ctx);
+  return handler(req);
+}
+#endif // FDR_PERF
+
+/**
+ * @brief URI table registered with the server.
+ */
+static const httpd_uri_t API_ENDPOINTS[] = {
+  {"/api/barometer", HTTP_GET, handleBarometer, nullptr},
+  {"/api/barometer/diag", HTTP_GET, handleBarometerDiag, nullptr},
+  {"/api/barometer/reference", HTTP_GET, handleBarometerReference, nullptr},
+  {"/api/imu", HTTP_GET, handleImu, nullptr},
+  {"/api/fdr/start", HTTP_GET, handleFdrStart, nullptr},
+  {"/api/fdr/stop", HTTP_GET, handleFdrStop, nullptr},
+  {"/api/fdr/reset", HTTP_GET, handleFdrReset, nullptr},
+  {"/api/fdr/status", HTTP_GET, handleFdrStatus, nullptr},
+  {"/api/fdr/stats", HTTP_GET, handleFdrStats, nullptr},
+  {"/api/fdr/sessions", HTTP_GET, handleFdrSessions, nullptr},
+  {"/api/fdr/download", HTTP_GET, handleFdrDownload, nullptr},
+  {"/api/fdr/query", HTTP_GET, handleFdrQuery, nullptr},
+  {"/api/fdr/live", HTTP_GET, handleFdrLive, nullptr},
+  {"/api/logs", HTTP_GET, handleLogs, nullptr},
+  {"/api/power", HTTP_GET, handlePower, nullptr},
+  {"/api/boot", HTTP_GET, handleBoot, nullptr},
+#if FDR_PERF
+  {"/api/debug/perf", HTTP_GET, handleDebugPerf, nullptr},
+#endif
+};
+
+/**
+ * @brief Starts the HTTP server task and registers the API endpoints.
+ *
+ * Besides the live and download connections, which the FDR module takes
+ * over, a few sockets are left for ordinary requests; when all are in use
+ * the least recently used one is closed.
+ */
+static void startHttpServer() {
+  httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+  config.task_priority = HTTP_TASK_PRIORITY;
+  config.stack_size = HTTP_TASK_STACK;
+  config.max_uri_handlers = sizeof(API_ENDPOINTS) / sizeof(API_ENDPOINTS[0]);
+  config.max_open_sockets = FDR_LIVE_MAX_CLIENTS + FDR_MAX_DOWNLOADS + 3;
+  config.lru_purge_enable = true;
+
+  if (httpd_start(&server, &config) != ESP_OK) {
+    LOG_ERROR("HTTP server failed to start");
+    return;
+  }
+  for (const httpd_uri_t &endpoint : API_ENDPOINTS) {
+#if FDR_PERF
+    httpd_uri_t timed = endpoint;
+    timed.user_ctx = reinterpret_cast<void*>(endpoint.handler);
+    timed.handler = timedHandler;
+    httpd_register_uri_handler(server, &timed);
+#else
+    httpd_register_uri_handler(server, &endpoint);
+#endif
+  }
+  LOG_INFO("HTTP server started (AP IP: 192.168.4.1)");
+}
+
 // ============================================================================
 // Setup and Initialization
 // ============================================================================
 
+/**
+ * @brief Keeps the power module's count of associated stations current;
+ * a station joining wakes the device up.
+ */
+static void onStationChange(arduino_event_id_t, arduino_event_info_t) {
+  power_setClients((uint8_t)WiFi.softAPgetStationNum());
+}
+
+/**
+ * @brief Notes when the access point is up; it starts in the background
+ * while setup() goes on.
+ */
+static void onApStart(arduino_event_id_t, arduino_event_info_t) {
+  boot_ap_us.store(esp_timer_get_time(), std::memory_order_relaxed);
+  LOG_INFO("AP ready");
+}
+
 /**
  * @brief Arduino setup function.
  * 
- * Initializes serial communication, LED, WiFi AP, I2C bus,
- * barometer and FDR modules, and sets up HTTP endpoints.
+ * Initializes serial communication and logging, LED, I2C bus, power,
+ * barometer, IMU and FDR modules first, so that after a reset (a brownout
+ * mid-flight) sampling and the interrupted session resume within the time
+ * it takes to probe the sensors. The WiFi AP and the HTTP server come
+ * after, while the sampler already runs. The startup blink runs in the LED
+ * task that led_init() starts, so nothing here waits for it.
  */
 void setup() {
   Serial.begin(115200);
-
-  // Initialize LED system and blink startup sequence
-  led_init();
-  led_startupBlink(10, 250);
-
-  // Start WiFi Access Point
-  WiFi.softAP(ssid, password);
-  Serial.println("Creating AP...");
-  delay(1000);
-  led_setBlue();
-  Serial.println("AP ready, blue LED on.");
+  logger_init(); // everything below logs without waiting for the port
+  led_init(); // startup blink, then the mode the FDR sets
 
   // Initialize I2C
   Wire.begin(8, 9); // SDA, SCL pins
-  Wire.setClock(100000); // Set I2C clock to 100 kHz
+  barometer_setBusClock(I2C_CLOCK_HZ); // applied by barometer_init()
 
-  // Initialize sensors and modules
+  // Initialize sensors and modules (fdr_init starts the sampler task and
+  // resumes a session cut off by the reset)
+  power_init();
   barometer_init();
+#if BAROMETER_BENCH
+  barometer_runBenchmark();
+#endif
+  imu_init();
+  boot_sensors_us = esp_timer_get_time();
   fdr_init();
+  boot_sampling_us = esp_timer_get_time();
 
-  // ========================================================================
-  // HTTP API Endpoints
-  // ========================================================================
-
-  /**
-   * @brief Returns barometer readings in JSON format.
-   * Endpoint: /api/barometer
-   */
-  server.on("/api/barometer", HTTP_GET, []() {
-    if (!barometer_isReady()) {
-      server.send(503, "application/json", "{\"error\":\"barometer not ready\"}");
-      return;
-    }
+  // Start WiFi Access Point; it comes up in the background
+  WiFi.onEvent(onStationChange, ARDUINO_EVENT_WIFI_AP_STACONNECTED);
+  WiFi.onEvent(onStationChange, ARDUINO_EVENT_WIFI_AP_STADISCONNECTED);
+  WiFi.onEvent(onApStart, ARDUINO_EVENT_WIFI_AP_START);
+  WiFi.softAP(ssid, password);
+  LOG_INFO("Creating AP...");
 
-    float t = barometer_getTemperature();
-    float p = barometer_getPressure();
-    char buf[128];
-    // Produce simple JSON with 2 decimals
-    snprintf(buf, sizeof(buf), "{\"temperature\":%.2f,\"pressure\":%.2f}", t, p);
-    server.send(200, "application/json", buf);
-  });
-
-  /**
-   * @brief Start FDR sampling with optional duration and frequency.
-   * Endpoint: /api/fdr/start?duration=<seconds>&frequency=<Hz>
-   */
-  server.on("/api/fdr/start", HTTP_GET, []() {
-    String dur = server.arg("duration");
-    String freq = server.arg("frequency");
-    uint32_t d = 180; // default duration (seconds)
-    uint32_t f = 1;   // default frequency (Hz)
-
-    if (dur.length() > 0) d = (uint32_t)dur.toInt();
-    if (freq.length() > 0) f = (uint32_t)freq.toInt();
-
-    fdr_start(d, f);
-
-    char response[256];
-    snprintf(response, sizeof(response), 
-             "{\"status\":\"started\",\"duration\":%u,\"frequency\":%u,\"interval_ms\":%u}",
-             (unsigned)d, (unsigned)f, (unsigned)(f > 0 ? 1000/f : 1000));
-    server.send(200, "application/json", response);
-  });
-
-  /**
-   * @brief Stop FDR sampling.
-   * Endpoint: /api/fdr/stop
-   */
-  server.on("/api/fdr/stop", HTTP_GET, []() {
-    fdr_stop();
-    server.send(200, "application/json", "{\"status\":\"stopped\"}");
-  });
-
-  /**
-   * @brief Reset FDR data and counters.
-   * Endpoint: /api/fdr/reset
-   */
-  server.on("/api/fdr/reset", HTTP_GET, []() {
-    fdr_reset();
-    server.send(200, "application/json", "{\"status\":\"reset\"}");
-  });
-
-  /**
-   * @brief Download FDR data file.
-   * Endpoint: /api/fdr/download
-   */
-  server.on("/api/fdr/download", HTTP_GET, []() {
-    fdr_streamFile(server);
-  });
-
-  // Start HTTP server
-  server.begin();
-  Serial.println("HTTP server started (AP IP: 192.168.4.1)");
+  // Start the HTTP server in its own task
+  startHttpServer();
+  boot_http_us = esp_timer_get_time();
+  LOG_INFO("Boot: %s reset, sensors %u ms, sampling %u ms, HTTP %u ms",
+           resetReasonName(esp_reset_reason()), (unsigned)(boot_sensors_us / 1000),
+           (unsigned)(boot_sampling_us / 1000), (unsigned)(boot_http_us / 1000));
 }
 
 // ============================================================================
@@ -148,17 +894,12 @@ void setup() {
 
 /**
  * @brief Arduino loop function.
- * 
- * Processes sensor readings, handles incoming HTTP requests,
- * and delegates FDR sampling and control to its module.
+ *
+ * Nothing is left to do here: HTTP requests are served by the server task,
+ * barometer reads and FDR sampling run in the FDR sampler task and the LED
+ * patterns in the LED task, so the loop task deletes itself to give its
+ * stack back.
  */
 void loop() {
-  // Process barometer readings
-  barometer_process();
-
-  // Handle incoming HTTP requests
-  server.handleClient();
-
-  // Delegate FDR sampling and control
-  fdr_process();
+  vTaskDelete(nullptr);
 }
@@ -0,0 +1,182 @@
+/**
+ * @file perf.cpp
+ * @brief Hot-path profiling scopes on the CPU cycle counter
+ * @author slopez.tech
+ * @date 2025-11-30
+ */
+
+#include "perf.h"
+
+#if FDR_PERF
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+
+// ============================================================================
+// Configuration Constants
+// ============================================================================
+
+/**
+ * @brief Histogram resolution: 2^PERF_SUB_BITS buckets per power of two,
+ * so a bucket spans at most 25% of its lower bound.
+ */
+static constexpr uint8_t PERF_SUB_BITS = 2;
+static constexpr uint32_t PERF_SUB_BUCKETS = 1u << PERF_SUB_BITS;
+
+/**
+ * @brief Buckets covering the whole 32-bit duration range: the values below
+ * PERF_SUB_BUCKETS exactly, then PERF_SUB_BUCKETS per power of two.
+ */
+static constexpr size_t PERF_BUCKETS = PERF_SUB_BUCKETS * (32 - PERF_SUB_BITS + 1);
+
+static constexpr const char* PERF_SCOPE_NAMES[PERF_SCOPE_COUNT] = {
+  "barometer_process",
+  "fdr_sample",
+  "fdr_imu_drain",
+  "fdr_writer_step",
+  "fdr_flush",
+  "fdr_commit",
+  "fdr_download_step",
+  "fdr_live_batch",
+  "http_handler",
+};
+
+// ============================================================================
+// State
+// ============================================================================
+
+/**
+ * @brief Accumulated durations of one scope. Bucket counts are 16-bit; when
+ * one would overflow all of them are halved, which keeps the shape of the
+ * distribution (and so the percentiles) while bounding the RAM.
+ */
+struct PerfScopeState {
+  uint32_t count;
+  uint32_t min_ns;
+  uint32_t max_ns;
+  uint64_t total_ns;
+  uint16_t buckets[PERF_BUCKETS];
+};
+
+/**
+ * @brief Statistics of every scope.
+ */
+static PerfScopeState perf_state[PERF_SCOPE_COUNT];
+
+/**
+ * @brief Guards perf_state; scopes are recorded from every task.
+ */
+static portMUX_TYPE perf_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// ============================================================================
+// Helper Functions
+// ============================================================================
+
+/**
+ * @brief Histogram bucket of a duration.
+ */
+static size_t bucketOf(uint32_t ns) {
+  if (ns < PERF_SUB_BUCKETS) return ns;
+  const uint32_t msb = 31 - (uint32_t)__builtin_clz(ns);
+  const uint32_t sub = (ns >> (msb - PERF_SUB_BITS)) & (PERF_SUB_BUCKETS - 1);
+  return (msb - PERF_SUB_BITS + 1) * PERF_SUB_BUCKETS + sub;
+}
+
+/**
+ * @brief Largest duration that falls into a bucket.
+ */
+static uint32_t bucketUpperBound(size_t bucket) {
+  if (bucket < PERF_SUB_BUCKETS) return (uint32_t)bucket;
+  const uint32_t msb = (uint32_t)(bucket / PERF_SUB_BUCKETS) + PERF_SUB_BITS - 1;
+  const uint64_t lower = (uint64_t)(PERF_SUB_BUCKETS + bucket % PERF_SUB_BUCKETS)
+                         << (msb - PERF_SUB_BITS);
+  return (uint32_t)(lower + (1ull << (msb - PERF_SUB_BITS)) - 1);
+}
+
+/**
+ * @brief Upper bound of the bucket holding the given percentile.
+ */
+static uint32_t percentile(const PerfScopeState &s, uint32_t pct) {
+  uint32_t total = 0;
+  for (uint16_t count : s.buckets) total += count;
+  if (total == 0) return 0;
+  const uint32_t rank = (total * pct + 99) / 100;
+  uint32_t seen = 0;
+  for (size_t i = 0; i < PERF_BUCKETS; i++) {
+    seen += s.buckets[i];
+    if (seen >= rank) {
+      const uint32_t bound = bucketUpperBound(i);
+      return bound < s.max_ns ? bound : s.max_ns;
+    }
+  }
+  return s.max_ns;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+/**
+ * @brief Adds one measured duration to a scope, converted to ns at the
+ * current clock: the power mode scales the clock between scopes, so cycles
+ * taken at different clocks cannot share a histogram.
+ */
+void perf_record(PerfScope scope, uint32_t cycles) {
+  PerfScopeState &s = perf_state[(size_t)scope];
+  const uint64_t ns_wide = (uint64_t)cycles * 1000 / perf_cpuMhz();
+  const uint32_t ns = ns_wide < UINT32_MAX ? (uint32_t)ns_wide : UINT32_MAX;
+  const size_t bucket = bucketOf(ns);
+  portENTER_CRITICAL(&perf_mux);
+  if (s.count == 0 || ns < s.min_ns) s.min_ns = ns;
+  if (ns > s.max_ns) s.max_ns = ns;
+  s.count++;
+  s.total_ns += ns;
+  if (s.buckets[bucket] == UINT16_MAX) {
+    for (uint16_t &count : s.buckets) count >>= 1;
+  }
+  s.buckets[bucket]++;
+  portEXIT_CRITICAL(&perf_mux);
+}
+
+/**
+ * @brief Copies the statistics of a scope.
+ */
+void perf_getStats(PerfScope scope, PerfStats &stats) {
+  static PerfScopeState copy; // only the server task reads the stats
+  portENTER_CRITICAL(&perf_mux);
+  copy = perf_state[(size_t)scope];
+  portEXIT_CRITICAL(&perf_mux);
+
+  stats.name = PERF_SCOPE_NAMES[(size_t)scope];
+  stats.count = copy.count;
+  stats.min_ns = copy.min_ns;
+  stats.max_ns = copy.max_ns;
+  stats.avg_ns = copy.count ? (uint32_t)(copy.total_ns / copy.count) : 0;
+  stats.p50_ns = percentile(copy, 50);
+  stats.p99_ns = percentile(copy, 99);
+}
+
+/**
+ * @brief Clears every scope.
+ */
+void perf_reset() {
+  portENTER_CRITICAL(&perf_mux);
+  memset(perf_state, 0, sizeof(perf_state));
+  portEXIT_CRITICAL(&perf_mux);
+}
+
+/**
+ * @brief CPU cycle counter, the clock of the scopes.
+ */
+uint32_t perf_cycles() {
+  return ESP.getCycleCount();
+}
+
+/**
+ * @brief Current CPU clock, at which perf_record() turns cycles into time.
+ */
+uint32_t perf_cpuMhz() {
+  return getCpuFrequencyMhz();
+}
+
+#endif // FDR_PERF
@@ -0,0 +1,113 @@
+/**
+ * @file perf.h
+ * @brief Hot-path profiling scopes on the CPU cycle counter
+ * @author slopez.tech
+ * @date 2025-11-30
+ *
+ * Build with -DFDR_PERF=1 (environment esp32-c3-zero-perf) to time the
+ * named scopes below and report them on /api/debug/perf. Each PERF_SCOPE()
+ * reads the cycle counter when it is entered and when it goes out of scope,
+ * and adds the difference, turned into time at the CPU clock of that moment,
+ * to its scope's statistics: count, min, max, mean and a log-scale
+ * histogram for percentiles, all in fixed RAM. Without the
+ * flag PERF_SCOPE() expands to nothing and this module is not built.
+ */
+
+#ifndef PERF_H
+#define PERF_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef FDR_PERF
+#define FDR_PERF 0
+#endif
+
+/**
+ * @brief Instrumented scopes. Keep PERF_SCOPE_NAMES in perf.cpp in sync.
+ */
+enum class PerfScope : uint8_t {
+  BarometerProcess, ///< barometer_process(): bus read and compensation
+  FdrSample,        ///< One barometer deadline of the sampler
+  FdrImuDrain,      ///< IMU FIFO drain of the sampler
+  FdrWriterStep,    ///< One writer task wakeup, flushes included
+  FdrFlush,         ///< RAM buffer to storage
+  FdrCommit,        ///< Journal commit record and storage sync
+  FdrDownloadStep,  ///< One CSV/binary download batch on the server task
+  FdrLiveBatch,     ///< One live telemetry batch on the server task
+  HttpHandler,      ///< Any API request handler
+  Count
+};
+
+static constexpr size_t PERF_SCOPE_COUNT = (size_t)PerfScope::Count;
+
+/**
+ * @brief Statistics of one scope since boot or the last perf_reset().
+ * Durations are in ns, whatever the CPU clock was when each was measured;
+ * percentiles are the upper bound of their histogram bucket (within 25%),
+ * never above max_ns.
+ */
+struct PerfStats {
+  const char* name;
+  uint32_t count;
+  uint32_t min_ns;
+  uint32_t avg_ns;
+  uint32_t max_ns;
+  uint32_t p50_ns;
+  uint32_t p99_ns;
+};
+
+#if FDR_PERF
+
+/**
+ * @brief Adds one measured duration, in cycles of the current CPU clock, to
+ * a scope. Safe from any task.
+ */
+void perf_record(PerfScope scope, uint32_t cycles);
+
+/**
+ * @brief Copies the statistics of a scope.
+ */
+void perf_getStats(PerfScope scope, PerfStats &stats);
+
+/**
+ * @brief Clears every scope.
+ */
+void perf_reset();
+
+/**
+ * @brief CPU cycle counter, the clock of the scopes.
+ */
+uint32_t perf_cycles();
+
+/**
+ * @brief Current CPU clock, at which perf_record() turns cycles into time.
+ */
+uint32_t perf_cpuMhz();
+
+/**
+ * @brief Times the enclosing block; see PERF_SCOPE().
+ */
+class PerfTimer {
+ public:
+  explicit PerfTimer(PerfScope scope) : scope_(scope), started_(perf_cycles()) {}
+  ~PerfTimer() { perf_record(scope_, perf_cycles() - started_); }
+  PerfTimer(const PerfTimer&) = delete;
+  PerfTimer& operator=(const PerfTimer&) = delete;
+
+ private:
+  PerfScope scope_;
+  uint32_t started_;
+};
+
+#define PERF_CONCAT_(a, b) a##b
+#define PERF_CONCAT(a, b) PERF_CONCAT_(a, b)
+#define PERF_SCOPE(scope) PerfTimer PERF_CONCAT(perf_timer_, __LINE__)(PerfScope::scope)
+
+#else
+
+#define PERF_SCOPE(scope) do {} while (0)
+
+#endif // FDR_PERF
+
+#endif // PERF_H
@@ -0,0 +1,253 @@
+/**
+ * @file power.cpp
+ * @brief CPU clock scaling and light sleep between samples
+ * @author slopez.tech
+ * @date 2025-11-30
+ */
+
+#include "power.h"
+#include "logger.h"
+#include <Arduino.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <esp_timer.h>
+#include <esp_sleep.h>
+#include <esp_freertos_hooks.h>
+
+// ============================================================================
+// Configuration Constants
+// ============================================================================
+
+/**
+ * @brief A light sleep ends this long before the sampler's wakeup, for the
+ * sleep exit and the clocks to settle.
+ */
+static constexpr int64_t POWER_WAKE_MARGIN_US = 2000;
+
+/**
+ * @brief Shorter gaps are not worth the light sleep entry and exit.
+ */
+static constexpr int64_t POWER_MIN_SLEEP_US = 3000;
+
+/**
+ * @brief Default current model of the board (ESP32-C3 Zero, BME280,
+ * MPU6050 and LED, access point up), in µA. Typical datasheet figures,
+ * not measurements: replace them with bench readings through /api/power.
+ */
+static constexpr uint32_t POWER_DEFAULT_CURRENT_UA[POWER_STATE_COUNT] = {
+  85000, // awake: 160 MHz, radio receiving
+  65000, // doze: 80 MHz, radio receiving
+  5000,  // light sleep: radio off, IMU still sampling
+};
+
+static constexpr int64_t POWER_LISTEN_PERIOD_US = (int64_t)POWER_LISTEN_PERIOD_MS * 1000;
+static constexpr int64_t POWER_LISTEN_WINDOW_US = (int64_t)POWER_LISTEN_WINDOW_MS * 1000;
+
+// ============================================================================
+// State
+// ============================================================================
+
+/** @brief Selected PowerMode. */
+static std::atomic<uint8_t> power_mode{(uint8_t)PowerMode::Performance};
+
+/** @brief Applied PowerState: Awake or Doze. */
+static std::atomic<uint8_t> power_state{(uint8_t)PowerState::Awake};
+
+/** @brief Stations associated with the access point. */
+static std::atomic<uint8_t> power_clients{0};
+
+/** @brief A triggered session is recording. */
+static std::atomic<bool> power_flight{false};
+
+/** @brief esp_timer time until which the last station's departure holds
+ * the device awake. */
+static std::atomic<int64_t> linger_until_us{0};
+
+/** @brief Next wakeup of the sampler, the latest end of a light sleep. */
+static std::atomic<int64_t> sampler_wake_us{0};
+
+/**
+ * @brief Serializes state changes, so the CPU clock always matches
+ * power_state. Taken by whichever task changes a hold.
+ */
+static SemaphoreHandle_t power_lock = nullptr;
+
+/**
+ * @brief Residency accounting; the idle hook adds its light sleeps.
+ * time_us[Doze] includes the light sleeps, subtracted when reported.
+ */
+static uint64_t residency_us[POWER_STATE_COUNT];
+static int64_t state_since_us = 0;
+static uint32_t sleep_count = 0;
+static uint32_t current_ua[POWER_STATE_COUNT] = {
+  POWER_DEFAULT_CURRENT_UA[0], POWER_DEFAULT_CURRENT_UA[1], POWER_DEFAULT_CURRENT_UA[2],
+};
+
+/** @brief Guards the accounting above. */
+static portMUX_TYPE power_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// ============================================================================
+// Helper Functions
+// ============================================================================
+
+/**
+ * @brief State the holds call for at `now_us`.
+ */
+static PowerState wantedState(int64_t now_us) {
+  const bool awake = power_mode.load(std::memory_order_relaxed) == (uint8_t)PowerMode::Performance ||
+                     power_clients.load(std::memory_order_relaxed) > 0 ||
+                     power_flight.load(std::memory_order_relaxed) ||
+                     now_us < linger_until_us.load(std::memory_order_relaxed);
+  return awake ? PowerState::Awake : PowerState::Doze;
+}
+
+/**
+ * @brief Moves to the state the holds call for, switching the CPU clock.
+ * Before power_init() only the state is tracked.
+ */
+static void applyState() {
+  if (power_lock == nullptr) return;
+  xSemaphoreTake(power_lock, portMAX_DELAY);
+  const int64_t now_us = esp_timer_get_time();
+  const PowerState want = wantedState(now_us);
+  const PowerState current = (PowerState)power_state.load(std::memory_order_relaxed);
+  if (want != current) {
+    setCpuFrequencyMhz(want == PowerState::Awake ? POWER_AWAKE_MHZ : POWER_DOZE_MHZ);
+    portENTER_CRITICAL(&power_mux);
+    residency_us[(size_t)current] += (uint64_t)(now_us - state_since_us);
+    state_since_us = now_us;
+    power_state.store((uint8_t)want, std::memory_order_relaxed);
+    portEXIT_CRITICAL(&power_mux);
+  }
+  xSemaphoreGive(power_lock);
+}
+
+/**
+ * @brief FreeRTOS idle hook: light-sleeps while dozing, outside the listen
+ * window, until just before the sampler's next wakeup or the next window.
+ * Every task is blocked when it runs. The other tasks' tick delays stretch
+ * by the sleep; the time-critical paths wait on esp_timer, which is
+ * compensated.
+ *
+ * @return true, so it is called again on the next idle iteration.
+ */
+static bool idleHook() {
+  if (power_state.load(std::memory_order_relaxed) != (uint8_t)PowerState::Doze) return true;
+  const int64_t now_us = esp_timer_get_time();
+  const int64_t phase_us = now_us % POWER_LISTEN_PERIOD_US;
+  if (phase_us < POWER_LISTEN_WINDOW_US) return true;
+
+  int64_t until_us = sampler_wake_us.load(std::memory_order_relaxed) - POWER_WAKE_MARGIN_US;
+  const int64_t window_us = now_us - phase_us + POWER_LISTEN_PERIOD_US;
+  if (window_us < until_us) until_us = window_us;
+  if (until_us - now_us < POWER_MIN_SLEEP_US) return true;
+
+  esp_sleep_enable_timer_wakeup((uint64_t)(until_us - now_us));
+  esp_light_sleep_start();
+  const int64_t slept_us = esp_timer_get_time() - now_us;
+  portENTER_CRITICAL(&power_mux);
+  residency_us[(size_t)PowerState::Sleep] += (uint64_t)slept_us;
+  sleep_count++;
+  portEXIT_CRITICAL(&power_mux);
+  return true;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+void power_init() {
+  if (power_lock != nullptr) return;
+  power_lock = xSemaphoreCreateMutex();
+  portENTER_CRITICAL(&power_mux);
+  state_since_us = esp_timer_get_time();
+  portEXIT_CRITICAL(&power_mux);
+  if (esp_register_freertos_idle_hook(idleHook) != ESP_OK) {
+    LOG_WARN("Power: cannot register the idle hook, light sleep disabled");
+  }
+}
+
+void power_setMode(PowerMode mode) {
+  const uint8_t previous = power_mode.exchange((uint8_t)mode, std::memory_order_relaxed);
+  if (previous == (uint8_t)mode) return;
+  portENTER_CRITICAL(&power_mux);
+  for (uint64_t &t : residency_us) t = 0;
+  state_since_us = esp_timer_get_time();
+  sleep_count = 0;
+  portEXIT_CRITICAL(&power_mux);
+  applyState();
+  LOG_INFO("Power: %s mode", power_modeName(mode));
+}
+
+void power_setStateCurrent(PowerState state, uint32_t current_ua_value) {
+  if (state >= PowerState::Count) return;
+  portENTER_CRITICAL(&power_mux);
+  current_ua[(size_t)state] = current_ua_value;
+  portEXIT_CRITICAL(&power_mux);
+}
+
+void power_setClients(uint8_t clients) {
+  const uint8_t previous = power_clients.exchange(clients, std::memory_order_relaxed);
+  if (clients == 0 && previous > 0) {
+    linger_until_us.store(esp_timer_get_time() + (int64_t)POWER_CLIENT_LINGER_MS * 1000,
+                          std::memory_order_relaxed);
+  }
+  applyState();
+}
+
+void power_holdFlight(bool hold) {
+  if (power_flight.exchange(hold, std::memory_order_relaxed) == hold) return;
+  applyState();
+}
+
+void power_prepareWait(int64_t wake_us) {
+  if ((uint8_t)wantedState(esp_timer_get_time()) != power_state.load(std::memory_order_relaxed)) {
+    applyState();
+  }
+  sampler_wake_us.store(wake_us, std::memory_order_relaxed);
+}
+
+void power_getStats(PowerStats &stats) {
+  stats.mode = (PowerMode)power_mode.load(std::memory_order_relaxed);
+  stats.clients = power_clients.load(std::memory_order_relaxed);
+  stats.flight = power_flight.load(std::memory_order_relaxed);
+  stats.cpu_mhz = getCpuFrequencyMhz();
+
+  const int64_t now_us = esp_timer_get_time();
+  portENTER_CRITICAL(&power_mux);
+  stats.state = (PowerState)power_state.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < POWER_STATE_COUNT; i++) {
+    stats.time_us[i] = residency_us[i];
+    stats.current_ua[i] = current_ua[i];
+  }
+  stats.time_us[(size_t)stats.state] += (uint64_t)(now_us - state_since_us);
+  stats.sleeps = sleep_count;
+  portEXIT_CRITICAL(&power_mux);
+
+  uint64_t &doze_us = stats.time_us[(size_t)PowerState::Doze];
+  const uint64_t sleep_us = stats.time_us[(size_t)PowerState::Sleep];
+  doze_us = doze_us > sleep_us ? doze_us - sleep_us : 0;
+
+  uint64_t total_us = 0;
+  uint64_t charge = 0; // µA·µs
+  for (size_t i = 0; i < POWER_STATE_COUNT; i++) {
+    total_us += stats.time_us[i];
+    charge += stats.time_us[i] * stats.current_ua[i];
+  }
+  stats.average_ua = total_us ? (uint32_t)(charge / total_us)
+                              : stats.current_ua[(size_t)stats.state];
+}
+
+const char* power_modeName(PowerMode mode) {
+  return mode == PowerMode::Saving ? "saving" : "performance";
+}
+
+const char* power_stateName(PowerState state) {
+  switch (state) {
+    case PowerState::Awake: return "awake";
+    case PowerState::Doze: return "doze";
+    case PowerState::Sleep: return "sleep";
+    default: return "unknown";
+  }
+}
@@ -0,0 +1,128 @@
+/**
+ * @file power.h
+ * @brief CPU clock scaling and light sleep between samples
+ * @author slopez.tech
+ * @date 2025-11-30
+ *
+ * In the default performance mode nothing changes: the CPU runs at
+ * POWER_AWAKE_MHZ and the access point is always up. In saving mode the
+ * device dozes whenever nobody needs it awake: the CPU drops to
+ * POWER_DOZE_MHZ, and whenever every task is blocked and the sampler's
+ * next wakeup is far enough away, the FreeRTOS idle hook light-sleeps until
+ * just before it. The radio is off while asleep, so the access point keeps
+ * a listen window of POWER_LISTEN_WINDOW_MS every POWER_LISTEN_PERIOD_MS
+ * where a client can find it and join.
+ *
+ * A station joining the access point (and for POWER_CLIENT_LINGER_MS after
+ * the last one left) or a fired trigger, until its session ends, holds the
+ * device awake at full clock and without light sleep.
+ *
+ * There is no current sensor on the board: the time spent in each state is
+ * measured, and the current is a per-state model (board estimates by
+ * default; set the bench-measured figures with power_setStateCurrent()).
+ */
+
+#ifndef POWER_H
+#define POWER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief CPU clock while awake, and the lowest one WiFi keeps working at.
+ * The APB clock, and so the I2C timing, is 80 MHz at both.
+ */
+static constexpr uint32_t POWER_AWAKE_MHZ = 160;
+static constexpr uint32_t POWER_DOZE_MHZ = 80;
+
+/**
+ * @brief Access point listen window while dozing: the radio stays on for
+ * the first POWER_LISTEN_WINDOW_MS of every POWER_LISTEN_PERIOD_MS.
+ */
+static constexpr uint32_t POWER_LISTEN_PERIOD_MS = 5000;
+static constexpr uint32_t POWER_LISTEN_WINDOW_MS = 1000;
+
+/**
+ * @brief Time the device stays awake after the last station left, so a
+ * client reconnecting (or a phone roaming back) finds it at once.
+ */
+static constexpr uint32_t POWER_CLIENT_LINGER_MS = 10000;
+
+enum class PowerMode : uint8_t {
+  Performance, ///< Full clock, never sleeps
+  Saving,      ///< Dozes and light-sleeps while nothing holds it awake
+};
+
+enum class PowerState : uint8_t {
+  Awake, ///< POWER_AWAKE_MHZ
+  Doze,  ///< POWER_DOZE_MHZ between light sleeps
+  Sleep, ///< Light sleep
+  Count
+};
+
+static constexpr size_t POWER_STATE_COUNT = (size_t)PowerState::Count;
+
+/**
+ * @brief Power report. Residency counts from boot or the last mode change.
+ */
+struct PowerStats {
+  PowerMode mode;
+  PowerState state;    ///< Awake or Doze; a task never sees Sleep
+  uint32_t cpu_mhz;
+  uint8_t clients;     ///< Stations associated with the access point
+  bool flight;         ///< A triggered session holds the device awake
+  uint64_t time_us[POWER_STATE_COUNT];
+  uint32_t sleeps;     ///< Light sleeps entered
+  uint32_t current_ua[POWER_STATE_COUNT]; ///< Current model of each state
+  uint32_t average_ua; ///< Model weighted by the residency
+};
+
+/**
+ * @brief Registers the light sleep idle hook. Starts in performance mode.
+ */
+void power_init();
+
+/**
+ * @brief Selects the mode; a change restarts the residency counters.
+ * Safe from any task.
+ */
+void power_setMode(PowerMode mode);
+
+/**
+ * @brief Replaces the modelled current of one state, e.g. with a bench
+ * measurement.
+ */
+void power_setStateCurrent(PowerState state, uint32_t current_ua);
+
+/**
+ * @brief Number of stations associated with the access point, from the
+ * WiFi event handler.
+ */
+void power_setClients(uint8_t clients);
+
+/**
+ * @brief Holds the device awake from a fired trigger until the end of its
+ * session. Safe from any task.
+ */
+void power_holdFlight(bool hold);
+
+/**
+ * @brief The sampler is about to block until `wake_us` (esp_timer time).
+ * Applies a pending state change (the client linger ending) and lets the
+ * idle hook sleep until just before then. FDR sampler task context.
+ */
+void power_prepareWait(int64_t wake_us);
+
+/**
+ * @brief Copies the power report.
+ */
+void power_getStats(PowerStats &stats);
+
+/**
+ * @brief Name of a mode ("performance", "saving") or state ("awake",
+ * "doze", "sleep").
+ */
+const char* power_modeName(PowerMode mode);
+const char* power_stateName(PowerState state);
+
+#endif // POWER_H
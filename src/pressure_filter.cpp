@@ -0,0 +1,311 @@
+/**
+ * @file pressure_filter.cpp
+ * @brief Configurable filter chain for barometer pressure samples
+ * @author slopez.tech
+ * @date 2025-11-30
+ */
+
+#include "pressure_filter.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================================
+// Configuration Constants
+// ============================================================================
+
+static const uint8_t MEDIAN_DEFAULT_WINDOW = 5;
+static const float EMA_DEFAULT_ALPHA = 0.25f;
+
+// Kalman defaults: a few g of vertical acceleration (about 12 Pa per m near
+// sea level) against the noise of the sensor in fast mode
+static const float KALMAN_DEFAULT_PROCESS_NOISE = 500.0f; // Pa/s²
+static const float KALMAN_DEFAULT_MEASUREMENT_NOISE = 3.0f; // Pa
+
+static const size_t SPEC_MAX_LEN = 64;
+
+struct StageName {
+  const char* name;
+  PressureFilterKind kind;
+};
+
+static const StageName STAGE_NAMES[] = {
+  {"none", PressureFilterKind::Bypass},
+  {"bypass", PressureFilterKind::Bypass},
+  {"ema", PressureFilterKind::Ema},
+  {"median", PressureFilterKind::Median},
+  {"kalman", PressureFilterKind::Kalman},
+};
+
+// ============================================================================
+// Helper Functions
+// ============================================================================
+
+static const char* stageName(PressureFilterKind kind) {
+  for (const StageName &entry : STAGE_NAMES) {
+    if (entry.kind == kind) return entry.name;
+  }
+  return "none";
+}
+
+/**
+ * @brief Parses one "name[:a[:b]]" stage, in place.
+ *
+ * @return false if the name or a parameter is invalid.
+ */
+static bool parseStage(char* text, PressureFilterStageConfig &stage) {
+  char* params = strchr(text, ':');
+  if (params != nullptr) *params++ = '\0';
+
+  bool known = false;
+  for (const StageName &entry : STAGE_NAMES) {
+    if (strcmp(text, entry.name) == 0) {
+      stage.kind = entry.kind;
+      known = true;
+    }
+  }
+  if (!known) return false;
+
+  switch (stage.kind) {
+    case PressureFilterKind::Ema:
+      stage.a = EMA_DEFAULT_ALPHA;
+      break;
+    case PressureFilterKind::Median:
+      stage.a = MEDIAN_DEFAULT_WINDOW;
+      break;
+    case PressureFilterKind::Kalman:
+      stage.a = KALMAN_DEFAULT_PROCESS_NOISE;
+      stage.b = KALMAN_DEFAULT_MEASUREMENT_NOISE;
+      break;
+    default:
+      break;
+  }
+
+  float* values[2] = {&stage.a, &stage.b};
+  for (float* value : values) {
+    if (params == nullptr || *params == '\0') break;
+    char* end;
+    *value = strtof(params, &end);
+    if (end == params || (*end != '\0' && *end != ':')) return false;
+    params = *end == ':' ? end + 1 : nullptr;
+  }
+  if (params != nullptr) return false; // too many parameters
+
+  switch (stage.kind) {
+    case PressureFilterKind::Ema:
+      return stage.a > 0.0f && stage.a <= 1.0f;
+    case PressureFilterKind::Median: {
+      const int window = (int)stage.a;
+      return (float)window == stage.a && window >= 3 &&
+             window <= PRESSURE_FILTER_MEDIAN_MAX && (window & 1);
+    }
+    case PressureFilterKind::Kalman:
+      return stage.a > 0.0f && stage.b > 0.0f;
+    default:
+      return true;
+  }
+}
+
+/**
+ * @brief Median of the samples in a stage's history.
+ */
+static uint32_t medianOf(const PressureFilterStage &s) {
+  uint32_t sorted[PRESSURE_FILTER_MEDIAN_MAX];
+  for (uint8_t i = 0; i < s.count; i++) {
+    const uint32_t value = s.history_q8[i];
+    uint8_t j = i;
+    while (j > 0 && sorted[j - 1] > value) {
+      sorted[j] = sorted[j - 1];
+      j--;
+    }
+    sorted[j] = value;
+  }
+  return sorted[s.count / 2];
+}
+
+/**
+ * @brief Computes the steady-state gains of the constant-rate Kalman
+ * filter (an alpha-beta filter) for one sample interval.
+ *
+ * Kalata's closed form from the tracking index
+ * lambda = process_noise * T² / measurement_noise. Runs in float, but
+ * only when the interval changes (start of a session, end of a burst).
+ */
+static void updateKalmanGains(PressureFilterStage &s, uint32_t dt_ms) {
+  const float t = dt_ms / 1000.0f;
+  const float lambda = s.process_noise * t * t / s.measurement_noise;
+  const float r = (4.0f + lambda - sqrtf(8.0f * lambda + lambda * lambda)) / 4.0f;
+  const float alpha = 1.0f - r * r;
+  const float beta = 2.0f * (2.0f - alpha) - 4.0f * sqrtf(1.0f - alpha);
+  s.gain_alpha_q16 = (int32_t)(alpha * 65536.0f + 0.5f);
+  s.gain_beta_q24 = (int32_t)(beta / dt_ms * 16777216.0f + 0.5f);
+  s.gains_dt_ms = dt_ms;
+}
+
+/**
+ * @brief One Kalman step: predict with the current rate, then correct
+ * position and rate by the residual.
+ */
+static uint32_t kalmanStep(PressureFilterStage &s, uint32_t t_ms, uint32_t z_q8) {
+  if (!s.primed) {
+    s.last_t_ms = t_ms;
+    s.rate_q16 = 0;
+    return z_q8;
+  }
+  const uint32_t dt_ms = t_ms - s.last_t_ms;
+  if (dt_ms == 0) return s.out_q8;
+  s.last_t_ms = t_ms;
+  if (dt_ms != s.gains_dt_ms) updateKalmanGains(s, dt_ms);
+
+  const int32_t predicted = (int32_t)s.out_q8 + (int32_t)(((int64_t)s.rate_q16 * dt_ms) >> 8);
+  const int32_t residual = (int32_t)z_q8 - predicted;
+  s.rate_q16 += (int32_t)(((int64_t)s.gain_beta_q24 * residual) >> 16);
+  const int32_t estimate = predicted + (int32_t)(((int64_t)s.gain_alpha_q16 * residual + 32768) >> 16);
+  return estimate > 0 ? (uint32_t)estimate : 0;
+}
+
+static uint32_t applyStage(PressureFilterStage &s, uint32_t t_ms, uint32_t in_q8) {
+  switch (s.kind) {
+    case PressureFilterKind::Ema: {
+      if (!s.primed) return in_q8;
+      const int64_t diff = (int64_t)in_q8 - (int64_t)s.out_q8;
+      return (uint32_t)((int64_t)s.out_q8 + ((diff * s.alpha_q16 + 32768) >> 16));
+    }
+    case PressureFilterKind::Median:
+      s.history_q8[s.next] = in_q8;
+      s.next = (uint8_t)((s.next + 1) % s.window);
+      if (s.count < s.window) s.count++;
+      return medianOf(s);
+    case PressureFilterKind::Kalman:
+      return kalmanStep(s, t_ms, in_q8);
+    default:
+      return in_q8;
+  }
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+/**
+ * @brief Parses a chain description such as "median:5,kalman".
+ */
+bool pressureFilter_parse(const char* spec, PressureFilterConfig &config) {
+  char text[SPEC_MAX_LEN];
+  if (strlen(spec) >= sizeof(text)) return false;
+  strcpy(text, spec);
+
+  PressureFilterConfig parsed;
+  parsed.stages = 0;
+  char* save = nullptr;
+  for (char* token = strtok_r(text, ",", &save); token != nullptr;
+       token = strtok_r(nullptr, ",", &save)) {
+    if (parsed.stages == PRESSURE_FILTER_MAX_STAGES) return false;
+    PressureFilterStageConfig &stage = parsed.stage[parsed.stages++];
+    stage = {PressureFilterKind::Bypass, 0.0f, 0.0f};
+    if (!parseStage(token, stage)) return false;
+  }
+  if (parsed.stages == 0) return false;
+  config = parsed;
+  return true;
+}
+
+/**
+ * @brief Describes a chain with all its parameters, e.g. "median:5,ema:0.250".
+ */
+void pressureFilter_describe(const PressureFilterConfig &config, char* out, size_t len) {
+  size_t used = 0;
+  out[0] = '\0';
+  for (uint8_t i = 0; i < config.stages && used < len; i++) {
+    const PressureFilterStageConfig &stage = config.stage[i];
+    const char* sep = i ? "," : "";
+    int n;
+    switch (stage.kind) {
+      case PressureFilterKind::Ema:
+        n = snprintf(out + used, len - used, "%sema:%.3f", sep, stage.a);
+        break;
+      case PressureFilterKind::Median:
+        n = snprintf(out + used, len - used, "%smedian:%u", sep, (unsigned)stage.a);
+        break;
+      case PressureFilterKind::Kalman:
+        n = snprintf(out + used, len - used, "%skalman:%g:%g", sep, stage.a, stage.b);
+        break;
+      default:
+        n = snprintf(out + used, len - used, "%s%s", sep, stageName(stage.kind));
+        break;
+    }
+    if (n < 0) break;
+    used += (size_t)n;
+  }
+}
+
+/**
+ * @brief Packs the stage kinds of a chain for FdrFileHeader::filter.
+ */
+uint16_t pressureFilter_pack(const PressureFilterConfig &config) {
+  uint16_t packed = 0;
+  for (uint8_t i = 0; i < config.stages; i++) {
+    packed |= (uint16_t)((uint8_t)config.stage[i].kind & 0x0F) << (4 * i);
+  }
+  return packed;
+}
+
+/**
+ * @brief Sets up a chain in its initial state.
+ */
+void pressureFilter_init(PressureFilterChain &chain, const PressureFilterConfig &config) {
+  memset(&chain, 0, sizeof(chain));
+  chain.stages = config.stages <= PRESSURE_FILTER_MAX_STAGES ? config.stages
+                                                             : PRESSURE_FILTER_MAX_STAGES;
+  for (uint8_t i = 0; i < chain.stages; i++) {
+    const PressureFilterStageConfig &in = config.stage[i];
+    PressureFilterStage &s = chain.stage[i];
+    s.kind = in.kind;
+    switch (in.kind) {
+      case PressureFilterKind::Ema: {
+        const float alpha = in.a > 0.0f && in.a <= 1.0f ? in.a : EMA_DEFAULT_ALPHA;
+        s.alpha_q16 = (uint32_t)(alpha * 65536.0f + 0.5f);
+        break;
+      }
+      case PressureFilterKind::Median: {
+        const uint8_t window = (uint8_t)in.a;
+        s.window = window >= 1 && window <= PRESSURE_FILTER_MEDIAN_MAX ? window
+                                                                      : MEDIAN_DEFAULT_WINDOW;
+        break;
+      }
+      case PressureFilterKind::Kalman:
+        s.process_noise = in.a > 0.0f ? in.a : KALMAN_DEFAULT_PROCESS_NOISE;
+        s.measurement_noise = in.b > 0.0f ? in.b : KALMAN_DEFAULT_MEASUREMENT_NOISE;
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+/**
+ * @brief Runs one sample through every stage of the chain.
+ */
+uint32_t pressureFilter_apply(PressureFilterChain &chain, uint32_t t_ms, uint32_t pressure_q8) {
+  uint32_t value = pressure_q8;
+  for (uint8_t i = 0; i < chain.stages; i++) {
+    PressureFilterStage &s = chain.stage[i];
+    value = applyStage(s, t_ms, value);
+    s.out_q8 = value;
+    s.primed = true;
+  }
+  return value;
+}
+
+/**
+ * @brief Pressure rate of the last Kalman stage, Pa/s in Q24.8.
+ */
+int32_t pressureFilter_rate(const PressureFilterChain &chain) {
+  for (uint8_t i = chain.stages; i-- > 0;) {
+    const PressureFilterStage &s = chain.stage[i];
+    // Pa/ms Q16 -> Pa/s Q8: * 1000 / 256
+    if (s.kind == PressureFilterKind::Kalman) return (int32_t)(((int64_t)s.rate_q16 * 1000) >> 8);
+  }
+  return 0;
+}
@@ -0,0 +1,121 @@
+/**
+ * @file pressure_filter.h
+ * @brief Configurable filter chain for barometer pressure samples
+ * @author slopez.tech
+ * @date 2025-11-30
+ *
+ * A chain is up to PRESSURE_FILTER_MAX_STAGES stages applied in order to
+ * every barometer sample of a session, e.g. a median to reject spikes
+ * followed by a smoother. Samples are Pa in Q24.8, as in FdrBaroRecord;
+ * the per-sample path is integer-only, floats are only used when a chain
+ * is configured (and by the Kalman stage when the sample interval changes).
+ */
+
+#ifndef PRESSURE_FILTER_H
+#define PRESSURE_FILTER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+static constexpr size_t PRESSURE_FILTER_MAX_STAGES = 3;
+static constexpr uint8_t PRESSURE_FILTER_MEDIAN_MAX = 9;
+
+/**
+ * @brief Stage types. The values are stored in FdrFileHeader::filter.
+ */
+enum class PressureFilterKind : uint8_t {
+  Bypass = 0, ///< Output = input
+  Ema = 1,    ///< Exponential moving average; a = alpha (0-1]
+  Median = 2, ///< Median of the last a samples (odd, 3-9): spike rejection
+  Kalman = 3, ///< Constant-rate Kalman filter; a = process noise (Pa/s²), b = measurement noise (Pa)
+};
+
+struct PressureFilterStageConfig {
+  PressureFilterKind kind;
+  float a;
+  float b;
+};
+
+/**
+ * @brief Requested chain. The default is the EMA (alpha 0.25) recordings
+ * have always used.
+ */
+struct PressureFilterConfig {
+  uint8_t stages = 1;
+  PressureFilterStageConfig stage[PRESSURE_FILTER_MAX_STAGES] = {
+    {PressureFilterKind::Ema, 0.25f, 0.0f}
+  };
+};
+
+/**
+ * @brief Runtime state of one stage.
+ */
+struct PressureFilterStage {
+  PressureFilterKind kind;
+  bool primed;                                   ///< Has seen a sample
+  uint32_t out_q8;                               ///< Last output
+  // EMA
+  uint32_t alpha_q16;
+  // Median
+  uint8_t window;
+  uint8_t count;
+  uint8_t next;
+  uint32_t history_q8[PRESSURE_FILTER_MEDIAN_MAX];
+  // Kalman (steady-state gains for the current sample interval)
+  float process_noise;
+  float measurement_noise;
+  uint32_t last_t_ms;
+  uint32_t gains_dt_ms;                          ///< Interval the gains are for, 0 = none yet
+  int32_t gain_alpha_q16;                        ///< Position gain
+  int32_t gain_beta_q24;                         ///< Rate gain divided by the interval (1/ms)
+  int32_t rate_q16;                              ///< Pressure rate in Pa/ms, Q16
+};
+
+struct PressureFilterChain {
+  uint8_t stages;
+  PressureFilterStage stage[PRESSURE_FILTER_MAX_STAGES];
+};
+
+/**
+ * @brief Parses a chain description: stages separated by commas, each a
+ * name with optional parameters separated by colons, e.g. "median:5,ema:0.1",
+ * "kalman:50:3", "none". Missing parameters take their defaults.
+ *
+ * @return false if the description is invalid; `config` is then unchanged.
+ */
+bool pressureFilter_parse(const char* spec, PressureFilterConfig &config);
+
+/**
+ * @brief Writes the description of a chain in the syntax accepted by
+ * pressureFilter_parse(), all parameters included.
+ */
+void pressureFilter_describe(const PressureFilterConfig &config, char* out, size_t len);
+
+/**
+ * @brief Stage kinds packed 4 bits per stage, first stage in the low bits,
+ * as stored in FdrFileHeader::filter.
+ */
+uint16_t pressureFilter_pack(const PressureFilterConfig &config);
+
+/**
+ * @brief Sets up a chain in its initial state.
+ */
+void pressureFilter_init(PressureFilterChain &chain, const PressureFilterConfig &config);
+
+/**
+ * @brief Runs one sample through the chain.
+ *
+ * @param t_ms Sample time, used by the Kalman stage.
+ * @param pressure_q8 Pa, Q24.8.
+ * @return Filtered pressure, Pa, Q24.8.
+ */
+uint32_t pressureFilter_apply(PressureFilterChain &chain, uint32_t t_ms, uint32_t pressure_q8);
+
+/**
+ * @brief Pressure rate estimated by the last Kalman stage of the chain.
+ *
+ * @return Pa/s in Q24.8 (negative while climbing); 0 without a Kalman stage.
+ */
+int32_t pressureFilter_rate(const PressureFilterChain &chain);
+
+#endif // PRESSURE_FILTER_H
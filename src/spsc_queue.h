@@ -0,0 +1,74 @@
+/**
+ * @file spsc_queue.h
+ * @brief Lock-free single-producer / single-consumer queue
+ * @author slopez.tech
+ * @date 2025-11-30
+ */
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+/**
+ * @brief Bounded FIFO shared by exactly one producer and one consumer task.
+ *
+ * The producer only writes `tail_` and the consumer only writes `head_`;
+ * acquire/release ordering on those counters publishes the slot contents,
+ * so neither side ever blocks or takes a lock. Storage is a member array.
+ *
+ * @tparam T Trivially copyable element type.
+ * @tparam N Capacity in elements; must be a power of two.
+ */
+template <typename T, size_t N>
+class SpscQueue {
+  static_assert(N > 0 && (N & (N - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+ public:
+  /** @brief Maximum number of queued elements. */
+  static constexpr size_t capacity() { return N; }
+
+  /**
+   * @brief Enqueues an element (producer side).
+   *
+   * @return false if the queue is full; the element is not stored.
+   */
+  bool push(const T &item) {
+    const uint32_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) >= N) return false;
+    slots_[tail & (N - 1)] = item;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Dequeues the oldest element (consumer side).
+   *
+   * @return false if the queue is empty.
+   */
+  bool pop(T &item) {
+    const uint32_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) return false;
+    item = slots_[head & (N - 1)];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /** @brief Number of queued elements (approximate when read concurrently). */
+  size_t size() const {
+    return (size_t)(tail_.load(std::memory_order_acquire) -
+                    head_.load(std::memory_order_acquire));
+  }
+
+  /** @brief True if nothing is queued. */
+  bool empty() const { return size() == 0; }
+
+ private:
+  T slots_[N];
+  std::atomic<uint32_t> head_{0};
+  std::atomic<uint32_t> tail_{0};
+};
+
+#endif // SPSC_QUEUE_H
@@ -0,0 +1,34 @@
+/**
+ * @file Adafruit_BME280.h
+ * @brief Host stand-in for the Adafruit BME280 driver, on the simulated
+ * sensor of Wire.h
+ * @author slopez.tech
+ * @date 2025-11-30
+ */
+
+#ifndef MOCK_ADAFRUIT_BME280_H
+#define MOCK_ADAFRUIT_BME280_H
+
+#include <Wire.h>
+
+class Adafruit_BME280 {
+ public:
+  enum sensor_sampling { SAMPLING_NONE, SAMPLING_X1, SAMPLING_X2, SAMPLING_X4, SAMPLING_X8,
+                         SAMPLING_X16 };
+  enum sensor_mode { MODE_SLEEP = 0, MODE_FORCED = 1, MODE_NORMAL = 3 };
+  enum sensor_filter { FILTER_OFF, FILTER_X2, FILTER_X4, FILTER_X8, FILTER_X16 };
+  enum standby_duration { STANDBY_MS_0_5, STANDBY_MS_62_5, STANDBY_MS_125, STANDBY_MS_250,
+                          STANDBY_MS_500, STANDBY_MS_1000, STANDBY_MS_10, STANDBY_MS_20 };
+
+  bool begin(uint8_t address = 0x77) {
+    return mock::bme280.present && mock::bme280.address == address &&
+           mock::bme280.chip_id == 0x60;
+  }
+  void setSampling(sensor_mode mode = MODE_NORMAL, sensor_sampling = SAMPLING_X16,
+                   sensor_sampling = SAMPLING_X16, sensor_sampling = SAMPLING_X16,
+                   sensor_filter = FILTER_OFF, standby_duration = STANDBY_MS_0_5) {
+    mock::bme280.mode = mode;
+  }
+};
+
+#endif // MOCK_ADAFRUIT_BME280_H
@@ -0,0 +1,42 @@
+/**
+ * @file Adafruit_NeoPixel.h
+ * @brief Host stand-in for the NeoPixel driver
+ * @author slopez.tech
+ * @date 2025-11-30
+ *
+ * show() counts the frames in mock::neopixel_frames and latches the pixel
+ * color in mock::neopixel_color, so a test can tell what the LED showed
+ * and how many times it was driven.
+ */
+
+#ifndef MOCK_ADAFRUIT_NEOPIXEL_H
+#define MOCK_ADAFRUIT_NEOPIXEL_H
+
+#include <stdint.h>
+
+#define NEO_GRB 0x52
+#define NEO_KHZ800 0x0000
+
+namespace mock {
+inline uint32_t neopixel_frames = 0;
+inline uint32_t neopixel_color = 0;
+} // namespace mock
+
+class Adafruit_NeoPixel {
+ public:
+  Adafruit_NeoPixel(uint16_t, int16_t, uint16_t) {}
+  void begin() {}
+  void setPixelColor(uint16_t, uint32_t color) { pending_ = color; }
+  void show() {
+    mock::neopixel_color = pending_;
+    mock::neopixel_frames++;
+  }
+  static uint32_t Color(uint8_t r, uint8_t g, uint8_t b) {
+    return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+  }
+
+ private:
+  uint32_t pending_ = 0;
+};
+
+#endif // MOCK_ADAFRUIT_NEOPIXEL_H
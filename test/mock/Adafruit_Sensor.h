@@ -0,0 +1,11 @@
+/**
+ * @file Adafruit_Sensor.h
+ * @brief Host stand-in for the Adafruit unified sensor header (unused)
+ * @author slopez.tech
+ * @date 2025-11-30
+ */
+
+#ifndef MOCK_ADAFRUIT_SENSOR_H
+#define MOCK_ADAFRUIT_SENSOR_H
+
+#endif // MOCK_ADAFRUIT_SENSOR_H
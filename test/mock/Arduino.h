@@ -0,0 +1,94 @@
+/**
+ * @file Arduino.h
+ * @brief Host stand-in for the parts of the Arduino core the modules use
+ * @author slopez.tech
+ * @date 2025-11-30
+ *
+ * Time comes from mock_clock.h. Serial output is discarded unless
+ * mock::serial_echo is set; mock::serial_bytes counts what was printed.
+ * The CPU clock set with setCpuFrequencyMhz() is kept in mock::cpu_mhz.
+ */
+
+#ifndef MOCK_ARDUINO_H
+#define MOCK_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "mock_clock.h"
+
+typedef uint8_t byte;
+
+#define DEC 10
+#define HEX 16
+
+inline unsigned long millis() { return (unsigned long)(mock::now_us / 1000); }
+inline unsigned long micros() { return (unsigned long)mock::now_us; }
+inline void delay(unsigned long ms) { mock::advanceUs((int64_t)ms * 1000); }
+inline void delayMicroseconds(unsigned int us) { mock::advanceUs(us); }
+inline void yield() {}
+
+namespace mock {
+inline bool serial_echo = false;
+inline size_t serial_bytes = 0;
+} // namespace mock
+
+class HWCDC {
+ public:
+  void begin(unsigned long) {}
+  void setTxTimeoutMs(uint32_t) {}
+  explicit operator bool() const { return true; }
+  int availableForWrite() { return 256; }
+
+  size_t write(const char* text, size_t len) {
+    mock::serial_bytes += len;
+    if (mock::serial_echo) fwrite(text, 1, len, stdout);
+    return len;
+  }
+  size_t write(const uint8_t* data, size_t len) { return write((const char*)data, len); }
+  size_t print(const char* text) { return write(text, strlen(text)); }
+  size_t print(long value, int base = DEC) {
+    char text[24];
+    snprintf(text, sizeof(text), base == HEX ? "%lX" : "%ld", value);
+    return print(text);
+  }
+  size_t println(const char* text = "") { return print(text) + print("\n"); }
+  size_t println(long value, int base = DEC) { return print(value, base) + print("\n"); }
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+    char text[256];
+    va_list args;
+    va_start(args, format);
+    const int len = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    return len > 0 ? write(text, (size_t)len < sizeof(text) ? (size_t)len : sizeof(text) - 1) : 0;
+  }
+};
+
+inline HWCDC Serial;
+
+class EspClass {
+ public:
+  /** @brief Host time at a notional 160 MHz, for cycle-count benchmarks. */
+  uint32_t getCycleCount() { return (uint32_t)(mock::hostNs() * 160 / 1000); }
+  uint32_t getFreeHeap() { return 200 * 1024; }
+};
+
+inline EspClass ESP;
+
+namespace mock {
+inline uint32_t cpu_mhz = 160;
+} // namespace mock
+
+inline bool setCpuFrequencyMhz(uint32_t mhz) {
+  mock::cpu_mhz = mhz;
+  return true;
+}
+inline uint32_t getCpuFrequencyMhz() { return mock::cpu_mhz; }
+
+#endif // MOCK_ARDUINO_H
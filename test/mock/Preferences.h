@@ -0,0 +1,56 @@
+/**
+ * @file Preferences.h
+ * @brief Host stand-in for the Arduino NVS key-value store
+ * @author slopez.tech
+ * @date 2025-11-30
+ *
+ * Entries live in mock::nvs, keyed "namespace/key", and survive anything
+ * but a test clearing the map: a simulated reset keeps them, as NVS does.
+ */
+
+#ifndef MOCK_PREFERENCES_H
+#define MOCK_PREFERENCES_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace mock {
+inline std::map<std::string, std::vector<uint8_t>> nvs;
+} // namespace mock
+
+class Preferences {
+ public:
+  bool begin(const char* name, bool read_only = false) {
+    name_ = name;
+    read_only_ = read_only;
+    return true;
+  }
+  void end() {}
+
+  size_t putBytes(const char* key, const void* value, size_t len) {
+    if (read_only_) return 0;
+    const uint8_t* bytes = static_cast<const uint8_t*>(value);
+    mock::nvs[path(key)].assign(bytes, bytes + len);
+    return len;
+  }
+  size_t getBytes(const char* key, void* buf, size_t max_len) {
+    const auto it = mock::nvs.find(path(key));
+    if (it == mock::nvs.end() || it->second.size() > max_len) return 0;
+    memcpy(buf, it->second.data(), it->second.size());
+    return it->second.size();
+  }
+  bool isKey(const char* key) { return mock::nvs.count(path(key)) > 0; }
+  bool remove(const char* key) { return !read_only_ && mock::nvs.erase(path(key)) > 0; }
+
+ private:
+  std::string path(const char* key) const { return name_ + "/" + key; }
+
+  std::string name_;
+  bool read_only_ = false;
+};
+
+#endif // MOCK_PREFERENCES_H
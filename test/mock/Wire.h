@@ -0,0 +1,202 @@
+/**
+ * @file Wire.h
+ * @brief Host stand-in for the Arduino I2C bus with a simulated BME280
+ * @author slopez.tech
+ * @date 2025-11-30
+ *
+ * One sensor answers on the bus (mock::bme280): chip ID, the datasheet's
+ * example trimming coefficients and a data block encoding whatever pressure
+ * and temperature the test sets, found by inverting the Bosch compensation.
+ * A forced conversion written to ctrl_meas keeps the status register's
+ * measuring bit set for `conversion_us` of simulated time.
+ * Every other address NACKs.
+ */
+
+#ifndef MOCK_WIRE_H
+#define MOCK_WIRE_H
+
+#include <Arduino.h>
+#include <random>
+
+namespace mock {
+
+/**
+ * @brief Simulated BME280 (or BMP280, with chip_id 0x58).
+ */
+struct Bme280Sim {
+  uint8_t address = 0x76;
+  uint8_t chip_id = 0x60;
+  bool present = true;
+  bool fail_reads = false;     ///< NACK data reads (bus fault)
+  double pressure_pa = 101325.0;
+  double temperature_c = 20.0;
+  double noise_pa = 0.0;       ///< Standard deviation added to each reading
+  uint32_t data_reads = 0;     ///< Data block reads served
+  int mode = 3;                ///< Last sensor mode set (driver or ctrl_meas)
+  uint32_t conversion_us = 5500; ///< Forced conversion time (typical at x1)
+  uint32_t forced_conversions = 0;
+  int64_t measuring_until_us = 0;
+
+  // Datasheet example trimming coefficients (BST-BME280-DS002, 8.2)
+  uint16_t T1 = 27504;
+  int16_t T2 = 26435, T3 = -1000;
+  uint16_t P1 = 36477;
+  int16_t P2 = -10685, P3 = 3024, P4 = 2855, P5 = 140, P6 = -7, P7 = 15500, P8 = -14600,
+          P9 = 6000;
+
+  std::mt19937 rng{1};
+
+  int32_t tFine(int32_t adc_T) const {
+    const int32_t var1 = ((((adc_T >> 3) - ((int32_t)T1 << 1))) * (int32_t)T2) >> 11;
+    const int32_t d = (adc_T >> 4) - (int32_t)T1;
+    const int32_t var2 = (((d * d) >> 12) * (int32_t)T3) >> 14;
+    return var1 + var2;
+  }
+
+  /** @brief Compensated pressure in Pa Q24.8 (datasheet 4.2.3). */
+  uint32_t pressureQ8(int32_t adc_P, int32_t t_fine) const {
+    int64_t var1 = (int64_t)t_fine - 128000;
+    int64_t var2 = var1 * var1 * (int64_t)P6;
+    var2 = var2 + ((var1 * (int64_t)P5) << 17);
+    var2 = var2 + ((int64_t)P4 << 35);
+    var1 = ((var1 * var1 * (int64_t)P3) >> 8) + ((var1 * (int64_t)P2) << 12);
+    var1 = ((((int64_t)1 << 47) + var1) * (int64_t)P1) >> 33;
+    if (var1 == 0) return 0;
+    int64_t p = 1048576 - adc_P;
+    p = (((p << 31) - var2) * 3125) / var1;
+    var1 = ((int64_t)P9 * (p >> 13) * (p >> 13)) >> 25;
+    var2 = ((int64_t)P8 * p) >> 19;
+    return (uint32_t)(((p + var1 + var2) >> 8) + ((int64_t)P7 << 4));
+  }
+
+  /** @brief Raw ADC values that compensate to the current conditions. */
+  void adcValues(int32_t &adc_T, int32_t &adc_P) {
+    const int32_t target_cdeg = (int32_t)lround(temperature_c * 100.0);
+    int32_t lo = 0, hi = (1 << 20) - 1;
+    while (lo < hi) { // temperature rises with adc_T
+      const int32_t mid = (lo + hi) / 2;
+      if (((tFine(mid) * 5 + 128) >> 8) < target_cdeg) lo = mid + 1; else hi = mid;
+    }
+    adc_T = lo;
+    const int32_t t_fine = tFine(adc_T);
+
+    double pa = pressure_pa;
+    if (noise_pa > 0.0) pa += std::normal_distribution<double>(0.0, noise_pa)(rng);
+    const uint32_t target_q8 = (uint32_t)(pa * 256.0);
+    lo = 0;
+    hi = (1 << 20) - 1;
+    while (lo < hi) { // pressure falls as adc_P rises
+      const int32_t mid = (lo + hi) / 2;
+      if (pressureQ8(mid, t_fine) > target_q8) lo = mid + 1; else hi = mid;
+    }
+    adc_P = lo;
+  }
+
+  /** @brief Register write. */
+  void writeRegister(uint8_t reg, uint8_t value) {
+    if (reg != 0xF4) return;
+    mode = value & 0x03;
+    if (mode == 1 || mode == 2) {
+      forced_conversions++;
+      measuring_until_us = mock::now_us + conversion_us;
+      mode = 0; // back to sleep once done
+    }
+  }
+
+  /** @brief Register read of `len` bytes from `reg`. */
+  void readRegisters(uint8_t reg, uint8_t* out, size_t len) {
+    const uint16_t calib[12] = {T1, (uint16_t)T2, (uint16_t)T3, P1, (uint16_t)P2, (uint16_t)P3,
+                                (uint16_t)P4, (uint16_t)P5, (uint16_t)P6, (uint16_t)P7,
+                                (uint16_t)P8, (uint16_t)P9};
+    uint8_t data[6] = {};
+    if (reg == 0xF7) {
+      int32_t adc_T, adc_P;
+      adcValues(adc_T, adc_P);
+      data[0] = (uint8_t)(adc_P >> 12);
+      data[1] = (uint8_t)(adc_P >> 4);
+      data[2] = (uint8_t)(adc_P << 4);
+      data[3] = (uint8_t)(adc_T >> 12);
+      data[4] = (uint8_t)(adc_T >> 4);
+      data[5] = (uint8_t)(adc_T << 4);
+      data_reads++;
+    }
+    for (size_t i = 0; i < len; i++) {
+      const unsigned r = reg + i;
+      if (r >= 0x88 && r < 0x88 + 24) {
+        const uint16_t word = calib[(r - 0x88) / 2];
+        out[i] = (uint8_t)((r - 0x88) % 2 ? word >> 8 : word);
+      } else if (r >= 0xF7 && r <= 0xFC) {
+        out[i] = data[r - 0xF7];
+      } else if (r == 0xD0) {
+        out[i] = chip_id;
+      } else if (r == 0xF3) {
+        out[i] = mock::now_us < measuring_until_us ? 0x08 : 0x00;
+      } else {
+        out[i] = 0;
+      }
+    }
+  }
+};
+
+inline Bme280Sim bme280;
+
+} // namespace mock
+
+class TwoWire {
+ public:
+  bool begin(int = -1, int = -1, uint32_t = 0) { return true; }
+  bool setClock(uint32_t hz) {
+    clock_ = hz;
+    return true;
+  }
+  uint32_t getClock() { return clock_; }
+
+  void beginTransmission(uint8_t address) {
+    address_ = address;
+    reg_ = 0;
+    tx_len_ = 0;
+  }
+  size_t write(uint8_t value) {
+    if (tx_len_++ == 0) reg_ = value;
+    else value_ = value;
+    return 1;
+  }
+  uint8_t endTransmission(bool = true) {
+    if (!responds(address_)) return 2;
+    if (tx_len_ >= 2) mock::bme280.writeRegister(reg_, value_);
+    return 0;
+  }
+
+  uint8_t requestFrom(uint8_t address, uint8_t len, bool = true) {
+    available_ = 0;
+    pos_ = 0;
+    if (!responds(address) || len > sizeof(rx_)) return 0;
+    if (reg_ == 0xF7 && mock::bme280.fail_reads) return 0;
+    mock::bme280.readRegisters(reg_, rx_, len);
+    available_ = len;
+    return len;
+  }
+  uint8_t requestFrom(uint8_t address, int len, bool stop = true) {
+    return requestFrom(address, (uint8_t)len, stop);
+  }
+  int available() { return available_ - pos_; }
+  int read() { return pos_ < available_ ? rx_[pos_++] : -1; }
+
+ private:
+  static bool responds(uint8_t address) {
+    return mock::bme280.present && address == mock::bme280.address;
+  }
+
+  uint32_t clock_ = 100000;
+  uint8_t address_ = 0;
+  uint8_t reg_ = 0;
+  uint8_t value_ = 0;
+  size_t tx_len_ = 0;
+  uint8_t rx_[32] = {};
+  int available_ = 0;
+  int pos_ = 0;
+};
+
+inline TwoWire Wire;
+
+#endif // MOCK_WIRE_H
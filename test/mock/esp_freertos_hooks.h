@@ -0,0 +1,27 @@
+/**
+ * @file esp_freertos_hooks.h
+ * @brief Host stand-in for the FreeRTOS idle hooks
+ * @author slopez.tech
+ * @date 2025-11-30
+ *
+ * The registered hook is kept in mock::idle_hook; a test calls it to play
+ * the idle task.
+ */
+
+#ifndef MOCK_ESP_FREERTOS_HOOKS_H
+#define MOCK_ESP_FREERTOS_HOOKS_H
+
+#include "esp_timer.h"
+
+typedef bool (*esp_freertos_idle_cb_t)(void);
+
+namespace mock {
+inline esp_freertos_idle_cb_t idle_hook = nullptr;
+} // namespace mock
+
+inline esp_err_t esp_register_freertos_idle_hook(esp_freertos_idle_cb_t cb) {
+  mock::idle_hook = cb;
+  return ESP_OK;
+}
+
+#endif // MOCK_ESP_FREERTOS_HOOKS_H
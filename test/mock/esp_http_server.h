@@ -0,0 +1,100 @@
+/**
+ * @file esp_http_server.h
+ * @brief Host stand-in for the esp_http_server API used by the modules
+ * @author slopez.tech
+ * @date 2025-11-30
+ *
+ * There is no server: query strings come from mock::query, response bodies
+ * and data sent on a taken-over connection are appended to
+ * mock::socket_output and queued work is dropped, so a test calls the
+ * conversion functions it wants to check itself.
+ */
+
+#ifndef MOCK_ESP_HTTP_SERVER_H
+#define MOCK_ESP_HTTP_SERVER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/types.h>
+#include <string>
+#include <esp_timer.h>
+
+#define ESP_ERR_NOT_FOUND 0x105
+#define ESP_ERR_HTTPD_RESULT_TRUNC 0xb004
+
+typedef void* httpd_handle_t;
+typedef enum { HTTP_GET = 1, HTTP_POST = 3 } httpd_method_t;
+typedef void (*httpd_work_fn_t)(void* arg);
+typedef void (*httpd_free_ctx_fn_t)(void* ctx);
+
+typedef struct httpd_req {
+  httpd_handle_t handle;
+  int method;
+  const char* uri;
+  void* user_ctx;
+  void* sess_ctx;
+  httpd_free_ctx_fn_t free_ctx;
+} httpd_req_t;
+
+#define HTTPD_200 "200 OK"
+#define HTTPD_400 "400 Bad Request"
+#define HTTPD_404 "404 Not Found"
+#define HTTPD_500 "500 Internal Server Error"
+
+namespace mock {
+inline std::string query;
+inline std::string socket_output;
+inline std::string response_status;
+} // namespace mock
+
+inline esp_err_t httpd_req_get_url_query_str(httpd_req_t*, char* buf, size_t len) {
+  if (mock::query.empty()) return ESP_ERR_NOT_FOUND;
+  if (mock::query.size() >= len) return ESP_ERR_HTTPD_RESULT_TRUNC;
+  memcpy(buf, mock::query.c_str(), mock::query.size() + 1);
+  return ESP_OK;
+}
+
+inline esp_err_t httpd_query_key_value(const char* query, const char* key, char* val, size_t len) {
+  const size_t key_len = strlen(key);
+  for (const char* p = query; *p != '\0';) {
+    const char* end = strchr(p, '&');
+    if (end == nullptr) end = p + strlen(p);
+    if ((size_t)(end - p) > key_len && strncmp(p, key, key_len) == 0 && p[key_len] == '=') {
+      const size_t n = (size_t)(end - p) - key_len - 1;
+      if (n >= len) return ESP_ERR_HTTPD_RESULT_TRUNC;
+      memcpy(val, p + key_len + 1, n);
+      val[n] = '\0';
+      return ESP_OK;
+    }
+    p = *end ? end + 1 : end;
+  }
+  return ESP_ERR_NOT_FOUND;
+}
+
+inline size_t httpd_req_get_hdr_value_len(httpd_req_t*, const char*) { return 0; }
+inline esp_err_t httpd_req_get_hdr_value_str(httpd_req_t*, const char*, char*, size_t) {
+  return ESP_ERR_NOT_FOUND;
+}
+inline esp_err_t httpd_resp_set_status(httpd_req_t*, const char* status) {
+  mock::response_status = status;
+  return ESP_OK;
+}
+inline esp_err_t httpd_resp_set_type(httpd_req_t*, const char*) { return ESP_OK; }
+inline esp_err_t httpd_resp_sendstr(httpd_req_t*, const char* text) {
+  mock::socket_output += text;
+  return ESP_OK;
+}
+inline esp_err_t httpd_resp_send_chunk(httpd_req_t*, const char* buf, ssize_t len) {
+  if (buf != nullptr) mock::socket_output.append(buf, (size_t)len);
+  return ESP_OK;
+}
+inline int httpd_req_to_sockfd(httpd_req_t*) { return 1; }
+inline esp_err_t httpd_queue_work(httpd_handle_t, httpd_work_fn_t, void*) { return ESP_OK; }
+inline int httpd_socket_send(httpd_handle_t, int, const char* buf, size_t len, int) {
+  mock::socket_output.append(buf, len);
+  return (int)len;
+}
+inline esp_err_t httpd_sess_trigger_close(httpd_handle_t, int) { return ESP_OK; }
+
+#endif // MOCK_ESP_HTTP_SERVER_H
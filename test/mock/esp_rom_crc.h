@@ -0,0 +1,25 @@
+/**
+ * @file esp_rom_crc.h
+ * @brief Host implementation of the ROM CRC-32 (IEEE 802.3, little endian)
+ * @author slopez.tech
+ * @date 2025-11-30
+ *
+ * Same convention as the ROM function: pass the previous result to chain
+ * blocks, 0 to start.
+ */
+
+#ifndef MOCK_ESP_ROM_CRC_H
+#define MOCK_ESP_ROM_CRC_H
+
+#include <stdint.h>
+
+inline uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len) {
+  crc = ~crc;
+  while (len--) {
+    crc ^= *buf++;
+    for (int bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+  }
+  return ~crc;
+}
+
+#endif // MOCK_ESP_ROM_CRC_H
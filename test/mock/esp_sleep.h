@@ -0,0 +1,32 @@
+/**
+ * @file esp_sleep.h
+ * @brief Host stand-in for light sleep on the simulated clock
+ * @author slopez.tech
+ * @date 2025-11-30
+ *
+ * esp_light_sleep_start() moves the clock on by the armed timer wakeup
+ * and counts the sleep in mock::light_sleeps.
+ */
+
+#ifndef MOCK_ESP_SLEEP_H
+#define MOCK_ESP_SLEEP_H
+
+#include <stdint.h>
+#include "esp_timer.h"
+
+namespace mock {
+inline uint64_t sleep_wakeup_us = 0;
+inline uint32_t light_sleeps = 0;
+} // namespace mock
+
+inline esp_err_t esp_sleep_enable_timer_wakeup(uint64_t time_us) {
+  mock::sleep_wakeup_us = time_us;
+  return ESP_OK;
+}
+inline esp_err_t esp_light_sleep_start() {
+  mock::advanceUs((int64_t)mock::sleep_wakeup_us);
+  mock::light_sleeps++;
+  return ESP_OK;
+}
+
+#endif // MOCK_ESP_SLEEP_H
@@ -0,0 +1,53 @@
+/**
+ * @file esp_timer.h
+ * @brief Host stand-in for esp_timer on the simulated clock
+ * @author slopez.tech
+ * @date 2025-11-30
+ *
+ * Timers are created but never fire; the tests schedule the work
+ * themselves. The deadline of the last one-shot start is kept in
+ * mock::timer_due_us (0 once stopped).
+ */
+
+#ifndef MOCK_ESP_TIMER_H
+#define MOCK_ESP_TIMER_H
+
+#include <stdint.h>
+#include "mock_clock.h"
+
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+
+namespace mock {
+inline int64_t timer_due_us = 0;
+} // namespace mock
+
+typedef struct esp_timer* esp_timer_handle_t;
+typedef void (*esp_timer_cb_t)(void* arg);
+typedef enum { ESP_TIMER_TASK } esp_timer_dispatch_t;
+
+typedef struct {
+  esp_timer_cb_t callback;
+  void* arg;
+  esp_timer_dispatch_t dispatch_method;
+  const char* name;
+  bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+inline esp_err_t esp_timer_create(const esp_timer_create_args_t*, esp_timer_handle_t* handle) {
+  *handle = nullptr;
+  return ESP_OK;
+}
+inline esp_err_t esp_timer_start_once(esp_timer_handle_t, uint64_t timeout_us) {
+  mock::timer_due_us = mock::now_us + (int64_t)timeout_us;
+  return ESP_OK;
+}
+inline esp_err_t esp_timer_start_periodic(esp_timer_handle_t, uint64_t) { return ESP_OK; }
+inline esp_err_t esp_timer_stop(esp_timer_handle_t) {
+  mock::timer_due_us = 0;
+  return ESP_OK;
+}
+inline int64_t esp_timer_get_time() { return mock::now_us; }
+
+#endif // MOCK_ESP_TIMER_H
@@ -0,0 +1,22 @@
+/**
+ * @file semphr.h
+ * @brief Host stand-in for FreeRTOS mutexes (single-threaded, always free)
+ * @author slopez.tech
+ * @date 2025-11-30
+ */
+
+#ifndef MOCK_FREERTOS_SEMPHR_H
+#define MOCK_FREERTOS_SEMPHR_H
+
+#include "FreeRTOS.h"
+
+typedef void* SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() {
+  static int dummy_mutex;
+  return &dummy_mutex;
+}
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t, TickType_t) { return pdTRUE; }
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t) { return pdTRUE; }
+
+#endif // MOCK_FREERTOS_SEMPHR_H
@@ -0,0 +1,44 @@
+/**
+ * @file task.h
+ * @brief Host stand-in for FreeRTOS tasks and notifications
+ * @author slopez.tech
+ * @date 2025-11-30
+ *
+ * Tasks are never started: the tests call the module's task steps
+ * directly. Notifications are counted so a test can tell a task was woken.
+ * A task step that would block calls mock::block_hook instead, which lets
+ * a test move the clock on and run the other tasks meanwhile.
+ */
+
+#ifndef MOCK_FREERTOS_TASK_H
+#define MOCK_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef void* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+namespace mock {
+inline uint32_t task_notifications = 0;
+inline void (*block_hook)(TickType_t ticks) = nullptr;
+} // namespace mock
+
+inline BaseType_t xTaskCreate(TaskFunction_t, const char*, uint32_t, void*, UBaseType_t,
+                              TaskHandle_t* handle) {
+  static int dummy_task;
+  if (handle != nullptr) *handle = &dummy_task;
+  return pdPASS;
+}
+
+inline BaseType_t xTaskNotifyGive(TaskHandle_t) {
+  mock::task_notifications++;
+  return pdPASS;
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t, TickType_t ticks) {
+  if (mock::block_hook != nullptr) mock::block_hook(ticks);
+  return 0;
+}
+inline void vTaskDelay(TickType_t) {}
+
+#endif // MOCK_FREERTOS_TASK_H
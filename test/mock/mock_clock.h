@@ -0,0 +1,37 @@
+/**
+ * @file mock_clock.h
+ * @brief Simulated time base of the native test environment
+ * @author slopez.tech
+ * @date 2025-11-30
+ *
+ * millis(), micros(), esp_timer_get_time() and delay() all run on this
+ * clock, which only moves when a test (or a simulated flash write) advances
+ * it, so timing-dependent code behaves the same on every run.
+ */
+
+#ifndef MOCK_CLOCK_H
+#define MOCK_CLOCK_H
+
+#include <stdint.h>
+#include <chrono>
+
+namespace mock {
+
+/** @brief Current simulated time in microseconds since boot. */
+inline int64_t now_us = 0;
+
+inline void setTimeUs(int64_t t_us) { now_us = t_us; }
+inline void advanceUs(int64_t us) { now_us += us; }
+
+/**
+ * @brief Host wall-clock time in nanoseconds, for the benchmarks; unrelated
+ * to the simulated clock.
+ */
+inline uint64_t hostNs() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+           std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace mock
+
+#endif // MOCK_CLOCK_H
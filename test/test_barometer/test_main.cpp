@@ -0,0 +1,217 @@
+/**
+ * @file test_main.cpp
+ * @brief Native tests of the barometer module (barometer.cpp) against the
+ * simulated BME280 of the Wire mock
+ * @author slopez.tech
+ * @date 2025-11-30
+ */
+
+#include <unity.h>
+#include "barometer.cpp"
+
+static constexpr uint32_t SAMPLE_US = 20000; // 50 Hz
+
+/**
+ * @brief Reads the simulated sensor once per sample period.
+ */
+static void runFor(uint32_t ms) {
+  for (uint32_t t = 0; t < ms * 1000; t += SAMPLE_US) {
+    mock::advanceUs(SAMPLE_US);
+    barometer_process();
+  }
+}
+
+/**
+ * @brief Pressure at an altitude of the standard atmosphere, in Pa.
+ */
+static double pressureAt(double altitude_m) {
+  return 101325.0 * pow(1.0 - altitude_m / 44330.77, 1.0 / 0.190263);
+}
+
+void setUp() {
+  mock::bme280 = mock::Bme280Sim();
+  mock::setTimeUs(1000000);
+  pressure_ema_q8 = 0; // module state survives barometer_init(), as on the device
+  barometer_init();
+  barometer_setReferencePressure(0);
+  runFor(100);
+}
+
+void tearDown() {}
+
+static void test_reads_the_simulated_sensor() {
+  TEST_ASSERT_TRUE(barometer_isReady());
+  TEST_ASSERT_FALSE(barometer_isBMP());
+  // One ADC step is ~0.2 Pa in this range
+  TEST_ASSERT_UINT32_WITHIN(64, 101325 * 256, barometer_getRawPressureQ8());
+  TEST_ASSERT_UINT32_WITHIN(64, 101325 * 256, barometer_getPressureQ8());
+  TEST_ASSERT_INT32_WITHIN(1, 2000, barometer_getTemperatureCdeg());
+
+  BarometerReading reading;
+  barometer_getReading(reading);
+  TEST_ASSERT_TRUE(reading.ready);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 1013.25f, reading.pressure);
+}
+
+static void test_ema_smooths_a_step() {
+  mock::bme280.pressure_pa = 101225.0;
+  runFor(20); // one reading
+  TEST_ASSERT_UINT32_WITHIN(64, 101225 * 256, barometer_getRawPressureQ8());
+  TEST_ASSERT_UINT32_WITHIN(64, 101300 * 256, barometer_getPressureQ8()); // alpha 0.25
+  runFor(1000);
+  TEST_ASSERT_UINT32_WITHIN(64, 101225 * 256, barometer_getPressureQ8());
+}
+
+static void test_altitude_follows_pressure() {
+  mock::bme280.pressure_pa = pressureAt(100.0);
+  runFor(1000);
+  BarometerFlight flight;
+  barometer_getFlight(flight);
+  TEST_ASSERT_TRUE(flight.valid);
+  TEST_ASSERT_INT32_WITHIN(10, 10000, flight.altitude_cm); // 2 cm quantization error allowed
+  TEST_ASSERT_INT32_WITHIN(20, 0, flight.vspeed_cms);
+}
+
+static void test_flight_events() {
+  BarometerFlight flight;
+  barometer_getFlight(flight);
+  const uint32_t events_before = flight.event_count; // counted since boot
+  double altitude = 0.0;
+  for (int i = 0; i < 300; i++) { // climb at 20 m/s for 6 s
+    altitude += 20.0 * SAMPLE_US / 1e6;
+    mock::bme280.pressure_pa = pressureAt(altitude);
+    runFor(20);
+  }
+  barometer_getFlight(flight);
+  TEST_ASSERT_EQUAL(BarometerPhase::Ascent, flight.phase);
+  TEST_ASSERT_EQUAL(BarometerEvent::Launch, flight.last_event);
+  TEST_ASSERT_INT32_WITHIN(50, 2000, flight.vspeed_cms);
+
+  for (int i = 0; i < 500; i++) { // descend at 5 m/s for 10 s
+    altitude -= 5.0 * SAMPLE_US / 1e6;
+    mock::bme280.pressure_pa = pressureAt(altitude);
+    runFor(20);
+  }
+  barometer_getFlight(flight);
+  TEST_ASSERT_EQUAL(BarometerPhase::Descent, flight.phase);
+  TEST_ASSERT_EQUAL(BarometerEvent::Apogee, flight.last_event);
+  TEST_ASSERT_INT32_WITHIN(20, 12000, flight.last_event_cm);
+
+  runFor(6000); // still on the ground
+  barometer_getFlight(flight);
+  TEST_ASSERT_EQUAL(BarometerPhase::Landed, flight.phase);
+  TEST_ASSERT_EQUAL(BarometerEvent::Landing, flight.last_event);
+  TEST_ASSERT_EQUAL_UINT32(events_before + 3, flight.event_count);
+}
+
+static void test_bad_reads_force_a_rescan() {
+  mock::bme280.fail_reads = true;
+  runFor(20 * BAD_READS_MAX);
+  TEST_ASSERT_FALSE(barometer_isReady());
+  BarometerBusStats bus;
+  barometer_getBusStats(bus);
+  TEST_ASSERT_GREATER_THAN(0, bus.errors);
+
+  mock::bme280.fail_reads = false;
+  runFor(RESCAN_BACKOFF_MAX_MS * 2);
+  TEST_ASSERT_TRUE(barometer_isReady());
+  TEST_ASSERT_UINT32_WITHIN(64, 101325 * 256, barometer_getRawPressureQ8());
+}
+
+static void test_fast_mode_is_applied_by_process() {
+  barometer_setFastMode(true);
+  TEST_ASSERT_FALSE(fast_mode_applied);
+  runFor(20);
+  TEST_ASSERT_TRUE(fast_mode_applied);
+  barometer_setFastMode(false);
+  runFor(20);
+  TEST_ASSERT_FALSE(fast_mode_applied);
+}
+
+static void test_sequence_tells_new_readings_apart() {
+  BarometerReading first, second;
+  barometer_getReading(first);
+  TEST_ASSERT_GREATER_THAN(0, first.seq);
+  barometer_getReading(second);
+  TEST_ASSERT_EQUAL_UINT32(first.seq, second.seq); // a re-read of the cache
+  mock::advanceUs(SAMPLE_US);
+  TEST_ASSERT_TRUE(barometer_process());
+  barometer_getReading(second);
+  TEST_ASSERT_EQUAL_UINT32(first.seq + 1, second.seq);
+  TEST_ASSERT_TRUE(second.t_us == mock::now_us);
+
+  barometer_setFastMode(true);
+  barometer_setForcedMode(true);
+  TEST_ASSERT_FALSE(barometer_process()); // nothing triggered
+  barometer_getReading(first);
+  TEST_ASSERT_EQUAL_UINT32(second.seq, first.seq);
+  barometer_setForcedMode(false);
+  barometer_setFastMode(false);
+}
+
+static void test_forced_mode_reads_each_conversion_once() {
+  barometer_setFastMode(true);
+  barometer_setForcedMode(true);
+  TEST_ASSERT_FALSE(barometer_process()); // applied, nothing triggered yet
+  TEST_ASSERT_TRUE(forced_mode_applied);
+  TEST_ASSERT_EQUAL(0, mock::bme280.mode); // asleep between conversions
+  TEST_ASSERT_EQUAL_UINT32(6425, barometer_getConversionUs(true));
+
+  const uint32_t reads = mock::bme280.data_reads;
+  TEST_ASSERT_TRUE(barometer_trigger());
+  TEST_ASSERT_EQUAL_UINT32(1, mock::bme280.forced_conversions);
+  mock::advanceUs(1000);
+  TEST_ASSERT_FALSE(barometer_process()); // status register: still measuring
+  mock::advanceUs(mock::bme280.conversion_us - 1000);
+  TEST_ASSERT_TRUE(barometer_process());  // done before the datasheet maximum
+  TEST_ASSERT_EQUAL_UINT32(reads + 1, mock::bme280.data_reads);
+  TEST_ASSERT_FALSE(barometer_process()); // consumed, no bus read
+  TEST_ASSERT_EQUAL_UINT32(reads + 1, mock::bme280.data_reads);
+
+  barometer_setForcedMode(false);
+  barometer_setFastMode(false);
+  TEST_ASSERT_TRUE(barometer_process());
+  TEST_ASSERT_FALSE(forced_mode_applied);
+  TEST_ASSERT_EQUAL(3, mock::bme280.mode);
+  TEST_ASSERT_FALSE(barometer_trigger());
+}
+
+/**
+ * @brief Host cost of the compensation, EMA and flight update per reading,
+ * excluding the simulated bus transfer.
+ */
+static void bench_pipeline() {
+  const uint32_t samples = 100000;
+  int32_t adc_T, adc_P;
+  mock::bme280.adcValues(adc_T, adc_P);
+  volatile uint32_t sink = 0;
+  const uint64_t started = mock::hostNs();
+  for (uint32_t n = 0; n < samples; n++) {
+    int32_t t_fine;
+    compensateTemperature(adc_T, t_fine);
+    const uint32_t raw_q8 = compensatePressure(adc_P - (int32_t)(n % 16), t_fine);
+    updatePressureEMA(raw_q8);
+    updateFlight((int64_t)n * SAMPLE_US, raw_q8, pressure_ema_q8);
+    sink = pressure_ema_q8;
+  }
+  const uint64_t elapsed = mock::hostNs() - started;
+  (void)sink;
+  char line[96];
+  snprintf(line, sizeof(line), "barometer pipeline %.1f ns/sample (host)",
+           (double)elapsed / samples);
+  TEST_MESSAGE(line);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_reads_the_simulated_sensor);
+  RUN_TEST(test_ema_smooths_a_step);
+  RUN_TEST(test_altitude_follows_pressure);
+  RUN_TEST(test_flight_events);
+  RUN_TEST(test_bad_reads_force_a_rescan);
+  RUN_TEST(test_fast_mode_is_applied_by_process);
+  RUN_TEST(test_forced_mode_reads_each_conversion_once);
+  RUN_TEST(test_sequence_tells_new_readings_apart);
+  RUN_TEST(bench_pipeline);
+  return UNITY_END();
+}
@@ -0,0 +1,238 @@
+/**
+ * @file test_main.cpp
+ * @brief Native tests and benchmark of the FDR delta codec (fdr_codec.cpp)
+ * @author slopez.tech
+ * @date 2025-11-30
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include "fdr_codec.h"
+#include "mock_clock.h"
+
+static FdrBaroRecord baro(uint8_t type, uint32_t t_ms, uint32_t pressure_q8, int16_t cdeg) {
+  FdrBaroRecord rec;
+  rec.type = type;
+  rec.t_ms = t_ms;
+  rec.pressure_q8 = pressure_q8;
+  rec.temperature_cdeg = cdeg;
+  return rec;
+}
+
+static FdrImuRecord imu(uint32_t t_ms, int16_t base) {
+  FdrImuRecord rec;
+  rec.type = FDR_REC_IMU;
+  rec.t_ms = t_ms;
+  for (int axis = 0; axis < 3; axis++) {
+    rec.accel[axis] = (int16_t)(base + axis);
+    rec.gyro[axis] = (int16_t)(-base - axis);
+  }
+  return rec;
+}
+
+/**
+ * @brief Encodes `count` records of `size` bytes back to back the way the
+ * writer does, then decodes the stream and checks every record.
+ *
+ * @return Encoded stream length.
+ */
+static size_t roundTrip(const uint8_t* records, size_t size, size_t count) {
+  static uint8_t stream[64 * 1024];
+  FdrCodecState encoder;
+  fdr_codecReset(encoder);
+  size_t len = 0;
+  for (size_t i = 0; i < count; i++) {
+    const uint8_t* rec = records + i * size;
+    len += fdr_encodeRecord(encoder, rec, stream + len);
+    fdr_codecAccept(encoder, rec);
+  }
+
+  FdrCodecState decoder;
+  fdr_codecReset(decoder);
+  size_t pos = 0;
+  for (size_t i = 0; i < count; i++) {
+    const size_t rec_len = fdr_recordLength(stream + pos, len - pos);
+    TEST_ASSERT_TRUE(rec_len > 0 && rec_len <= len - pos);
+    uint8_t out[FDR_MAX_RECORD_SIZE];
+    TEST_ASSERT_EQUAL_UINT32(size, fdr_decodeRecord(decoder, stream + pos, rec_len, out));
+    TEST_ASSERT_EQUAL_MEMORY(records + i * size, out, size);
+    pos += rec_len;
+  }
+  TEST_ASSERT_EQUAL_UINT32(len, pos);
+  return len;
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_first_sample_is_absolute() {
+  FdrCodecState state;
+  fdr_codecReset(state);
+  const FdrBaroRecord rec = baro(FDR_REC_BARO, 0, 101325u << 8, 2000);
+  uint8_t out[FDR_MAX_RECORD_SIZE];
+  TEST_ASSERT_EQUAL_UINT32(sizeof(rec), fdr_encodeRecord(state, (const uint8_t*)&rec, out));
+  TEST_ASSERT_EQUAL_UINT8(FDR_REC_BARO, out[0]);
+}
+
+static void test_steady_rate_barometer_is_compact() {
+  FdrBaroRecord recs[500];
+  for (uint32_t i = 0; i < 500; i++) {
+    recs[i] = baro(FDR_REC_BARO, i * 20, (101325u << 8) - i * 37, (int16_t)(2000 + (i % 3)));
+  }
+  const size_t len = roundTrip((const uint8_t*)recs, sizeof(FdrBaroRecord), 500);
+  // Steady interval: one tag byte plus two short varints
+  TEST_ASSERT_LESS_OR_EQUAL(sizeof(FdrBaroRecord) + 499 * 4, len);
+}
+
+static void test_irregular_intervals_round_trip() {
+  FdrBaroRecord recs[200];
+  uint32_t t_ms = 0;
+  for (uint32_t i = 0; i < 200; i++) {
+    t_ms += (i % 7 == 0) ? 1000 : 10 + i % 5; // jumps need an explicit interval
+    recs[i] = baro(FDR_REC_BARO, t_ms, (90000u << 8) + i * i * 13, (int16_t)(-500 + i));
+  }
+  roundTrip((const uint8_t*)recs, sizeof(FdrBaroRecord), 200);
+}
+
+static void test_large_pressure_step_round_trips() {
+  FdrBaroRecord recs[3] = {baro(FDR_REC_BARO, 0, 30000u << 8, 0),
+                           baro(FDR_REC_BARO, 10, 110000u << 8, 8500),
+                           baro(FDR_REC_BARO, 20, 30000u << 8, -4000)};
+  roundTrip((const uint8_t*)recs, sizeof(FdrBaroRecord), 3);
+}
+
+static void test_imu_round_trip() {
+  FdrImuRecord recs[300];
+  for (uint32_t i = 0; i < 300; i++) recs[i] = imu(i * 5, (int16_t)(i * 3 - 400));
+  const size_t len = roundTrip((const uint8_t*)recs, sizeof(FdrImuRecord), 300);
+  TEST_ASSERT_LESS_THAN(300 * sizeof(FdrImuRecord), len);
+}
+
+static void test_channels_keep_separate_references() {
+  // Interleaved barometer, raw barometer and altitude share nothing but the layout
+  uint8_t stream[64 * 1024];
+  FdrCodecState encoder;
+  fdr_codecReset(encoder);
+  FdrBaroRecord recs[300];
+  for (uint32_t i = 0; i < 100; i++) {
+    recs[3 * i] = baro(FDR_REC_BARO, i * 100, (100000u << 8) + i * 50, 2100);
+    recs[3 * i + 1] = baro(FDR_REC_BARO_RAW, i * 100, (100000u << 8) + i * 50 + (i % 2) * 900, 2100);
+    recs[3 * i + 2] = baro(FDR_REC_ALT, i * 100, i * 30, (int16_t)(i % 40));
+  }
+  size_t len = 0;
+  for (const FdrBaroRecord &rec : recs) {
+    len += fdr_encodeRecord(encoder, (const uint8_t*)&rec, stream + len);
+    fdr_codecAccept(encoder, (const uint8_t*)&rec);
+  }
+  FdrCodecState decoder;
+  fdr_codecReset(decoder);
+  size_t pos = 0;
+  for (const FdrBaroRecord &rec : recs) {
+    const size_t rec_len = fdr_recordLength(stream + pos, len - pos);
+    TEST_ASSERT_EQUAL_UINT8(rec.type, fdr_recordChannel(stream[pos]));
+    uint8_t out[FDR_MAX_RECORD_SIZE];
+    TEST_ASSERT_EQUAL_UINT32(sizeof(rec), fdr_decodeRecord(decoder, stream + pos, rec_len, out));
+    TEST_ASSERT_EQUAL_MEMORY(&rec, out, sizeof(rec));
+    pos += rec_len;
+  }
+}
+
+static void test_truncated_record_asks_for_more() {
+  FdrCodecState state;
+  fdr_codecReset(state);
+  const FdrBaroRecord first = baro(FDR_REC_BARO, 0, 1000000, 0);
+  fdr_codecAccept(state, (const uint8_t*)&first);
+  const FdrBaroRecord next = baro(FDR_REC_BARO, 5000, 900000, 1234);
+  uint8_t out[FDR_MAX_RECORD_SIZE];
+  const size_t len = fdr_encodeRecord(state, (const uint8_t*)&next, out);
+  TEST_ASSERT_TRUE((out[0] & FDR_DELTA_TYPE_MASK) == FDR_REC_BARO_DELTA);
+  for (size_t avail = 1; avail < len; avail++) {
+    TEST_ASSERT_GREATER_THAN(avail, fdr_recordLength(out, avail));
+  }
+  TEST_ASSERT_EQUAL_UINT32(len, fdr_recordLength(out, len));
+}
+
+static void test_unknown_tag_is_invalid() {
+  const uint8_t junk[4] = {0x7E, 0, 0, 0};
+  TEST_ASSERT_EQUAL_UINT32(0, fdr_recordLength(junk, sizeof(junk)));
+  TEST_ASSERT_EQUAL_UINT8(0, fdr_recordChannel(0x7E));
+}
+
+static void test_delta_without_reference_is_rejected() {
+  FdrCodecState state;
+  fdr_codecReset(state);
+  const uint8_t delta[3] = {(uint8_t)(FDR_REC_BARO_DELTA | FDR_DELTA_DT_BIAS), 0, 0};
+  uint8_t out[FDR_MAX_RECORD_SIZE];
+  TEST_ASSERT_EQUAL_UINT32(0, fdr_decodeRecord(state, delta, sizeof(delta), out));
+}
+
+static void test_sync_record_resets_both_sides() {
+  FdrCodecState encoder, decoder;
+  fdr_codecReset(encoder);
+  fdr_codecReset(decoder);
+  uint8_t stream[FDR_MAX_RECORD_SIZE];
+  uint8_t out[FDR_MAX_RECORD_SIZE];
+  const FdrBaroRecord first = baro(FDR_REC_BARO, 0, 101325u << 8, 2000);
+  const FdrBaroRecord second = baro(FDR_REC_BARO, 20, 101300u << 8, 2001);
+  size_t len = fdr_encodeRecord(encoder, (const uint8_t*)&first, stream);
+  fdr_codecAccept(encoder, (const uint8_t*)&first);
+  TEST_ASSERT_EQUAL_UINT32(sizeof(first), fdr_decodeRecord(decoder, stream, len, out));
+
+  FdrSyncRecord sync;
+  sync.type = FDR_REC_SYNC;
+  sync.t_ms = 0;
+  fdr_codecAccept(encoder, (const uint8_t*)&sync);
+  TEST_ASSERT_EQUAL_UINT32(sizeof(sync), fdr_decodeRecord(decoder, (const uint8_t*)&sync,
+                                                          sizeof(sync), out));
+
+  // Absolute again after the sync point, and decodable by a reader that
+  // starts there
+  len = fdr_encodeRecord(encoder, (const uint8_t*)&second, stream);
+  TEST_ASSERT_EQUAL_UINT8(FDR_REC_BARO, stream[0]);
+  FdrCodecState seeker;
+  fdr_codecReset(seeker);
+  TEST_ASSERT_EQUAL_UINT32(sizeof(second), fdr_decodeRecord(seeker, stream, len, out));
+  TEST_ASSERT_EQUAL_MEMORY(&second, out, sizeof(second));
+}
+
+/**
+ * @brief Host cost of encoding one barometer sample, the writer-side work
+ * per record.
+ */
+static void bench_encode() {
+  static FdrBaroRecord recs[10000];
+  for (uint32_t i = 0; i < 10000; i++) {
+    recs[i] = baro(FDR_REC_BARO, i * 20, (101325u << 8) - i * 11, 2000);
+  }
+  static uint8_t stream[10000 * sizeof(FdrBaroRecord)];
+  FdrCodecState state;
+  fdr_codecReset(state);
+  size_t len = 0;
+  const uint64_t started = mock::hostNs();
+  for (const FdrBaroRecord &rec : recs) {
+    len += fdr_encodeRecord(state, (const uint8_t*)&rec, stream + len);
+    fdr_codecAccept(state, (const uint8_t*)&rec);
+  }
+  const uint64_t elapsed = mock::hostNs() - started;
+  char line[96];
+  snprintf(line, sizeof(line), "encode: %.1f ns/sample (host), %.2f bytes/sample",
+           (double)elapsed / 10000.0, (double)len / 10000.0);
+  TEST_MESSAGE(line);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_first_sample_is_absolute);
+  RUN_TEST(test_steady_rate_barometer_is_compact);
+  RUN_TEST(test_irregular_intervals_round_trip);
+  RUN_TEST(test_large_pressure_step_round_trips);
+  RUN_TEST(test_imu_round_trip);
+  RUN_TEST(test_channels_keep_separate_references);
+  RUN_TEST(test_truncated_record_asks_for_more);
+  RUN_TEST(test_unknown_tag_is_invalid);
+  RUN_TEST(test_delta_without_reference_is_rejected);
+  RUN_TEST(test_sync_record_resets_both_sides);
+  RUN_TEST(bench_encode);
+  return UNITY_END();
+}
@@ -0,0 +1,940 @@
+/**
+ * @file test_main.cpp
+ * @brief Native tests and benchmarks of the FDR module (fdr.cpp): sessions
+ * run end to end on the simulated clock, against a RAM storage backend
+ * @author slopez.tech
+ * @date 2025-11-30
+ *
+ * runSession() is the real sampler loop. Whenever it would wait for its
+ * timer, simBlock() moves the clock to the deadline and runs a
+ * writerStep() every WRITER_POLL_INTERVAL_MS on the way, as the writer
+ * task would. The storage backend charges simulated time for each append
+ * and sync, so flush latencies and the jitter they cause show up in the
+ * statistics the way they would on the device (a flash write stalls the
+ * whole CPU there too).
+ */
+
+#include <unity.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+#include "fdr.cpp"
+
+// ============================================================================
+// RAM storage backend
+// ============================================================================
+
+/**
+ * @brief FdrStorage on host memory with a rough cost model of LittleFS on
+ * the ESP32-C3 flash: a fixed cost per append plus a throughput, and a
+ * fixed cost per sync (metadata commit).
+ */
+class RamStorage : public FdrStorage {
+ public:
+  static constexpr uint32_t CAPACITY_BYTES = 1024 * 1024;
+  static constexpr uint32_t APPEND_BASE_US = 150;
+  static constexpr uint32_t APPEND_US_PER_KB = 4000; // ~250 KB/s
+  static constexpr uint32_t SYNC_US = 3000;
+
+  std::map<uint32_t, std::vector<uint8_t>> sessions;
+  std::vector<uint8_t> index;
+  uint32_t capacity = CAPACITY_BYTES;
+  uint32_t target = 0;
+  bool open = false;
+  uint32_t appends = 0;
+  uint32_t syncs = 0;
+  /** @brief Appends store nothing in this window (µs), as if the flash fell behind. */
+  int64_t stall_from_us = 0;
+  int64_t stall_until_us = 0;
+
+  const char* name() const override { return "ram"; }
+  bool mount() override { return true; }
+
+  size_t loadIndex(uint8_t* out, size_t max) override {
+    const size_t len = index.size() < max ? index.size() : max;
+    memcpy(out, index.data(), len);
+    return len;
+  }
+  bool saveIndex(const uint8_t* data, size_t len) override {
+    index.assign(data, data + len);
+    return true;
+  }
+  bool create(uint32_t id) override {
+    sessions[id].clear();
+    target = id;
+    open = true;
+    return true;
+  }
+  size_t append(const uint8_t* data, size_t len) override {
+    if (!open) return 0;
+    if (mock::now_us >= stall_from_us && mock::now_us < stall_until_us) len = 0;
+    if (len > freeBytes()) len = freeBytes();
+    std::vector<uint8_t> &file = sessions[target];
+    file.insert(file.end(), data, data + len);
+    appends++;
+    mock::advanceUs(APPEND_BASE_US + (uint64_t)len * APPEND_US_PER_KB / 1024);
+    return len;
+  }
+  bool sync() override {
+    syncs++;
+    mock::advanceUs(SYNC_US);
+    return true;
+  }
+  void close() override {
+    if (open) sync();
+    open = false;
+  }
+  bool remove(uint32_t id) override { return sessions.erase(id) > 0; }
+  uint32_t size(uint32_t id) override {
+    const auto it = sessions.find(id);
+    return it == sessions.end() ? 0 : (uint32_t)it->second.size();
+  }
+  size_t read(uint32_t id, uint32_t offset, uint8_t* out, size_t len) override {
+    const auto it = sessions.find(id);
+    if (it == sessions.end() || offset >= it->second.size()) return 0;
+    if (len > it->second.size() - offset) len = it->second.size() - offset;
+    memcpy(out, it->second.data() + offset, len);
+    return len;
+  }
+  uint32_t totalBytes() override { return capacity; }
+  uint32_t freeBytes() override {
+    uint32_t used = 0;
+    for (const auto &entry : sessions) used += (uint32_t)entry.second.size();
+    return used < capacity ? capacity - used : 0;
+  }
+
+  void wipe() {
+    capacity = CAPACITY_BYTES;
+    stall_from_us = 0;
+    stall_until_us = 0;
+    sessions.clear();
+    index.clear();
+    open = false;
+    appends = 0;
+    syncs = 0;
+  }
+};
+
+static RamStorage ram_storage;
+
+FdrStorage &fdr_storage() {
+  return ram_storage;
+}
+
+// ============================================================================
+// Sensor and LED stubs
+// ============================================================================
+
+namespace sim {
+/** @brief Scripted pressure in Pa at a session time in ms; 101325 by default. */
+double (*pressure)(uint32_t t_ms) = nullptr;
+int64_t session_start_us = 0;
+uint32_t pressure_q8 = 101325 * 256;
+BarometerFlight flight = {};
+LedMode led_mode = LedMode::Boot;
+uint8_t led_conditions = 0;
+bool led_hold = false;
+bool forced = false;
+uint32_t conversion_us = 6425;
+int64_t conversion_started_us = 0; ///< 0 = no conversion to read
+uint32_t triggers = 0;
+uint32_t early_reads = 0;           ///< Reads before the conversion time
+uint32_t reads = 0;                 ///< Readings stored
+int64_t cut_us = 0;                 ///< Power loss at this time; 0 = none
+bool imu_ready = false;
+} // namespace sim
+
+void barometer_init() {}
+bool barometer_process() {
+  if (sim::forced) {
+    if (sim::conversion_started_us == 0) return false;
+    if (mock::now_us - sim::conversion_started_us < sim::conversion_us) {
+      sim::early_reads++;
+      return false;
+    }
+    sim::conversion_started_us = 0;
+  }
+  const uint32_t t_ms = (uint32_t)((mock::now_us - sim::session_start_us) / 1000);
+  const double pa = sim::pressure != nullptr ? sim::pressure(t_ms) : 101325.0;
+  sim::pressure_q8 = (uint32_t)(pa * 256.0 + 0.5);
+  sim::reads++;
+  return true;
+}
+bool barometer_isReady() { return true; }
+void barometer_setFastMode(bool) {}
+void barometer_setForcedMode(bool forced) { sim::forced = forced; }
+uint32_t barometer_getConversionUs(bool) { return sim::conversion_us; }
+bool barometer_trigger() {
+  if (!sim::forced) return false;
+  sim::triggers++;
+  sim::conversion_started_us = mock::now_us;
+  return true;
+}
+int16_t barometer_getTemperatureCdeg() { return 2150; }
+uint32_t barometer_getPressureQ8() { return sim::pressure_q8; }
+uint32_t barometer_getRawPressureQ8() { return sim::pressure_q8; }
+void barometer_getFlight(BarometerFlight &flight) { flight = sim::flight; }
+
+bool imu_isReady() { return sim::imu_ready; }
+size_t imu_process(ImuSample*, size_t) { return 0; }
+uint16_t imu_setRate(uint16_t hz) { return hz; }
+uint16_t imu_rateFor(uint16_t hz) { return hz; }
+
+void led_setMode(LedMode mode) { sim::led_mode = mode; }
+void led_setCondition(uint8_t condition, bool set) {
+  sim::led_conditions = set ? sim::led_conditions | condition : sim::led_conditions & ~condition;
+}
+void led_setHold(bool hold) { sim::led_hold = hold; }
+
+// ============================================================================
+// Simulation
+// ============================================================================
+
+static int64_t next_writer_us = 0;
+static std::vector<uint32_t> flush_latencies_us;
+static uint32_t flushes_seen = 0;
+
+/**
+ * @brief Runs one writer wakeup and notes the latency of any flush it made.
+ */
+static void runWriter() {
+  writerStep();
+  if (storage_stats.flushes != flushes_seen) {
+    flushes_seen = storage_stats.flushes;
+    flush_latencies_us.push_back(storage_stats.flush_last_us);
+  }
+}
+
+/**
+ * @brief The sampler waits for its timer: run the writer until then.
+ */
+static void simBlock(TickType_t) {
+  const int64_t due_us = mock::timer_due_us;
+  if (sim::cut_us > 0 && due_us >= sim::cut_us) {
+    fdr_sampling = false; // nothing runs after the power loss
+    return;
+  }
+  while (due_us > 0 && next_writer_us <= due_us) {
+    if (mock::now_us < next_writer_us) mock::now_us = next_writer_us;
+    runWriter();
+    next_writer_us += WRITER_POLL_INTERVAL_MS * 1000;
+  }
+  if (mock::now_us < due_us) mock::now_us = due_us;
+}
+
+/**
+ * @brief Runs a started session to its end and closes it.
+ */
+static void runToEnd() {
+  next_writer_us = mock::now_us + WRITER_POLL_INTERVAL_MS * 1000;
+  runSession();
+  for (int i = 0; i < 10 && fdr_active; i++) runWriter();
+  TEST_ASSERT_FALSE(fdr_isActive());
+}
+
+/**
+ * @brief Runs a started session until the power is lost `after_ms` in.
+ */
+static void runUntilPowerLoss(uint32_t after_ms) {
+  sim::cut_us = fdr_start_us + (int64_t)after_ms * 1000;
+  next_writer_us = mock::now_us + WRITER_POLL_INTERVAL_MS * 1000;
+  runSession();
+  sim::cut_us = 0;
+}
+
+/**
+ * @brief Boots again after a power loss: the RAM state is gone, the
+ * storage and NVS keep what reached them.
+ */
+static void rebootDevice() {
+  fdr_active = false;
+  session_open = false;
+  ram_storage.open = false;
+  storage_mounted = false;
+  session_count = 0;
+  fdr_init();
+  sim::session_start_us = fdr_start_us;
+}
+
+static bool startSession(const FdrSessionConfig &config) {
+  const bool started = fdr_start(config);
+  sim::session_start_us = fdr_start_us; // sample 0 is due once its conversion is done
+  return started;
+}
+
+/**
+ * @brief CSV export of a channel of the latest session.
+ */
+static std::string exportCsv(uint8_t type) {
+  const FdrIndexEntry &entry = session_index[session_count - 1];
+  FdrFileHeader header;
+  TEST_ASSERT_TRUE(readFdrHeader(entry.session_id, header));
+  DownloadCursor from = {};
+  from.session_id = entry.session_id;
+  from.type = type;
+  from.bin_offset = sizeof(FdrFileHeader);
+  fdr_codecReset(from.codec);
+  CsvOutput out = {nullptr, 1, false, 0, UINT32_MAX, 0, UINT32_MAX, false};
+  mock::socket_output.clear();
+  TEST_ASSERT_TRUE(convertToCsv(header, from, storage.size(entry.session_id), out, nullptr));
+  return mock::socket_output;
+}
+
+static size_t countLines(const std::string &text) {
+  size_t lines = 0;
+  for (char c : text) lines += c == '\n';
+  return lines;
+}
+
+void setUp() {
+  ram_storage.wipe();
+  storage_mounted = false;
+  session_count = 0;
+  mock::setTimeUs(10000000);
+  mock::block_hook = simBlock;
+  sim::pressure = nullptr;
+  sim::pressure_q8 = 101325 * 256;
+  sim::flight = {};
+  sim::triggers = 0;
+  sim::early_reads = 0;
+  sim::conversion_started_us = 0;
+  sim::cut_us = 0;
+  sim::imu_ready = false;
+  mock::nvs.clear();
+  flush_latencies_us.clear();
+  flushes_seen = 0;
+  fdr_init();
+}
+
+void tearDown() {
+  fdr_stop();
+  mock::block_hook = nullptr;
+}
+
+// ============================================================================
+// Tests
+// ============================================================================
+
+static void test_session_records_every_deadline() {
+  FdrSessionConfig config;
+  config.duration_s = 5;
+  config.samples_per_sec = 10.0f;
+  config.record_altitude = false;
+  TEST_ASSERT_TRUE(startSession(config));
+  runToEnd();
+
+  FdrTimingStats timing;
+  fdr_getTimingStats(timing);
+  TEST_ASSERT_EQUAL_UINT32(51, timing.samples); // the last deadline ends the session
+  TEST_ASSERT_EQUAL_UINT32(0, timing.missed_deadlines);
+
+  FdrSessionSummary sessions[FDR_MAX_SESSIONS];
+  TEST_ASSERT_EQUAL(1, fdr_listSessions(sessions, FDR_MAX_SESSIONS));
+  TEST_ASSERT_FALSE(sessions[0].open);
+  TEST_ASSERT_EQUAL_UINT32(50, sessions[0].baro_records);
+  TEST_ASSERT_EQUAL_UINT32(4900, sessions[0].duration_ms);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 1013.25f, sessions[0].pressure_min_hpa);
+}
+
+static void test_csv_export_matches_the_samples() {
+  sim::pressure = [](uint32_t t_ms) { return 101325.0 - t_ms / 10.0; }; // -100 Pa/s
+  FdrSessionConfig config;
+  config.duration_s = 2;
+  config.samples_per_sec = 5.0f;
+  config.filter = PressureFilterConfig();
+  TEST_ASSERT_TRUE(pressureFilter_parse("none", config.filter));
+  config.record_altitude = false;
+  TEST_ASSERT_TRUE(startSession(config));
+  runToEnd();
+
+  const std::string csv = exportCsv(FDR_REC_BARO);
+  TEST_ASSERT_EQUAL(11, countLines(csv)); // header + 10 samples
+  TEST_ASSERT_EQUAL_STRING("timestamp_s,pressure_hpa\n"
+                           "0.000,1013.25\n"
+                           "0.200,1013.05\n"
+                           "0.400,1012.85\n",
+                           csv.substr(0, 67).c_str());
+}
+
+static void test_csv_row_format() {
+  char row[CSV_MAX_ROW_LEN];
+  FdrBaroRecord rec = {};
+  rec.t_ms = 123456;
+  rec.pressure_q8 = 99999 * 256 + 200; // rounds up
+  TEST_ASSERT_EQUAL(16, formatCsvRow(rec, row));
+  row[16] = '\0';
+  TEST_ASSERT_EQUAL_STRING("123.456,1000.00\n", row);
+}
+
+static void test_flushes_follow_the_interval_at_low_rates() {
+  FdrSessionConfig config;
+  config.duration_s = 10;
+  config.samples_per_sec = 1.0f;
+  TEST_ASSERT_TRUE(startSession(config));
+  runToEnd();
+
+  FdrStorageStats stats;
+  fdr_getStorageStats(stats);
+  TEST_ASSERT_UINT32_WITHIN(2, 10, stats.flushes); // BUFFER_FLUSH_INTERVAL_MS
+  TEST_ASSERT_GREATER_THAN(0, stats.commits);
+  TEST_ASSERT_EQUAL_STRING("ram", stats.backend);
+}
+
+static void test_armed_session_commits_the_pretrigger_window() {
+  // Ground for 3 s, then pressure falling at 500 Pa/s
+  sim::pressure = [](uint32_t t_ms) {
+    return t_ms < 3000 ? 101325.0 : 101325.0 - (t_ms - 3000) * 0.5;
+  };
+  FdrSessionConfig config;
+  config.duration_s = 2;
+  config.samples_per_sec = 20.0f;
+  config.record_altitude = false;
+  config.pretrigger_ms = 1000;
+  config.trigger.pressure_drop_pa_s = 200;
+  TEST_ASSERT_TRUE(startSession(config));
+  FdrSessionInfo info;
+  fdr_getSessionInfo(info);
+  TEST_ASSERT_TRUE(info.armed);
+  TEST_ASSERT_TRUE(sim::led_mode == LedMode::Armed);
+  runToEnd();
+  TEST_ASSERT_TRUE(sim::led_mode == LedMode::Idle);
+
+  fdr_getSessionInfo(info);
+  TEST_ASSERT_TRUE(info.triggered);
+  TEST_ASSERT_EQUAL_STRING("pressure", info.trigger_cause);
+  TEST_ASSERT_UINT32_WITHIN(600, 3300, info.trigger_t_ms);
+
+  FdrSessionSummary sessions[FDR_MAX_SESSIONS];
+  TEST_ASSERT_EQUAL(1, fdr_listSessions(sessions, FDR_MAX_SESSIONS));
+  // About 1 s before the trigger plus the 2 s after it, at 20 Hz
+  TEST_ASSERT_UINT32_WITHIN(3, 60, sessions[0].baro_records);
+}
+
+static void test_reader_commits_the_pretrigger_window_first() {
+  sim::pressure = [](uint32_t t_ms) {
+    return t_ms < 1500 ? 101325.0 : 101325.0 - (t_ms - 1500) * 0.5;
+  };
+  FdrSessionConfig config;
+  config.duration_s = 2;
+  config.samples_per_sec = 10.0f;
+  config.record_altitude = false;
+  config.pretrigger_ms = 1000;
+  config.trigger.pressure_drop_pa_s = 200;
+  TEST_ASSERT_TRUE(startSession(config));
+  // The trigger fires, and the sampler goes on for a while before the writer runs
+  sim::cut_us = fdr_start_us + 3000000;
+  mock::block_hook = [](TickType_t) {
+    if (mock::timer_due_us >= sim::cut_us) fdr_sampling = false;
+    else if (mock::now_us < mock::timer_due_us) mock::now_us = mock::timer_due_us;
+  };
+  runSession();
+  mock::block_hook = simBlock;
+  sim::cut_us = 0;
+  fdr_sampling = true; // still recording
+  TEST_ASSERT_TRUE(pretrigger_done.load());
+  TEST_ASSERT_FALSE(pretrigger_committed);
+
+  // A download of the live session stores the ring before the queue
+  {
+    FdrLockGuard lock;
+    syncLiveSessionLocked();
+  }
+  const std::string csv = exportCsv(FDR_REC_BARO);
+  double last = -1.0;
+  size_t rows = 0;
+  for (size_t pos = csv.find('\n') + 1; pos < csv.size(); pos = csv.find('\n', pos) + 1) {
+    const double t = atof(csv.c_str() + pos);
+    TEST_ASSERT_TRUE(t >= last);
+    last = t;
+    rows++;
+  }
+  TEST_ASSERT_GREATER_THAN_UINT32(15, rows);
+  runToEnd();
+}
+
+static void test_untriggered_armed_session_is_deleted() {
+  FdrSessionConfig config;
+  config.duration_s = 2;
+  config.samples_per_sec = 10.0f;
+  config.pretrigger_ms = 1000;
+  config.trigger.pressure_drop_pa_s = 200;
+  TEST_ASSERT_TRUE(startSession(config));
+  const uint32_t header_appends = ram_storage.appends;
+  next_writer_us = mock::now_us;
+  for (int i = 0; i < 100; i++) { // 5 s without a trigger
+    mock::timer_due_us = mock::now_us + 50000;
+    simBlock(0);
+    barometer_process();
+    sampleOnce(mock::now_us, false, true);
+  }
+  TEST_ASSERT_EQUAL(header_appends, ram_storage.appends); // nothing reached flash
+  fdr_stop();
+  TEST_ASSERT_EQUAL(0, fdr_listSessions(nullptr, 0));
+}
+
+static void test_forced_session_reads_one_conversion_per_sample() {
+  FdrSessionConfig config;
+  config.duration_s = 2;
+  config.samples_per_sec = 20.0f;
+  config.record_altitude = false;
+  TEST_ASSERT_TRUE(startSession(config));
+  FdrSessionInfo info;
+  fdr_getSessionInfo(info);
+  TEST_ASSERT_TRUE(info.baro_forced);
+  TEST_ASSERT_TRUE(sim::forced);
+  runToEnd();
+  TEST_ASSERT_FALSE(sim::forced); // normal mode again between sessions
+
+  FdrTimingStats timing;
+  fdr_getTimingStats(timing);
+  TEST_ASSERT_EQUAL_UINT32(41, timing.samples);
+  TEST_ASSERT_EQUAL_UINT32(timing.samples, sim::triggers);
+  TEST_ASSERT_EQUAL_UINT32(0, sim::early_reads);
+  TEST_ASSERT_EQUAL_UINT32(0, timing.skipped_stale);
+  TEST_ASSERT_EQUAL_UINT32(0, timing.missed_deadlines);
+
+  FdrSessionSummary sessions[FDR_MAX_SESSIONS];
+  TEST_ASSERT_EQUAL(1, fdr_listSessions(sessions, FDR_MAX_SESSIONS));
+  TEST_ASSERT_EQUAL_UINT32(40, sessions[0].baro_records);
+}
+
+static void test_short_periods_keep_normal_mode() {
+  FdrSessionConfig config;
+  config.duration_s = 1;
+  config.samples_per_sec = 10.0f;
+  config.burst_ms = 500; // 200 Hz: 5 ms, shorter than a conversion
+  TEST_ASSERT_TRUE(startSession(config));
+  FdrSessionInfo info;
+  fdr_getSessionInfo(info);
+  TEST_ASSERT_FALSE(info.baro_forced);
+  runToEnd();
+  TEST_ASSERT_EQUAL_UINT32(0, sim::triggers);
+}
+
+/**
+ * @brief Barometer reads of the idle sampler over `seconds` of sim time.
+ */
+static uint32_t idleReadsOver(uint32_t seconds) {
+  const uint32_t before = sim::reads;
+  const int64_t end_us = mock::now_us + (int64_t)seconds * 1000000;
+  while (mock::now_us < end_us) {
+    const int64_t wait_us = idleStep();
+    mock::now_us += wait_us > 0 ? wait_us : 1000;
+  }
+  return sim::reads - before;
+}
+
+static void test_idle_reads_follow_the_demand() {
+  idleReadsOver(1); // settle the schedule
+  TEST_ASSERT_UINT32_WITHIN(1, 10, idleReadsOver(10)); // default 1 Hz
+
+  fdr_setIdleRate(5.0f);
+  TEST_ASSERT_UINT32_WITHIN(1, 50, idleReadsOver(10));
+  FdrAcquisitionInfo acquisition;
+  fdr_getAcquisitionInfo(acquisition);
+  TEST_ASSERT_EQUAL_STRING("idle", acquisition.mode);
+  TEST_ASSERT_EQUAL_UINT32(5000, acquisition.rate_mhz);
+
+  live_enabled = true; // a live client is attached
+  TEST_ASSERT_UINT32_WITHIN(1, 100, idleReadsOver(10));
+  fdr_getAcquisitionInfo(acquisition);
+  TEST_ASSERT_EQUAL_STRING("live", acquisition.mode);
+  live_enabled = false;
+  FdrBaroRecord stale_live;
+  while (live_baro_queue.pop(stale_live)) {}
+  fdr_setIdleRate(0.0f);
+  fdr_getAcquisitionInfo(acquisition);
+  TEST_ASSERT_EQUAL_UINT32(1000, acquisition.idle_rate_mhz);
+}
+
+static void test_armed_session_needs_a_trigger() {
+  FdrSessionConfig config;
+  config.pretrigger_ms = 1000;
+  TEST_ASSERT_FALSE(startSession(config));
+}
+
+static void test_start_lowers_the_rates_to_fit_the_storage() {
+  ram_storage.capacity = 128 * 1024;
+  FdrSessionConfig config;
+  config.duration_s = 300;
+  config.samples_per_sec = 20.0f;
+  sim::flight.valid = true;
+  TEST_ASSERT_TRUE(startSession(config));
+  FdrStoragePlan plan;
+  fdr_getStoragePlan(plan);
+  TEST_ASSERT_TRUE(plan.decimated);
+  TEST_ASSERT_EQUAL_UINT32(20000, plan.requested_rate_mhz);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(plan.available_bytes - STORAGE_RESERVE_BYTES, plan.session_bytes);
+  FdrSessionInfo info;
+  fdr_getSessionInfo(info);
+  TEST_ASSERT_TRUE(info.rate_mhz < 20000 && info.rate_mhz > 10000);
+  runToEnd();
+
+  // Everything was stored, within the estimate
+  FdrBufferStats buffer;
+  fdr_getBufferStats(buffer);
+  TEST_ASSERT_EQUAL_UINT32(0, buffer.overflow_records);
+  TEST_ASSERT_UINT32_WITHIN(2, info.rate_mhz * 300 / 1000, buffer.baro_records);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(plan.session_bytes, session_index[session_count - 1].bytes);
+}
+
+static void test_start_rejects_a_session_that_does_not_fit() {
+  ram_storage.capacity = 128 * 1024;
+  FdrSessionConfig config;
+  config.duration_s = 5;
+  TEST_ASSERT_TRUE(startSession(config));
+  runToEnd();
+
+  config.duration_s = 300;
+  config.samples_per_sec = 20.0f;
+  config.storage_policy = FdrStoragePolicy::Reject;
+  TEST_ASSERT_FALSE(startSession(config));
+  FdrStoragePlan plan;
+  fdr_getStoragePlan(plan);
+  TEST_ASSERT_TRUE(plan.rejected);
+  TEST_ASSERT_FALSE(plan.decimated);
+  TEST_ASSERT_FALSE(fdr_isActive());
+  TEST_ASSERT_EQUAL_UINT32(1, session_count); // nothing deleted for it
+
+  // Not even the lowest rate fits
+  config.duration_s = 10000000;
+  config.storage_policy = FdrStoragePolicy::Decimate;
+  TEST_ASSERT_FALSE(startSession(config));
+  fdr_getStoragePlan(plan);
+  TEST_ASSERT_TRUE(plan.rejected);
+  TEST_ASSERT_EQUAL_UINT32(1, session_count);
+}
+
+static void test_rejected_start_leaves_the_session_recording() {
+  ram_storage.capacity = 128 * 1024;
+  FdrSessionConfig config;
+  config.duration_s = 30;
+  config.samples_per_sec = 10.0f;
+  TEST_ASSERT_TRUE(startSession(config));
+  runUntilPowerLoss(10000);
+  fdr_sampling = true; // still recording, the sampler is only paused
+
+  FdrSessionConfig next;
+  next.duration_s = 300;
+  next.samples_per_sec = 20.0f;
+  next.record_raw = true;
+  next.storage_policy = FdrStoragePolicy::Reject;
+  TEST_ASSERT_FALSE(fdr_start(next));
+  FdrStoragePlan plan;
+  fdr_getStoragePlan(plan);
+  TEST_ASSERT_TRUE(plan.rejected);
+  next.pretrigger_ms = 1000; // no trigger condition
+  TEST_ASSERT_FALSE(fdr_start(next));
+
+  TEST_ASSERT_TRUE(fdr_isActive());
+  FdrSessionInfo info;
+  fdr_getSessionInfo(info);
+  TEST_ASSERT_EQUAL_UINT32(10000, info.rate_mhz);
+  TEST_ASSERT_FALSE(info.record_raw);
+  TEST_ASSERT_EQUAL_UINT32(0, info.pretrigger_ms);
+  TEST_ASSERT_EQUAL_UINT32(1, session_count);
+  runToEnd();
+  FdrBufferStats buffer;
+  fdr_getBufferStats(buffer);
+  TEST_ASSERT_UINT32_WITHIN(2, 300, buffer.baro_records);
+}
+
+static void test_backpressure_decimates_while_the_storage_stalls() {
+  FdrSessionConfig config;
+  config.duration_s = 120;
+  config.samples_per_sec = 50.0f;
+  config.record_raw = true;
+  TEST_ASSERT_TRUE(startSession(config));
+  // Long enough to overflow the RAM buffer at the full rate
+  ram_storage.stall_from_us = fdr_start_us + 5000000;
+  ram_storage.stall_until_us = fdr_start_us + 65000000;
+  runToEnd();
+
+  FdrStoragePlan plan;
+  fdr_getStoragePlan(plan);
+  FdrBufferStats buffer;
+  fdr_getBufferStats(buffer);
+  TEST_ASSERT_EQUAL_UINT32(0, buffer.overflow_records);
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(4, plan.max_decimation);
+  TEST_ASSERT_EQUAL_STRING("buffer", plan.backpressure_cause);
+  TEST_ASSERT_EQUAL_UINT8(1, plan.decimation); // eased once the storage caught up
+  TEST_ASSERT_GREATER_THAN_UINT32(0, plan.decimated_records);
+  TEST_ASSERT_UINT32_WITHIN(2, 120 * 50, buffer.baro_records + plan.decimated_records / 2);
+}
+
+static void test_interrupted_session_resumes_after_a_reset() {
+  FdrSessionConfig config;
+  config.duration_s = 20;
+  config.samples_per_sec = 10.0f;
+  config.record_altitude = false;
+  TEST_ASSERT_TRUE(startSession(config));
+  runUntilPowerLoss(8000);
+  rebootDevice();
+
+  TEST_ASSERT_TRUE(fdr_isActive());
+  FdrSessionInfo info;
+  fdr_getSessionInfo(info);
+  TEST_ASSERT_EQUAL_UINT32(1, info.resumed_from);
+  TEST_ASSERT_EQUAL_UINT32(2, info.session_id);
+  // About 7 s were committed before the power loss
+  TEST_ASSERT_UINT32_WITHIN(1, 13, info.duration_s);
+  runToEnd();
+
+  FdrSessionSummary sessions[FDR_MAX_SESSIONS];
+  TEST_ASSERT_EQUAL(2, fdr_listSessions(sessions, FDR_MAX_SESSIONS));
+  TEST_ASSERT_TRUE(sessions[0].recovered);
+  TEST_ASSERT_FALSE(sessions[0].resumed);
+  TEST_ASSERT_TRUE(sessions[1].resumed);
+  TEST_ASSERT_FALSE(sessions[1].open);
+
+  // Closed normally: the next boot stays idle
+  rebootDevice();
+  TEST_ASSERT_FALSE(fdr_isActive());
+}
+
+static void test_waiting_armed_session_is_armed_again() {
+  FdrSessionConfig config;
+  config.duration_s = 5;
+  config.samples_per_sec = 10.0f;
+  config.pretrigger_ms = 1000;
+  config.trigger.pressure_drop_pa_s = 200;
+  TEST_ASSERT_TRUE(startSession(config));
+  runUntilPowerLoss(3000);
+  rebootDevice();
+
+  FdrSessionInfo info;
+  fdr_getSessionInfo(info);
+  TEST_ASSERT_TRUE(info.armed);
+  TEST_ASSERT_EQUAL_UINT32(1000, info.pretrigger_ms);
+  FdrSessionSummary sessions[FDR_MAX_SESSIONS];
+  TEST_ASSERT_EQUAL(1, fdr_listSessions(sessions, FDR_MAX_SESSIONS)); // the empty one is gone
+  TEST_ASSERT_TRUE(sessions[0].open);
+}
+
+/**
+ * @brief Records one minute at 50 Hz with the altitude channel, long enough
+ * for a few dozen sync points.
+ */
+static void recordMinute() {
+  sim::pressure = [](uint32_t t_ms) { return 101325.0 + 20.0 * sin(t_ms / 700.0); };
+  sim::flight.valid = true;
+  FdrSessionConfig config;
+  config.duration_s = 60;
+  config.samples_per_sec = 50.0f;
+  TEST_ASSERT_TRUE(startSession(config));
+  runToEnd();
+}
+
+/**
+ * @brief /api/fdr/query response to `query`.
+ */
+static std::string runQuery(const char* query) {
+  httpd_req_t req = {};
+  mock::query = query;
+  mock::socket_output.clear();
+  mock::response_status.clear();
+  fdr_query(&req);
+  mock::query.clear();
+  return mock::socket_output;
+}
+
+static uint32_t jsonUint(const std::string &json, const char* key) {
+  const size_t at = json.find(std::string("\"") + key + "\":");
+  TEST_ASSERT_TRUE(at != std::string::npos);
+  return (uint32_t)strtoul(json.c_str() + at + strlen(key) + 3, nullptr, 10);
+}
+
+static void test_query_seeks_to_the_range() {
+  recordMinute();
+  FdrSessionSummary sessions[FDR_MAX_SESSIONS];
+  TEST_ASSERT_EQUAL(1, fdr_listSessions(sessions, FDR_MAX_SESSIONS));
+
+  const std::string json = runQuery("from=40&to=41&channels=baro");
+  TEST_ASSERT_TRUE(mock::response_status.empty());
+  TEST_ASSERT_TRUE(json.find("\"indexed\":true") != std::string::npos);
+  TEST_ASSERT_TRUE(json.find("\"rows\":[[\"baro\",40.000,") != std::string::npos);
+  TEST_ASSERT_TRUE(json.find("\"baro\",40.980,") != std::string::npos);
+  TEST_ASSERT_TRUE(json.find("\"next\":null") != std::string::npos);
+  TEST_ASSERT_EQUAL_UINT32(50, jsonUint(json, "count"));
+  // Started at the sync point before 40 s, not at the beginning
+  TEST_ASSERT_TRUE(jsonUint(json, "scanned_bytes") < sessions[0].bytes / 4);
+
+  // The sync points do not disturb a sequential export
+  TEST_ASSERT_EQUAL(sessions[0].baro_records + 1, countLines(exportCsv(FDR_REC_BARO)));
+}
+
+static void test_query_step_decimates() {
+  recordMinute();
+  const std::string json = runQuery("from=10&to=20&step=2.5&channels=baro,alt");
+  TEST_ASSERT_EQUAL_UINT32(8, jsonUint(json, "count")); // 4 steps of both channels
+  TEST_ASSERT_TRUE(json.find("[\"baro\",12.500,") != std::string::npos);
+  TEST_ASSERT_TRUE(json.find("[\"alt\",17.500,") != std::string::npos);
+
+  runQuery("from=20&to=10");
+  TEST_ASSERT_EQUAL_STRING(HTTPD_400, mock::response_status.c_str());
+  runQuery("channels=gps");
+  TEST_ASSERT_EQUAL_STRING(HTTPD_400, mock::response_status.c_str());
+}
+
+static void test_query_refuses_over_long_values() {
+  recordMinute();
+  // Longer than the channel list buffer: refused, not read as "all channels"
+  std::string json = runQuery("channels=baro,alt,baro,alt,baro,alt,baro,alt,baro,alt,baro,alt");
+  TEST_ASSERT_EQUAL_STRING(HTTPD_400, mock::response_status.c_str());
+  TEST_ASSERT_TRUE(json.find("parameter too long") != std::string::npos);
+  runQuery("from=00000000000000000040&to=41");
+  TEST_ASSERT_EQUAL_STRING(HTTPD_400, mock::response_status.c_str());
+  // A query past HTTP_MAX_QUERY_LEN is refused as a whole
+  const std::string query =
+      "from=40&to=41&channels=baro&pad=" + std::string(HTTP_MAX_QUERY_LEN, 'x');
+  json = runQuery(query.c_str());
+  TEST_ASSERT_EQUAL_STRING(HTTPD_400, mock::response_status.c_str());
+  TEST_ASSERT_TRUE(json.find("parameter too long") != std::string::npos);
+
+  runQuery("from=40&to=41&channels=baro");
+  TEST_ASSERT_TRUE(mock::response_status.empty());
+}
+
+static void test_query_of_the_live_session_reads_its_last_commit() {
+  sim::pressure = [](uint32_t t_ms) { return 101325.0 + 20.0 * sin(t_ms / 700.0); };
+  FdrSessionConfig config;
+  config.duration_s = 60;
+  config.samples_per_sec = 50.0f;
+  TEST_ASSERT_TRUE(startSession(config));
+  runUntilPowerLoss(20000);
+  fdr_sampling = true; // still recording, the sampler is only paused
+  const uint32_t syncs = storage_stats.syncs;
+  const uint32_t appends = ram_storage.appends;
+
+  const std::string json = runQuery("channels=baro");
+  TEST_ASSERT_TRUE(mock::response_status.empty());
+  TEST_ASSERT_EQUAL_UINT32(syncs, storage_stats.syncs); // nothing forced to flash
+  TEST_ASSERT_EQUAL_UINT32(appends, ram_storage.appends);
+  TEST_ASSERT_TRUE(json.find("\"indexed\":true") != std::string::npos);
+  // Up to the last commit, at most a commit interval and a writer poll behind
+  const uint32_t count = jsonUint(json, "count");
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(1000, count);
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(1000 - 50 * 2, count);
+}
+
+static void test_query_keeps_late_records_after_a_sync_point() {
+  sim::imu_ready = true;
+  FdrSessionConfig config;
+  config.duration_s = 60;
+  config.samples_per_sec = 10.0f;
+  config.imu_rate_hz = 100;
+  config.record_altitude = false;
+  TEST_ASSERT_TRUE(startSession(config));
+  {
+    // Each second, the IMU batch of one second and the barometer samples of
+    // the second before: each channel lands after sync points that already
+    // carry later timestamps of the other one
+    FdrLockGuard lock;
+    for (uint32_t s = 0; s <= 30; s++) {
+      for (uint32_t t = s * 1000; s < 30 && t < s * 1000 + 1000; t += 10) {
+        const int16_t noise = (int16_t)(t * 7919);
+        FdrImuRecord imu = {FDR_REC_IMU, t, {noise, (int16_t)-noise, 16384},
+                            {(int16_t)(noise / 3), 2, 3}};
+        TEST_ASSERT_TRUE(storeRecord((const uint8_t*)&imu));
+      }
+      for (uint32_t t = s * 1000 - 1000; s > 0 && t < s * 1000; t += 100) {
+        FdrBaroRecord baro = {FDR_REC_BARO, t, 101325 * 256 + t, 2150};
+        TEST_ASSERT_TRUE(storeRecord((const uint8_t*)&baro));
+      }
+      flushBufferToFile();
+    }
+    TEST_ASSERT_GREATER_THAN_UINT32(10, time_index_count);
+  }
+  fdr_stop();
+
+  // Every range sees all of its samples, wherever the seek lands
+  for (uint32_t from = 1; from < 29; from++) {
+    char query[64];
+    snprintf(query, sizeof(query), "from=%u&to=%u&channels=baro,imu", (unsigned)from,
+             (unsigned)from + 1);
+    const std::string json = runQuery(query);
+    TEST_ASSERT_TRUE(json.find("\"indexed\":true") != std::string::npos);
+    TEST_ASSERT_EQUAL_UINT32(10 + 100, jsonUint(json, "count"));
+  }
+}
+
+// ============================================================================
+// Benchmarks
+// ============================================================================
+
+static uint32_t percentile(std::vector<uint32_t> values, uint32_t pct) {
+  if (values.empty()) return 0;
+  std::sort(values.begin(), values.end());
+  return values[(values.size() - 1) * pct / 100];
+}
+
+/**
+ * @brief One minute of recording at a rate, with the altitude channel:
+ * host CPU time per sample, simulated flush latency and flash throughput.
+ */
+static void benchRate(float rate) {
+  sim::pressure = [](uint32_t t_ms) { return 101325.0 + 20.0 * sin(t_ms / 700.0); };
+  sim::flight.valid = true;
+  FdrSessionConfig config;
+  config.duration_s = 60;
+  config.samples_per_sec = rate;
+  TEST_ASSERT_TRUE(startSession(config));
+  const uint64_t started = mock::hostNs();
+  runToEnd();
+  const uint64_t elapsed = mock::hostNs() - started;
+
+  FdrTimingStats timing;
+  fdr_getTimingStats(timing);
+  FdrStorageStats stats;
+  fdr_getStorageStats(stats);
+  FdrBufferStats buffer;
+  fdr_getBufferStats(buffer);
+  char line[200];
+  snprintf(line, sizeof(line),
+           "%5.1f Hz: %u samples, %.0f ns/sample (host), %u flushes p50 %u us p99 %u us "
+           "max %u us, %.0f B/s to flash, %.2f B/sample, jitter max %u us",
+           rate, (unsigned)timing.samples, (double)elapsed / timing.samples,
+           (unsigned)stats.flushes, (unsigned)percentile(flush_latencies_us, 50),
+           (unsigned)percentile(flush_latencies_us, 99), (unsigned)stats.flush_max_us,
+           stats.write_bytes / 60.0,
+           buffer.baro_records ? (double)buffer.encoded_bytes / buffer.baro_records : 0.0,
+           (unsigned)timing.jitter_max_us);
+  TEST_MESSAGE(line);
+  TEST_ASSERT_EQUAL_UINT32(0, buffer.overflow_records);
+  TEST_ASSERT_EQUAL_UINT32(0, buffer.queue_dropped);
+}
+
+static void bench_1hz() { benchRate(1.0f); }
+static void bench_10hz() { benchRate(10.0f); }
+static void bench_50hz() { benchRate(50.0f); }
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_session_records_every_deadline);
+  RUN_TEST(test_csv_export_matches_the_samples);
+  RUN_TEST(test_csv_row_format);
+  RUN_TEST(test_flushes_follow_the_interval_at_low_rates);
+  RUN_TEST(test_armed_session_commits_the_pretrigger_window);
+  RUN_TEST(test_reader_commits_the_pretrigger_window_first);
+  RUN_TEST(test_untriggered_armed_session_is_deleted);
+  RUN_TEST(test_armed_session_needs_a_trigger);
+  RUN_TEST(test_forced_session_reads_one_conversion_per_sample);
+  RUN_TEST(test_short_periods_keep_normal_mode);
+  RUN_TEST(test_idle_reads_follow_the_demand);
+  RUN_TEST(test_start_lowers_the_rates_to_fit_the_storage);
+  RUN_TEST(test_start_rejects_a_session_that_does_not_fit);
+  RUN_TEST(test_rejected_start_leaves_the_session_recording);
+  RUN_TEST(test_backpressure_decimates_while_the_storage_stalls);
+  RUN_TEST(test_interrupted_session_resumes_after_a_reset);
+  RUN_TEST(test_waiting_armed_session_is_armed_again);
+  RUN_TEST(test_query_seeks_to_the_range);
+  RUN_TEST(test_query_step_decimates);
+  RUN_TEST(test_query_keeps_late_records_after_a_sync_point);
+  RUN_TEST(test_query_refuses_over_long_values);
+  RUN_TEST(test_query_of_the_live_session_reads_its_last_commit);
+  RUN_TEST(bench_1hz);
+  RUN_TEST(bench_10hz);
+  RUN_TEST(bench_50hz);
+  return UNITY_END();
+}
@@ -0,0 +1,101 @@
+/**
+ * @file test_main.cpp
+ * @brief Native tests of the status LED patterns and frame rate (led.cpp)
+ * @author slopez.tech
+ * @date 2025-11-30
+ */
+
+#include <unity.h>
+#include <Arduino.h>
+// The module is built into the suite, so its task step is reachable
+#include "led.cpp"
+
+/**
+ * @brief Runs the LED task for `ms`, one step per tick.
+ */
+static void runMs(uint32_t ms) {
+  for (uint32_t t = 0; t < ms; t += LED_TICK_MS) {
+    ledStep(millis());
+    mock::advanceUs((int64_t)LED_TICK_MS * 1000);
+  }
+}
+
+void setUp() {
+  mock::setTimeUs(0);
+  led_setMode(LedMode::Boot);
+  led_setCondition(LED_STORAGE_LOW | LED_SENSOR_LOST, false);
+  led_setHold(false);
+  led_init();
+  current_mode = LedMode::Boot;
+  shown = LED_OFF;
+  mock::neopixel_frames = 0;
+}
+
+void tearDown() {}
+
+static void test_startup_blink_ends_blue() {
+  runMs(LED_BOOT_MS - LED_TICK_MS);
+  TEST_ASSERT_EQUAL_UINT32(LED_BOOT_BLINKS * 2, mock::neopixel_frames);
+  runMs(LED_TICK_MS * 2);
+  TEST_ASSERT_TRUE(led_mode.load() == (uint8_t)LedMode::Idle);
+  TEST_ASSERT_EQUAL_UINT32(Adafruit_NeoPixel::Color(0, 0, 255), mock::neopixel_color);
+}
+
+static void test_mode_set_during_the_blink_wins() {
+  runMs(LED_BOOT_BLINK_MS * 3);
+  led_setMode(LedMode::Recording);
+  runMs(LED_BOOT_MS);
+  TEST_ASSERT_TRUE(led_mode.load() == (uint8_t)LedMode::Recording);
+  TEST_ASSERT_EQUAL_UINT32(Adafruit_NeoPixel::Color(0, 255, 0), mock::neopixel_color);
+}
+
+static void test_solid_color_is_shown_once() {
+  led_setMode(LedMode::Recording);
+  runMs(10000);
+  TEST_ASSERT_EQUAL_UINT32(1, mock::neopixel_frames);
+}
+
+static void test_armed_blinks_once_per_period() {
+  led_setMode(LedMode::Armed);
+  runMs(10 * LED_ARMED_PERIOD_MS);
+  TEST_ASSERT_EQUAL_UINT32(2 * 10, mock::neopixel_frames);
+}
+
+static void test_patterns() {
+  const LedColor amber = led_patternColor(LedMode::Armed, 0, 0);
+  TEST_ASSERT_TRUE(sameColor(amber, LED_AMBER));
+  TEST_ASSERT_TRUE(sameColor(led_patternColor(LedMode::Armed, 0, LED_ARMED_PERIOD_MS / 2), LED_OFF));
+  // Storage low: a red flash at the end of every second
+  TEST_ASSERT_TRUE(sameColor(led_patternColor(LedMode::Recording, LED_STORAGE_LOW, 0), LED_GREEN));
+  TEST_ASSERT_TRUE(sameColor(led_patternColor(LedMode::Recording, LED_STORAGE_LOW,
+                                              LED_STORAGE_FLASH_PERIOD_MS - 1), LED_RED));
+  // A lost sensor overrides the mode
+  TEST_ASSERT_TRUE(sameColor(led_patternColor(LedMode::Idle, LED_SENSOR_LOST, 0), LED_RED));
+  TEST_ASSERT_TRUE(sameColor(led_patternColor(LedMode::Idle, LED_SENSOR_LOST,
+                                              LED_SENSOR_LOST_PERIOD_MS / 2), LED_OFF));
+}
+
+static void test_hold_defers_the_frame() {
+  led_setMode(LedMode::Idle);
+  runMs(LED_TICK_MS);
+  const uint32_t frames = mock::neopixel_frames;
+  led_setHold(true);
+  led_setMode(LedMode::Recording);
+  runMs(1000);
+  TEST_ASSERT_EQUAL_UINT32(frames, mock::neopixel_frames);
+  led_setHold(false);
+  runMs(LED_TICK_MS);
+  TEST_ASSERT_EQUAL_UINT32(frames + 1, mock::neopixel_frames);
+  TEST_ASSERT_EQUAL_UINT32(Adafruit_NeoPixel::Color(0, 255, 0), mock::neopixel_color);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_startup_blink_ends_blue);
+  RUN_TEST(test_mode_set_during_the_blink_wins);
+  RUN_TEST(test_solid_color_is_shown_once);
+  RUN_TEST(test_armed_blinks_once_per_period);
+  RUN_TEST(test_patterns);
+  RUN_TEST(test_hold_defers_the_frame);
+  return UNITY_END();
+}
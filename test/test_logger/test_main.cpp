@@ -0,0 +1,88 @@
+/**
+ * @file test_main.cpp
+ * @brief Native tests of the logging ring and rate limiting (logger.cpp)
+ * @author slopez.tech
+ * @date 2025-11-30
+ */
+
+#include <unity.h>
+#include <Arduino.h>
+#include "logger.h"
+
+static LoggerLine lines[LOGGER_RING_LINES];
+
+void setUp() {
+  mock::setTimeUs(1000000);
+}
+
+void tearDown() {}
+
+static void test_lines_are_read_back_in_order() {
+  const uint32_t first = logger_nextSeq();
+  LOG_INFO("first %d", 1);
+  LOG_WARN("second");
+  uint32_t lost;
+  TEST_ASSERT_EQUAL(2, logger_read(first, lines, LOGGER_RING_LINES, lost));
+  TEST_ASSERT_EQUAL_UINT32(0, lost);
+  TEST_ASSERT_EQUAL_STRING("first 1", lines[0].text);
+  TEST_ASSERT_EQUAL_UINT8(LOGGER_LEVEL_INFO, lines[0].level);
+  TEST_ASSERT_EQUAL_UINT32(1000, lines[0].t_ms);
+  TEST_ASSERT_EQUAL_UINT32(first + 1, lines[1].seq);
+  TEST_ASSERT_EQUAL('W', logger_levelLetter(lines[1].level));
+  TEST_ASSERT_EQUAL(0, logger_read(first + 2, lines, LOGGER_RING_LINES, lost));
+}
+
+static void test_debug_is_compiled_out_by_default() {
+  const uint32_t first = logger_nextSeq();
+  int evaluated = 0;
+  LOG_DEBUG("%d", ++evaluated);
+  TEST_ASSERT_EQUAL(0, evaluated);
+  TEST_ASSERT_EQUAL_UINT32(first, logger_nextSeq());
+}
+
+static void test_long_lines_are_cut() {
+  const uint32_t first = logger_nextSeq();
+  char text[200];
+  memset(text, 'x', sizeof(text) - 1);
+  text[sizeof(text) - 1] = '\0';
+  LOG_ERROR("%s", text);
+  uint32_t lost;
+  TEST_ASSERT_EQUAL(1, logger_read(first, lines, 1, lost));
+  TEST_ASSERT_EQUAL(LOGGER_LINE_MAX - 1, strlen(lines[0].text));
+}
+
+static void test_overwritten_lines_are_reported_lost() {
+  const uint32_t first = logger_nextSeq();
+  for (size_t i = 0; i < LOGGER_RING_LINES + 5; i++) LOG_INFO("line %u", (unsigned)i);
+  uint32_t lost;
+  TEST_ASSERT_EQUAL(LOGGER_RING_LINES, logger_read(first, lines, LOGGER_RING_LINES, lost));
+  TEST_ASSERT_EQUAL_UINT32(5, lost);
+  TEST_ASSERT_EQUAL_STRING("line 5", lines[0].text);
+}
+
+static void logRepeatedly() {
+  LOG_WARN_EVERY(1000, "not ready");
+}
+
+static void test_repeats_are_rate_limited() {
+  const uint32_t first = logger_nextSeq();
+  for (int i = 0; i < 50; i++) { // 20 ms apart for 1 s
+    logRepeatedly();
+    mock::advanceUs(20000);
+  }
+  logRepeatedly();
+  uint32_t lost;
+  TEST_ASSERT_EQUAL(2, logger_read(first, lines, LOGGER_RING_LINES, lost));
+  TEST_ASSERT_EQUAL_STRING("not ready", lines[0].text);
+  TEST_ASSERT_EQUAL_STRING("not ready (49 more suppressed)", lines[1].text);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_lines_are_read_back_in_order);
+  RUN_TEST(test_debug_is_compiled_out_by_default);
+  RUN_TEST(test_long_lines_are_cut);
+  RUN_TEST(test_overwritten_lines_are_reported_lost);
+  RUN_TEST(test_repeats_are_rate_limited);
+  return UNITY_END();
+}
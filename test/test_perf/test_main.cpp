@@ -0,0 +1,99 @@
+/**
+ * @file test_main.cpp
+ * @brief Native tests of the profiling scopes (perf.cpp)
+ * @author slopez.tech
+ * @date 2025-11-30
+ */
+
+#include <unity.h>
+#include <Arduino.h>
+#include "perf.h"
+
+void setUp() {
+  mock::cpu_mhz = 160;
+  perf_reset();
+}
+
+void tearDown() {}
+
+static void test_min_avg_max() {
+  const uint32_t cycles[] = {160, 480, 320}; // 1, 3 and 2 µs at 160 MHz
+  for (uint32_t c : cycles) perf_record(PerfScope::FdrFlush, c);
+  PerfStats s;
+  perf_getStats(PerfScope::FdrFlush, s);
+  TEST_ASSERT_EQUAL_STRING("fdr_flush", s.name);
+  TEST_ASSERT_EQUAL_UINT32(3, s.count);
+  TEST_ASSERT_EQUAL_UINT32(1000, s.min_ns);
+  TEST_ASSERT_EQUAL_UINT32(2000, s.avg_ns);
+  TEST_ASSERT_EQUAL_UINT32(3000, s.max_ns);
+
+  perf_getStats(PerfScope::FdrSample, s);
+  TEST_ASSERT_EQUAL_UINT32(0, s.count);
+  TEST_ASSERT_EQUAL_UINT32(0, s.p99_ns);
+}
+
+static void test_durations_follow_the_clock_they_were_taken_at() {
+  perf_record(PerfScope::FdrSample, 16000);
+  mock::cpu_mhz = 80; // power saving mode
+  perf_record(PerfScope::FdrSample, 8000);
+  PerfStats s;
+  perf_getStats(PerfScope::FdrSample, s);
+  TEST_ASSERT_EQUAL_UINT32(100000, s.min_ns);
+  TEST_ASSERT_EQUAL_UINT32(100000, s.max_ns);
+  TEST_ASSERT_EQUAL_UINT32(100000, s.p99_ns);
+}
+
+static void test_percentiles_within_a_bucket() {
+  // 990 fast iterations (10 µs) and 10 slow ones (50 µs)
+  for (int i = 0; i < 990; i++) perf_record(PerfScope::FdrSample, 1600);
+  for (int i = 0; i < 10; i++) perf_record(PerfScope::FdrSample, 8000);
+  PerfStats s;
+  perf_getStats(PerfScope::FdrSample, s);
+  TEST_ASSERT_UINT32_WITHIN(2500, 10000 + 1250, s.p50_ns);
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(10000, s.p50_ns);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(12500, s.p99_ns);
+
+  perf_record(PerfScope::FdrSample, 8000);
+  perf_getStats(PerfScope::FdrSample, s);
+  TEST_ASSERT_EQUAL_UINT32(50000, s.p99_ns); // capped at max
+}
+
+static void test_extreme_durations() {
+  perf_record(PerfScope::HttpHandler, 0);
+  perf_record(PerfScope::HttpHandler, UINT32_MAX); // 26.8 s, saturates
+  PerfStats s;
+  perf_getStats(PerfScope::HttpHandler, s);
+  TEST_ASSERT_EQUAL_UINT32(0, s.min_ns);
+  TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, s.max_ns);
+  TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, s.p99_ns);
+}
+
+static void test_saturated_histogram_keeps_its_shape() {
+  // 400 ns, and 25.6 µs once in 50
+  for (uint32_t i = 0; i < 200000; i++) perf_record(PerfScope::FdrWriterStep, i % 50 ? 64 : 4096);
+  PerfStats s;
+  perf_getStats(PerfScope::FdrWriterStep, s);
+  TEST_ASSERT_EQUAL_UINT32(200000, s.count);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(500, s.p50_ns);
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(25600, s.p99_ns);
+}
+
+static void test_scope_times_its_block() {
+  {
+    PERF_SCOPE(BarometerProcess);
+  }
+  PerfStats s;
+  perf_getStats(PerfScope::BarometerProcess, s);
+  TEST_ASSERT_EQUAL_UINT32(1, s.count);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_min_avg_max);
+  RUN_TEST(test_durations_follow_the_clock_they_were_taken_at);
+  RUN_TEST(test_percentiles_within_a_bucket);
+  RUN_TEST(test_extreme_durations);
+  RUN_TEST(test_saturated_histogram_keeps_its_shape);
+  RUN_TEST(test_scope_times_its_block);
+  return UNITY_END();
+}
@@ -0,0 +1,141 @@
+/**
+ * @file test_main.cpp
+ * @brief Native tests of the power modes and their accounting (power.cpp)
+ * @author slopez.tech
+ * @date 2025-11-30
+ */
+
+#include <unity.h>
+#include <Arduino.h>
+#include <esp_sleep.h>
+#include <esp_freertos_hooks.h>
+#include "power.h"
+
+static constexpr int64_t LISTEN_PERIOD_US = (int64_t)POWER_LISTEN_PERIOD_MS * 1000;
+
+/**
+ * @brief Moves the clock to `ms` into the next listen period.
+ */
+static void atPhaseMs(uint32_t ms) {
+  mock::setTimeUs((mock::now_us / LISTEN_PERIOD_US + 1) * LISTEN_PERIOD_US + (int64_t)ms * 1000);
+}
+
+void setUp() {
+  power_init();
+  power_setMode(PowerMode::Performance);
+  power_setClients(0);
+  power_holdFlight(false);
+  mock::advanceUs((int64_t)POWER_CLIENT_LINGER_MS * 1000 * 2);
+  mock::light_sleeps = 0;
+}
+
+void tearDown() {}
+
+static void test_performance_mode_never_sleeps() {
+  atPhaseMs(2000);
+  power_prepareWait(mock::now_us + 500000);
+  mock::idle_hook();
+  TEST_ASSERT_EQUAL_UINT32(0, mock::light_sleeps);
+  TEST_ASSERT_EQUAL_UINT32(POWER_AWAKE_MHZ, mock::cpu_mhz);
+  PowerStats s;
+  power_getStats(s);
+  TEST_ASSERT_EQUAL_STRING("awake", power_stateName(s.state));
+}
+
+static void test_saving_mode_sleeps_until_the_sampler_wakes() {
+  atPhaseMs(2000);
+  const int64_t start_us = mock::now_us;
+  power_setMode(PowerMode::Saving);
+  power_prepareWait(start_us + 500000);
+  TEST_ASSERT_EQUAL_UINT32(POWER_DOZE_MHZ, mock::cpu_mhz);
+
+  mock::idle_hook();
+  TEST_ASSERT_EQUAL_UINT32(1, mock::light_sleeps);
+  TEST_ASSERT_TRUE(mock::now_us < start_us + 500000);
+  TEST_ASSERT_TRUE(mock::now_us >= start_us + 490000);
+  mock::idle_hook(); // too close to the wakeup for another one
+  TEST_ASSERT_EQUAL_UINT32(1, mock::light_sleeps);
+
+  PowerStats s;
+  power_getStats(s);
+  TEST_ASSERT_EQUAL_STRING("saving", power_modeName(s.mode));
+  TEST_ASSERT_EQUAL_STRING("doze", power_stateName(s.state));
+  TEST_ASSERT_EQUAL_UINT32(1, s.sleeps);
+  TEST_ASSERT_TRUE(s.time_us[(size_t)PowerState::Sleep] == (uint64_t)(mock::now_us - start_us));
+  TEST_ASSERT_TRUE(s.time_us[(size_t)PowerState::Doze] == 0);
+  TEST_ASSERT_EQUAL_UINT32(s.current_ua[(size_t)PowerState::Sleep], s.average_ua);
+}
+
+static void test_listen_window_keeps_the_radio_on() {
+  power_setMode(PowerMode::Saving);
+  atPhaseMs(500);
+  power_prepareWait(mock::now_us + 2000000);
+  mock::idle_hook();
+  TEST_ASSERT_EQUAL_UINT32(0, mock::light_sleeps);
+
+  atPhaseMs(4000);
+  const int64_t window_us = mock::now_us + 1000000;
+  power_prepareWait(mock::now_us + 2000000);
+  mock::idle_hook();
+  TEST_ASSERT_EQUAL_UINT32(1, mock::light_sleeps);
+  TEST_ASSERT_TRUE(mock::now_us == window_us); // woken for the next window
+  mock::idle_hook();
+  TEST_ASSERT_EQUAL_UINT32(1, mock::light_sleeps);
+}
+
+static void test_clients_hold_the_device_awake() {
+  power_setMode(PowerMode::Saving);
+  atPhaseMs(2000);
+  power_setClients(1);
+  TEST_ASSERT_EQUAL_UINT32(POWER_AWAKE_MHZ, mock::cpu_mhz);
+  power_prepareWait(mock::now_us + 500000);
+  mock::idle_hook();
+  TEST_ASSERT_EQUAL_UINT32(0, mock::light_sleeps);
+
+  // Still awake while the last client lingers
+  power_setClients(0);
+  mock::advanceUs((int64_t)POWER_CLIENT_LINGER_MS * 1000 - 1000);
+  power_prepareWait(mock::now_us + 500000);
+  TEST_ASSERT_EQUAL_UINT32(POWER_AWAKE_MHZ, mock::cpu_mhz);
+  mock::advanceUs(1000);
+  power_prepareWait(mock::now_us + 500000);
+  TEST_ASSERT_EQUAL_UINT32(POWER_DOZE_MHZ, mock::cpu_mhz);
+}
+
+static void test_flight_holds_the_device_awake() {
+  power_setMode(PowerMode::Saving);
+  TEST_ASSERT_EQUAL_UINT32(POWER_DOZE_MHZ, mock::cpu_mhz);
+  power_holdFlight(true);
+  TEST_ASSERT_EQUAL_UINT32(POWER_AWAKE_MHZ, mock::cpu_mhz);
+  PowerStats s;
+  power_getStats(s);
+  TEST_ASSERT_TRUE(s.flight);
+  power_holdFlight(false);
+  TEST_ASSERT_EQUAL_UINT32(POWER_DOZE_MHZ, mock::cpu_mhz);
+}
+
+static void test_average_weights_the_measured_currents() {
+  power_setStateCurrent(PowerState::Doze, 40000);
+  power_setStateCurrent(PowerState::Sleep, 2000);
+  atPhaseMs(1000);
+  power_setMode(PowerMode::Saving);
+  mock::advanceUs(1000000); // 1 s dozing
+  power_prepareWait(mock::now_us + 3000000 + 2000);
+  mock::idle_hook();        // then 3 s asleep
+  PowerStats s;
+  power_getStats(s);
+  TEST_ASSERT_TRUE(s.time_us[(size_t)PowerState::Doze] == 1000000);
+  TEST_ASSERT_TRUE(s.time_us[(size_t)PowerState::Sleep] == 3000000);
+  TEST_ASSERT_EQUAL_UINT32((40000 + 3 * 2000) / 4, s.average_ua);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_performance_mode_never_sleeps);
+  RUN_TEST(test_saving_mode_sleeps_until_the_sampler_wakes);
+  RUN_TEST(test_listen_window_keeps_the_radio_on);
+  RUN_TEST(test_clients_hold_the_device_awake);
+  RUN_TEST(test_flight_holds_the_device_awake);
+  RUN_TEST(test_average_weights_the_measured_currents);
+  return UNITY_END();
+}
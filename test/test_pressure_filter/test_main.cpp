@@ -0,0 +1,143 @@
+/**
+ * @file test_main.cpp
+ * @brief Native tests and benchmark of the pressure filter chain
+ * (pressure_filter.cpp)
+ * @author slopez.tech
+ * @date 2025-11-30
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include "pressure_filter.h"
+#include "mock_clock.h"
+
+static constexpr uint32_t PA = 256; // Q24.8
+static constexpr uint32_t GROUND_Q8 = 101325 * PA;
+
+static PressureFilterConfig parsed(const char* spec) {
+  PressureFilterConfig config;
+  TEST_ASSERT_TRUE(pressureFilter_parse(spec, config));
+  return config;
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_parse_describe_round_trip() {
+  char text[64];
+  pressureFilter_describe(PressureFilterConfig(), text, sizeof(text));
+  TEST_ASSERT_EQUAL_STRING("ema:0.250", text);
+  pressureFilter_describe(parsed("median:3,kalman:200:2"), text, sizeof(text));
+  TEST_ASSERT_EQUAL_STRING("median:3,kalman:200:2", text);
+  pressureFilter_describe(parsed(text), text, sizeof(text));
+  TEST_ASSERT_EQUAL_STRING("median:3,kalman:200:2", text);
+  pressureFilter_describe(parsed("none"), text, sizeof(text));
+  TEST_ASSERT_EQUAL_STRING("none", text);
+}
+
+static void test_invalid_chains_are_rejected() {
+  PressureFilterConfig config;
+  const char* invalid[] = {"", "bogus", "ema:0", "ema:1.5", "median:4", "median:11",
+                           "ema,ema,ema,ema", "kalman:-1"};
+  for (const char* spec : invalid) {
+    TEST_ASSERT_FALSE(pressureFilter_parse(spec, config));
+  }
+  char text[64];
+  pressureFilter_describe(config, text, sizeof(text));
+  TEST_ASSERT_EQUAL_STRING("ema:0.250", text); // unchanged
+}
+
+static void test_pack_stores_kinds_in_nibbles() {
+  TEST_ASSERT_EQUAL_UINT16(0x0032, pressureFilter_pack(parsed("median,kalman")));
+  TEST_ASSERT_EQUAL_UINT16(0x0001, pressureFilter_pack(PressureFilterConfig()));
+}
+
+static void test_bypass_passes_samples_through() {
+  PressureFilterChain chain;
+  pressureFilter_init(chain, parsed("none"));
+  for (uint32_t i = 0; i < 10; i++) {
+    TEST_ASSERT_EQUAL_UINT32(GROUND_Q8 + i * 977, pressureFilter_apply(chain, i * 20, GROUND_Q8 + i * 977));
+  }
+}
+
+static void test_ema_converges_on_a_step() {
+  PressureFilterChain chain;
+  pressureFilter_init(chain, PressureFilterConfig());
+  TEST_ASSERT_EQUAL_UINT32(GROUND_Q8, pressureFilter_apply(chain, 0, GROUND_Q8));
+  const uint32_t step_q8 = GROUND_Q8 - 100 * PA;
+  uint32_t out = 0;
+  out = pressureFilter_apply(chain, 20, step_q8);
+  TEST_ASSERT_UINT32_WITHIN(PA, GROUND_Q8 - 25 * PA, out); // alpha 0.25
+  for (uint32_t i = 2; i < 60; i++) out = pressureFilter_apply(chain, i * 20, step_q8);
+  TEST_ASSERT_UINT32_WITHIN(PA / 4, step_q8, out);
+}
+
+static void test_median_rejects_a_spike() {
+  PressureFilterChain chain;
+  pressureFilter_init(chain, parsed("median:5"));
+  uint32_t out = 0;
+  for (uint32_t i = 0; i < 20; i++) {
+    const uint32_t in = (i == 10) ? GROUND_Q8 - 2000 * PA : GROUND_Q8;
+    out = pressureFilter_apply(chain, i * 20, in);
+    TEST_ASSERT_EQUAL_UINT32(GROUND_Q8, out);
+  }
+}
+
+static void test_kalman_tracks_a_climb_and_its_rate() {
+  PressureFilterChain chain;
+  pressureFilter_init(chain, parsed("kalman"));
+  // 120 Pa/s drop (about 10 m/s climb), 50 Hz
+  uint32_t out = 0;
+  uint32_t in = 0;
+  for (uint32_t i = 0; i < 250; i++) {
+    in = GROUND_Q8 - (uint32_t)((uint64_t)i * 120 * PA / 50);
+    out = pressureFilter_apply(chain, i * 20, in);
+  }
+  TEST_ASSERT_UINT32_WITHIN(2 * PA, in, out);
+  TEST_ASSERT_INT32_WITHIN(10 * (int32_t)PA, -120 * (int32_t)PA, pressureFilter_rate(chain));
+}
+
+static void test_rate_is_zero_without_kalman() {
+  PressureFilterChain chain;
+  pressureFilter_init(chain, parsed("median,ema"));
+  for (uint32_t i = 0; i < 10; i++) pressureFilter_apply(chain, i * 20, GROUND_Q8 - i * PA);
+  TEST_ASSERT_EQUAL_INT32(0, pressureFilter_rate(chain));
+}
+
+/**
+ * @brief Host cost per sample of each stage, and of the longest chain.
+ */
+static void bench_chains() {
+  const char* specs[] = {"none", "ema", "median:9", "kalman", "median:5,kalman,ema"};
+  for (const char* spec : specs) {
+    PressureFilterChain chain;
+    pressureFilter_init(chain, parsed(spec));
+    volatile uint32_t sink = 0;
+    const uint32_t samples = 200000;
+    const uint64_t started = mock::hostNs();
+    for (uint32_t i = 0; i < samples; i++) {
+      sink = pressureFilter_apply(chain, i * 20, GROUND_Q8 - (i % 97) * 31);
+    }
+    const uint64_t elapsed = mock::hostNs() - started;
+    (void)sink;
+    char line[96];
+    snprintf(line, sizeof(line), "filter %-20s %.1f ns/sample (host)", spec,
+             (double)elapsed / samples);
+    TEST_MESSAGE(line);
+  }
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_parse_describe_round_trip);
+  RUN_TEST(test_invalid_chains_are_rejected);
+  RUN_TEST(test_pack_stores_kinds_in_nibbles);
+  RUN_TEST(test_bypass_passes_samples_through);
+  RUN_TEST(test_ema_converges_on_a_step);
+  RUN_TEST(test_median_rejects_a_spike);
+  RUN_TEST(test_kalman_tracks_a_climb_and_its_rate);
+  RUN_TEST(test_rate_is_zero_without_kalman);
+  RUN_TEST(bench_chains);
+  return UNITY_END();
+}